@@ -0,0 +1,321 @@
+/**
+Copyright 2026 Carl van Mastrigt
+
+This file is part of solipsix.
+
+solipsix is free software: you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+solipsix is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with solipsix.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdatomic.h>
+#include <threads.h>
+#include <time.h>
+#include <unistd.h>
+#include <assert.h>
+
+/** shared helpers for the standalone benchmark programs in this directory
+ * every benchmark writes one JSON object per line to stdout, so runs can be diffed or loaded into anything that reads JSON:
+ *     {"benchmark":"pool","variant":"magazine","threads":4,"operations":4194304,"seconds":0.0523,"operations_per_second":8.02e+07,
+ *      "latency_ns":{"samples":262144,"p50":40,"p90":52,"p99":180,"p999":2410,"max":51200}}
+ * latency is sampled (every SOL_BENCHMARK_LATENCY_SAMPLE_INTERVAL operations) rather than measured for every operation, so that the timing doesn't dominate throughput
+ * what a single operation/latency sample covers is described by each benchmark */
+
+#ifndef SOL_BENCHMARK_LATENCY_SAMPLE_INTERVAL
+#define SOL_BENCHMARK_LATENCY_SAMPLE_INTERVAL 16
+#endif
+
+static_assert((SOL_BENCHMARK_LATENCY_SAMPLE_INTERVAL & (SOL_BENCHMARK_LATENCY_SAMPLE_INTERVAL - 1)) == 0, "sample interval must be a power of 2");
+
+static inline uint64_t sol_benchmark_time(void)
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (uint64_t)time.tv_sec * 1000000000llu + (uint64_t)time.tv_nsec;
+}
+
+static inline bool sol_benchmark_should_sample(uint64_t operation_index)
+{
+    return (operation_index & (SOL_BENCHMARK_LATENCY_SAMPLE_INTERVAL - 1)) == 0;
+}
+
+/** processors available to this process, used as the default maximum thread count */
+static inline uint32_t sol_benchmark_processor_count(void)
+{
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (uint32_t)count : 1;
+}
+
+
+
+struct sol_benchmark_latencies
+{
+    uint64_t* samples;
+    uint32_t count;
+    uint32_t space;
+};
+
+static inline void sol_benchmark_latencies_initialise(struct sol_benchmark_latencies* latencies)
+{
+    latencies->samples = NULL;
+    latencies->count = 0;
+    latencies->space = 0;
+}
+
+static inline void sol_benchmark_latencies_terminate(struct sol_benchmark_latencies* latencies)
+{
+    free(latencies->samples);
+}
+
+static inline void sol_benchmark_latencies_reset(struct sol_benchmark_latencies* latencies)
+{
+    latencies->count = 0;
+}
+
+static inline void sol_benchmark_latencies_record(struct sol_benchmark_latencies* latencies, uint64_t nanoseconds)
+{
+    if(latencies->count == latencies->space)
+    {
+        latencies->space = latencies->space ? latencies->space * 2 : 1024;
+        latencies->samples = realloc(latencies->samples, sizeof(uint64_t) * latencies->space);
+    }
+    latencies->samples[latencies->count++] = nanoseconds;
+}
+
+static inline void sol_benchmark_latencies_append(struct sol_benchmark_latencies* latencies, const struct sol_benchmark_latencies* source)
+{
+    uint32_t i;
+    for(i = 0; i < source->count; i++)
+    {
+        sol_benchmark_latencies_record(latencies, source->samples[i]);
+    }
+}
+
+static inline int sol_benchmark_latency_compare(const void* a, const void* b)
+{
+    uint64_t va = *(const uint64_t*)a;
+    uint64_t vb = *(const uint64_t*)b;
+    return (va > vb) - (va < vb);
+}
+
+/** sorts the samples, `per_mille` is out of 1000 (e.g. 999 for the 99.9th percentile) */
+static inline uint64_t sol_benchmark_latencies_percentile(struct sol_benchmark_latencies* latencies, uint32_t per_mille)
+{
+    uint64_t index;
+
+    if(latencies->count == 0)
+    {
+        return 0;
+    }
+
+    qsort(latencies->samples, latencies->count, sizeof(uint64_t), &sol_benchmark_latency_compare);
+
+    index = ((uint64_t)latencies->count * per_mille) / 1000;
+    return latencies->samples[index < latencies->count ? index : latencies->count - 1];
+}
+
+
+
+struct sol_benchmark_result
+{
+    uint32_t thread_count;
+    uint64_t operation_count;
+    uint64_t nanoseconds;
+    struct sol_benchmark_latencies latencies;
+};
+
+static inline void sol_benchmark_result_initialise(struct sol_benchmark_result* result, uint32_t thread_count)
+{
+    result->thread_count = thread_count;
+    result->operation_count = 0;
+    result->nanoseconds = 0;
+    sol_benchmark_latencies_initialise(&result->latencies);
+}
+
+static inline void sol_benchmark_result_terminate(struct sol_benchmark_result* result)
+{
+    sol_benchmark_latencies_terminate(&result->latencies);
+}
+
+static inline void sol_benchmark_result_write_json(FILE* file, const char* benchmark, const char* variant, struct sol_benchmark_result* result)
+{
+    double seconds = (double)result->nanoseconds * 1e-9;
+
+    fprintf(file, "{\"benchmark\":\"%s\",\"variant\":\"%s\",\"threads\":%"PRIu32",\"operations\":%"PRIu64",\"seconds\":%.6f,\"operations_per_second\":%.4g,",
+        benchmark, variant, result->thread_count, result->operation_count, seconds, seconds > 0.0 ? (double)result->operation_count / seconds : 0.0);
+
+    fprintf(file, "\"latency_ns\":{\"samples\":%"PRIu32",\"p50\":%"PRIu64",\"p90\":%"PRIu64",\"p99\":%"PRIu64",\"p999\":%"PRIu64",\"max\":%"PRIu64"}}\n",
+        result->latencies.count,
+        sol_benchmark_latencies_percentile(&result->latencies, 500),
+        sol_benchmark_latencies_percentile(&result->latencies, 900),
+        sol_benchmark_latencies_percentile(&result->latencies, 990),
+        sol_benchmark_latencies_percentile(&result->latencies, 999),
+        sol_benchmark_latencies_percentile(&result->latencies, 1000));
+
+    fflush(file);
+}
+
+
+
+/** spinning barrier for lock-step rounds between benchmark threads, spinning so that waking threads doesn't show up in the measurements */
+struct sol_benchmark_spin_barrier
+{
+    atomic_uint_fast32_t arrived;
+    atomic_uint_fast32_t generation;
+    uint32_t thread_count;
+};
+
+static inline void sol_benchmark_spin_barrier_initialise(struct sol_benchmark_spin_barrier* barrier, uint32_t thread_count)
+{
+    atomic_init(&barrier->arrived, 0);
+    atomic_init(&barrier->generation, 0);
+    barrier->thread_count = thread_count;
+}
+
+static inline void sol_benchmark_spin_barrier_wait(struct sol_benchmark_spin_barrier* barrier)
+{
+    uint_fast32_t generation = atomic_load_explicit(&barrier->generation, memory_order_acquire);
+
+    if(atomic_fetch_add_explicit(&barrier->arrived, 1, memory_order_acq_rel) + 1 == barrier->thread_count)
+    {
+        atomic_store_explicit(&barrier->arrived, 0, memory_order_relaxed);
+        atomic_store_explicit(&barrier->generation, generation + 1, memory_order_release);
+    }
+    else
+    {
+        /** yield rather than spin outright, otherwise oversubscribed runs (more threads than processors) take forever */
+        while(atomic_load_explicit(&barrier->generation, memory_order_acquire) == generation)
+        {
+            thrd_yield();
+        }
+    }
+}
+
+
+
+/** runs `thread_function` on `thread_count` threads which start together, the result covers the time from the start until every thread has returned
+ * each thread counts its own operations and records its own latencies, which are gathered into the result afterwards */
+struct sol_benchmark_start
+{
+    atomic_uint_fast32_t ready_count;
+    atomic_bool started;
+};
+
+struct sol_benchmark_thread
+{
+    uint32_t index;
+    uint32_t thread_count;
+    void* data;
+
+    uint64_t operation_count;
+    struct sol_benchmark_latencies latencies;
+
+    struct sol_benchmark_start* start;
+    void (*thread_function)(struct sol_benchmark_thread* thread);
+};
+
+static inline int sol_benchmark_thread_entry(void* in)
+{
+    struct sol_benchmark_thread* thread = in;
+
+    atomic_fetch_add_explicit(&thread->start->ready_count, 1, memory_order_relaxed);
+    while( ! atomic_load_explicit(&thread->start->started, memory_order_acquire))
+    {
+        thrd_yield();
+    }
+
+    thread->thread_function(thread);
+
+    return 0;
+}
+
+static inline void sol_benchmark_run_threads(struct sol_benchmark_result* result, uint32_t thread_count, void (*thread_function)(struct sol_benchmark_thread* thread), void* data)
+{
+    struct sol_benchmark_start start;
+    struct sol_benchmark_thread* threads;
+    thrd_t* handles;
+    uint64_t start_time;
+    uint32_t i;
+
+    threads = malloc(sizeof(struct sol_benchmark_thread) * thread_count);
+    handles = malloc(sizeof(thrd_t) * thread_count);
+
+    atomic_init(&start.ready_count, 0);
+    atomic_init(&start.started, false);
+
+    for(i = 0; i < thread_count; i++)
+    {
+        threads[i] = (struct sol_benchmark_thread)
+        {
+            .index = i,
+            .thread_count = thread_count,
+            .data = data,
+            .operation_count = 0,
+            .start = &start,
+            .thread_function = thread_function,
+        };
+        sol_benchmark_latencies_initialise(&threads[i].latencies);
+
+        thrd_create(handles + i, &sol_benchmark_thread_entry, threads + i);
+    }
+
+    /** the start time must be taken before any thread is let go, a thread may otherwise run to completion before this thread is scheduled again */
+    while(atomic_load_explicit(&start.ready_count, memory_order_relaxed) < thread_count)
+    {
+        thrd_yield();
+    }
+    start_time = sol_benchmark_time();
+    atomic_store_explicit(&start.started, true, memory_order_release);
+
+    for(i = 0; i < thread_count; i++)
+    {
+        thrd_join(handles[i], NULL);
+    }
+
+    result->nanoseconds = sol_benchmark_time() - start_time;
+    result->thread_count = thread_count;
+
+    for(i = 0; i < thread_count; i++)
+    {
+        result->operation_count += threads[i].operation_count;
+        sol_benchmark_latencies_append(&result->latencies, &threads[i].latencies);
+        sol_benchmark_latencies_terminate(&threads[i].latencies);
+    }
+
+    free(handles);
+    free(threads);
+}
+
+/** thread counts to benchmark: powers of 2 up to and including `maximum_thread_count` (and it too if it isnt a power of 2)
+ * returns the number of counts written, `thread_counts` must have space for 34 */
+static inline uint32_t sol_benchmark_thread_counts(uint32_t* thread_counts, uint32_t maximum_thread_count)
+{
+    uint32_t count = 0;
+    uint32_t thread_count;
+
+    for(thread_count = 1; thread_count <= maximum_thread_count && thread_count; thread_count *= 2)
+    {
+        thread_counts[count++] = thread_count;
+    }
+    if(thread_counts[count - 1] != maximum_thread_count)
+    {
+        thread_counts[count++] = maximum_thread_count;
+    }
+
+    return count;
+}
@@ -0,0 +1,309 @@
+/**
+Copyright 2026 Carl van Mastrigt
+
+This file is part of solipsix.
+
+solipsix is free software: you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+solipsix is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with solipsix.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/** compares the 4-ary `data_structures/binary_heap.h` (the default `SOL_BINARY_HEAP_ARITY`) against the same heap as a regular binary heap
+ *
+ * usage: binary_heap_benchmark [largest entry count exponent, base 10 (default: 7)] [seed (default: 1)]
+ *
+ * build from the directory containing solipsix, e.g.:
+ *     cc -std=gnu17 -O2 -DNDEBUG -Isolipsix -I. solipsix/benchmarks/binary_heap_benchmark.c -lpthread -o binary_heap_benchmark
+ *
+ * entries are a random 56 bit key and an identifier, the heap index of every identifier is tracked (as the atlases and allocators do) so entries can be updated in place
+ * every benchmark is run with 10^3 entries up to the largest entry count, the entry count is appended to the benchmark name (e.g. "binary_heap_push_1000")
+ * benchmarks (JSON lines, see benchmarks/benchmark.h), variants are "arity_2" and "arity_4":
+ *     binary_heap_push:   operation is appending one entry to a heap being filled from empty to the entry count, latency is one operation
+ *     binary_heap_pop:    operation is withdrawing the top entry of a heap being drained from the entry count to empty, latency is one operation
+ *     binary_heap_update: operation is giving a random entry of a full heap a new random key and restoring its place with update_index, latency is one operation
+ *     binary_heap_hold:   operation is withdrawing the top entry of a full heap and appending it again with a larger key (the event queue "hold" model), latency is one operation */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "benchmarks/benchmark.h"
+
+struct sol_binary_heap_benchmark_entry
+{
+    uint64_t key;
+    uint32_t identifier;
+};
+
+#define SOL_BINARY_HEAP_ENTRY_TYPE struct sol_binary_heap_benchmark_entry
+#define SOL_BINARY_HEAP_STRUCT_NAME sol_binary_heap_benchmark_heap_2
+#define SOL_BINARY_HEAP_CONTEXT_TYPE uint32_t*
+#define SOL_BINARY_HEAP_ENTRY_CMP_LT(A, B, CTX) ((A)->key < (B)->key)
+#define SOL_BINARY_HEAP_SET_ENTRY_INDEX(E, IDX, CTX) ((CTX)[(E)->identifier] = (IDX))
+#define SOL_BINARY_HEAP_ARITY 2
+#include "data_structures/binary_heap.h"
+
+#define SOL_BINARY_HEAP_ENTRY_TYPE struct sol_binary_heap_benchmark_entry
+#define SOL_BINARY_HEAP_STRUCT_NAME sol_binary_heap_benchmark_heap_4
+#define SOL_BINARY_HEAP_CONTEXT_TYPE uint32_t*
+#define SOL_BINARY_HEAP_ENTRY_CMP_LT(A, B, CTX) ((A)->key < (B)->key)
+#define SOL_BINARY_HEAP_SET_ENTRY_INDEX(E, IDX, CTX) ((CTX)[(E)->identifier] = (IDX))
+#define SOL_BINARY_HEAP_ARITY 4
+#include "data_structures/binary_heap.h"
+
+
+#define SOL_BINARY_HEAP_BENCHMARK_SMALLEST_EXPONENT 3
+#define SOL_BINARY_HEAP_BENCHMARK_LARGEST_EXPONENT 9
+
+
+enum sol_binary_heap_benchmark_variant
+{
+    SOL_BINARY_HEAP_BENCHMARK_ARITY_2,
+    SOL_BINARY_HEAP_BENCHMARK_ARITY_4,
+    SOL_BINARY_HEAP_BENCHMARK_VARIANT_COUNT,
+};
+
+static const char* const sol_binary_heap_benchmark_variant_names[SOL_BINARY_HEAP_BENCHMARK_VARIANT_COUNT] =
+{
+    [SOL_BINARY_HEAP_BENCHMARK_ARITY_2] = "arity_2",
+    [SOL_BINARY_HEAP_BENCHMARK_ARITY_4] = "arity_4",
+};
+
+enum sol_binary_heap_benchmark_operation
+{
+    SOL_BINARY_HEAP_BENCHMARK_PUSH,
+    SOL_BINARY_HEAP_BENCHMARK_POP,
+    SOL_BINARY_HEAP_BENCHMARK_UPDATE,
+    SOL_BINARY_HEAP_BENCHMARK_HOLD,
+    SOL_BINARY_HEAP_BENCHMARK_OPERATION_COUNT,
+};
+
+static const char* const sol_binary_heap_benchmark_operation_names[SOL_BINARY_HEAP_BENCHMARK_OPERATION_COUNT] =
+{
+    [SOL_BINARY_HEAP_BENCHMARK_PUSH]   = "binary_heap_push",
+    [SOL_BINARY_HEAP_BENCHMARK_POP]    = "binary_heap_pop",
+    [SOL_BINARY_HEAP_BENCHMARK_UPDATE] = "binary_heap_update",
+    [SOL_BINARY_HEAP_BENCHMARK_HOLD]   = "binary_heap_hold",
+};
+
+/** both heaps have the same layout, only the functions differ */
+struct sol_binary_heap_benchmark_data
+{
+    enum sol_binary_heap_benchmark_variant variant;
+    union
+    {
+        struct sol_binary_heap_benchmark_heap_2 heap_2;
+        struct sol_binary_heap_benchmark_heap_4 heap_4;
+    };
+    uint32_t* heap_indices;
+    uint64_t random_state;
+};
+
+static inline uint64_t sol_binary_heap_benchmark_random(uint64_t* state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+static inline void sol_binary_heap_benchmark_append(struct sol_binary_heap_benchmark_data* data, struct sol_binary_heap_benchmark_entry entry)
+{
+    if(data->variant == SOL_BINARY_HEAP_BENCHMARK_ARITY_2)
+    {
+        sol_binary_heap_benchmark_heap_2_append(&data->heap_2, entry, data->heap_indices);
+    }
+    else
+    {
+        sol_binary_heap_benchmark_heap_4_append(&data->heap_4, entry, data->heap_indices);
+    }
+}
+
+static inline void sol_binary_heap_benchmark_withdraw(struct sol_binary_heap_benchmark_data* data, struct sol_binary_heap_benchmark_entry* entry)
+{
+    bool withdrawn;
+
+    if(data->variant == SOL_BINARY_HEAP_BENCHMARK_ARITY_2)
+    {
+        withdrawn = sol_binary_heap_benchmark_heap_2_withdraw(&data->heap_2, entry, data->heap_indices);
+    }
+    else
+    {
+        withdrawn = sol_binary_heap_benchmark_heap_4_withdraw(&data->heap_4, entry, data->heap_indices);
+    }
+
+    if( ! withdrawn)
+    {
+        fprintf(stderr, "binary heap benchmark withdrew from an empty heap\n");
+        abort();
+    }
+}
+
+static inline void sol_binary_heap_benchmark_update(struct sol_binary_heap_benchmark_data* data, uint32_t identifier, uint64_t key)
+{
+    const uint32_t index = data->heap_indices[identifier];
+
+    if(data->variant == SOL_BINARY_HEAP_BENCHMARK_ARITY_2)
+    {
+        sol_binary_heap_benchmark_heap_2_access_index(&data->heap_2, index)->key = key;
+        sol_binary_heap_benchmark_heap_2_update_index(&data->heap_2, index, data->heap_indices);
+    }
+    else
+    {
+        sol_binary_heap_benchmark_heap_4_access_index(&data->heap_4, index)->key = key;
+        sol_binary_heap_benchmark_heap_4_update_index(&data->heap_4, index, data->heap_indices);
+    }
+}
+
+/** fills the heap with `entry_count` random entries, the identifiers being 0 to `entry_count`-1 */
+static void sol_binary_heap_benchmark_fill(struct sol_binary_heap_benchmark_data* data, uint32_t entry_count, struct sol_benchmark_result* result)
+{
+    struct sol_binary_heap_benchmark_entry entry;
+    uint64_t start_time, operation_start_time;
+    uint32_t i;
+
+    start_time = sol_benchmark_time();
+    for(i = 0; i < entry_count; i++)
+    {
+        entry.key = sol_binary_heap_benchmark_random(&data->random_state) >> 8;
+        entry.identifier = i;
+
+        operation_start_time = (result && sol_benchmark_should_sample(i)) ? sol_benchmark_time() : 0;
+
+        sol_binary_heap_benchmark_append(data, entry);
+
+        if(operation_start_time)
+        {
+            sol_benchmark_latencies_record(&result->latencies, sol_benchmark_time() - operation_start_time);
+        }
+    }
+
+    if(result)
+    {
+        result->nanoseconds = sol_benchmark_time() - start_time;
+        result->operation_count = entry_count;
+    }
+}
+
+static void sol_binary_heap_benchmark_run(enum sol_binary_heap_benchmark_variant variant, enum sol_binary_heap_benchmark_operation operation, uint32_t entry_count, uint64_t seed)
+{
+    struct sol_binary_heap_benchmark_data data;
+    struct sol_binary_heap_benchmark_entry entry;
+    struct sol_benchmark_result result;
+    uint64_t start_time, operation_start_time, previous_key;
+    char benchmark_name[64];
+    uint32_t i;
+
+    data.variant = variant;
+    data.heap_indices = malloc(sizeof(uint32_t) * entry_count);
+    data.random_state = seed * 0x9E3779B97F4A7C15llu + 0x2545F4914F6CDD1Dllu;
+
+    /** the heaps have identical layouts so either initialise/terminate will do */
+    sol_binary_heap_benchmark_heap_4_initialise(&data.heap_4, 0);
+
+    sol_benchmark_result_initialise(&result, 1);
+
+    if(operation == SOL_BINARY_HEAP_BENCHMARK_PUSH)
+    {
+        sol_binary_heap_benchmark_fill(&data, entry_count, &result);
+    }
+    else
+    {
+        sol_binary_heap_benchmark_fill(&data, entry_count, NULL);
+
+        previous_key = 0;
+        start_time = sol_benchmark_time();
+
+        for(i = 0; i < entry_count; i++)
+        {
+            operation_start_time = sol_benchmark_should_sample(i) ? sol_benchmark_time() : 0;
+
+            switch(operation)
+            {
+                case SOL_BINARY_HEAP_BENCHMARK_POP:
+                    sol_binary_heap_benchmark_withdraw(&data, &entry);
+                    /** also checks the heap is correct */
+                    if(entry.key < previous_key)
+                    {
+                        fprintf(stderr, "binary heap benchmark withdrew entries out of order\n");
+                        abort();
+                    }
+                    previous_key = entry.key;
+                    break;
+
+                case SOL_BINARY_HEAP_BENCHMARK_UPDATE:
+                    sol_binary_heap_benchmark_update(&data, (uint32_t)(sol_binary_heap_benchmark_random(&data.random_state) % entry_count), sol_binary_heap_benchmark_random(&data.random_state));
+                    break;
+
+                case SOL_BINARY_HEAP_BENCHMARK_HOLD:
+                    sol_binary_heap_benchmark_withdraw(&data, &entry);
+                    /** keys start below 2^56 and increase by less than 2^24, so even 10^9 operations can't overflow them */
+                    entry.key += sol_binary_heap_benchmark_random(&data.random_state) >> 40;
+                    sol_binary_heap_benchmark_append(&data, entry);
+                    break;
+
+                default:
+                    abort();
+            }
+
+            if(operation_start_time)
+            {
+                sol_benchmark_latencies_record(&result.latencies, sol_benchmark_time() - operation_start_time);
+            }
+        }
+
+        result.nanoseconds = sol_benchmark_time() - start_time;
+        result.operation_count = entry_count;
+    }
+
+    snprintf(benchmark_name, sizeof(benchmark_name), "%s_%"PRIu32, sol_binary_heap_benchmark_operation_names[operation], entry_count);
+    sol_benchmark_result_write_json(stdout, benchmark_name, sol_binary_heap_benchmark_variant_names[variant], &result);
+
+    sol_benchmark_result_terminate(&result);
+    sol_binary_heap_benchmark_heap_4_terminate(&data.heap_4);
+    free(data.heap_indices);
+}
+
+int main(int argc, char** argv)
+{
+    enum sol_binary_heap_benchmark_variant variant;
+    enum sol_binary_heap_benchmark_operation operation;
+    uint32_t largest_exponent, exponent, entry_count;
+    uint64_t seed;
+
+    largest_exponent = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 10) : 7;
+    seed = argc > 2 ? strtoull(argv[2], NULL, 10) : 1;
+
+    if(largest_exponent < SOL_BINARY_HEAP_BENCHMARK_SMALLEST_EXPONENT || largest_exponent > SOL_BINARY_HEAP_BENCHMARK_LARGEST_EXPONENT)
+    {
+        fprintf(stderr, "usage: %s [largest entry count exponent, base 10 (%d-%d)] [seed]\n", argv[0], SOL_BINARY_HEAP_BENCHMARK_SMALLEST_EXPONENT, SOL_BINARY_HEAP_BENCHMARK_LARGEST_EXPONENT);
+        return EXIT_FAILURE;
+    }
+
+    for(exponent = 0, entry_count = 1; exponent <= largest_exponent; exponent++, entry_count *= 10)
+    {
+        if(exponent < SOL_BINARY_HEAP_BENCHMARK_SMALLEST_EXPONENT)
+        {
+            continue;
+        }
+
+        for(operation = 0; operation < SOL_BINARY_HEAP_BENCHMARK_OPERATION_COUNT; operation++)
+        {
+            for(variant = 0; variant < SOL_BINARY_HEAP_BENCHMARK_VARIANT_COUNT; variant++)
+            {
+                sol_binary_heap_benchmark_run(variant, operation, entry_count, seed);
+            }
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,140 @@
+/**
+Copyright 2026 Carl van Mastrigt
+
+This file is part of solipsix.
+
+solipsix is free software: you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+solipsix is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with solipsix.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/** replays a buddy grid trace (see data_structures/buddy_grid_trace.h) against both buddy grid implementations, no GPU required
+ *
+ * usage: buddy_grid_trace_replay [glyph|icon|trace file (default: glyph)] [operation count (default: 1048576, generated traces only)] [seed (default: 1)] [save path]
+ *
+ * build from the directory containing solipsix, e.g.:
+ *     cc -std=gnu17 -O2 -DNDEBUG -Isolipsix -I. solipsix/benchmarks/buddy_grid_trace_replay.c solipsix/data_structures/buddy_grid_trace.c
+ *         solipsix/data_structures/buddy_grid.c solipsix/data_structures/buddy_grid_2.c -o buddy_grid_trace_replay
+ *
+ * "glyph" and "icon" generate a synthetic trace for a 1024x1024x4 grid (kept around 7/8 full), anything else is loaded as a trace file (e.g. one recorded by an image atlas)
+ * if a save path is given the trace (generated or loaded) is written there, so a generated trace can be replayed elsewhere
+ * output is one JSON object per line (per implementation), in the spirit of benchmarks/benchmark.h:
+ *     {"benchmark":"buddy_grid_trace","variant":"sol_buddy_grid","trace":"glyph","acquires":...,"failed_acquires":...,"releases":...,
+ *      "ns_per_operation":...,"peak_fragmentation":...,"mean_fragmentation":...,"peak_memory_bytes":...} */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "data_structures/buddy_grid_trace.h"
+
+
+#define SOL_BUDDY_GRID_TRACE_REPLAY_FILL_FACTOR 224
+#define SOL_BUDDY_GRID_TRACE_REPLAY_SAMPLE_INTERVAL 1024
+
+
+static void sol_buddy_grid_trace_replay_write_json(FILE* file, const char* trace_name, const struct sol_buddy_grid_trace_allocator* allocator, const struct sol_buddy_grid_trace_statistics* statistics)
+{
+    fprintf(file, "{\"benchmark\":\"buddy_grid_trace\",\"variant\":\"%s\",\"trace\":\"%s\",\"acquires\":%"PRIu64",\"failed_acquires\":%"PRIu64",\"releases\":%"PRIu64",",
+        allocator->name, trace_name, statistics->acquire_count, statistics->failed_acquire_count, statistics->release_count);
+
+    fprintf(file, "\"ns_per_operation\":%.2f,\"peak_fragmentation\":%.4f,\"mean_fragmentation\":%.4f,\"peak_memory_bytes\":%zu}\n",
+        statistics->nanoseconds_per_operation, statistics->peak_fragmentation, statistics->mean_fragmentation, statistics->peak_memory_usage);
+}
+
+int main(int argc, char** argv)
+{
+    const struct sol_buddy_grid_trace_allocator* const allocators[] =
+    {
+        &sol_buddy_grid_trace_allocator_buddy_grid,
+        &sol_buddy_grid_trace_allocator_buddy_grid_2,
+    };
+    const struct sol_buddy_grid_description description =
+    {
+        .image_x_dimension_exponent = 10,
+        .image_y_dimension_exponent = 10,
+        .image_array_dimension = 4,
+    };
+    struct sol_buddy_grid_trace trace;
+    struct sol_buddy_grid_trace_statistics statistics;
+    const char* trace_name;
+    uint32_t operation_count, i;
+    uint64_t seed;
+    FILE* file;
+    bool loaded, saved;
+
+    trace_name = argc > 1 ? argv[1] : "glyph";
+    operation_count = argc > 2 ? (uint32_t)strtoul(argv[2], NULL, 10) : (1u << 20);
+    seed = argc > 3 ? strtoull(argv[3], NULL, 10) : 1;
+
+    if(operation_count == 0)
+    {
+        fprintf(stderr, "usage: %s [glyph|icon|trace file] [operation count (>0)] [seed] [save path]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if(strcmp(trace_name, "glyph") == 0)
+    {
+        sol_buddy_grid_trace_generate(&trace, description, SOL_BUDDY_GRID_TRACE_DISTRIBUTION_GLYPH, operation_count, SOL_BUDDY_GRID_TRACE_REPLAY_FILL_FACTOR, seed);
+    }
+    else if(strcmp(trace_name, "icon") == 0)
+    {
+        sol_buddy_grid_trace_generate(&trace, description, SOL_BUDDY_GRID_TRACE_DISTRIBUTION_ICON, operation_count, SOL_BUDDY_GRID_TRACE_REPLAY_FILL_FACTOR, seed);
+    }
+    else
+    {
+        file = fopen(trace_name, "rb");
+        if(file == NULL)
+        {
+            fprintf(stderr, "could not open trace file: %s\n", trace_name);
+            return EXIT_FAILURE;
+        }
+
+        loaded = sol_buddy_grid_trace_load(&trace, file);
+        fclose(file);
+
+        if( ! loaded)
+        {
+            fprintf(stderr, "malformed trace file: %s\n", trace_name);
+            sol_buddy_grid_trace_terminate(&trace);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if(argc > 4)
+    {
+        file = fopen(argv[4], "wb");
+        saved = file && sol_buddy_grid_trace_save(&trace, file);
+        if(file)
+        {
+            saved = fclose(file) == 0 && saved;
+        }
+
+        if( ! saved)
+        {
+            fprintf(stderr, "could not save trace file: %s\n", argv[4]);
+            sol_buddy_grid_trace_terminate(&trace);
+            return EXIT_FAILURE;
+        }
+    }
+
+    for(i = 0; i < sizeof(allocators) / sizeof(allocators[0]); i++)
+    {
+        sol_buddy_grid_trace_replay(&trace, allocators[i], SOL_BUDDY_GRID_TRACE_REPLAY_SAMPLE_INTERVAL, &statistics);
+        sol_buddy_grid_trace_replay_write_json(stdout, trace_name, allocators[i], &statistics);
+    }
+
+    sol_buddy_grid_trace_terminate(&trace);
+
+    return EXIT_SUCCESS;
+}
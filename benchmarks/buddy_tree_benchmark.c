@@ -0,0 +1,331 @@
+/**
+Copyright 2026 Carl van Mastrigt
+
+This file is part of solipsix.
+
+solipsix is free software: you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+solipsix is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with solipsix.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/** compares `sol_buddy_tree_acquire_exact` against power of 2 `sol_buddy_tree_acquire` (rounding each request up) on a 65536 unit tree
+ *
+ * usage: buddy_tree_benchmark [operation count (default: 2097152)] [seed (default: 1)]
+ *
+ * build from the directory containing solipsix, e.g.:
+ *     cc -std=gnu17 -O2 -DNDEBUG -Isolipsix -I. solipsix/benchmarks/buddy_tree_benchmark.c solipsix/data_structures/buddy_tree.c -o buddy_tree_benchmark
+ *
+ * variants are "power_of_2" and "exact", request sizes are either "uniform_1_64" or "log_uniform_1_127" (a uniformly random power of 2 range, then uniform within it)
+ * benchmarks:
+ *     buddy_tree_fill:              acquire from an empty tree until the first failure (operation count is ignored)
+ *     buddy_tree_steady_state_fifo: fill, then repeatedly release the oldest allocation and acquire a new one, releasing the oldest until the acquire succeeds
+ *     buddy_tree_random:            acquire or release (a random live allocation) with equal probability, releasing instead whenever an acquire fails
+ * utilisation is the fraction of the tree covered by the units actually requested, so space lost to rounding up counts against power_of_2
+ * output is one JSON object per line, in the spirit of benchmarks/benchmark.h:
+ *     {"benchmark":"buddy_tree_fill","variant":"exact","sizes":"uniform_1_64","operations":...,"failed_acquires":...,"ns_per_operation":...,
+ *      "mean_utilisation":...,"utilisation_at_failure":...}
+ * an operation is one acquire (successful or not) or release, mean utilisation is sampled after every operation
+ * utilisation at failure is the mean over failed acquires, i.e. how full the tree was when fragmentation (or rounding) stopped an allocation */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <assert.h>
+#include <inttypes.h>
+
+#include "benchmarks/benchmark.h"
+#include "data_structures/buddy_tree.h"
+
+
+#define SOL_BUDDY_TREE_BENCHMARK_TREE_SIZE 65536
+
+
+enum sol_buddy_tree_benchmark_variant
+{
+    SOL_BUDDY_TREE_BENCHMARK_POWER_OF_2,
+    SOL_BUDDY_TREE_BENCHMARK_EXACT,
+    SOL_BUDDY_TREE_BENCHMARK_VARIANT_COUNT,
+};
+
+static const char* const sol_buddy_tree_benchmark_variant_names[SOL_BUDDY_TREE_BENCHMARK_VARIANT_COUNT] =
+{
+    [SOL_BUDDY_TREE_BENCHMARK_POWER_OF_2] = "power_of_2",
+    [SOL_BUDDY_TREE_BENCHMARK_EXACT]      = "exact",
+};
+
+enum sol_buddy_tree_benchmark_sizes
+{
+    SOL_BUDDY_TREE_BENCHMARK_UNIFORM_1_64,
+    SOL_BUDDY_TREE_BENCHMARK_LOG_UNIFORM_1_127,
+    SOL_BUDDY_TREE_BENCHMARK_SIZES_COUNT,
+};
+
+static const char* const sol_buddy_tree_benchmark_sizes_names[SOL_BUDDY_TREE_BENCHMARK_SIZES_COUNT] =
+{
+    [SOL_BUDDY_TREE_BENCHMARK_UNIFORM_1_64]      = "uniform_1_64",
+    [SOL_BUDDY_TREE_BENCHMARK_LOG_UNIFORM_1_127] = "log_uniform_1_127",
+};
+
+enum sol_buddy_tree_benchmark_type
+{
+    SOL_BUDDY_TREE_BENCHMARK_FILL,
+    SOL_BUDDY_TREE_BENCHMARK_STEADY_STATE_FIFO,
+    SOL_BUDDY_TREE_BENCHMARK_RANDOM,
+    SOL_BUDDY_TREE_BENCHMARK_TYPE_COUNT,
+};
+
+static const char* const sol_buddy_tree_benchmark_type_names[SOL_BUDDY_TREE_BENCHMARK_TYPE_COUNT] =
+{
+    [SOL_BUDDY_TREE_BENCHMARK_FILL]              = "buddy_tree_fill",
+    [SOL_BUDDY_TREE_BENCHMARK_STEADY_STATE_FIFO] = "buddy_tree_steady_state_fifo",
+    [SOL_BUDDY_TREE_BENCHMARK_RANDOM]            = "buddy_tree_random",
+};
+
+/** live allocations, used as a FIFO ring (steady state) or an unordered set (random) */
+struct sol_buddy_tree_benchmark_allocations
+{
+    uint32_t offsets[SOL_BUDDY_TREE_BENCHMARK_TREE_SIZE];
+    uint32_t sizes[SOL_BUDDY_TREE_BENCHMARK_TREE_SIZE];
+    uint32_t first;
+    uint32_t count;
+    /** sum of requested sizes */
+    uint32_t units;
+};
+
+struct sol_buddy_tree_benchmark_statistics
+{
+    uint64_t operation_count;
+    uint64_t failed_acquire_count;
+    uint64_t nanoseconds;
+    /** sums, divided by the relevant count when written */
+    uint64_t utilised_units;
+    uint64_t utilised_units_at_failure;
+};
+
+static inline uint64_t sol_buddy_tree_benchmark_random(uint64_t* state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+static inline uint32_t sol_buddy_tree_benchmark_size(enum sol_buddy_tree_benchmark_sizes sizes, uint64_t* random_state)
+{
+    uint64_t random;
+    uint32_t exponent;
+
+    random = sol_buddy_tree_benchmark_random(random_state);
+
+    switch(sizes)
+    {
+        case SOL_BUDDY_TREE_BENCHMARK_UNIFORM_1_64:
+            return 1 + (uint32_t)(random % 64);
+
+        case SOL_BUDDY_TREE_BENCHMARK_LOG_UNIFORM_1_127:
+            /** [2^e, 2^(e+1)) for e in [0,6] */
+            exponent = (uint32_t)(random % 7);
+            return (1u << exponent) + (uint32_t)((random >> 8) % (1u << exponent));
+
+        default:
+            abort();
+    }
+}
+
+static inline bool sol_buddy_tree_benchmark_acquire(struct sol_buddy_tree* tree, enum sol_buddy_tree_benchmark_variant variant, uint32_t size, uint32_t* offset)
+{
+    switch(variant)
+    {
+        case SOL_BUDDY_TREE_BENCHMARK_POWER_OF_2:
+            return sol_buddy_tree_acquire(tree, size > 1 ? 32 - (uint32_t)__builtin_clz(size - 1) : 0, offset);
+
+        case SOL_BUDDY_TREE_BENCHMARK_EXACT:
+            return sol_buddy_tree_acquire_exact(tree, size, offset);
+
+        default:
+            abort();
+    }
+}
+
+/** acquires into the back of the ring, returns false (recording the failure) if the tree couldn't accommodate the request */
+static inline bool sol_buddy_tree_benchmark_append(struct sol_buddy_tree* tree, enum sol_buddy_tree_benchmark_variant variant, struct sol_buddy_tree_benchmark_allocations* allocations, uint32_t size, struct sol_buddy_tree_benchmark_statistics* statistics)
+{
+    uint32_t offset, index;
+
+    statistics->operation_count++;
+
+    if( ! sol_buddy_tree_benchmark_acquire(tree, variant, size, &offset))
+    {
+        statistics->failed_acquire_count++;
+        statistics->utilised_units_at_failure += allocations->units;
+        statistics->utilised_units += allocations->units;
+        return false;
+    }
+
+    index = (allocations->first + allocations->count) % SOL_BUDDY_TREE_BENCHMARK_TREE_SIZE;
+    allocations->offsets[index] = offset;
+    allocations->sizes[index] = size;
+    allocations->count++;
+    allocations->units += size;
+
+    statistics->utilised_units += allocations->units;
+    return true;
+}
+
+/** releases the allocation `position` places from the front of the ring, moving the back of the ring into its place */
+static inline void sol_buddy_tree_benchmark_remove(struct sol_buddy_tree* tree, struct sol_buddy_tree_benchmark_allocations* allocations, uint32_t position, struct sol_buddy_tree_benchmark_statistics* statistics)
+{
+    uint32_t index, last_index;
+
+    assert(position < allocations->count);
+
+    index = (allocations->first + position) % SOL_BUDDY_TREE_BENCHMARK_TREE_SIZE;
+    last_index = (allocations->first + allocations->count - 1) % SOL_BUDDY_TREE_BENCHMARK_TREE_SIZE;
+
+    sol_buddy_tree_release(tree, allocations->offsets[index]);
+    allocations->units -= allocations->sizes[index];
+
+    if(position == 0)
+    {
+        allocations->first = (allocations->first + 1) % SOL_BUDDY_TREE_BENCHMARK_TREE_SIZE;
+    }
+    else
+    {
+        allocations->offsets[index] = allocations->offsets[last_index];
+        allocations->sizes[index] = allocations->sizes[last_index];
+    }
+    allocations->count--;
+
+    statistics->operation_count++;
+    statistics->utilised_units += allocations->units;
+}
+
+static void sol_buddy_tree_benchmark_run(enum sol_buddy_tree_benchmark_type type, enum sol_buddy_tree_benchmark_variant variant, enum sol_buddy_tree_benchmark_sizes sizes,
+    uint32_t operation_count, uint64_t seed, struct sol_buddy_tree_benchmark_allocations* allocations, struct sol_buddy_tree_benchmark_statistics* statistics)
+{
+    struct sol_buddy_tree tree;
+    struct sol_buddy_tree_benchmark_statistics fill_statistics = {0};
+    uint64_t random_state, start_time;
+    uint32_t size;
+
+    /** every variant sees the same sequence of requests */
+    random_state = seed * 0x9E3779B97F4A7C15llu + 0x2545F4914F6CDD1Dllu;
+
+    sol_buddy_tree_initialise(&tree, SOL_BUDDY_TREE_BENCHMARK_TREE_SIZE);
+    allocations->first = 0;
+    allocations->count = 0;
+    allocations->units = 0;
+    *statistics = (struct sol_buddy_tree_benchmark_statistics){0};
+
+    /** fill is measured on its own, otherwise it is the untimed starting state */
+    start_time = sol_benchmark_time();
+    while(sol_buddy_tree_benchmark_append(&tree, variant, allocations, sol_buddy_tree_benchmark_size(sizes, &random_state), &fill_statistics));
+    fill_statistics.nanoseconds = sol_benchmark_time() - start_time;
+
+    if(type == SOL_BUDDY_TREE_BENCHMARK_FILL)
+    {
+        *statistics = fill_statistics;
+    }
+    else
+    {
+        start_time = sol_benchmark_time();
+
+        while(statistics->operation_count < operation_count)
+        {
+            size = sol_buddy_tree_benchmark_size(sizes, &random_state);
+
+            if(type == SOL_BUDDY_TREE_BENCHMARK_STEADY_STATE_FIFO)
+            {
+                do
+                {
+                    sol_buddy_tree_benchmark_remove(&tree, allocations, 0, statistics);
+                }
+                while( ! sol_buddy_tree_benchmark_append(&tree, variant, allocations, size, statistics));
+            }
+            else if(allocations->count == 0 || (sol_buddy_tree_benchmark_random(&random_state) & 1))
+            {
+                if( ! sol_buddy_tree_benchmark_append(&tree, variant, allocations, size, statistics))
+                {
+                    sol_buddy_tree_benchmark_remove(&tree, allocations, (uint32_t)(sol_buddy_tree_benchmark_random(&random_state) % allocations->count), statistics);
+                }
+            }
+            else
+            {
+                sol_buddy_tree_benchmark_remove(&tree, allocations, (uint32_t)(sol_buddy_tree_benchmark_random(&random_state) % allocations->count), statistics);
+            }
+        }
+
+        statistics->nanoseconds = sol_benchmark_time() - start_time;
+    }
+
+    while(allocations->count)
+    {
+        sol_buddy_tree_benchmark_remove(&tree, allocations, 0, &fill_statistics);
+    }
+
+    if( ! sol_buddy_tree_is_empty(&tree))
+    {
+        fprintf(stderr, "%s %s did not return to empty after releasing everything\n", sol_buddy_tree_benchmark_type_names[type], sol_buddy_tree_benchmark_variant_names[variant]);
+        abort();
+    }
+
+    sol_buddy_tree_terminate(&tree);
+}
+
+static void sol_buddy_tree_benchmark_write_json(FILE* file, enum sol_buddy_tree_benchmark_type type, enum sol_buddy_tree_benchmark_variant variant, enum sol_buddy_tree_benchmark_sizes sizes, const struct sol_buddy_tree_benchmark_statistics* statistics)
+{
+    fprintf(file, "{\"benchmark\":\"%s\",\"variant\":\"%s\",\"sizes\":\"%s\",\"operations\":%"PRIu64",\"failed_acquires\":%"PRIu64",",
+        sol_buddy_tree_benchmark_type_names[type], sol_buddy_tree_benchmark_variant_names[variant], sol_buddy_tree_benchmark_sizes_names[sizes], statistics->operation_count, statistics->failed_acquire_count);
+
+    fprintf(file, "\"ns_per_operation\":%.2f,\"mean_utilisation\":%.4f,\"utilisation_at_failure\":%.4f}\n",
+        statistics->operation_count ? (double)statistics->nanoseconds / (double)statistics->operation_count : 0.0,
+        statistics->operation_count ? (double)statistics->utilised_units / ((double)statistics->operation_count * SOL_BUDDY_TREE_BENCHMARK_TREE_SIZE) : 0.0,
+        statistics->failed_acquire_count ? (double)statistics->utilised_units_at_failure / ((double)statistics->failed_acquire_count * SOL_BUDDY_TREE_BENCHMARK_TREE_SIZE) : 0.0);
+}
+
+int main(int argc, char** argv)
+{
+    struct sol_buddy_tree_benchmark_allocations* allocations;
+    struct sol_buddy_tree_benchmark_statistics statistics;
+    enum sol_buddy_tree_benchmark_type type;
+    enum sol_buddy_tree_benchmark_variant variant;
+    enum sol_buddy_tree_benchmark_sizes sizes;
+    uint32_t operation_count;
+    uint64_t seed;
+
+    operation_count = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 10) : (1u << 21);
+    seed = argc > 2 ? strtoull(argv[2], NULL, 10) : 1;
+
+    if(operation_count == 0)
+    {
+        fprintf(stderr, "usage: %s [operation count (>0)] [seed]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    allocations = malloc(sizeof(struct sol_buddy_tree_benchmark_allocations));
+
+    for(type = 0; type < SOL_BUDDY_TREE_BENCHMARK_TYPE_COUNT; type++)
+    {
+        for(sizes = 0; sizes < SOL_BUDDY_TREE_BENCHMARK_SIZES_COUNT; sizes++)
+        {
+            for(variant = 0; variant < SOL_BUDDY_TREE_BENCHMARK_VARIANT_COUNT; variant++)
+            {
+                sol_buddy_tree_benchmark_run(type, variant, sizes, operation_count, seed, allocations, &statistics);
+                sol_buddy_tree_benchmark_write_json(stdout, type, variant, sizes, &statistics);
+            }
+        }
+    }
+
+    free(allocations);
+
+    return EXIT_SUCCESS;
+}
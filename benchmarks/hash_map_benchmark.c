@@ -0,0 +1,287 @@
+/**
+Copyright 2026 Carl van Mastrigt
+
+This file is part of solipsix.
+
+solipsix is free software: you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+solipsix is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with solipsix.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/** compares the `SOL_HASH_MAP_SHARDED` configuration of the hash map against the same map wrapped in a single mutex (as the multithreaded buffer atlas does)
+ *
+ * usage: hash_map_benchmark [maximum thread count (default: processor count)] [scale (default: 1, multiplies the work done)]
+ *
+ * build from the directory containing solipsix, e.g.:
+ *     cc -std=gnu17 -O2 -DNDEBUG -Isolipsix -I. solipsix/benchmarks/hash_map_benchmark.c -lpthread -o hash_map_benchmark
+ *
+ * keys are random 64 bit identifiers (used directly as the hash, like the atlas maps) drawn from a fixed set, half of which are in the map to begin with
+ * benchmarks (JSON lines, see benchmarks/benchmark.h), variants are "sharded" and "locked":
+ *     hash_map_find_mostly: operation is one find (15 in 16) or an obtain/remove pair on the same key, latency is one operation
+ *     hash_map_mixed:       operation is one find (1 in 2), obtain (1 in 4) or remove (1 in 4), latency is one operation */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <threads.h>
+
+#include "data_structures/hash_map_defines.h"
+
+struct sol_hash_map_benchmark_entry
+{
+    uint64_t key;
+    uint64_t value;
+};
+
+#define SOL_HASH_MAP_STRUCT_NAME sol_hash_map_benchmark_sharded_map
+#define SOL_HASH_MAP_KEY_TYPE uint64_t
+#define SOL_HASH_MAP_ENTRY_TYPE struct sol_hash_map_benchmark_entry
+#define SOL_HASH_MAP_FUNCTION_KEYWORDS static inline
+#define SOL_HASH_MAP_KEY_ENTRY_CMP_EQUAL(K, E) ((K) == (E)->key)
+#define SOL_HASH_MAP_KEY_FROM_ENTRY(E) ((E)->key)
+#define SOL_HASH_MAP_KEY_HASH(K) (K)
+#define SOL_HASH_MAP_SHARDED
+#include "data_structures/hash_map_implement.h"
+
+#define SOL_HASH_MAP_STRUCT_NAME sol_hash_map_benchmark_map
+#define SOL_HASH_MAP_KEY_TYPE uint64_t
+#define SOL_HASH_MAP_ENTRY_TYPE struct sol_hash_map_benchmark_entry
+#define SOL_HASH_MAP_FUNCTION_KEYWORDS static inline
+#define SOL_HASH_MAP_KEY_ENTRY_CMP_EQUAL(K, E) ((K) == (E)->key)
+#define SOL_HASH_MAP_KEY_FROM_ENTRY(E) ((E)->key)
+#define SOL_HASH_MAP_KEY_HASH(K) (K)
+#include "data_structures/hash_map_implement.h"
+
+#include "benchmarks/benchmark.h"
+
+
+#define SOL_HASH_MAP_BENCHMARK_OPERATIONS (1u << 22)
+/** number of distinct keys used, at most half of which are in the map at once (on average) */
+#define SOL_HASH_MAP_BENCHMARK_KEY_EXPONENT 16
+
+
+static uint32_t sol_hash_map_benchmark_scale = 1;
+
+/** the keys every thread draws from, generated once */
+static uint64_t sol_hash_map_benchmark_keys[1u << SOL_HASH_MAP_BENCHMARK_KEY_EXPONENT];
+
+enum sol_hash_map_benchmark_variant
+{
+    SOL_HASH_MAP_BENCHMARK_SHARDED,
+    SOL_HASH_MAP_BENCHMARK_LOCKED,
+    SOL_HASH_MAP_BENCHMARK_VARIANT_COUNT,
+};
+
+static const char* const sol_hash_map_benchmark_variant_names[SOL_HASH_MAP_BENCHMARK_VARIANT_COUNT] =
+{
+    [SOL_HASH_MAP_BENCHMARK_SHARDED] = "sharded",
+    [SOL_HASH_MAP_BENCHMARK_LOCKED]  = "locked",
+};
+
+struct sol_hash_map_benchmark_data
+{
+    enum sol_hash_map_benchmark_variant variant;
+    /** out of 16, the rest of the operations are split evenly between obtain and remove */
+    uint32_t find_sixteenths;
+
+    struct sol_hash_map_benchmark_sharded_map sharded_map;
+
+    struct sol_hash_map_benchmark_map locked_map;
+    mtx_t mutex;
+};
+
+/** xorshift, each thread has its own state */
+static inline uint64_t sol_hash_map_benchmark_random(uint64_t* state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+static inline void sol_hash_map_benchmark_find(struct sol_hash_map_benchmark_data* data, uint64_t key)
+{
+    struct sol_hash_map_benchmark_entry entry;
+    struct sol_hash_map_benchmark_entry* entry_ptr;
+
+    if(data->variant == SOL_HASH_MAP_BENCHMARK_SHARDED)
+    {
+        sol_hash_map_benchmark_sharded_map_find(&data->sharded_map, key, &entry);
+    }
+    else
+    {
+        mtx_lock(&data->mutex);
+        if(sol_hash_map_benchmark_map_find(&data->locked_map, key, &entry_ptr) == SOL_MAP_SUCCESS_FOUND)
+        {
+            entry = *entry_ptr;
+        }
+        mtx_unlock(&data->mutex);
+    }
+}
+
+static inline void sol_hash_map_benchmark_obtain(struct sol_hash_map_benchmark_data* data, uint64_t key)
+{
+    struct sol_hash_map_benchmark_entry entry = {.key = key, .value = ~key};
+    struct sol_hash_map_benchmark_entry* entry_ptr;
+
+    if(data->variant == SOL_HASH_MAP_BENCHMARK_SHARDED)
+    {
+        sol_hash_map_benchmark_sharded_map_obtain(&data->sharded_map, key, &entry);
+    }
+    else
+    {
+        mtx_lock(&data->mutex);
+        if(sol_hash_map_benchmark_map_obtain(&data->locked_map, key, &entry_ptr) == SOL_MAP_SUCCESS_INSERTED)
+        {
+            *entry_ptr = entry;
+        }
+        mtx_unlock(&data->mutex);
+    }
+}
+
+static inline void sol_hash_map_benchmark_remove(struct sol_hash_map_benchmark_data* data, uint64_t key)
+{
+    if(data->variant == SOL_HASH_MAP_BENCHMARK_SHARDED)
+    {
+        sol_hash_map_benchmark_sharded_map_remove(&data->sharded_map, key, NULL);
+    }
+    else
+    {
+        mtx_lock(&data->mutex);
+        sol_hash_map_benchmark_map_remove(&data->locked_map, key, NULL);
+        mtx_unlock(&data->mutex);
+    }
+}
+
+static void sol_hash_map_benchmark_thread(struct sol_benchmark_thread* thread)
+{
+    struct sol_hash_map_benchmark_data* data = thread->data;
+    uint64_t i, operation_count, start_time, random, key;
+    uint64_t random_state = 0x9E3779B97F4A7C15llu * (thread->index + 1);
+    uint32_t selector;
+
+    operation_count = ((uint64_t)SOL_HASH_MAP_BENCHMARK_OPERATIONS * sol_hash_map_benchmark_scale) / thread->thread_count;
+
+    for(i = 0; i < operation_count; i++)
+    {
+        random = sol_hash_map_benchmark_random(&random_state);
+        key = sol_hash_map_benchmark_keys[random & ((1u << SOL_HASH_MAP_BENCHMARK_KEY_EXPONENT) - 1)];
+        selector = (uint32_t)(random >> 60);
+
+        start_time = sol_benchmark_should_sample(i) ? sol_benchmark_time() : 0;
+
+        if(selector < data->find_sixteenths)
+        {
+            sol_hash_map_benchmark_find(data, key);
+        }
+        else if(data->find_sixteenths == 15)
+        {
+            /** too few slots to split, so pair them to keep the map at the same size */
+            sol_hash_map_benchmark_obtain(data, key);
+            sol_hash_map_benchmark_remove(data, key);
+        }
+        else if(selector & 1)
+        {
+            sol_hash_map_benchmark_obtain(data, key);
+        }
+        else
+        {
+            sol_hash_map_benchmark_remove(data, key);
+        }
+
+        if(start_time)
+        {
+            sol_benchmark_latencies_record(&thread->latencies, sol_benchmark_time() - start_time);
+        }
+    }
+
+    thread->operation_count = operation_count;
+}
+
+static void sol_hash_map_benchmark_run(uint32_t thread_count, const char* benchmark_name, uint32_t find_sixteenths, enum sol_hash_map_benchmark_variant variant)
+{
+    const struct sol_hash_map_descriptor descriptor =
+    {
+        .entry_space_exponent_initial = 12,
+        .entry_space_exponent_limit = 24,
+        .resize_fill_factor = 160,
+        .limit_fill_factor = 224,
+    };
+    struct sol_hash_map_benchmark_data data;
+    struct sol_benchmark_result result;
+    uint32_t i;
+
+    data.variant = variant;
+    data.find_sixteenths = find_sixteenths;
+
+    sol_hash_map_benchmark_sharded_map_initialise(&data.sharded_map, descriptor);
+    sol_hash_map_benchmark_map_initialise(&data.locked_map, descriptor);
+    mtx_init(&data.mutex, mtx_plain);
+
+    for(i = 0; i < (1u << SOL_HASH_MAP_BENCHMARK_KEY_EXPONENT); i += 2)
+    {
+        sol_hash_map_benchmark_obtain(&data, sol_hash_map_benchmark_keys[i]);
+    }
+
+    sol_benchmark_result_initialise(&result, thread_count);
+    sol_benchmark_run_threads(&result, thread_count, &sol_hash_map_benchmark_thread, &data);
+    sol_benchmark_result_write_json(stdout, benchmark_name, sol_hash_map_benchmark_variant_names[variant], &result);
+    sol_benchmark_result_terminate(&result);
+
+    mtx_destroy(&data.mutex);
+    sol_hash_map_benchmark_map_terminate(&data.locked_map);
+    sol_hash_map_benchmark_sharded_map_terminate(&data.sharded_map);
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t thread_counts[34];
+    uint32_t maximum_thread_count, thread_count_count, i;
+    enum sol_hash_map_benchmark_variant variant;
+    uint64_t random_state;
+
+    maximum_thread_count = sol_benchmark_processor_count();
+
+    if(argc > 1)
+    {
+        maximum_thread_count = (uint32_t)strtoul(argv[1], NULL, 10);
+    }
+    if(argc > 2)
+    {
+        sol_hash_map_benchmark_scale = (uint32_t)strtoul(argv[2], NULL, 10);
+    }
+
+    if(maximum_thread_count == 0 || maximum_thread_count > 1024 || sol_hash_map_benchmark_scale == 0)
+    {
+        fprintf(stderr, "usage: %s [maximum thread count (1-1024)] [scale (>0)]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    /** fixed seed so every run uses the same keys, duplicates are harmless (they just make that key more common) */
+    random_state = 0x2545F4914F6CDD1Dllu;
+    for(i = 0; i < (1u << SOL_HASH_MAP_BENCHMARK_KEY_EXPONENT); i++)
+    {
+        sol_hash_map_benchmark_keys[i] = sol_hash_map_benchmark_random(&random_state);
+    }
+
+    thread_count_count = sol_benchmark_thread_counts(thread_counts, maximum_thread_count);
+
+    for(i = 0; i < thread_count_count; i++)
+    {
+        for(variant = 0; variant < SOL_HASH_MAP_BENCHMARK_VARIANT_COUNT; variant++)
+        {
+            sol_hash_map_benchmark_run(thread_counts[i], "hash_map_find_mostly", 15, variant);
+            sol_hash_map_benchmark_run(thread_counts[i], "hash_map_mixed", 8, variant);
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,240 @@
+/**
+Copyright 2026 Carl van Mastrigt
+
+This file is part of solipsix.
+
+solipsix is free software: you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+solipsix is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with solipsix.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/** compares the lockfree MPMC queue against the mutex protected `data_structures/queue.h` it is intended to replace
+ *
+ * usage: queue_benchmark [maximum thread count (default: 64)] [scale (default: 1, multiplies the work done)]
+ *
+ * build from the directory containing solipsix, e.g.:
+ *     cc -std=gnu17 -O2 -DNDEBUG -Isolipsix -I. solipsix/benchmarks/queue_benchmark.c solipsix/lockfree/queue.c -lpthread -o queue_benchmark
+ *
+ * every thread alternates between enqueueing and dequeueing, so the queue holds roughly the same number of entries throughout
+ * benchmarks (JSON lines, see benchmarks/benchmark.h):
+ *     queue, "lockfree"/"locked":                 operation is one entry enqueued and one dequeued, latency is that pair
+ *     queue, "lockfree_batched"/"locked_batched": operation is one entry enqueued and dequeued in batches of 16, latency is the pair of batches */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <threads.h>
+
+#include "lockfree/queue.h"
+
+#define SOL_QUEUE_ENTRY_TYPE void*
+#define SOL_QUEUE_FUNCTION_PREFIX sol_queue_benchmark_locked_queue
+#define SOL_QUEUE_STRUCT_NAME sol_queue_benchmark_locked_queue
+#include "data_structures/queue.h"
+
+#include "benchmarks/benchmark.h"
+
+
+#define SOL_QUEUE_BENCHMARK_OPERATIONS (1u << 21)
+#define SOL_QUEUE_BENCHMARK_BATCH_SIZE 16
+/** entries in the queue before the threads start, so that dequeues rarely find it empty */
+#define SOL_QUEUE_BENCHMARK_PREFILL 256
+/** must hold the prefill plus a batch from every thread */
+#define SOL_QUEUE_BENCHMARK_CAPACITY_EXPONENT 16
+
+
+static uint32_t sol_queue_benchmark_scale = 1;
+
+enum sol_queue_benchmark_variant
+{
+    SOL_QUEUE_BENCHMARK_LOCKFREE,
+    SOL_QUEUE_BENCHMARK_LOCKFREE_BATCHED,
+    SOL_QUEUE_BENCHMARK_LOCKED,
+    SOL_QUEUE_BENCHMARK_LOCKED_BATCHED,
+    SOL_QUEUE_BENCHMARK_VARIANT_COUNT,
+};
+
+static const char* const sol_queue_benchmark_variant_names[SOL_QUEUE_BENCHMARK_VARIANT_COUNT] =
+{
+    [SOL_QUEUE_BENCHMARK_LOCKFREE]         = "lockfree",
+    [SOL_QUEUE_BENCHMARK_LOCKFREE_BATCHED] = "lockfree_batched",
+    [SOL_QUEUE_BENCHMARK_LOCKED]           = "locked",
+    [SOL_QUEUE_BENCHMARK_LOCKED_BATCHED]   = "locked_batched",
+};
+
+struct sol_queue_benchmark_data
+{
+    enum sol_queue_benchmark_variant variant;
+
+    struct sol_lockfree_queue lockfree_queue;
+
+    struct sol_queue_benchmark_locked_queue locked_queue;
+    mtx_t mutex;
+};
+
+/** entries must not be NULL (the lockfree queue uses NULL to indicate it was empty) */
+static inline void* sol_queue_benchmark_entry(uint64_t i)
+{
+    return (void*)(uintptr_t)(i + 1);
+}
+
+static void sol_queue_benchmark_thread(struct sol_benchmark_thread* thread)
+{
+    struct sol_queue_benchmark_data* data = thread->data;
+    void* entries[SOL_QUEUE_BENCHMARK_BATCH_SIZE];
+    uint64_t i, operation_count, start_time;
+    uint32_t batch_size, enqueued, dequeued, transferred, j;
+
+    batch_size = (data->variant == SOL_QUEUE_BENCHMARK_LOCKFREE_BATCHED || data->variant == SOL_QUEUE_BENCHMARK_LOCKED_BATCHED) ? SOL_QUEUE_BENCHMARK_BATCH_SIZE : 1;
+    operation_count = ((uint64_t)SOL_QUEUE_BENCHMARK_OPERATIONS * sol_queue_benchmark_scale) / (thread->thread_count * batch_size);
+
+    for(i = 0; i < operation_count; i++)
+    {
+        for(j = 0; j < batch_size; j++)
+        {
+            entries[j] = sol_queue_benchmark_entry(i * batch_size + j);
+        }
+
+        start_time = sol_benchmark_should_sample(i) ? sol_benchmark_time() : 0;
+
+        switch(data->variant)
+        {
+            case SOL_QUEUE_BENCHMARK_LOCKFREE:
+            case SOL_QUEUE_BENCHMARK_LOCKFREE_BATCHED:
+                /** the lockfree queue can enqueue/dequeue fewer entries than requested when another thread is preempted part way through using a slot
+                 * (it then appears full/empty at that slot), so retry until the whole batch has gone through, as a user of the queue would have to
+                 * this can't deadlock: each thread enqueues its batch before dequeueing one, and the queue has space for the prefill plus a batch from every thread */
+                for(enqueued = 0; enqueued < batch_size; )
+                {
+                    transferred = sol_lockfree_queue_enqueue_many(&data->lockfree_queue, entries + enqueued, batch_size - enqueued);
+                    enqueued += transferred;
+                    if(transferred == 0)
+                    {
+                        thrd_yield();
+                    }
+                }
+                for(dequeued = 0; dequeued < batch_size; )
+                {
+                    transferred = sol_lockfree_queue_dequeue_many(&data->lockfree_queue, entries + dequeued, batch_size - dequeued);
+                    dequeued += transferred;
+                    if(transferred == 0)
+                    {
+                        thrd_yield();
+                    }
+                }
+                break;
+
+            case SOL_QUEUE_BENCHMARK_LOCKED:
+                mtx_lock(&data->mutex);
+                sol_queue_benchmark_locked_queue_enqueue(&data->locked_queue, entries[0], NULL);
+                mtx_unlock(&data->mutex);
+
+                mtx_lock(&data->mutex);
+                dequeued = sol_queue_benchmark_locked_queue_dequeue(&data->locked_queue, entries);
+                mtx_unlock(&data->mutex);
+                break;
+
+            case SOL_QUEUE_BENCHMARK_LOCKED_BATCHED:
+                mtx_lock(&data->mutex);
+                sol_queue_benchmark_locked_queue_enqueue_many(&data->locked_queue, entries, batch_size, NULL);
+                mtx_unlock(&data->mutex);
+
+                mtx_lock(&data->mutex);
+                dequeued = sol_queue_benchmark_locked_queue_dequeue_many(&data->locked_queue, entries, batch_size);
+                mtx_unlock(&data->mutex);
+                break;
+
+            default:
+                assert(false);
+                dequeued = 0;
+        }
+
+        /** every thread's own entries are in the queue before it dequeues, so a locked dequeue can't come up short */
+        assert(dequeued == batch_size);
+        (void)dequeued;
+
+        if(start_time)
+        {
+            sol_benchmark_latencies_record(&thread->latencies, sol_benchmark_time() - start_time);
+        }
+    }
+
+    thread->operation_count = operation_count * batch_size;
+}
+
+static void sol_queue_benchmark_run(uint32_t thread_count, enum sol_queue_benchmark_variant variant)
+{
+    struct sol_queue_benchmark_data data;
+    struct sol_benchmark_result result;
+    void* entry;
+    uint32_t i;
+
+    data.variant = variant;
+
+    sol_lockfree_queue_initialise(&data.lockfree_queue, SOL_QUEUE_BENCHMARK_CAPACITY_EXPONENT);
+    sol_queue_benchmark_locked_queue_initialise(&data.locked_queue, 1u << SOL_QUEUE_BENCHMARK_CAPACITY_EXPONENT);
+    mtx_init(&data.mutex, mtx_plain);
+
+    for(i = 0; i < SOL_QUEUE_BENCHMARK_PREFILL; i++)
+    {
+        sol_lockfree_queue_enqueue(&data.lockfree_queue, sol_queue_benchmark_entry(i));
+        sol_queue_benchmark_locked_queue_enqueue(&data.locked_queue, sol_queue_benchmark_entry(i), NULL);
+    }
+
+    sol_benchmark_result_initialise(&result, thread_count);
+    sol_benchmark_run_threads(&result, thread_count, &sol_queue_benchmark_thread, &data);
+    sol_benchmark_result_write_json(stdout, "queue", sol_queue_benchmark_variant_names[variant], &result);
+    sol_benchmark_result_terminate(&result);
+
+    while(sol_lockfree_queue_dequeue(&data.lockfree_queue));
+    while(sol_queue_benchmark_locked_queue_dequeue(&data.locked_queue, &entry));
+
+    mtx_destroy(&data.mutex);
+    sol_queue_benchmark_locked_queue_terminate(&data.locked_queue);
+    sol_lockfree_queue_terminate(&data.lockfree_queue);
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t thread_counts[34];
+    uint32_t maximum_thread_count, thread_count_count, i;
+    enum sol_queue_benchmark_variant variant;
+
+    maximum_thread_count = 64;
+
+    if(argc > 1)
+    {
+        maximum_thread_count = (uint32_t)strtoul(argv[1], NULL, 10);
+    }
+    if(argc > 2)
+    {
+        sol_queue_benchmark_scale = (uint32_t)strtoul(argv[2], NULL, 10);
+    }
+
+    /** every thread may hold a batch, which must fit in the queue alongside the prefill */
+    if(maximum_thread_count == 0 || maximum_thread_count > 1024 || sol_queue_benchmark_scale == 0)
+    {
+        fprintf(stderr, "usage: %s [maximum thread count (1-1024)] [scale (>0)]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    thread_count_count = sol_benchmark_thread_counts(thread_counts, maximum_thread_count);
+
+    for(i = 0; i < thread_count_count; i++)
+    {
+        for(variant = 0; variant < SOL_QUEUE_BENCHMARK_VARIANT_COUNT; variant++)
+        {
+            sol_queue_benchmark_run(thread_counts[i], variant);
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,260 @@
+/**
+Copyright 2026 Carl van Mastrigt
+
+This file is part of solipsix.
+
+solipsix is free software: you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+solipsix is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with solipsix.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/** compares the sorts in `sorts/` against libc qsort on 32 bit keys
+ *
+ * usage: sort_benchmark [element count (default: 1048576)] [repetitions (default: 8)] [seed (default: 1)]
+ *
+ * build from the directory containing solipsix, e.g.:
+ *     cc -std=gnu17 -O2 -DNDEBUG -Isolipsix -I. solipsix/benchmarks/sort_benchmark.c -lpthread -o sort_benchmark
+ *
+ * variants are "introsort" (sorts/quicksort.h), "block_partition" (sorts/quicksort.h with `SOL_SORT_BLOCK_PARTITION`), "radix" (sorts/radix_sort.h) and "qsort"
+ * every variant sorts an identical copy of the input, the result is checked (aborting if it isn't sorted) outside of the timed region
+ * benchmarks (JSON lines, see benchmarks/benchmark.h), named for the input:
+ *     sort_random:             uniformly random keys
+ *     sort_sorted:             already ascending
+ *     sort_reversed:           descending
+ *     sort_few_unique:         random keys drawn from only 16 values
+ *     sort_median_of_3_killer: Musser's sequence, built to make median of 3 (first, middle, last) pivots as bad as possible
+ * operation is one element sorted, latency is one whole sort (one sample per repetition) */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "benchmarks/benchmark.h"
+
+#define SOL_SORT_TYPE uint32_t
+#define SOL_SORT_FUNCTION_NAME sol_sort_benchmark_introsort
+#define SOL_SORT_COMPARE_LT(A, B) (*(A) < *(B))
+#include "sorts/quicksort.h"
+
+#define SOL_SORT_TYPE uint32_t
+#define SOL_SORT_FUNCTION_NAME sol_sort_benchmark_block_partition
+#define SOL_SORT_COMPARE_LT(A, B) (*(A) < *(B))
+#define SOL_SORT_BLOCK_PARTITION
+#include "sorts/quicksort.h"
+
+#define SOL_SORT_TYPE uint32_t
+#define SOL_SORT_FUNCTION_NAME sol_sort_benchmark_radix_sort
+#define SOL_SORT_KEY(E) (*(E))
+#include "sorts/radix_sort.h"
+
+
+#define SOL_SORT_BENCHMARK_FEW_UNIQUE_COUNT 16
+
+
+enum sol_sort_benchmark_variant
+{
+    SOL_SORT_BENCHMARK_INTROSORT,
+    SOL_SORT_BENCHMARK_BLOCK_PARTITION,
+    SOL_SORT_BENCHMARK_RADIX,
+    SOL_SORT_BENCHMARK_QSORT,
+    SOL_SORT_BENCHMARK_VARIANT_COUNT,
+};
+
+static const char* const sol_sort_benchmark_variant_names[SOL_SORT_BENCHMARK_VARIANT_COUNT] =
+{
+    [SOL_SORT_BENCHMARK_INTROSORT]       = "introsort",
+    [SOL_SORT_BENCHMARK_BLOCK_PARTITION] = "block_partition",
+    [SOL_SORT_BENCHMARK_RADIX]           = "radix",
+    [SOL_SORT_BENCHMARK_QSORT]           = "qsort",
+};
+
+enum sol_sort_benchmark_input
+{
+    SOL_SORT_BENCHMARK_RANDOM,
+    SOL_SORT_BENCHMARK_SORTED,
+    SOL_SORT_BENCHMARK_REVERSED,
+    SOL_SORT_BENCHMARK_FEW_UNIQUE,
+    SOL_SORT_BENCHMARK_MEDIAN_OF_3_KILLER,
+    SOL_SORT_BENCHMARK_INPUT_COUNT,
+};
+
+static const char* const sol_sort_benchmark_input_names[SOL_SORT_BENCHMARK_INPUT_COUNT] =
+{
+    [SOL_SORT_BENCHMARK_RANDOM]             = "sort_random",
+    [SOL_SORT_BENCHMARK_SORTED]             = "sort_sorted",
+    [SOL_SORT_BENCHMARK_REVERSED]           = "sort_reversed",
+    [SOL_SORT_BENCHMARK_FEW_UNIQUE]         = "sort_few_unique",
+    [SOL_SORT_BENCHMARK_MEDIAN_OF_3_KILLER] = "sort_median_of_3_killer",
+};
+
+static inline uint64_t sol_sort_benchmark_random(uint64_t* state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+static int sol_sort_benchmark_qsort_compare(const void* a, const void* b)
+{
+    uint32_t va = *(const uint32_t*)a;
+    uint32_t vb = *(const uint32_t*)b;
+    return (va > vb) - (va < vb);
+}
+
+static void sol_sort_benchmark_generate(uint32_t* data, size_t count, enum sol_sort_benchmark_input input, uint64_t seed)
+{
+    uint64_t random_state = seed * 0x9E3779B97F4A7C15llu + 0x2545F4914F6CDD1Dllu;
+    size_t i, half;
+
+    switch(input)
+    {
+        case SOL_SORT_BENCHMARK_RANDOM:
+            for(i = 0; i < count; i++)
+            {
+                data[i] = (uint32_t)sol_sort_benchmark_random(&random_state);
+            }
+            break;
+
+        case SOL_SORT_BENCHMARK_SORTED:
+            for(i = 0; i < count; i++)
+            {
+                data[i] = (uint32_t)i;
+            }
+            break;
+
+        case SOL_SORT_BENCHMARK_REVERSED:
+            for(i = 0; i < count; i++)
+            {
+                data[i] = (uint32_t)(count - i);
+            }
+            break;
+
+        case SOL_SORT_BENCHMARK_FEW_UNIQUE:
+            for(i = 0; i < count; i++)
+            {
+                data[i] = (uint32_t)(sol_sort_benchmark_random(&random_state) % SOL_SORT_BENCHMARK_FEW_UNIQUE_COUNT);
+            }
+            break;
+
+        case SOL_SORT_BENCHMARK_MEDIAN_OF_3_KILLER:
+            /** Musser 1997, for 1 based i <= k = n/2: a[i] = i when i is odd, k+i-1 when even, and a[k+i] = 2i (an odd count gets its largest value appended) */
+            half = count / 2;
+            for(i = 1; i <= half; i++)
+            {
+                data[i - 1] = (uint32_t)((i & 1) ? i : half + i - 1);
+                data[half + i - 1] = (uint32_t)(2 * i);
+            }
+            if(count & 1)
+            {
+                data[count - 1] = (uint32_t)count;
+            }
+            break;
+
+        default:
+            abort();
+    }
+}
+
+static void sol_sort_benchmark_sort(enum sol_sort_benchmark_variant variant, uint32_t* data, uint32_t* scratch, size_t count)
+{
+    switch(variant)
+    {
+        case SOL_SORT_BENCHMARK_INTROSORT:
+            sol_sort_benchmark_introsort(data, count);
+            break;
+
+        case SOL_SORT_BENCHMARK_BLOCK_PARTITION:
+            sol_sort_benchmark_block_partition(data, count);
+            break;
+
+        case SOL_SORT_BENCHMARK_RADIX:
+            sol_sort_benchmark_radix_sort(data, scratch, count);
+            break;
+
+        case SOL_SORT_BENCHMARK_QSORT:
+            qsort(data, count, sizeof(uint32_t), &sol_sort_benchmark_qsort_compare);
+            break;
+
+        default:
+            abort();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    struct sol_benchmark_result result;
+    enum sol_sort_benchmark_variant variant;
+    enum sol_sort_benchmark_input input;
+    uint32_t* input_data;
+    uint32_t* data;
+    uint32_t* scratch;
+    uint64_t seed, start_time, nanoseconds;
+    size_t count, i;
+    uint32_t repetitions, repetition;
+
+    count = argc > 1 ? strtoull(argv[1], NULL, 10) : (1u << 20);
+    repetitions = argc > 2 ? (uint32_t)strtoul(argv[2], NULL, 10) : 8;
+    seed = argc > 3 ? strtoull(argv[3], NULL, 10) : 1;
+
+    /** the radix sort doesn't bother sorting fewer than 2 elements, neither does this */
+    if(count < 2 || count > UINT32_MAX || repetitions == 0)
+    {
+        fprintf(stderr, "usage: %s [element count (2-4294967295)] [repetitions (>0)] [seed]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    input_data = malloc(sizeof(uint32_t) * count);
+    data = malloc(sizeof(uint32_t) * count);
+    scratch = malloc(sizeof(uint32_t) * count);
+
+    for(input = 0; input < SOL_SORT_BENCHMARK_INPUT_COUNT; input++)
+    {
+        sol_sort_benchmark_generate(input_data, count, input, seed);
+
+        for(variant = 0; variant < SOL_SORT_BENCHMARK_VARIANT_COUNT; variant++)
+        {
+            sol_benchmark_result_initialise(&result, 1);
+
+            for(repetition = 0; repetition < repetitions; repetition++)
+            {
+                memcpy(data, input_data, sizeof(uint32_t) * count);
+
+                start_time = sol_benchmark_time();
+                sol_sort_benchmark_sort(variant, data, scratch, count);
+                nanoseconds = sol_benchmark_time() - start_time;
+
+                result.nanoseconds += nanoseconds;
+                result.operation_count += count;
+                sol_benchmark_latencies_record(&result.latencies, nanoseconds);
+
+                for(i = 1; i < count; i++)
+                {
+                    if(data[i] < data[i - 1])
+                    {
+                        fprintf(stderr, "%s did not sort %s input (index %zu)\n", sol_sort_benchmark_variant_names[variant], sol_sort_benchmark_input_names[input], i);
+                        abort();
+                    }
+                }
+            }
+
+            sol_benchmark_result_write_json(stdout, sol_sort_benchmark_input_names[input], sol_sort_benchmark_variant_names[variant], &result);
+            sol_benchmark_result_terminate(&result);
+        }
+    }
+
+    free(scratch);
+    free(data);
+    free(input_data);
+
+    return EXIT_SUCCESS;
+}
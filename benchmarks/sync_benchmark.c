@@ -0,0 +1,460 @@
+/**
+Copyright 2026 Carl van Mastrigt
+
+This file is part of solipsix.
+
+solipsix is free software: you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+solipsix is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with solipsix.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/** baseline for the lockfree and sync systems, run before and after changing any of them and compare the output
+ *
+ * usage: sync_benchmark [maximum thread count (default: processor count)] [scale (default: 1, multiplies the work done by every benchmark)]
+ *
+ * build from the directory containing solipsix, with every source file in solipsix/lockfree and solipsix/sync, e.g.:
+ *     cc -std=gnu17 -O2 -DNDEBUG -Isolipsix -I. solipsix/benchmarks/sync_benchmark.c $LOCKFREE_AND_SYNC_SOURCES -lpthread -lm -o sync_benchmark
+ *
+ * benchmarks (JSON lines, see benchmarks/benchmark.h), threads are benchmark threads for pool/hopper and task system workers for the rest:
+ *     pool, "direct"/"magazine":  operation is acquiring then relinquishing one entry, latency is that pair
+ *     hopper, "push":             operation is pushing one entry into a hopper shared by all threads, latency is one push
+ *     hopper, "close":            operation is closing the shared hopper and returning its entries to the pool (once every round), latency is the same
+ *     task, "fan_out_fan_in":     operation is one task, latency is from preparing a graph of a root task, 256 children and a join task, until a gate after it is passed
+ *     barrier, "chain":           operation is one task, latency is from preparing a chain of 16 stages of 16 tasks, each stage joined by a barrier, until a gate after it is passed
+ *     gate, "wake":               operation is one wait, latency is from a task finishing (after the waiting thread must have gone to sleep) until its waiting gate returns */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "sol_utils.h"
+
+#include "lockfree/pool.h"
+#include "lockfree/hopper.h"
+#include "sync/task.h"
+#include "sync/barrier.h"
+#include "sync/gate.h"
+
+#include "benchmarks/benchmark.h"
+
+
+#define SOL_SYNC_BENCHMARK_POOL_OPERATIONS (1u << 22)
+
+#define SOL_SYNC_BENCHMARK_HOPPER_ROUNDS 4096
+#define SOL_SYNC_BENCHMARK_HOPPER_PUSHES_PER_ROUND 16
+
+#define SOL_SYNC_BENCHMARK_FAN_OUT_ROUNDS 2048
+#define SOL_SYNC_BENCHMARK_FAN_OUT_WIDTH 256
+
+#define SOL_SYNC_BENCHMARK_BARRIER_ROUNDS 512
+#define SOL_SYNC_BENCHMARK_BARRIER_STAGES 16
+#define SOL_SYNC_BENCHMARK_BARRIER_WIDTH 16
+
+#define SOL_SYNC_BENCHMARK_GATE_ROUNDS 1024
+/** how long the signalling task runs for, long enough that the waiting thread has certainly gone to sleep */
+#define SOL_SYNC_BENCHMARK_GATE_TASK_NANOSECONDS 50000
+
+
+static uint32_t sol_sync_benchmark_scale = 1;
+
+
+
+struct sol_sync_benchmark_pool_data
+{
+    struct sol_lockfree_pool pool;
+    bool use_magazine;
+};
+
+static void sol_sync_benchmark_pool_thread(struct sol_benchmark_thread* thread)
+{
+    struct sol_sync_benchmark_pool_data* data = thread->data;
+    struct sol_lockfree_pool_magazine magazine;
+    uint64_t i, operation_count, start_time;
+    uint64_t* entry;
+
+    operation_count = ((uint64_t)SOL_SYNC_BENCHMARK_POOL_OPERATIONS * sol_sync_benchmark_scale) / thread->thread_count;
+
+    if(data->use_magazine)
+    {
+        sol_lockfree_pool_magazine_initialise(&magazine, &data->pool);
+    }
+
+    for(i = 0; i < operation_count; i++)
+    {
+        start_time = sol_benchmark_should_sample(i) ? sol_benchmark_time() : 0;
+
+        if(data->use_magazine)
+        {
+            entry = sol_lockfree_pool_magazine_acquire_entry(&magazine);
+            assert(entry);
+            *entry = i;
+            sol_lockfree_pool_magazine_relinquish_entry(&magazine, entry);
+        }
+        else
+        {
+            entry = sol_lockfree_pool_acquire_entry(&data->pool);
+            assert(entry);
+            *entry = i;
+            sol_lockfree_pool_relinquish_entry(&data->pool, entry);
+        }
+
+        if(start_time)
+        {
+            sol_benchmark_latencies_record(&thread->latencies, sol_benchmark_time() - start_time);
+        }
+    }
+
+    if(data->use_magazine)
+    {
+        sol_lockfree_pool_magazine_terminate(&magazine);
+    }
+
+    thread->operation_count = operation_count;
+}
+
+static void sol_sync_benchmark_pool(uint32_t thread_count)
+{
+    struct sol_sync_benchmark_pool_data data;
+    struct sol_benchmark_result result;
+
+    /** enough for every magazine to be full, with half again to spare */
+    sol_lockfree_pool_initialise(&data.pool, sol_u32_exp_ge(thread_count * SOL_LOCKFREE_POOL_MAGAZINE_CAPACITY * 2), sizeof(uint64_t));
+
+    data.use_magazine = false;
+    sol_benchmark_result_initialise(&result, thread_count);
+    sol_benchmark_run_threads(&result, thread_count, &sol_sync_benchmark_pool_thread, &data);
+    sol_benchmark_result_write_json(stdout, "pool", "direct", &result);
+    sol_benchmark_result_terminate(&result);
+
+    data.use_magazine = true;
+    sol_benchmark_result_initialise(&result, thread_count);
+    sol_benchmark_run_threads(&result, thread_count, &sol_sync_benchmark_pool_thread, &data);
+    sol_benchmark_result_write_json(stdout, "pool", "magazine", &result);
+    sol_benchmark_result_terminate(&result);
+
+    sol_lockfree_pool_terminate(&data.pool);
+}
+
+
+
+struct sol_sync_benchmark_hopper_data
+{
+    struct sol_lockfree_pool pool;
+    struct sol_lockfree_hopper hopper;
+    struct sol_benchmark_spin_barrier round_barrier;
+    /** only accessed by the first thread */
+    struct sol_benchmark_latencies close_latencies;
+};
+
+static void sol_sync_benchmark_hopper_thread(struct sol_benchmark_thread* thread)
+{
+    struct sol_sync_benchmark_hopper_data* data = thread->data;
+    uint64_t round, round_count, push_index, start_time;
+    uint32_t i, first_entry_index, entry_index;
+    void* entry;
+    bool pushed;
+
+    round_count = (uint64_t)SOL_SYNC_BENCHMARK_HOPPER_ROUNDS * sol_sync_benchmark_scale;
+    push_index = 0;
+
+    for(round = 0; round < round_count; round++)
+    {
+        for(i = 0; i < SOL_SYNC_BENCHMARK_HOPPER_PUSHES_PER_ROUND; i++, push_index++)
+        {
+            entry = sol_lockfree_pool_acquire_entry(&data->pool);
+            assert(entry);
+
+            start_time = sol_benchmark_should_sample(push_index) ? sol_benchmark_time() : 0;
+            pushed = sol_lockfree_hopper_push(&data->hopper, &data->pool, entry);
+            if(start_time)
+            {
+                sol_benchmark_latencies_record(&thread->latencies, sol_benchmark_time() - start_time);
+            }
+
+            /** the hopper is only closed once every thread has finished pushing for the round */
+            assert(pushed);
+            (void)pushed;
+        }
+
+        sol_benchmark_spin_barrier_wait(&data->round_barrier);
+
+        if(thread->index == 0)
+        {
+            start_time = sol_benchmark_time();
+
+            first_entry_index = sol_lockfree_hopper_close(&data->hopper);
+            entry_index = first_entry_index;
+            entry = sol_lockfree_pool_get_entry_pointer(&data->pool, entry_index);
+            while(entry)
+            {
+                entry = sol_lockfree_pool_iterate(&data->pool, &entry_index);
+            }
+            sol_lockfree_pool_relinquish_entry_index_range(&data->pool, first_entry_index, entry_index);
+
+            sol_benchmark_latencies_record(&data->close_latencies, sol_benchmark_time() - start_time);
+
+            sol_lockfree_hopper_reset(&data->hopper);
+        }
+
+        sol_benchmark_spin_barrier_wait(&data->round_barrier);
+    }
+
+    thread->operation_count = push_index;
+}
+
+static void sol_sync_benchmark_hopper(uint32_t thread_count)
+{
+    struct sol_sync_benchmark_hopper_data data;
+    struct sol_benchmark_result result, close_result;
+    uint32_t first_entry_index;
+    sol_lockfree_pool_initialise(&data.pool, sol_u32_exp_ge(thread_count * SOL_SYNC_BENCHMARK_HOPPER_PUSHES_PER_ROUND), sizeof(uint64_t));
+    /** a hopper starts closed */
+    sol_lockfree_hopper_initialise(&data.hopper);
+    sol_lockfree_hopper_reset(&data.hopper);
+    sol_benchmark_spin_barrier_initialise(&data.round_barrier, thread_count);
+    sol_benchmark_latencies_initialise(&data.close_latencies);
+
+    sol_benchmark_result_initialise(&result, thread_count);
+    sol_benchmark_run_threads(&result, thread_count, &sol_sync_benchmark_hopper_thread, &data);
+    sol_benchmark_result_write_json(stdout, "hopper", "push", &result);
+
+    /** the close result shares the timing of the whole run */
+    sol_benchmark_result_initialise(&close_result, thread_count);
+    close_result.nanoseconds = result.nanoseconds;
+    close_result.operation_count = data.close_latencies.count;
+    sol_benchmark_latencies_append(&close_result.latencies, &data.close_latencies);
+    sol_benchmark_result_write_json(stdout, "hopper", "close", &close_result);
+
+    sol_benchmark_result_terminate(&close_result);
+    sol_benchmark_result_terminate(&result);
+
+    sol_benchmark_latencies_terminate(&data.close_latencies);
+
+    /** every round leaves the hopper reset (and empty) */
+    first_entry_index = sol_lockfree_hopper_close(&data.hopper);
+    assert(first_entry_index == SOL_LOCKFREE_POOL_INVALID_ENTRY);
+    (void)first_entry_index;
+    sol_lockfree_hopper_terminate(&data.hopper);
+    sol_lockfree_pool_terminate(&data.pool);
+}
+
+
+
+static void sol_sync_benchmark_empty_task(void* data)
+{
+}
+
+/** the task system is used from this (non worker) thread, so the result is written directly rather than using sol_benchmark_run_threads */
+static void sol_sync_benchmark_fan_out_fan_in(struct sol_sync_task_system* task_system, struct sol_sync_gate_pool* gate_pool, uint32_t worker_count)
+{
+    struct sol_benchmark_result result;
+    struct sol_sync_task_handle root, join, child;
+    struct sol_sync_gate_handle gate;
+    uint64_t round, round_count, start_time, end_time;
+    uint32_t i;
+
+    round_count = (uint64_t)SOL_SYNC_BENCHMARK_FAN_OUT_ROUNDS * sol_sync_benchmark_scale;
+
+    sol_benchmark_result_initialise(&result, worker_count);
+
+    for(round = 0; round < round_count; round++)
+    {
+        start_time = sol_benchmark_time();
+
+        gate = sol_sync_gate_prepare(gate_pool);
+        root = sol_sync_task_prepare(task_system, &sol_sync_benchmark_empty_task, NULL);
+        join = sol_sync_task_prepare(task_system, &sol_sync_benchmark_empty_task, NULL);
+        sol_sync_task_attach_successor(join, gate.primitive);
+
+        for(i = 0; i < SOL_SYNC_BENCHMARK_FAN_OUT_WIDTH; i++)
+        {
+            child = sol_sync_task_prepare(task_system, &sol_sync_benchmark_empty_task, NULL);
+            sol_sync_task_attach_successor(root, child.primitive);
+            sol_sync_task_attach_successor(child, join.primitive);
+            sol_sync_task_activate(child);
+        }
+
+        sol_sync_task_activate(join);
+        sol_sync_task_activate(root);
+        sol_sync_gate_wait(gate);
+
+        end_time = sol_benchmark_time();
+
+        sol_benchmark_latencies_record(&result.latencies, end_time - start_time);
+        result.nanoseconds += end_time - start_time;
+        result.operation_count += SOL_SYNC_BENCHMARK_FAN_OUT_WIDTH + 2;
+    }
+
+    sol_benchmark_result_write_json(stdout, "task", "fan_out_fan_in", &result);
+    sol_benchmark_result_terminate(&result);
+}
+
+static void sol_sync_benchmark_barrier_chain(struct sol_sync_task_system* task_system, struct sol_sync_barrier_pool* barrier_pool, struct sol_sync_gate_pool* gate_pool, uint32_t worker_count)
+{
+    struct sol_benchmark_result result;
+    struct sol_sync_barrier_handle barriers[SOL_SYNC_BENCHMARK_BARRIER_STAGES];
+    struct sol_sync_task_handle task;
+    struct sol_sync_gate_handle gate;
+    uint64_t round, round_count, start_time, end_time;
+    uint32_t stage, i;
+
+    round_count = (uint64_t)SOL_SYNC_BENCHMARK_BARRIER_ROUNDS * sol_sync_benchmark_scale;
+
+    sol_benchmark_result_initialise(&result, worker_count);
+
+    for(round = 0; round < round_count; round++)
+    {
+        start_time = sol_benchmark_time();
+
+        gate = sol_sync_gate_prepare(gate_pool);
+
+        for(stage = 0; stage < SOL_SYNC_BENCHMARK_BARRIER_STAGES; stage++)
+        {
+            barriers[stage] = sol_sync_barrier_prepare(barrier_pool);
+        }
+        sol_sync_barrier_attach_successor(barriers[SOL_SYNC_BENCHMARK_BARRIER_STAGES - 1], gate.primitive);
+
+        /** stage s runs after barrier s-1 and before barrier s */
+        for(stage = 0; stage < SOL_SYNC_BENCHMARK_BARRIER_STAGES; stage++)
+        {
+            for(i = 0; i < SOL_SYNC_BENCHMARK_BARRIER_WIDTH; i++)
+            {
+                task = sol_sync_task_prepare(task_system, &sol_sync_benchmark_empty_task, NULL);
+                if(stage)
+                {
+                    sol_sync_barrier_attach_successor(barriers[stage - 1], task.primitive);
+                }
+                sol_sync_task_attach_successor(task, barriers[stage].primitive);
+                sol_sync_task_activate(task);
+            }
+        }
+
+        for(stage = 0; stage < SOL_SYNC_BENCHMARK_BARRIER_STAGES; stage++)
+        {
+            sol_sync_barrier_activate(barriers[stage]);
+        }
+
+        sol_sync_gate_wait(gate);
+
+        end_time = sol_benchmark_time();
+
+        sol_benchmark_latencies_record(&result.latencies, end_time - start_time);
+        result.nanoseconds += end_time - start_time;
+        result.operation_count += SOL_SYNC_BENCHMARK_BARRIER_STAGES * SOL_SYNC_BENCHMARK_BARRIER_WIDTH;
+    }
+
+    sol_benchmark_result_write_json(stdout, "barrier", "chain", &result);
+    sol_benchmark_result_terminate(&result);
+}
+
+static void sol_sync_benchmark_gate_signalling_task(void* data)
+{
+    _Atomic uint64_t* signal_time = data;
+    uint64_t start_time = sol_benchmark_time();
+
+    while(sol_benchmark_time() - start_time < SOL_SYNC_BENCHMARK_GATE_TASK_NANOSECONDS);
+
+    /** the gate is signalled as this tasks successor immediately after this returns */
+    atomic_store_explicit(signal_time, sol_benchmark_time(), memory_order_relaxed);
+}
+
+static void sol_sync_benchmark_gate_wake(struct sol_sync_task_system* task_system, struct sol_sync_gate_pool* gate_pool, uint32_t worker_count)
+{
+    struct sol_benchmark_result result;
+    struct sol_sync_task_handle task;
+    struct sol_sync_gate_handle gate;
+    uint64_t round, round_count, start_time, end_time;
+    _Atomic uint64_t signal_time;
+
+    round_count = (uint64_t)SOL_SYNC_BENCHMARK_GATE_ROUNDS * sol_sync_benchmark_scale;
+
+    sol_benchmark_result_initialise(&result, worker_count);
+
+    for(round = 0; round < round_count; round++)
+    {
+        start_time = sol_benchmark_time();
+
+        gate = sol_sync_gate_prepare(gate_pool);
+        task = sol_sync_task_prepare(task_system, &sol_sync_benchmark_gate_signalling_task, &signal_time);
+        sol_sync_task_attach_successor(task, gate.primitive);
+        sol_sync_task_activate(task);
+        sol_sync_gate_wait(gate);
+
+        end_time = sol_benchmark_time();
+
+        sol_benchmark_latencies_record(&result.latencies, end_time - atomic_load_explicit(&signal_time, memory_order_relaxed));
+        result.nanoseconds += end_time - start_time;
+        result.operation_count++;
+    }
+
+    sol_benchmark_result_write_json(stdout, "gate", "wake", &result);
+    sol_benchmark_result_terminate(&result);
+}
+
+static void sol_sync_benchmark_task_system(uint32_t worker_count)
+{
+    struct sol_sync_task_system task_system;
+    struct sol_sync_barrier_pool barrier_pool;
+    struct sol_sync_gate_pool gate_pool;
+
+    /** successors: every worker can hold a magazine worth, plus a round of the fan out graph (2 per child) */
+    sol_sync_task_system_initialise(&task_system, worker_count, 10, sol_u32_exp_ge(worker_count * SOL_LOCKFREE_POOL_MAGAZINE_CAPACITY + SOL_SYNC_BENCHMARK_FAN_OUT_WIDTH * 4));
+    sol_sync_barrier_pool_initialise(&barrier_pool, 8, 12);
+    sol_sync_gate_pool_initialise(&gate_pool, 4);
+
+    sol_sync_benchmark_fan_out_fan_in(&task_system, &gate_pool, worker_count);
+    sol_sync_benchmark_barrier_chain(&task_system, &barrier_pool, &gate_pool, worker_count);
+    sol_sync_benchmark_gate_wake(&task_system, &gate_pool, worker_count);
+
+    sol_sync_task_system_begin_shutdown(&task_system);
+    sol_sync_task_system_end_shutdown(&task_system);
+    sol_sync_task_system_terminate(&task_system);
+
+    sol_sync_gate_pool_terminate(&gate_pool);
+    sol_sync_barrier_pool_terminate(&barrier_pool);
+}
+
+
+
+int main(int argc, char** argv)
+{
+    uint32_t thread_counts[34];
+    uint32_t maximum_thread_count, thread_count_count, i;
+
+    maximum_thread_count = sol_benchmark_processor_count();
+
+    if(argc > 1)
+    {
+        maximum_thread_count = (uint32_t)strtoul(argv[1], NULL, 10);
+    }
+    if(argc > 2)
+    {
+        sol_sync_benchmark_scale = (uint32_t)strtoul(argv[2], NULL, 10);
+    }
+
+    if(maximum_thread_count == 0 || maximum_thread_count > 1024 || sol_sync_benchmark_scale == 0)
+    {
+        fprintf(stderr, "usage: %s [maximum thread count (1-1024)] [scale (>0)]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    thread_count_count = sol_benchmark_thread_counts(thread_counts, maximum_thread_count);
+
+    for(i = 0; i < thread_count_count; i++)
+    {
+        sol_sync_benchmark_pool(thread_counts[i]);
+        sol_sync_benchmark_hopper(thread_counts[i]);
+        sol_sync_benchmark_task_system(thread_counts[i]);
+    }
+
+    return EXIT_SUCCESS;
+}
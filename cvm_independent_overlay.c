@@ -23,6 +23,12 @@ along with solipsix.  If not, see <https://www.gnu.org/licenses/>.
 #include "overlay/render.h"
 
 
+/** bytes of image data each atlas may move per frame while compacting, small so that defragmenting is never a noticeable part of a frame */
+#ifndef CVM_OVERLAY_ATLAS_DEFRAGMENT_BYTE_BUDGET
+#define CVM_OVERLAY_ATLAS_DEFRAGMENT_BYTE_BUDGET (256 * 1024)
+#endif
+
+
 
 struct cvm_overlay_frame_resources
 {
@@ -541,6 +547,8 @@ struct sol_vk_timeline_semaphore_moment cvm_overlay_render_to_target(struct cvm_
 
     for(i = 0; i< SOL_OVERLAY_IMAGE_ATLAS_TYPE_COUNT; i++)
     {
+        /** compact the atlas a little (before any locations are vended) so that large entries don't force evictions, this returns immediately unless the atlas has become fragmented */
+        sol_image_atlas_defragment(renderer->overlay_rendering_resources.atlases[i], cb.buffer, CVM_OVERLAY_ATLAS_DEFRAGMENT_BYTE_BUDGET);
         sol_image_atlas_access_range_begin(renderer->overlay_rendering_resources.atlases[i]);
     }
 
@@ -50,18 +50,33 @@ along with solipsix.  If not, see <https://www.gnu.org/licenses/>.
 #endif
 
 
+/** number of children each node has, 4 keeps all children of a node within a cache line for small entries and halves the depth of the heap
+ * at the cost of more comparisons per level when moving down, must be at least 2 (2 makes it a regular binary heap) */
+#ifndef SOL_BINARY_HEAP_ARITY
+#define SOL_BINARY_HEAP_ARITY 4
+#endif
+
+static_assert(SOL_BINARY_HEAP_ARITY >= 2, "binary heap arity must be at least 2");
+
+
+/** SOL_BINARY_HEAP_SET_ENTRY_INDEX is called every time an entry is placed in the heap with its new index,
+ * tracking this externally allows the index based functions (withdraw_index/update_index/decrease_index) to be used */
 #ifdef SOL_BINARY_HEAP_CONTEXT_TYPE
     #ifndef SOL_BINARY_HEAP_SET_ENTRY_INDEX
     #define SOL_BINARY_HEAP_SET_ENTRY_INDEX(E, IDX, CTX)
     #endif
     #define SOL_BINARY_HEAP_ENTRY_CMP_LT_CONTEXT(A, B) SOL_BINARY_HEAP_ENTRY_CMP_LT(A, B, context)
     #define SOL_BINARY_HEAP_SET_ENTRY_INDEX_CONTEXT(E, IDX) SOL_BINARY_HEAP_SET_ENTRY_INDEX(E, IDX, context)
+    #define SOL_BINARY_HEAP_CONTEXT_PARAMETER , SOL_BINARY_HEAP_CONTEXT_TYPE context
+    #define SOL_BINARY_HEAP_CONTEXT_ARGUMENT , context
 #else
     #ifndef SOL_BINARY_HEAP_SET_ENTRY_INDEX
     #define SOL_BINARY_HEAP_SET_ENTRY_INDEX(E, IDX)
     #endif
     #define SOL_BINARY_HEAP_ENTRY_CMP_LT_CONTEXT(A, B) SOL_BINARY_HEAP_ENTRY_CMP_LT(A, B)
     #define SOL_BINARY_HEAP_SET_ENTRY_INDEX_CONTEXT(E, IDX) SOL_BINARY_HEAP_SET_ENTRY_INDEX(E, IDX)
+    #define SOL_BINARY_HEAP_CONTEXT_PARAMETER
+    #define SOL_BINARY_HEAP_CONTEXT_ARGUMENT
 #endif
 
 
@@ -72,6 +87,62 @@ struct SOL_BINARY_HEAP_STRUCT_NAME
     uint32_t count;
 };
 
+/** move entry towards the top of the heap starting from index (which should be considered empty), placing it where it belongs */
+static inline void SOL_CONCATENATE(SOL_BINARY_HEAP_FUNCTION_PREFIX,_move_up__i)(struct SOL_BINARY_HEAP_STRUCT_NAME* restrict heap, uint32_t index, SOL_BINARY_HEAP_ENTRY_TYPE entry SOL_BINARY_HEAP_CONTEXT_PARAMETER)
+{
+    uint32_t parent_index;
+
+    while(index)
+    {
+        parent_index = (index - 1) / SOL_BINARY_HEAP_ARITY;
+
+        if(SOL_BINARY_HEAP_ENTRY_CMP_LT_CONTEXT((heap->heap + parent_index), (&entry)))
+        {
+            break;
+        }
+
+        heap->heap[index] = heap->heap[parent_index];
+        SOL_BINARY_HEAP_SET_ENTRY_INDEX_CONTEXT((heap->heap + index), index);
+        index = parent_index;
+    }
+
+    heap->heap[index] = entry;
+    SOL_BINARY_HEAP_SET_ENTRY_INDEX_CONTEXT((heap->heap + index), index);
+}
+
+/** move entry towards the bottom of the heap starting from index (which should be considered empty), placing it where it belongs */
+static inline void SOL_CONCATENATE(SOL_BINARY_HEAP_FUNCTION_PREFIX,_move_down__i)(struct SOL_BINARY_HEAP_STRUCT_NAME* restrict heap, uint32_t index, SOL_BINARY_HEAP_ENTRY_TYPE entry SOL_BINARY_HEAP_CONTEXT_PARAMETER)
+{
+    uint32_t child_index, child_end, best_index;
+    const uint32_t count = heap->count;
+
+    while((child_index = index * SOL_BINARY_HEAP_ARITY + 1) < count)
+    {
+        child_end = (count - child_index > SOL_BINARY_HEAP_ARITY) ? child_index + SOL_BINARY_HEAP_ARITY : count;
+
+        best_index = child_index;
+        while(++child_index < child_end)
+        {
+            if(SOL_BINARY_HEAP_ENTRY_CMP_LT_CONTEXT((heap->heap + child_index), (heap->heap + best_index)))
+            {
+                best_index = child_index;
+            }
+        }
+
+        if(SOL_BINARY_HEAP_ENTRY_CMP_LT_CONTEXT((&entry), (heap->heap + best_index)))
+        {
+            break;
+        }
+
+        heap->heap[index] = heap->heap[best_index];
+        SOL_BINARY_HEAP_SET_ENTRY_INDEX_CONTEXT((heap->heap + index), index);
+        index = best_index;
+    }
+
+    heap->heap[index] = entry;
+    SOL_BINARY_HEAP_SET_ENTRY_INDEX_CONTEXT((heap->heap + index), index);
+}
+
 static inline void SOL_CONCATENATE(SOL_BINARY_HEAP_FUNCTION_PREFIX,_initialise)(struct SOL_BINARY_HEAP_STRUCT_NAME* heap, uint32_t initial_space)
 {
     heap->heap = initial_space ? malloc(sizeof(SOL_BINARY_HEAP_ENTRY_TYPE) * initial_space) : NULL;
@@ -84,14 +155,8 @@ static inline void SOL_CONCATENATE(SOL_BINARY_HEAP_FUNCTION_PREFIX,_terminate)(s
     free(heap->heap);
 }
 
-#ifdef SOL_BINARY_HEAP_CONTEXT_TYPE
-static inline void SOL_CONCATENATE(SOL_BINARY_HEAP_FUNCTION_PREFIX,_append)(struct SOL_BINARY_HEAP_STRUCT_NAME* restrict heap, SOL_BINARY_HEAP_ENTRY_TYPE entry, SOL_BINARY_HEAP_CONTEXT_TYPE context)
-#else
-static inline void SOL_CONCATENATE(SOL_BINARY_HEAP_FUNCTION_PREFIX,_append)(struct SOL_BINARY_HEAP_STRUCT_NAME* restrict heap, SOL_BINARY_HEAP_ENTRY_TYPE entry)
-#endif
+static inline void SOL_CONCATENATE(SOL_BINARY_HEAP_FUNCTION_PREFIX,_append)(struct SOL_BINARY_HEAP_STRUCT_NAME* restrict heap, SOL_BINARY_HEAP_ENTRY_TYPE entry SOL_BINARY_HEAP_CONTEXT_PARAMETER)
 {
-    uint32_t next_index, index;
-
     if(heap->count == heap->space)
     {
         if(heap->space)
@@ -105,24 +170,7 @@ static inline void SOL_CONCATENATE(SOL_BINARY_HEAP_FUNCTION_PREFIX,_append)(stru
         heap->heap = realloc(heap->heap, sizeof(SOL_BINARY_HEAP_ENTRY_TYPE) * heap->space);
     }
 
-    index = heap->count++;
-
-    while(index)
-    {
-        next_index = (index - 1) >> 1;
-
-        if(SOL_BINARY_HEAP_ENTRY_CMP_LT_CONTEXT((heap->heap + next_index), (&entry)))
-        {
-            break;
-        }
-
-        heap->heap[index] = heap->heap[next_index];
-        SOL_BINARY_HEAP_SET_ENTRY_INDEX_CONTEXT((heap->heap + index), index);
-        index = next_index;
-    }
-
-    heap->heap[index] = entry;
-    SOL_BINARY_HEAP_SET_ENTRY_INDEX_CONTEXT((heap->heap + index), index);
+    SOL_CONCATENATE(SOL_BINARY_HEAP_FUNCTION_PREFIX,_move_up__i)(heap, heap->count++, entry SOL_BINARY_HEAP_CONTEXT_ARGUMENT);
 }
 
 static inline void SOL_CONCATENATE(SOL_BINARY_HEAP_FUNCTION_PREFIX,_clear)(struct SOL_BINARY_HEAP_STRUCT_NAME* heap)
@@ -140,15 +188,15 @@ static inline const SOL_BINARY_HEAP_ENTRY_TYPE* SOL_CONCATENATE(SOL_BINARY_HEAP_
     return heap->heap;
 }
 
-#ifdef SOL_BINARY_HEAP_CONTEXT_TYPE
-static inline bool SOL_CONCATENATE(SOL_BINARY_HEAP_FUNCTION_PREFIX,_withdraw)(struct SOL_BINARY_HEAP_STRUCT_NAME* restrict heap, SOL_BINARY_HEAP_ENTRY_TYPE* restrict entry, SOL_BINARY_HEAP_CONTEXT_TYPE context)
-#else
-static inline bool SOL_CONCATENATE(SOL_BINARY_HEAP_FUNCTION_PREFIX,_withdraw)(struct SOL_BINARY_HEAP_STRUCT_NAME* restrict heap, SOL_BINARY_HEAP_ENTRY_TYPE* restrict entry)
-#endif
+/** the returned entry may be modified, but if this changes its ordering then update_index or decrease_index must be called before any other heap operation */
+static inline SOL_BINARY_HEAP_ENTRY_TYPE* SOL_CONCATENATE(SOL_BINARY_HEAP_FUNCTION_PREFIX,_access_index)(struct SOL_BINARY_HEAP_STRUCT_NAME* heap, uint32_t index)
 {
-    uint32_t index, next_index, count;
-    const SOL_BINARY_HEAP_ENTRY_TYPE* replacement;
+    assert(index < heap->count);
+    return heap->heap + index;
+}
 
+static inline bool SOL_CONCATENATE(SOL_BINARY_HEAP_FUNCTION_PREFIX,_withdraw)(struct SOL_BINARY_HEAP_STRUCT_NAME* restrict heap, SOL_BINARY_HEAP_ENTRY_TYPE* restrict entry SOL_BINARY_HEAP_CONTEXT_PARAMETER)
+{
     if(heap->count == 0)
     {
         return false;
@@ -158,42 +206,18 @@ static inline bool SOL_CONCATENATE(SOL_BINARY_HEAP_FUNCTION_PREFIX,_withdraw)(st
     {
         *entry = heap->heap[0];
     }
-    count = --heap->count;
-    replacement = heap->heap + count;
-    index = 0;
-    next_index = 2;
 
-    while(next_index < count)
-    {
-        next_index -= SOL_BINARY_HEAP_ENTRY_CMP_LT_CONTEXT((heap->heap + next_index - 1), (heap->heap + next_index));
-        if(SOL_BINARY_HEAP_ENTRY_CMP_LT_CONTEXT((replacement), (heap->heap + next_index)))
-        {
-            break;
-        }
-        heap->heap[index] = heap->heap[next_index];
-        SOL_BINARY_HEAP_SET_ENTRY_INDEX_CONTEXT((heap->heap + index), index);
-        index = next_index;
-        next_index = (next_index + 1) << 1;
-    }
-    if(next_index == count && (SOL_BINARY_HEAP_ENTRY_CMP_LT_CONTEXT((heap->heap + next_index - 1), replacement)))
+    if(--heap->count)
     {
-        heap->heap[index] = heap->heap[next_index - 1];
-        SOL_BINARY_HEAP_SET_ENTRY_INDEX_CONTEXT((heap->heap + index), index);
-        index = next_index - 1;
+        SOL_CONCATENATE(SOL_BINARY_HEAP_FUNCTION_PREFIX,_move_down__i)(heap, 0, heap->heap[heap->count] SOL_BINARY_HEAP_CONTEXT_ARGUMENT);
     }
 
-    heap->heap[index] = *replacement;
-    SOL_BINARY_HEAP_SET_ENTRY_INDEX_CONTEXT((heap->heap + index), index);
     return true;
 }
 
-#ifdef SOL_BINARY_HEAP_CONTEXT_TYPE
-static inline void SOL_CONCATENATE(SOL_BINARY_HEAP_FUNCTION_PREFIX,_withdraw_index)(struct SOL_BINARY_HEAP_STRUCT_NAME* restrict heap, uint32_t index, SOL_BINARY_HEAP_ENTRY_TYPE* restrict entry, SOL_BINARY_HEAP_CONTEXT_TYPE context)
-#else
-static inline void SOL_CONCATENATE(SOL_BINARY_HEAP_FUNCTION_PREFIX,_withdraw_index)(struct SOL_BINARY_HEAP_STRUCT_NAME* restrict heap, uint32_t index, SOL_BINARY_HEAP_ENTRY_TYPE* restrict entry)
-#endif
+/** remove the entry at an arbitrary index, requires the index to be tracked with SOL_BINARY_HEAP_SET_ENTRY_INDEX */
+static inline void SOL_CONCATENATE(SOL_BINARY_HEAP_FUNCTION_PREFIX,_withdraw_index)(struct SOL_BINARY_HEAP_STRUCT_NAME* restrict heap, uint32_t index, SOL_BINARY_HEAP_ENTRY_TYPE* restrict entry SOL_BINARY_HEAP_CONTEXT_PARAMETER)
 {
-    uint32_t next_index, count;
     const SOL_BINARY_HEAP_ENTRY_TYPE* replacement;
 
     assert(index < heap->count);
@@ -202,47 +226,46 @@ static inline void SOL_CONCATENATE(SOL_BINARY_HEAP_FUNCTION_PREFIX,_withdraw_ind
     {
         *entry = heap->heap[index];
     }
-    count = --heap->count;
-    replacement = heap->heap + count;
 
-    /** attempt to move replacement up the heap */
-    while(index)
+    if(index == --heap->count)
     {
-        next_index = (index - 1) >> 1;
+        /** removed the last entry, nothing to fill */
+        return;
+    }
 
-        if(SOL_BINARY_HEAP_ENTRY_CMP_LT_CONTEXT((heap->heap + next_index), (entry)))
-        {
-            break;
-        }
+    /** the last entry fills the gap, it may belong above or below it */
+    replacement = heap->heap + heap->count;
 
-        heap->heap[index] = heap->heap[next_index];
-        SOL_BINARY_HEAP_SET_ENTRY_INDEX_CONTEXT((heap->heap + index), index);
-        index = next_index;
+    if(index && SOL_BINARY_HEAP_ENTRY_CMP_LT_CONTEXT((replacement), (heap->heap + (index - 1) / SOL_BINARY_HEAP_ARITY)))
+    {
+        SOL_CONCATENATE(SOL_BINARY_HEAP_FUNCTION_PREFIX,_move_up__i)(heap, index, *replacement SOL_BINARY_HEAP_CONTEXT_ARGUMENT);
+    }
+    else
+    {
+        SOL_CONCATENATE(SOL_BINARY_HEAP_FUNCTION_PREFIX,_move_down__i)(heap, index, *replacement SOL_BINARY_HEAP_CONTEXT_ARGUMENT);
     }
+}
+
+/** the entry at index has been modified such that it orders earlier (or the same), this is the classic decrease-key for a min-heap */
+static inline void SOL_CONCATENATE(SOL_BINARY_HEAP_FUNCTION_PREFIX,_decrease_index)(struct SOL_BINARY_HEAP_STRUCT_NAME* restrict heap, uint32_t index SOL_BINARY_HEAP_CONTEXT_PARAMETER)
+{
+    assert(index < heap->count);
+    SOL_CONCATENATE(SOL_BINARY_HEAP_FUNCTION_PREFIX,_move_up__i)(heap, index, heap->heap[index] SOL_BINARY_HEAP_CONTEXT_ARGUMENT);
+}
+
+/** the entry at index has been modified in an arbitrary way, restore its place in the heap */
+static inline void SOL_CONCATENATE(SOL_BINARY_HEAP_FUNCTION_PREFIX,_update_index)(struct SOL_BINARY_HEAP_STRUCT_NAME* restrict heap, uint32_t index SOL_BINARY_HEAP_CONTEXT_PARAMETER)
+{
+    assert(index < heap->count);
 
-    /** attempt to move replacement down the hep */
-    next_index = (index + 1) << 1;
-    while(next_index < count)
+    if(index && SOL_BINARY_HEAP_ENTRY_CMP_LT_CONTEXT((heap->heap + index), (heap->heap + (index - 1) / SOL_BINARY_HEAP_ARITY)))
     {
-        next_index -= SOL_BINARY_HEAP_ENTRY_CMP_LT_CONTEXT((heap->heap + next_index - 1), (heap->heap + next_index));
-        if(SOL_BINARY_HEAP_ENTRY_CMP_LT_CONTEXT((replacement), (heap->heap + next_index)))
-        {
-            break;
-        }
-        heap->heap[index] = heap->heap[next_index];
-        SOL_BINARY_HEAP_SET_ENTRY_INDEX_CONTEXT((heap->heap + index), index);
-        index = next_index;
-        next_index = (next_index + 1) << 1;
+        SOL_CONCATENATE(SOL_BINARY_HEAP_FUNCTION_PREFIX,_move_up__i)(heap, index, heap->heap[index] SOL_BINARY_HEAP_CONTEXT_ARGUMENT);
     }
-    if(next_index == count && (SOL_BINARY_HEAP_ENTRY_CMP_LT_CONTEXT((heap->heap + next_index - 1), replacement)))
+    else
     {
-        heap->heap[index] = heap->heap[next_index - 1];
-        SOL_BINARY_HEAP_SET_ENTRY_INDEX_CONTEXT((heap->heap + index), index);
-        index = next_index - 1;
+        SOL_CONCATENATE(SOL_BINARY_HEAP_FUNCTION_PREFIX,_move_down__i)(heap, index, heap->heap[index] SOL_BINARY_HEAP_CONTEXT_ARGUMENT);
     }
-
-    heap->heap[index] = *replacement;
-    SOL_BINARY_HEAP_SET_ENTRY_INDEX_CONTEXT((heap->heap + index), index);
 }
 
 
@@ -252,9 +275,12 @@ static inline void SOL_CONCATENATE(SOL_BINARY_HEAP_FUNCTION_PREFIX,_withdraw_ind
 #undef SOL_BINARY_HEAP_DEFAULT_STARTING_SIZE
 #undef SOL_BINARY_HEAP_ENTRY_CMP_LT
 #undef SOL_BINARY_HEAP_SET_ENTRY_INDEX
+#undef SOL_BINARY_HEAP_ARITY
 
 #undef SOL_BINARY_HEAP_ENTRY_CMP_LT_CONTEXT
 #undef SOL_BINARY_HEAP_SET_ENTRY_INDEX_CONTEXT
+#undef SOL_BINARY_HEAP_CONTEXT_PARAMETER
+#undef SOL_BINARY_HEAP_CONTEXT_ARGUMENT
 
 #ifdef SOL_BINARY_HEAP_CONTEXT_TYPE
 #undef SOL_BINARY_HEAP_CONTEXT_TYPE
@@ -134,6 +134,21 @@ static inline void sol_buddy_grid_entry_set_heap_index(const uint32_t* entry_ind
 	entry->heap_index = new_index_in_heap;
 }
 
+/** defragmentation candidates are considered worst placed (highest packed location) first */
+static inline bool sol_buddy_grid_relocation_packed_location_cmp_gt(const struct sol_buddy_grid_relocation* relocation_a, const struct sol_buddy_grid_relocation* relocation_b, struct sol_buddy_grid* grid)
+{
+	const struct sol_buddy_grid_entry* entry_a = sol_buddy_grid_entry_array_access_entry(&grid->entry_array, relocation_a->source_index);
+	const struct sol_buddy_grid_entry* entry_b = sol_buddy_grid_entry_array_access_entry(&grid->entry_array, relocation_b->source_index);
+
+	return entry_a->packed_location > entry_b->packed_location;
+}
+
+#define SOL_SORT_TYPE struct sol_buddy_grid_relocation
+#define SOL_SORT_FUNCTION_NAME sol_buddy_grid_relocation_sort
+#define SOL_SORT_CONTEXT_TYPE struct sol_buddy_grid*
+#define SOL_SORT_COMPARE_LT(A, B, CTX) sol_buddy_grid_relocation_packed_location_cmp_gt(A, B, CTX)
+#include "sorts/quicksort.h"
+
 #define SOL_BUDDY_GRID_PACKED_X_MASK     0x00555555u
 #define SOL_BUDDY_GRID_PACKED_Y_MASK     0x00AAAAAAu
 #define SOL_BUDDY_GRID_PACKED_LAYER_MASK 0xFF000000u
@@ -940,4 +955,84 @@ bool sol_buddy_grid_has_space(struct sol_buddy_grid* grid, u16_vec2 size)
 	}
 
 	return false;
-}
\ No newline at end of file
+}
+
+size_t sol_buddy_grid_memory_usage(const struct sol_buddy_grid* grid)
+{
+	uint32_t x_size_class, y_size_class;
+	size_t usage;
+
+	usage = sizeof(struct sol_buddy_grid);
+	usage += sizeof(struct sol_buddy_grid_entry) * grid->entry_array.space;
+	usage += sizeof(uint32_t) * grid->entry_array.available_indices.space;
+
+	for(x_size_class = 0; x_size_class < SOL_BUDDY_GRID_SIZE_CLASS_COUNT; x_size_class++)
+	{
+		for(y_size_class = 0; y_size_class < SOL_BUDDY_GRID_SIZE_CLASS_COUNT; y_size_class++)
+		{
+			usage += sizeof(uint32_t) * grid->availablity_heaps[x_size_class][y_size_class].space;
+		}
+	}
+
+	return usage;
+}
+
+u16_vec2 sol_buddy_grid_get_size(struct sol_buddy_grid* grid, uint32_t index)
+{
+	struct sol_buddy_grid_entry* entry = sol_buddy_grid_entry_array_access_entry(&grid->entry_array, index);
+
+	assert( ! entry->is_available);
+
+	return u16_vec2_set(1u << entry->x_size_class, 1u << entry->y_size_class);
+}
+
+uint32_t sol_buddy_grid_plan_relocations(struct sol_buddy_grid* grid, struct sol_buddy_grid_relocation* relocations, uint32_t candidate_count, uint32_t area_budget)
+{
+	const struct sol_buddy_grid_entry* entry;
+	uint32_t candidate, relocation_count, x_size_class, y_size_class, source_packed_location, destination_index, area;
+	/** array index is x, bit index is y; size classes for which no better location can be found */
+	uint16_t exhausted_masks[SOL_BUDDY_GRID_SIZE_CLASS_COUNT] = {0};
+
+	sol_buddy_grid_relocation_sort(relocations, candidate_count, grid);
+
+	relocation_count = 0;
+
+	for(candidate = 0; candidate < candidate_count; candidate++)
+	{
+		entry = sol_buddy_grid_entry_array_access_entry(&grid->entry_array, relocations[candidate].source_index);
+		assert( ! entry->is_available);
+
+		x_size_class = entry->x_size_class;
+		y_size_class = entry->y_size_class;
+		source_packed_location = entry->packed_location;
+		area = 1u << (x_size_class + y_size_class);
+
+		if(area > area_budget || (exhausted_masks[x_size_class] & (1u << y_size_class)))
+		{
+			continue;
+		}
+
+		/** NOTE: this may relocate entries in memory */
+		if( ! sol_buddy_grid_acquire_available_entry_of_size(grid, x_size_class, y_size_class, &destination_index))
+		{
+			exhausted_masks[x_size_class] |= 1u << y_size_class;
+			continue;
+		}
+
+		if(sol_buddy_grid_entry_array_access_entry(&grid->entry_array, destination_index)->packed_location > source_packed_location)
+		{
+			/** acquisition is deterministic and releasing restores the grid to its prior state, so the same (worse) location would be found for any remaining candidate of this size
+			 * which, being sorted, are all better placed than this one */
+			sol_buddy_grid_entry_make_available(grid, destination_index);
+			exhausted_masks[x_size_class] |= 1u << y_size_class;
+			continue;
+		}
+
+		relocations[candidate].destination_index = destination_index;
+		SOL_SWAP(relocations[candidate], relocations[relocation_count]);
+		relocation_count++;
+		area_budget -= area;
+	}
+
+	return relocation_count;
+}
@@ -17,8 +17,12 @@ You should have received a copy of the GNU Affero General Public License
 along with solipsix.  If not, see <https://www.gnu.org/licenses/>.
 */
 
+#pragma once
+
 /** note derived/extracted from image atlas algorithm */
 #include <inttypes.h>
+#include <stddef.h>
+#include <stdbool.h>
 #include "math/u16_vec2.h"
 
 struct sol_buddy_grid_location
@@ -50,6 +54,29 @@ struct sol_buddy_grid_location sol_buddy_grid_get_location(struct sol_buddy_grid
 
 bool sol_buddy_grid_has_space(struct sol_buddy_grid* grid, u16_vec2 size);
 
+/** bytes of memory allocated by the grid (for comparison between implementations) */
+size_t sol_buddy_grid_memory_usage(const struct sol_buddy_grid* grid);
+
+/** size of the acquired region in grid units, always a power of 2 in each dimension (may be larger than the size requested) */
+u16_vec2 sol_buddy_grid_get_size(struct sol_buddy_grid* grid, uint32_t index);
+
+
+/** defragmentation: an acquired index (source) that has been given a better placed region (destination) */
+struct sol_buddy_grid_relocation
+{
+	uint32_t source_index;
+	uint32_t destination_index;
+	/** not used by the buddy grid, for identifying the owner of the source */
+	uint32_t reference;
+};
+
+/** plan moves for the acquired indices provided in `relocations[].source_index` to regions closer to the start of the grid,
+ * the worst placed candidates (furthest from the start) are moved first, until moving another would exceed `area_budget` (in grid units)
+ * relocations is reordered such that the first N (returned) entries are the planned moves, with `destination_index` acquired
+ * the sources remain acquired (so no destination can overlap a source) and must be released once their contents have been moved
+ * NOTE: this only interacts with the grid through acquire/release and so can be tested/run without any image */
+uint32_t sol_buddy_grid_plan_relocations(struct sol_buddy_grid* grid, struct sol_buddy_grid_relocation* relocations, uint32_t candidate_count, uint32_t area_budget);
+
 
 
 
@@ -69,6 +96,9 @@ struct sol_buddy_grid_location sol_buddy_grid_2_get_location(struct sol_buddy_gr
 
 bool sol_buddy_grid_2_has_space(struct sol_buddy_grid_2* grid, u16_vec2 size);
 
+/** bytes of memory allocated by the grid (for comparison between implementations) */
+size_t sol_buddy_grid_2_memory_usage(const struct sol_buddy_grid_2* grid);
+
 
 
 /** TODO: look into permitting allocating with some kind of bias towards the end, preferable for very short lived allocations to be separated from long lived ones */
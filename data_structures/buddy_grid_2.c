@@ -29,8 +29,11 @@ along with solipsix.  If not, see <https://www.gnu.org/licenses/>.
 /** maximum xy dimension classes; the maximum number of sizes a tile can be (0-12 inclusive) */
 #define SOL_BUDDY_GRID_SIZE_CLASS_COUNT 13
 
+/** either may be defined when compiling to select how available entries are stored (e.g. to compare them with buddy_grid_trace), defaults to the tree */
 // #define USE_LINKED_LIST
+#if !defined(USE_LINKED_LIST) && !defined(USE_RB_TREE)
 #define USE_RB_TREE
+#endif
 
 struct sol_buddy_grid_entry
 {
@@ -635,8 +638,8 @@ static inline void sol_buddy_grid_withdraw_available(struct sol_buddy_grid_2* gr
 	}
 
 	assert(*traversal_references[depth] == entry_index);
+	/** note: rebalancing may rewrite `traversal_references` at and below depth, so they cannot be checked after this */
 	sol_buddy_grid_withdraw(grid, traversal_references, ~(uint64_t)0, depth);
-	assert(*traversal_references[depth] == entry->right_child);
 	if(*traversal_references[0] == 0)
 	{
 		grid->availability_masks[x_size_class] &= ~((uint16_t)1 << y_size_class);
@@ -1030,3 +1033,14 @@ bool sol_buddy_grid_2_has_space(struct sol_buddy_grid_2* grid, u16_vec2 size)
 
 	return false;
 }
+
+size_t sol_buddy_grid_2_memory_usage(const struct sol_buddy_grid_2* grid)
+{
+	size_t usage;
+
+	usage = sizeof(struct sol_buddy_grid_2);
+	usage += sizeof(struct sol_buddy_grid_entry) * grid->entry_array.space;
+	usage += sizeof(uint32_t) * grid->entry_array.available_indices.space;
+
+	return usage;
+}
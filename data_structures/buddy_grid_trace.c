@@ -0,0 +1,568 @@
+/**
+Copyright 2026 Carl van Mastrigt
+
+This file is part of solipsix.
+
+solipsix is free software: you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+solipsix is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with solipsix.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+
+#include "sol_utils.h"
+
+#include "data_structures/buddy_grid_trace.h"
+
+#define SOL_BUDDY_GRID_TRACE_VERSION 1
+
+#define SOL_BUDDY_GRID_TRACE_RECORD_ACQUIRE        0
+#define SOL_BUDDY_GRID_TRACE_RECORD_FAILED_ACQUIRE 1
+#define SOL_BUDDY_GRID_TRACE_RECORD_RELEASE        2
+
+#define SOL_BUDDY_GRID_TRACE_HEADER_SIZE 8
+#define SOL_BUDDY_GRID_TRACE_RECORD_SIZE 5
+
+/** both grid implementations support 13 size classes (SOL_BUDDY_GRID_SIZE_CLASS_COUNT), so 2^12 in each dimension */
+#define SOL_BUDDY_GRID_TRACE_DIMENSION_EXPONENT_LIMIT 12
+
+
+
+static inline uint8_t* sol_buddy_grid_trace_append_record(struct sol_buddy_grid_trace* trace)
+{
+	uint8_t* record;
+
+	if(trace->record_bytes + SOL_BUDDY_GRID_TRACE_RECORD_SIZE > trace->record_space)
+	{
+		trace->record_space = trace->record_space ? trace->record_space * 2 : 4096;
+		trace->records = realloc(trace->records, trace->record_space);
+	}
+
+	record = trace->records + trace->record_bytes;
+	trace->record_bytes += SOL_BUDDY_GRID_TRACE_RECORD_SIZE;
+
+	return record;
+}
+
+static inline void sol_buddy_grid_trace_append_acquire(struct sol_buddy_grid_trace* trace, u16_vec2 size, bool acquired)
+{
+	uint8_t* record = sol_buddy_grid_trace_append_record(trace);
+
+	record[0] = acquired ? SOL_BUDDY_GRID_TRACE_RECORD_ACQUIRE : SOL_BUDDY_GRID_TRACE_RECORD_FAILED_ACQUIRE;
+	record[1] = size.x & 0xFF;
+	record[2] = size.x >> 8;
+	record[3] = size.y & 0xFF;
+	record[4] = size.y >> 8;
+
+	trace->acquire_count++;
+}
+
+static inline void sol_buddy_grid_trace_append_release(struct sol_buddy_grid_trace* trace, uint32_t acquire_number)
+{
+	uint8_t* record = sol_buddy_grid_trace_append_record(trace);
+
+	assert(acquire_number < trace->acquire_count);
+
+	record[0] = SOL_BUDDY_GRID_TRACE_RECORD_RELEASE;
+	record[1] = acquire_number & 0xFF;
+	record[2] = (acquire_number >> 8) & 0xFF;
+	record[3] = (acquire_number >> 16) & 0xFF;
+	record[4] = acquire_number >> 24;
+}
+
+static inline u16_vec2 sol_buddy_grid_trace_record_get_size(const uint8_t* record)
+{
+	return u16_vec2_set((uint16_t)record[1] | ((uint16_t)record[2] << 8), (uint16_t)record[3] | ((uint16_t)record[4] << 8));
+}
+
+static inline uint32_t sol_buddy_grid_trace_record_get_acquire_number(const uint8_t* record)
+{
+	return (uint32_t)record[1] | ((uint32_t)record[2] << 8) | ((uint32_t)record[3] << 16) | ((uint32_t)record[4] << 24);
+}
+
+void sol_buddy_grid_trace_initialise(struct sol_buddy_grid_trace* trace, struct sol_buddy_grid_description description)
+{
+	trace->description = description;
+	trace->records = NULL;
+	trace->record_bytes = 0;
+	trace->record_space = 0;
+	trace->acquire_count = 0;
+	trace->index_acquires = NULL;
+	trace->index_space = 0;
+}
+
+void sol_buddy_grid_trace_terminate(struct sol_buddy_grid_trace* trace)
+{
+	free(trace->records);
+	free(trace->index_acquires);
+}
+
+void sol_buddy_grid_trace_record_acquire(struct sol_buddy_grid_trace* trace, u16_vec2 size, bool acquired, uint32_t index)
+{
+	if(acquired)
+	{
+		if(index >= trace->index_space)
+		{
+			trace->index_space = SOL_MAX(trace->index_space * 2, index + 1);
+			trace->index_acquires = realloc(trace->index_acquires, sizeof(uint32_t) * trace->index_space);
+		}
+		trace->index_acquires[index] = trace->acquire_count;
+	}
+
+	sol_buddy_grid_trace_append_acquire(trace, size, acquired);
+}
+
+void sol_buddy_grid_trace_record_release(struct sol_buddy_grid_trace* trace, uint32_t index)
+{
+	assert(index < trace->index_space);
+	sol_buddy_grid_trace_append_release(trace, trace->index_acquires[index]);
+}
+
+bool sol_buddy_grid_trace_save(const struct sol_buddy_grid_trace* trace, FILE* file)
+{
+	const uint8_t header[SOL_BUDDY_GRID_TRACE_HEADER_SIZE] =
+	{
+		'S', 'B', 'G', 'T',
+		SOL_BUDDY_GRID_TRACE_VERSION,
+		trace->description.image_x_dimension_exponent,
+		trace->description.image_y_dimension_exponent,
+		trace->description.image_array_dimension,
+	};
+
+	if(fwrite(header, 1, SOL_BUDDY_GRID_TRACE_HEADER_SIZE, file) != SOL_BUDDY_GRID_TRACE_HEADER_SIZE)
+	{
+		return false;
+	}
+
+	return fwrite(trace->records, 1, trace->record_bytes, file) == trace->record_bytes;
+}
+
+bool sol_buddy_grid_trace_load(struct sol_buddy_grid_trace* trace, FILE* file)
+{
+	uint8_t header[SOL_BUDDY_GRID_TRACE_HEADER_SIZE];
+	uint8_t* record;
+	/** per acquire number: whether it is still live (acquired and not yet released) */
+	bool* live_acquires;
+	size_t read_bytes, offset;
+	uint32_t acquire_number, acquire_count;
+	bool valid;
+
+	sol_buddy_grid_trace_initialise(trace, (struct sol_buddy_grid_description){0});
+
+	if(fread(header, 1, SOL_BUDDY_GRID_TRACE_HEADER_SIZE, file) != SOL_BUDDY_GRID_TRACE_HEADER_SIZE || memcmp(header, "SBGT", 4) || header[4] != SOL_BUDDY_GRID_TRACE_VERSION)
+	{
+		return false;
+	}
+
+	/** must be a description the grids can be created with */
+	if(header[5] > SOL_BUDDY_GRID_TRACE_DIMENSION_EXPONENT_LIMIT || header[6] > SOL_BUDDY_GRID_TRACE_DIMENSION_EXPONENT_LIMIT || header[7] == 0)
+	{
+		return false;
+	}
+
+	trace->description = (struct sol_buddy_grid_description)
+	{
+		.image_x_dimension_exponent = header[5],
+		.image_y_dimension_exponent = header[6],
+		.image_array_dimension = header[7],
+	};
+
+	do
+	{
+		record = sol_buddy_grid_trace_append_record(trace);
+		read_bytes = fread(record, 1, SOL_BUDDY_GRID_TRACE_RECORD_SIZE, file);
+	}
+	while(read_bytes == SOL_BUDDY_GRID_TRACE_RECORD_SIZE);
+
+	trace->record_bytes -= SOL_BUDDY_GRID_TRACE_RECORD_SIZE;
+
+	if(read_bytes != 0 || ferror(file))
+	{
+		/** truncated record */
+		return false;
+	}
+
+	/** validate record types and count acquires */
+	for(offset = 0; offset < trace->record_bytes; offset += SOL_BUDDY_GRID_TRACE_RECORD_SIZE)
+	{
+		switch(trace->records[offset])
+		{
+		case SOL_BUDDY_GRID_TRACE_RECORD_ACQUIRE:
+		case SOL_BUDDY_GRID_TRACE_RECORD_FAILED_ACQUIRE:
+			if(trace->acquire_count == UINT32_MAX)
+			{
+				return false;
+			}
+			trace->acquire_count++;
+			break;
+		case SOL_BUDDY_GRID_TRACE_RECORD_RELEASE:
+			break;
+		default:
+			return false;
+		}
+	}
+
+	/** every release must refer to an earlier successful acquire that hasn't already been released,
+	 * replay relies on this to only ever look up the indices of acquires it has already performed */
+	live_acquires = malloc(sizeof(bool) * SOL_MAX(trace->acquire_count, 1u));
+	acquire_count = 0;
+	valid = true;
+
+	for(offset = 0; valid && offset < trace->record_bytes; offset += SOL_BUDDY_GRID_TRACE_RECORD_SIZE)
+	{
+		record = trace->records + offset;
+		switch(record[0])
+		{
+		case SOL_BUDDY_GRID_TRACE_RECORD_ACQUIRE:
+			live_acquires[acquire_count++] = true;
+			break;
+		case SOL_BUDDY_GRID_TRACE_RECORD_FAILED_ACQUIRE:
+			live_acquires[acquire_count++] = false;
+			break;
+		case SOL_BUDDY_GRID_TRACE_RECORD_RELEASE:
+			acquire_number = sol_buddy_grid_trace_record_get_acquire_number(record);
+			valid = acquire_number < acquire_count && live_acquires[acquire_number];
+			if(valid)
+			{
+				live_acquires[acquire_number] = false;
+			}
+			break;
+		}
+	}
+
+	free(live_acquires);
+
+	return valid;
+}
+
+
+
+static inline uint64_t sol_buddy_grid_trace_random(uint64_t* state)
+{
+	/** xorshift64* */
+	*state ^= *state >> 12;
+	*state ^= *state << 25;
+	*state ^= *state >> 27;
+	return *state * 0x2545F4914F6CDD1Dllu;
+}
+
+static inline u16_vec2 sol_buddy_grid_trace_random_size(enum sol_buddy_grid_trace_distribution distribution, uint64_t* state)
+{
+	const uint64_t r = sol_buddy_grid_trace_random(state);
+	uint16_t side;
+
+	switch(distribution)
+	{
+	case SOL_BUDDY_GRID_TRACE_DISTRIBUTION_GLYPH:
+		/** mostly 1-3 wide and 2-5 tall, with an occasional large glyph */
+		if((r & 15) == 0)
+		{
+			return u16_vec2_set(3 + (r >> 8) % 4, 5 + (r >> 16) % 4);
+		}
+		return u16_vec2_set(1 + (r >> 8) % 3, 2 + (r >> 16) % 4);
+
+	case SOL_BUDDY_GRID_TRACE_DISTRIBUTION_ICON:
+		/** square power of two sizes biased towards the small end, with an occasional wide panel */
+		if((r & 31) == 0)
+		{
+			return u16_vec2_set(32, 16);
+		}
+		side = (uint16_t)2 << ((r >> 8) % 8 < 4 ? 0 : (r >> 8) % 8 < 7 ? 1 : 2);
+		return u16_vec2_set(side, side);
+	}
+
+	assert(false);
+	return u16_vec2_set(1, 1);
+}
+
+void sol_buddy_grid_trace_generate(struct sol_buddy_grid_trace* trace, struct sol_buddy_grid_description description, enum sol_buddy_grid_trace_distribution distribution, uint32_t operation_count, uint32_t fill_factor, uint64_t seed)
+{
+	/** live allocations in (roughly) the order they were acquired: acquire number and area */
+	uint32_t* live_acquires;
+	uint64_t* live_areas;
+	uint32_t live_start, live_count, live_space, operation, selected;
+	uint64_t live_area, target_area, state, r;
+	u16_vec2 size;
+
+	sol_buddy_grid_trace_initialise(trace, description);
+
+	state = seed ? seed : 0x9E3779B97F4A7C15llu;
+	target_area = ((uint64_t)description.image_array_dimension << (description.image_x_dimension_exponent + description.image_y_dimension_exponent)) * fill_factor / 256;
+	live_area = 0;
+
+	/** a ring buffer of live allocations, at most one allocation per operation can be live */
+	live_space = operation_count + 1;
+	live_acquires = malloc(sizeof(uint32_t) * live_space);
+	live_areas = malloc(sizeof(uint64_t) * live_space);
+	live_start = 0;
+	live_count = 0;
+
+	for(operation = 0; operation < operation_count; operation++)
+	{
+		r = sol_buddy_grid_trace_random(&state);
+
+		if(live_count && (live_area > target_area || (r & 7) == 0))
+		{
+			/** glyphs are mostly evicted oldest first, icons are released in a more random order */
+			selected = live_start;
+			if(distribution == SOL_BUDDY_GRID_TRACE_DISTRIBUTION_ICON || ((r >> 3) & 7) == 0)
+			{
+				selected = (live_start + (uint32_t)((r >> 8) % live_count)) % live_space;
+				SOL_SWAP(live_acquires[selected], live_acquires[live_start]);
+				SOL_SWAP(live_areas[selected], live_areas[live_start]);
+			}
+
+			sol_buddy_grid_trace_append_release(trace, live_acquires[live_start]);
+			live_area -= live_areas[live_start];
+			live_start = (live_start + 1) % live_space;
+			live_count--;
+		}
+		else
+		{
+			size = sol_buddy_grid_trace_random_size(distribution, &state);
+
+			selected = (live_start + live_count) % live_space;
+			live_acquires[selected] = trace->acquire_count;
+			live_areas[selected] = (uint64_t)1 << (sol_u32_exp_ge(size.x) + sol_u32_exp_ge(size.y));
+			live_area += live_areas[selected];
+			live_count++;
+
+			sol_buddy_grid_trace_append_acquire(trace, size, true);
+		}
+	}
+
+	free(live_acquires);
+	free(live_areas);
+}
+
+
+
+/** returns nanoseconds spent replaying, only meaningful when not sampling (sample_interval of zero) */
+static uint64_t sol_buddy_grid_trace_run(const struct sol_buddy_grid_trace* trace, const struct sol_buddy_grid_trace_allocator* allocator, uint32_t sample_interval, struct sol_buddy_grid_trace_statistics* statistics)
+{
+	struct timespec start_time, end_time;
+	const uint8_t* record;
+	void* grid;
+	uint32_t* acquired_indices;
+	uint64_t* acquired_areas;
+	uint32_t acquire_number, released_number, index, operation, x, y, sample_count;
+	uint64_t live_area, free_area, largest_area, total_area;
+	double fragmentation, fragmentation_sum;
+	size_t offset, memory_usage;
+	u16_vec2 size;
+	bool acquired;
+
+	const uint32_t max_x = trace->description.image_x_dimension_exponent;
+	const uint32_t max_y = trace->description.image_y_dimension_exponent;
+
+	total_area = (uint64_t)trace->description.image_array_dimension << (max_x + max_y);
+	live_area = 0;
+	sample_count = 0;
+	fragmentation_sum = 0.0;
+
+	acquired_indices = malloc(sizeof(uint32_t) * SOL_MAX(trace->acquire_count, 1u));
+	acquired_areas = malloc(sizeof(uint64_t) * SOL_MAX(trace->acquire_count, 1u));
+
+	grid = allocator->create(trace->description);
+
+	acquire_number = 0;
+	operation = 0;
+
+	clock_gettime(CLOCK_MONOTONIC, &start_time);
+
+	for(offset = 0; offset < trace->record_bytes; offset += SOL_BUDDY_GRID_TRACE_RECORD_SIZE)
+	{
+		record = trace->records + offset;
+
+		if(record[0] == SOL_BUDDY_GRID_TRACE_RECORD_RELEASE)
+		{
+			released_number = sol_buddy_grid_trace_record_get_acquire_number(record);
+			/** guaranteed by recording/generation and checked when loading */
+			assert(released_number < acquire_number);
+			index = acquired_indices[released_number];
+			if(index != SOL_U32_INVALID)
+			{
+				allocator->release(grid, index);
+				live_area -= acquired_areas[released_number];
+				acquired_indices[released_number] = SOL_U32_INVALID;
+			}
+			statistics->release_count++;
+		}
+		else
+		{
+			size = sol_buddy_grid_trace_record_get_size(record);
+			acquired = allocator->acquire(grid, size, &index);
+
+			statistics->acquire_count++;
+			acquired_areas[acquire_number] = (uint64_t)1 << (sol_u32_exp_ge(size.x) + sol_u32_exp_ge(size.y));
+
+			if(!acquired)
+			{
+				statistics->failed_acquire_count++;
+				index = SOL_U32_INVALID;
+			}
+			else if(record[0] == SOL_BUDDY_GRID_TRACE_RECORD_FAILED_ACQUIRE)
+			{
+				/** there will be no release for this in the trace */
+				allocator->release(grid, index);
+				index = SOL_U32_INVALID;
+			}
+			else
+			{
+				live_area += acquired_areas[acquire_number];
+			}
+			acquired_indices[acquire_number++] = index;
+		}
+
+		if(sample_interval && ++operation % sample_interval == 0)
+		{
+			/** largest acquirable area: for each width find the tallest acquirable height */
+			largest_area = 0;
+			for(x = 0; x <= max_x; x++)
+			{
+				for(y = max_y + 1; y-- > 0;)
+				{
+					if(allocator->has_space(grid, u16_vec2_set(1u << x, 1u << y)))
+					{
+						largest_area = SOL_MAX(largest_area, (uint64_t)1 << (x + y));
+						break;
+					}
+				}
+			}
+
+			free_area = total_area - live_area;
+			fragmentation = free_area ? 1.0 - (double)largest_area / (double)free_area : 0.0;
+
+			statistics->peak_fragmentation = SOL_MAX(statistics->peak_fragmentation, fragmentation);
+			fragmentation_sum += fragmentation;
+			sample_count++;
+
+			memory_usage = allocator->memory_usage(grid);
+			statistics->peak_memory_usage = SOL_MAX(statistics->peak_memory_usage, memory_usage);
+		}
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &end_time);
+
+	if(sample_count)
+	{
+		statistics->mean_fragmentation = fragmentation_sum / (double)sample_count;
+	}
+
+	/** the grid requires everything be released before it is destroyed */
+	for(acquire_number = 0; acquire_number < trace->acquire_count; acquire_number++)
+	{
+		if(acquired_indices[acquire_number] != SOL_U32_INVALID)
+		{
+			allocator->release(grid, acquired_indices[acquire_number]);
+		}
+	}
+
+	free(acquired_indices);
+	free(acquired_areas);
+
+	allocator->destroy(grid);
+
+	return (uint64_t)(end_time.tv_sec - start_time.tv_sec) * 1000000000llu + (uint64_t)end_time.tv_nsec - (uint64_t)start_time.tv_nsec;
+}
+
+void sol_buddy_grid_trace_replay(const struct sol_buddy_grid_trace* trace, const struct sol_buddy_grid_trace_allocator* allocator, uint32_t sample_interval, struct sol_buddy_grid_trace_statistics* statistics)
+{
+	struct sol_buddy_grid_trace_statistics timing_statistics = {0};
+	uint64_t elapsed;
+
+	*statistics = (struct sol_buddy_grid_trace_statistics){0};
+
+	elapsed = sol_buddy_grid_trace_run(trace, allocator, 0, &timing_statistics);
+	sol_buddy_grid_trace_run(trace, allocator, SOL_MAX(sample_interval, 1u), statistics);
+
+	statistics->nanoseconds_per_operation = (double)elapsed / (double)SOL_MAX(timing_statistics.acquire_count + timing_statistics.release_count, 1llu);
+}
+
+
+
+static void* sol_buddy_grid_trace_buddy_grid_create(struct sol_buddy_grid_description description)
+{
+	return sol_buddy_grid_create(description);
+}
+static void sol_buddy_grid_trace_buddy_grid_destroy(void* grid)
+{
+	sol_buddy_grid_destroy(grid);
+}
+static bool sol_buddy_grid_trace_buddy_grid_acquire(void* grid, u16_vec2 size, uint32_t* index)
+{
+	return sol_buddy_grid_acquire(grid, size, index);
+}
+static void sol_buddy_grid_trace_buddy_grid_release(void* grid, uint32_t index)
+{
+	sol_buddy_grid_release(grid, index);
+}
+static bool sol_buddy_grid_trace_buddy_grid_has_space(void* grid, u16_vec2 size)
+{
+	return sol_buddy_grid_has_space(grid, size);
+}
+static size_t sol_buddy_grid_trace_buddy_grid_memory_usage(const void* grid)
+{
+	return sol_buddy_grid_memory_usage(grid);
+}
+
+const struct sol_buddy_grid_trace_allocator sol_buddy_grid_trace_allocator_buddy_grid =
+{
+	.name = "sol_buddy_grid",
+	.create = sol_buddy_grid_trace_buddy_grid_create,
+	.destroy = sol_buddy_grid_trace_buddy_grid_destroy,
+	.acquire = sol_buddy_grid_trace_buddy_grid_acquire,
+	.release = sol_buddy_grid_trace_buddy_grid_release,
+	.has_space = sol_buddy_grid_trace_buddy_grid_has_space,
+	.memory_usage = sol_buddy_grid_trace_buddy_grid_memory_usage,
+};
+
+
+
+static void* sol_buddy_grid_trace_buddy_grid_2_create(struct sol_buddy_grid_description description)
+{
+	return sol_buddy_grid_2_create(description);
+}
+static void sol_buddy_grid_trace_buddy_grid_2_destroy(void* grid)
+{
+	sol_buddy_grid_2_destroy(grid);
+}
+static bool sol_buddy_grid_trace_buddy_grid_2_acquire(void* grid, u16_vec2 size, uint32_t* index)
+{
+	return sol_buddy_grid_2_acquire(grid, size, index);
+}
+static void sol_buddy_grid_trace_buddy_grid_2_release(void* grid, uint32_t index)
+{
+	sol_buddy_grid_2_release(grid, index);
+}
+static bool sol_buddy_grid_trace_buddy_grid_2_has_space(void* grid, u16_vec2 size)
+{
+	return sol_buddy_grid_2_has_space(grid, size);
+}
+static size_t sol_buddy_grid_trace_buddy_grid_2_memory_usage(const void* grid)
+{
+	return sol_buddy_grid_2_memory_usage(grid);
+}
+
+const struct sol_buddy_grid_trace_allocator sol_buddy_grid_trace_allocator_buddy_grid_2 =
+{
+	.name = "sol_buddy_grid_2",
+	.create = sol_buddy_grid_trace_buddy_grid_2_create,
+	.destroy = sol_buddy_grid_trace_buddy_grid_2_destroy,
+	.acquire = sol_buddy_grid_trace_buddy_grid_2_acquire,
+	.release = sol_buddy_grid_trace_buddy_grid_2_release,
+	.has_space = sol_buddy_grid_trace_buddy_grid_2_has_space,
+	.memory_usage = sol_buddy_grid_trace_buddy_grid_2_memory_usage,
+};
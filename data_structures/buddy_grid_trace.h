@@ -0,0 +1,113 @@
+/**
+Copyright 2026 Carl van Mastrigt
+
+This file is part of solipsix.
+
+solipsix is free software: you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+solipsix is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with solipsix.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "data_structures/buddy_grid.h"
+
+/** a trace is a sequence of acquire/release operations on a buddy grid, independent of which implementation (or image) they were performed on
+ * traces can be recorded from real use (e.g. the image atlas), generated from synthetic size distributions, saved/loaded, and replayed against any implementation
+ * this needs nothing but the CPU, so allows comparing the buddy grid implementations on real workloads (see benchmarks/buddy_grid_trace_replay.c)
+ *
+ * file format (all values little endian):
+ *     header: "SBGT" | u8 version | u8 image_x_dimension_exponent | u8 image_y_dimension_exponent | u8 image_array_dimension
+ *     records:
+ *         acquire:        u8 0 | u16 x size | u16 y size
+ *         failed acquire: u8 1 | u16 x size | u16 y size   (failed when recorded, if it succeeds on replay it is released immediately)
+ *         release:        u8 2 | u32 acquire number          (acquires, failed or not, are numbered from zero in order) */
+
+struct sol_buddy_grid_trace
+{
+	struct sol_buddy_grid_description description;
+
+	uint8_t* records;
+	size_t record_bytes;
+	size_t record_space;
+
+	/** number of acquire records (failed or not) */
+	uint32_t acquire_count;
+
+	/** only used while recording, grid index -> acquire number of the allocation currently using that index */
+	uint32_t* index_acquires;
+	uint32_t index_space;
+};
+
+void sol_buddy_grid_trace_initialise(struct sol_buddy_grid_trace* trace, struct sol_buddy_grid_description description);
+void sol_buddy_grid_trace_terminate(struct sol_buddy_grid_trace* trace);
+
+/** record the result of acquiring `size` from a grid, index is ignored if not acquired */
+void sol_buddy_grid_trace_record_acquire(struct sol_buddy_grid_trace* trace, u16_vec2 size, bool acquired, uint32_t index);
+void sol_buddy_grid_trace_record_release(struct sol_buddy_grid_trace* trace, uint32_t index);
+
+bool sol_buddy_grid_trace_save(const struct sol_buddy_grid_trace* trace, FILE* file);
+/** initialises the trace, which must be terminated even on failure
+ * fails on malformed traces: a description the grids can't be created with, unknown records, or a release that doesn't match an earlier (successful, unreleased) acquire */
+bool sol_buddy_grid_trace_load(struct sol_buddy_grid_trace* trace, FILE* file);
+
+
+enum sol_buddy_grid_trace_distribution
+{
+	/** small, mostly taller than wide, very many of them, evicted in roughly least recently used order */
+	SOL_BUDDY_GRID_TRACE_DISTRIBUTION_GLYPH,
+	/** a few power of two square sizes with occasional large entries, longer lived */
+	SOL_BUDDY_GRID_TRACE_DISTRIBUTION_ICON,
+};
+
+/** initialises the trace with `operation_count` synthetic operations, keeping the (power of 2 rounded) live area around `fill_factor` (out of 256) of the grid */
+void sol_buddy_grid_trace_generate(struct sol_buddy_grid_trace* trace, struct sol_buddy_grid_description description, enum sol_buddy_grid_trace_distribution distribution, uint32_t operation_count, uint32_t fill_factor, uint64_t seed);
+
+
+/** allows replaying a trace against any buddy grid implementation */
+struct sol_buddy_grid_trace_allocator
+{
+	const char* name;
+	void* (*create)(struct sol_buddy_grid_description description);
+	void (*destroy)(void* grid);
+	bool (*acquire)(void* grid, u16_vec2 size, uint32_t* index);
+	void (*release)(void* grid, uint32_t index);
+	bool (*has_space)(void* grid, u16_vec2 size);
+	size_t (*memory_usage)(const void* grid);
+};
+
+extern const struct sol_buddy_grid_trace_allocator sol_buddy_grid_trace_allocator_buddy_grid;
+extern const struct sol_buddy_grid_trace_allocator sol_buddy_grid_trace_allocator_buddy_grid_2;
+
+struct sol_buddy_grid_trace_statistics
+{
+	uint64_t acquire_count;
+	uint64_t failed_acquire_count;
+	uint64_t release_count;
+
+	/** time spent in acquire and release, measured in a separate replay without any sampling */
+	double nanoseconds_per_operation;
+
+	/** fragmentation is 1 - (largest acquirable area / free area), sampled periodically */
+	double peak_fragmentation;
+	double mean_fragmentation;
+
+	size_t peak_memory_usage;
+};
+
+/** replays the trace twice; once timed, once to gather the remaining statistics (sampling every `sample_interval` operations) */
+void sol_buddy_grid_trace_replay(const struct sol_buddy_grid_trace* trace, const struct sol_buddy_grid_trace_allocator* allocator, uint32_t sample_interval, struct sol_buddy_grid_trace_statistics* statistics);
@@ -179,6 +179,12 @@ bool sol_buddy_tree_acquire(struct sol_buddy_tree* tree, uint32_t desired_size_e
 	/** this stores the size class/exponent for a given allocation at the maximum layer (one for highest granularity allocations)
 		importantly: when there is information regarding allocation availibility that will actually be read overlapping this write the values will always match (0) */
 	tree->availablity_masks[offset] = desired_size_exponent;
+	/** the next entry in the maximum layer is also inside the allocation (when it is larger than one unit) so stores the allocations exact size
+	 * this is what allows allocations that aren't a power of 2 to be released (see `sol_buddy_tree_acquire_exact`) */
+	if(desired_size_exponent)
+	{
+		tree->availablity_masks[offset + 1] = desired_size_bit;
+	}
 	/** need to remove top bit (relative max exponent) from the offset to get allocation offset in terms of minimum allocation size, and it MUST be present */
 	assert(offset & tree->encompasing_bit);
 
@@ -192,27 +198,10 @@ bool sol_buddy_tree_acquire(struct sol_buddy_tree* tree, uint32_t desired_size_e
 	return true;
 }
 
-void sol_buddy_tree_release(struct sol_buddy_tree* tree, uint32_t offset)
+/** offset is the index of the (entirely allocated) node in the tree, at the level of the tree for the size class `exponent` */
+static inline void sol_buddy_tree_release_node__i(struct sol_buddy_tree* tree, uint32_t offset, uint32_t exponent)
 {
-	uint32_t exponent, released_size_bit, delta_size_bits;
-
-	/** check allocation offset is a valid value for this allocator */
-	assert(offset < tree->size);
-
-	/** check offset isn't too big */
-	assert(offset < tree->encompasing_bit);
-
-	/** indices in tree have (relative) high bit set */
-	offset |= tree->encompasing_bit;
-
-	/** allocate stores size class in last layer for any given offset */
-	exponent = tree->availablity_masks[offset];
-
-	/** ensure the alignment of the allocation offset is correct given the expected (stored) size class */
-	assert((offset & (((size_t)1 << exponent) - 1)) == 0);
-	/** move to the size appropriate level of the tree (i.e. where the allocation mist have been made from) */
-	offset >>= exponent;
-
+	uint32_t released_size_bit, delta_size_bits;
 
 	released_size_bit = 1u << exponent;
 
@@ -259,6 +248,110 @@ void sol_buddy_tree_release(struct sol_buddy_tree* tree, uint32_t offset)
 	assert(tree->availablity_masks[0] == ~0u);
 }
 
+bool sol_buddy_tree_acquire_exact(struct sol_buddy_tree* tree, uint32_t desired_size, uint32_t* allocation_offset)
+{
+	uint32_t exponent, offset, current_size_bit, remaining_size;
+
+	assert(desired_size > 0);
+
+	exponent = sol_u32_exp_ge(desired_size);
+
+	if( ! sol_buddy_tree_acquire(tree, exponent, allocation_offset))
+	{
+		return false;
+	}
+
+	current_size_bit = 1u << exponent;
+
+	if(desired_size == current_size_bit)
+	{
+		return true;
+	}
+
+	/** the allocation is placed at the start of the power of 2 sized node that was acquired, the slack after it is made available
+	 * this is effectively the same as how `sol_buddy_tree_initialise` handles non power of 2 sizes:
+	 * walk down the node, every time the remaining size fits in the left child the right child is slack, otherwise the left child is entirely used
+	 * the used nodes are the set bits of desired size, in decreasing size order (this is relied upon when releasing) */
+	offset = (*allocation_offset | tree->encompasing_bit) >> exponent;
+	remaining_size = desired_size;
+
+	while(remaining_size != current_size_bit)
+	{
+		current_size_bit >>= 1;
+		offset <<= 1;
+
+		if(remaining_size > current_size_bit)
+		{
+			tree->availablity_masks[offset] = 0;
+			remaining_size -= current_size_bit;
+			offset++;
+		}
+		else
+		{
+			tree->availablity_masks[offset + 1] = current_size_bit;
+		}
+	}
+
+	/** last used node */
+	tree->availablity_masks[offset] = 0;
+
+	/** every node on the path (both within the acquired node and above it) is split, so has exactly the sizes available in its children */
+	while(offset > 1)
+	{
+		offset >>= 1;
+		tree->availablity_masks[offset] = tree->availablity_masks[offset << 1] | tree->availablity_masks[(offset << 1) + 1];
+	}
+
+	/** replace the size stored by acquire with the exact size, a size that isn't a power of 2 is at least 3 so this is always inside the first used node */
+	tree->availablity_masks[(*allocation_offset | tree->encompasing_bit) + 1] = desired_size;
+
+	assert(tree->availablity_masks[0] == ~0u);
+
+	return true;
+}
+
+void sol_buddy_tree_release(struct sol_buddy_tree* tree, uint32_t offset)
+{
+	uint32_t exponent, size, size_bit;
+
+	/** check allocation offset is a valid value for this allocator */
+	assert(offset < tree->size);
+
+	/** check offset isn't too big */
+	assert(offset < tree->encompasing_bit);
+
+	/** indices in tree have (relative) high bit set */
+	offset |= tree->encompasing_bit;
+
+	/** allocate stores size class in last layer for any given offset */
+	exponent = tree->availablity_masks[offset];
+
+	/** ensure the alignment of the allocation offset is correct given the expected (stored) size class */
+	assert((offset & (((size_t)1 << exponent) - 1)) == 0);
+
+	size = exponent ? tree->availablity_masks[offset + 1] : 1;
+	assert(size > (1u << exponent) / 2 && size <= (1u << exponent));
+
+	if(size == (1u << exponent))
+	{
+		/** move to the size appropriate level of the tree (i.e. where the allocation mist have been made from) */
+		sol_buddy_tree_release_node__i(tree, offset >> exponent, exponent);
+	}
+	else
+	{
+		/** release the used nodes smallest (last) first, so each can coalesce with the slack after it (if that slack is still available) */
+		offset += size;
+		while(size)
+		{
+			size_bit = size & -size;
+			exponent = sol_u32_ctz(size_bit);
+			offset -= size_bit;
+			sol_buddy_tree_release_node__i(tree, offset >> exponent, exponent);
+			size ^= size_bit;
+		}
+	}
+}
+
 uint32_t sol_buddy_tree_query_allocation_size_exponent(const struct sol_buddy_tree* tree, uint32_t offset)
 {
 	uint32_t exponent;
@@ -281,4 +374,12 @@ uint32_t sol_buddy_tree_query_allocation_size_exponent(const struct sol_buddy_tr
 	return exponent;
 }
 
+uint32_t sol_buddy_tree_query_allocation_size(const struct sol_buddy_tree* tree, uint32_t offset)
+{
+	uint32_t exponent;
 
+	exponent = sol_buddy_tree_query_allocation_size_exponent(tree, offset);
+
+	/** an allocation of more than one unit stores its exact size in the maximum layer entry after its first */
+	return exponent ? tree->availablity_masks[(offset | tree->encompasing_bit) + 1] : 1;
+}
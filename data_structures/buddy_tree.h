@@ -20,6 +20,7 @@ along with solipsix.  If not, see <https://www.gnu.org/licenses/>.
 
 
 #include <inttypes.h>
+#include <stdbool.h>
 
 struct sol_buddy_tree
 {
@@ -38,9 +39,16 @@ void sol_buddy_tree_initialise(struct sol_buddy_tree* tree, uint32_t size);
 void sol_buddy_tree_terminate(struct sol_buddy_tree* tree);
 
 bool sol_buddy_tree_acquire(struct sol_buddy_tree* tree, uint32_t desired_size_exponent, uint32_t* allocation_offset);
+/** acquires exactly `desired_size` units, from the start of a power of 2 sized (and aligned) node, with the slack at the end of that node made available to smaller allocations
+ * when the allocation is released it will coalesce with whatever parts of the slack are still available */
+bool sol_buddy_tree_acquire_exact(struct sol_buddy_tree* tree, uint32_t desired_size, uint32_t* allocation_offset);
+/** releases allocations made with either acquire function */
 void sol_buddy_tree_release(struct sol_buddy_tree* tree, uint32_t allocation_offset);
 
+/** the size class of the node the allocation was made from, the allocation is aligned to this but may be smaller (if made with `sol_buddy_tree_acquire_exact`) */
 uint32_t sol_buddy_tree_query_allocation_size_exponent(const struct sol_buddy_tree* tree, uint32_t allocation_offset);
+/** the exact size of the allocation in units */
+uint32_t sol_buddy_tree_query_allocation_size(const struct sol_buddy_tree* tree, uint32_t allocation_offset);
 
 static inline bool sol_buddy_tree_has_space(struct sol_buddy_tree* tree, uint32_t desired_size_exponent)
 {
@@ -59,8 +67,6 @@ static inline bool sol_buddy_tree_is_empty(struct sol_buddy_tree* tree)
  * thus any subsequent resizing is very unlikely to work as the space it would try to take is the most likely region to have been allocated by any appropriately sized allocations */ 
 
 /** possible to have a multilevel buddy allocator that uses u16 basis allocations at both (?) levels - puts some onus on caller
- * 
- * possible to allow non- Po2 allocations that provide space for smaller allocations to fill the gap (put "real size", in high bits with effective size class in lowe bits as is done now)
  * 
  * */
 
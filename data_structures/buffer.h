@@ -20,25 +20,15 @@ along with solipsix.  If not, see <https://www.gnu.org/licenses/>.
 #pragma once
 
 #include <inttypes.h>
+#include <stdbool.h>
 #include <stdlib.h>
 #include <assert.h>
 #include <string.h>
+#include <stdatomic.h>
 
 #include "sol_utils.h"
 
 
-// struct sol_vk_shunt_buffer
-// {
-//     bool multithreaded;
-//     char* backing;
-//     VkDeviceSize alignment;
-//     VkDeviceSize size;
-//     union
-//     {
-//         VkDeviceSize offset;/** non-multithreaded */
-//         atomic_uint_fast64_t atomic_offset;/** multithreaded */
-//     };
-// };
 struct sol_buffer
 {
 	char* allocation;
@@ -126,3 +116,146 @@ static inline bool sol_buffer_can_accomodate_aligned_allocation(struct sol_buffe
 	return offset + size <= b->total_space;
 }
 
+
+
+/** shunt buffer: a sol_buffer that may have segments fetched from multiple threads at once
+ * fetching a segment is a single atomic add; to allow this, space is reserved for worst case alignment padding (beyond the buffers own alignment)
+ * a failed fetch still consumes the space it asked for, the buffer is treated as full from that point on for anything that large
+ * reset/copy/used_space must not be called while another thread may be fetching segments (i.e. only between frames/batches) */
+struct sol_shunt_buffer
+{
+	char* allocation;
+	uint32_t total_space;
+	uint32_t alignment;
+	/** 64 bit so that any number of failed fetches cannot wrap */
+	atomic_uint_fast64_t used_space;
+};
+
+/** a range of a shunt buffer reserved for use by a single thread, segments can be fetched from this without touching shared state
+ * must be reset after the shunt buffer it was taken from is reset */
+struct sol_shunt_buffer_chunk
+{
+	uint32_t offset;
+	uint32_t end;
+};
+
+#define SOL_SHUNT_BUFFER_CHUNK_EMPTY ((struct sol_shunt_buffer_chunk){.offset = 0, .end = 0})
+
+static inline void sol_shunt_buffer_initialise(struct sol_shunt_buffer* b, uint32_t space, uint32_t alignment)
+{
+	assert(space);
+	assert(alignment && (alignment & (alignment - 1)) == 0);
+	b->allocation = malloc(space);
+	b->total_space = space;
+	b->alignment = alignment;
+	atomic_init(&b->used_space, 0);
+}
+static inline void sol_shunt_buffer_terminate(struct sol_shunt_buffer* b)
+{
+	free(b->allocation);
+}
+
+static inline void sol_shunt_buffer_reset(struct sol_shunt_buffer* b)
+{
+	atomic_store_explicit(&b->used_space, 0, memory_order_relaxed);
+}
+
+static inline uint32_t sol_shunt_buffer_used_space(struct sol_shunt_buffer* b)
+{
+	const uint_fast64_t used_space = atomic_load_explicit(&b->used_space, memory_order_relaxed);
+	return used_space < b->total_space ? (uint32_t)used_space : b->total_space;
+}
+
+/** copies everything fetched so far, including any padding/unused chunk space between segments */
+static inline void sol_shunt_buffer_copy(struct sol_shunt_buffer* b, void* dst)
+{
+	memcpy(dst, b->allocation, sol_shunt_buffer_used_space(b));
+}
+
+/** reserve a range with the given size and alignment, returns the offset of the range or UINT32_MAX on failure */
+static inline uint32_t sol_shunt_buffer_reserve__i(struct sol_shunt_buffer* b, uint32_t size, uint32_t alignment)
+{
+	uint_fast64_t offset, reserved_size;
+
+	alignment = SOL_MAX(b->alignment, alignment);
+	assert((alignment & (alignment - 1)) == 0);
+
+	/** keep the shared offset aligned to the buffers alignment, which means only larger alignments require padding */
+	reserved_size = ((uint_fast64_t)size + b->alignment - 1) & (- (uint_fast64_t)b->alignment);
+	reserved_size += alignment - b->alignment;
+
+	offset = atomic_fetch_add_explicit(&b->used_space, reserved_size, memory_order_relaxed);
+	offset = (offset + alignment - 1) & (- (uint_fast64_t)alignment);
+
+	if(offset + size > b->total_space)
+	{
+		return UINT32_MAX;
+	}
+	return (uint32_t)offset;
+}
+
+/** will return empty allocation if insufficient space remains, may be called from any thread */
+static inline struct sol_buffer_segment sol_shunt_buffer_fetch_aligned_segment(struct sol_shunt_buffer* b, uint32_t size, uint32_t alignment)
+{
+	assert(size <= b->total_space);
+	const uint32_t offset = sol_shunt_buffer_reserve__i(b, size, alignment);
+
+	if(offset == UINT32_MAX)
+	{
+		return SOL_BUFFER_SEGMENT_NULL;
+	}
+	else
+	{
+		return (struct sol_buffer_segment)
+		{
+			.ptr = b->allocation + offset,
+			.size = size,
+			.offset = offset,
+		};
+	}
+}
+
+/** fetch a segment from a thread local chunk, taking a new chunk of (at least) chunk_size from the shunt buffer when the current one cannot fit the segment
+ * any space remaining in the previous chunk is abandoned; returns empty allocation if the shunt buffer has insufficient space */
+static inline struct sol_buffer_segment sol_shunt_buffer_chunk_fetch_aligned_segment(struct sol_shunt_buffer* b, struct sol_shunt_buffer_chunk* chunk, uint32_t size, uint32_t alignment, uint32_t chunk_size)
+{
+	uint32_t offset;
+
+	assert(size <= b->total_space);
+	alignment = SOL_MAX(b->alignment, alignment);
+	assert((alignment & (alignment - 1)) == 0);
+
+	/** alignment is applied to the offset within the whole buffer, chunk sizes are not a multiple of the segment alignment */
+	offset = (chunk->offset + alignment - 1) & (- alignment);
+
+	if(offset < chunk->offset || offset + size > chunk->end || offset + size < offset)
+	{
+		/** chunk is aligned to the segments alignment so that the segment is guaranteed to fit */
+		chunk_size = SOL_MAX(chunk_size, size);
+
+		/** a failed reservation consumes the rest of the buffer, so when a whole chunk (probably) no longer fits just reserve the segment
+		 * the load is only paid when taking a new chunk, the reservation itself is still a single atomic add */
+		if(atomic_load_explicit(&b->used_space, memory_order_relaxed) + chunk_size + alignment > b->total_space)
+		{
+			chunk_size = size;
+		}
+
+		offset = sol_shunt_buffer_reserve__i(b, chunk_size, alignment);
+
+		if(offset == UINT32_MAX)
+		{
+			*chunk = SOL_SHUNT_BUFFER_CHUNK_EMPTY;
+			return SOL_BUFFER_SEGMENT_NULL;
+		}
+		chunk->end = offset + chunk_size;
+	}
+
+	chunk->offset = offset + size;
+
+	return (struct sol_buffer_segment)
+	{
+		.ptr = b->allocation + offset,
+		.size = size,
+		.offset = offset,
+	};
+}
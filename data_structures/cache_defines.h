@@ -37,10 +37,10 @@ enum sol_cache_result
     SOL_CACHE_RESULT_END       = 4,
 };
 
-struct sol_cache_link_u16
+struct sol_cache_link_u32
 {
-    uint16_t older;
-    uint16_t newer;
+    uint32_t older;
+    uint32_t newer;
 };
 
 
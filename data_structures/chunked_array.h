@@ -0,0 +1,239 @@
+/**
+Copyright 2026 Carl van Mastrigt
+
+This file is part of solipsix.
+
+solipsix is free software: you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+solipsix is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with solipsix.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include <stdlib.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <assert.h>
+
+#include "sol_utils.h"
+
+#include "data_structures/indices_stack.h"
+
+/** array with the same interface as array.h, but storage is never moved, so pointers to entries remain valid for as long as the entry is live
+ * storage is a series of chunks that double in size, chunk k holds (1 << (SOL_CHUNKED_ARRAY_CHUNK_EXPONENT + k)) entries
+ * the table of chunks has a fixed size so looking up an index never reads memory that may be reallocated
+ *
+ * a single thread may append while any number of other threads read entries with index below the published count
+ * entries acquired with append_index/append_ptr become visible to those readers once publish is called,
+ * append with a value publishes immediately, unless entries acquired before it with append_index/append_ptr have yet to be published (it is then published along with them)
+ * all other operations are not safe to call concurrently with readers */
+
+
+
+#ifndef SOL_CHUNKED_ARRAY_ENTRY_TYPE
+#error must define SOL_CHUNKED_ARRAY_ENTRY_TYPE
+#define SOL_CHUNKED_ARRAY_ENTRY_TYPE int
+#endif
+
+#ifndef SOL_CHUNKED_ARRAY_STRUCT_NAME
+#error must define SOL_CHUNKED_ARRAY_STRUCT_NAME
+#define SOL_CHUNKED_ARRAY_STRUCT_NAME placeholder_chunked_array
+#endif
+
+#ifndef SOL_CHUNKED_ARRAY_FUNCTION_PREFIX
+#define SOL_CHUNKED_ARRAY_FUNCTION_PREFIX SOL_CHUNKED_ARRAY_STRUCT_NAME
+#endif
+
+/** size of the first chunk, (1 << exponent) entries */
+#ifndef SOL_CHUNKED_ARRAY_CHUNK_EXPONENT
+#define SOL_CHUNKED_ARRAY_CHUNK_EXPONENT 6
+#endif
+
+static_assert(SOL_CHUNKED_ARRAY_CHUNK_EXPONENT < 32, "chunked array first chunk is too large");
+
+#define SOL_CHUNKED_ARRAY_MAX_CHUNKS (32 - SOL_CHUNKED_ARRAY_CHUNK_EXPONENT)
+
+
+
+struct SOL_CHUNKED_ARRAY_STRUCT_NAME
+{
+    struct sol_indices_stack available_indices;
+    SOL_CHUNKED_ARRAY_ENTRY_TYPE* chunks[SOL_CHUNKED_ARRAY_MAX_CHUNKS];
+    uint32_t chunk_count;
+    uint32_t space;
+    uint32_t count;
+    /** count below which every entry is known to have been written (by append, or by the user before calling publish), never exceeds count */
+    uint32_t filled_count;
+    /** count up to which entries may be read by other threads, the last filled_count stored */
+    atomic_uint_fast32_t published_count;
+};
+
+static inline void SOL_CONCATENATE(SOL_CHUNKED_ARRAY_FUNCTION_PREFIX,_add_chunk__i)(struct SOL_CHUNKED_ARRAY_STRUCT_NAME* a);
+
+/** as with array.h `initial_size` must be a power of 2 (or 0), enough chunks are allocated up front to hold that many entries */
+static inline void SOL_CONCATENATE(SOL_CHUNKED_ARRAY_FUNCTION_PREFIX,_initialise)(struct SOL_CHUNKED_ARRAY_STRUCT_NAME* a, uint32_t initial_size)
+{
+    assert((initial_size & (initial_size - 1)) == 0);
+    sol_indices_stack_initialise(&a->available_indices, initial_size);
+    a->chunk_count = 0;
+    a->space = 0;
+    a->count = 0;
+    a->filled_count = 0;
+    atomic_init(&a->published_count, 0);
+
+    while(a->space < initial_size)
+    {
+        SOL_CONCATENATE(SOL_CHUNKED_ARRAY_FUNCTION_PREFIX,_add_chunk__i)(a);
+    }
+}
+
+static inline void SOL_CONCATENATE(SOL_CHUNKED_ARRAY_FUNCTION_PREFIX,_terminate)(struct SOL_CHUNKED_ARRAY_STRUCT_NAME* a)
+{
+    uint32_t chunk_index;
+
+    sol_indices_stack_terminate(&a->available_indices);
+    for(chunk_index = 0; chunk_index < a->chunk_count; chunk_index++)
+    {
+        free(a->chunks[chunk_index]);
+    }
+}
+
+static inline void SOL_CONCATENATE(SOL_CHUNKED_ARRAY_FUNCTION_PREFIX,_add_chunk__i)(struct SOL_CHUNKED_ARRAY_STRUCT_NAME* a)
+{
+    const uint32_t chunk_size = UINT32_C(1) << (SOL_CHUNKED_ARRAY_CHUNK_EXPONENT + a->chunk_count);
+
+    /** with all chunks allocated space is (1 << 32) - (1 << SOL_CHUNKED_ARRAY_CHUNK_EXPONENT), which still fits in 32 bits */
+    assert(a->chunk_count < SOL_CHUNKED_ARRAY_MAX_CHUNKS);
+
+    a->chunks[a->chunk_count++] = malloc(sizeof(SOL_CHUNKED_ARRAY_ENTRY_TYPE) * chunk_size);
+    a->space += chunk_size;
+}
+
+/** ensures this many entries can be appended without allocating, does not affect existing entries (which never move) */
+static inline void SOL_CONCATENATE(SOL_CHUNKED_ARRAY_FUNCTION_PREFIX,_ensure_available_capacity)(struct SOL_CHUNKED_ARRAY_STRUCT_NAME* a, uint32_t desired_available_capacity)
+{
+    while(sol_indices_stack_count(&a->available_indices) + a->space - a->count < desired_available_capacity)
+    {
+        SOL_CONCATENATE(SOL_CHUNKED_ARRAY_FUNCTION_PREFIX,_add_chunk__i)(a);
+    }
+}
+
+static inline SOL_CHUNKED_ARRAY_ENTRY_TYPE* SOL_CONCATENATE(SOL_CHUNKED_ARRAY_FUNCTION_PREFIX,_access_entry)(const struct SOL_CHUNKED_ARRAY_STRUCT_NAME* a, uint32_t index)
+{
+    /** offsetting the index by the first chunks size makes the chunk index the position of the highest set bit */
+    const uint32_t offset_index = index + (UINT32_C(1) << SOL_CHUNKED_ARRAY_CHUNK_EXPONENT);
+    const uint32_t exponent = sol_u32_exp_le(offset_index);
+
+    return a->chunks[exponent - SOL_CHUNKED_ARRAY_CHUNK_EXPONENT] + (offset_index - (UINT32_C(1) << exponent));
+}
+
+static inline SOL_CHUNKED_ARRAY_ENTRY_TYPE SOL_CONCATENATE(SOL_CHUNKED_ARRAY_FUNCTION_PREFIX,_get_entry)(const struct SOL_CHUNKED_ARRAY_STRUCT_NAME* a, uint32_t index)
+{
+    return *SOL_CONCATENATE(SOL_CHUNKED_ARRAY_FUNCTION_PREFIX,_access_entry)(a, index);
+}
+
+/** entries appended after the last publish (with index at or above count at that time) may not be read by other threads until this is called */
+static inline void SOL_CONCATENATE(SOL_CHUNKED_ARRAY_FUNCTION_PREFIX,_publish)(struct SOL_CHUNKED_ARRAY_STRUCT_NAME* a)
+{
+    a->filled_count = a->count;
+    atomic_store_explicit(&a->published_count, a->filled_count, memory_order_release);
+}
+
+/** may be called from any thread, entries below the returned count may be read (but see notes on reuse of withdrawn indices) */
+static inline uint32_t SOL_CONCATENATE(SOL_CHUNKED_ARRAY_FUNCTION_PREFIX,_published_count)(const struct SOL_CHUNKED_ARRAY_STRUCT_NAME* a)
+{
+    return (uint32_t)atomic_load_explicit(&a->published_count, memory_order_acquire);
+}
+
+/** NOTE: an index reused from withdrawn entries is not republished, synchronising reads of reused entries is up to the user */
+static inline uint32_t SOL_CONCATENATE(SOL_CHUNKED_ARRAY_FUNCTION_PREFIX,_append_index)(struct SOL_CHUNKED_ARRAY_STRUCT_NAME* a)
+{
+    uint32_t i;
+    if(!sol_indices_stack_withdraw(&a->available_indices, &i))
+    {
+        if(a->count == a->space)
+        {
+            SOL_CONCATENATE(SOL_CHUNKED_ARRAY_FUNCTION_PREFIX,_add_chunk__i)(a);
+        }
+        i = a->count++;
+    }
+    return i;
+}
+
+static inline SOL_CHUNKED_ARRAY_ENTRY_TYPE* SOL_CONCATENATE(SOL_CHUNKED_ARRAY_FUNCTION_PREFIX,_append_ptr)(struct SOL_CHUNKED_ARRAY_STRUCT_NAME* a, uint32_t* index_ptr)
+{
+    uint32_t i;
+    i = SOL_CONCATENATE(SOL_CHUNKED_ARRAY_FUNCTION_PREFIX,_append_index)(a);
+    if(index_ptr)
+    {
+        *index_ptr = i;
+    }
+    return SOL_CONCATENATE(SOL_CHUNKED_ARRAY_FUNCTION_PREFIX,_access_entry)(a, i);
+}
+
+static inline uint32_t SOL_CONCATENATE(SOL_CHUNKED_ARRAY_FUNCTION_PREFIX,_append)(struct SOL_CHUNKED_ARRAY_STRUCT_NAME* a, SOL_CHUNKED_ARRAY_ENTRY_TYPE value)
+{
+    uint32_t i;
+    i = SOL_CONCATENATE(SOL_CHUNKED_ARRAY_FUNCTION_PREFIX,_append_index)(a);
+    *SOL_CONCATENATE(SOL_CHUNKED_ARRAY_FUNCTION_PREFIX,_access_entry)(a, i) = value;
+
+    /** only publish if every entry before this one has been written, entries from append_index/append_ptr may still be awaiting their values
+     * (a reused index is below filled_count already, and isn't republished) */
+    if(i == a->filled_count)
+    {
+        a->filled_count++;
+        atomic_store_explicit(&a->published_count, a->filled_count, memory_order_release);
+    }
+    return i;
+}
+
+/** returned pointer cannot be used after any other operation has occurred*/
+static inline SOL_CHUNKED_ARRAY_ENTRY_TYPE* SOL_CONCATENATE(SOL_CHUNKED_ARRAY_FUNCTION_PREFIX,_withdraw_ptr)(struct SOL_CHUNKED_ARRAY_STRUCT_NAME* a, uint32_t index)
+{
+    assert(index < a->count);
+    sol_indices_stack_append(&a->available_indices, index);
+    return SOL_CONCATENATE(SOL_CHUNKED_ARRAY_FUNCTION_PREFIX,_access_entry)(a, index);
+}
+
+static inline SOL_CHUNKED_ARRAY_ENTRY_TYPE SOL_CONCATENATE(SOL_CHUNKED_ARRAY_FUNCTION_PREFIX,_withdraw)(struct SOL_CHUNKED_ARRAY_STRUCT_NAME* a, uint32_t index)
+{
+    assert(index < a->count);
+    sol_indices_stack_append(&a->available_indices, index);
+    return *SOL_CONCATENATE(SOL_CHUNKED_ARRAY_FUNCTION_PREFIX,_access_entry)(a, index);
+}
+
+/** retains allocated chunks */
+static inline void SOL_CONCATENATE(SOL_CHUNKED_ARRAY_FUNCTION_PREFIX,_reset)(struct SOL_CHUNKED_ARRAY_STRUCT_NAME* a)
+{
+    sol_indices_stack_reset(&a->available_indices);
+    a->count = 0;
+    a->filled_count = 0;
+    atomic_store_explicit(&a->published_count, 0, memory_order_relaxed);
+}
+
+static inline uint32_t SOL_CONCATENATE(SOL_CHUNKED_ARRAY_FUNCTION_PREFIX,_is_empty)(struct SOL_CHUNKED_ARRAY_STRUCT_NAME* a)
+{
+    return a->count == sol_indices_stack_count(&a->available_indices);
+}
+
+static inline uint32_t SOL_CONCATENATE(SOL_CHUNKED_ARRAY_FUNCTION_PREFIX,_active_count)(struct SOL_CHUNKED_ARRAY_STRUCT_NAME* a)
+{
+    assert(a->count >= sol_indices_stack_count(&a->available_indices));
+    return a->count - sol_indices_stack_count(&a->available_indices);
+}
+
+
+#undef SOL_CHUNKED_ARRAY_ENTRY_TYPE
+#undef SOL_CHUNKED_ARRAY_FUNCTION_PREFIX
+#undef SOL_CHUNKED_ARRAY_STRUCT_NAME
+#undef SOL_CHUNKED_ARRAY_CHUNK_EXPONENT
+#undef SOL_CHUNKED_ARRAY_MAX_CHUNKS
@@ -86,9 +86,17 @@ SOL_HASH_MAP_FUNCTION_KEYWORDS void SOL_CONCATENATE(SOL_HASH_MAP_FUNCTION_PREFIX
 /** completely empties the hash map, effectively removing all entries */
 SOL_HASH_MAP_FUNCTION_KEYWORDS void SOL_CONCATENATE(FUNCTION_PREFIX,_clear)(struct SOL_HASH_MAP_STRUCT_NAME* map);
 
+/** completes any incremental resize in progress, returns false if that was not possible because the map is full */
+SOL_HASH_MAP_FUNCTION_KEYWORDS bool SOL_CONCATENATE(FUNCTION_PREFIX,_settle)(struct SOL_HASH_MAP_STRUCT_NAME* map);
+
 /** searches for key; then if found sets entry to allow direct access to it (if entry non null) then returns true
- *  pointer returned with entry becomes invalid after any other map functions are executed */
+ *  pointer returned with entry becomes invalid after any other map functions are executed
+ *  with `SOL_HASH_MAP_INCREMENTAL_RESIZE` defined find advances the resize, so does not take a const map */
+#ifdef SOL_HASH_MAP_INCREMENTAL_RESIZE
+SOL_HASH_MAP_FUNCTION_KEYWORDS enum sol_map_operation_result SOL_CONCATENATE(FUNCTION_PREFIX,_find)(struct SOL_HASH_MAP_STRUCT_NAME* map, SOL_HASH_MAP_KEY_TYPE key, SOL_HASH_MAP_ENTRY_TYPE** entry_ptr);
+#else
 SOL_HASH_MAP_FUNCTION_KEYWORDS enum sol_map_operation_result SOL_CONCATENATE(FUNCTION_PREFIX,_find)(const struct SOL_HASH_MAP_STRUCT_NAME* map, SOL_HASH_MAP_KEY_TYPE key, SOL_HASH_MAP_ENTRY_TYPE** entry_ptr);
+#endif
 
 /** find that upon failure assigns space based key, returns true if insertion was performed
  *  pointer returned with entry becomes invalid after any other map functions are executed
@@ -22,9 +22,11 @@ along with solipsix.  If not, see <https://www.gnu.org/licenses/>.
 /** all includes put here instead of implement file to take advantage of pragma once */
 #include <limits.h>
 #include <stdlib.h>
+#include <stdio.h>
 #include <inttypes.h>
 #include <stdbool.h>
 #include <assert.h>
+#include <threads.h>
 
 #include "sol_utils.h"
 
@@ -52,5 +54,66 @@ struct sol_hash_map_descriptor
 #define SOL_HASH_MAP_DELTA_TEST_BIT 0x8000
 
 
+/** group probing: compare a group of (16 bit) identifiers against the identifiers a key would have at each of those locations at once
+ * only used by maps with the default identifier type, can be disabled for all maps by defining `SOL_HASH_MAP_SCALAR_PROBE`
+ * masks have `SOL_HASH_MAP_GROUP_LANE_BITS` set for each identifier in the group, in order */
+#if !defined(SOL_HASH_MAP_SCALAR_PROBE) && defined(__AVX2__)
+#include <immintrin.h>
+#define SOL_HASH_MAP_GROUP_SIZE 16
+#define SOL_HASH_MAP_GROUP_LANE_BITS 2
+#define SOL_HASH_MAP_GROUP_FULL_MASK ((uint64_t)0xFFFFFFFFllu)
+#elif !defined(SOL_HASH_MAP_SCALAR_PROBE) && (defined(__SSE2__) || defined(_M_X64))
+#include <emmintrin.h>
+#define SOL_HASH_MAP_GROUP_SIZE 8
+#define SOL_HASH_MAP_GROUP_LANE_BITS 2
+#define SOL_HASH_MAP_GROUP_FULL_MASK ((uint64_t)0xFFFFllu)
+#elif !defined(SOL_HASH_MAP_SCALAR_PROBE) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#include <arm_neon.h>
+#define SOL_HASH_MAP_GROUP_SIZE 8
+#define SOL_HASH_MAP_GROUP_LANE_BITS 8
+#define SOL_HASH_MAP_GROUP_FULL_MASK ((uint64_t)0xFFFFFFFFFFFFFFFFllu)
+#endif
+
+#ifdef SOL_HASH_MAP_GROUP_SIZE
+/** the identifier a key has at lane k of the group is `identifier - k * offset_unit`
+ * skip: occupied by an identifier smaller than the keys (the key would be placed after it)
+ * match: occupied by exactly the keys identifier (candidate for comparison) */
+static inline void sol_hash_map_identifier_group_probe(const uint16_t* identifiers, uint16_t identifier, uint16_t offset_unit, uint64_t* skip_mask, uint64_t* match_mask)
+{
+    #if defined(__AVX2__)
+    const __m256i ids = _mm256_loadu_si256((const __m256i*)identifiers);
+    const __m256i ramp = _mm256_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    const __m256i expected = _mm256_sub_epi16(_mm256_set1_epi16((short)identifier), _mm256_mullo_epi16(ramp, _mm256_set1_epi16((short)offset_unit)));
+    /** no unsigned 16 bit compare, so flip the sign bit and compare signed */
+    const __m256i bias = _mm256_set1_epi16((short)0x8000);
+    const __m256i empty = _mm256_cmpeq_epi16(ids, _mm256_setzero_si256());
+    const __m256i less = _mm256_cmpgt_epi16(_mm256_xor_si256(expected, bias), _mm256_xor_si256(ids, bias));
+
+    *skip_mask  = (uint32_t)_mm256_movemask_epi8(_mm256_andnot_si256(empty, less));
+    *match_mask = (uint32_t)_mm256_movemask_epi8(_mm256_andnot_si256(empty, _mm256_cmpeq_epi16(ids, expected)));
+    #elif defined(__SSE2__) || defined(_M_X64)
+    const __m128i ids = _mm_loadu_si128((const __m128i*)identifiers);
+    const __m128i ramp = _mm_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m128i expected = _mm_sub_epi16(_mm_set1_epi16((short)identifier), _mm_mullo_epi16(ramp, _mm_set1_epi16((short)offset_unit)));
+    const __m128i bias = _mm_set1_epi16((short)0x8000);
+    const __m128i empty = _mm_cmpeq_epi16(ids, _mm_setzero_si128());
+    const __m128i less = _mm_cmplt_epi16(_mm_xor_si128(ids, bias), _mm_xor_si128(expected, bias));
+
+    *skip_mask  = (uint32_t)_mm_movemask_epi8(_mm_andnot_si128(empty, less));
+    *match_mask = (uint32_t)_mm_movemask_epi8(_mm_andnot_si128(empty, _mm_cmpeq_epi16(ids, expected)));
+    #else
+    static const uint16_t ramp_values[8] = {0, 1, 2, 3, 4, 5, 6, 7};
+    const uint16x8_t ids = vld1q_u16(identifiers);
+    const uint16x8_t expected = vmlsq_u16(vdupq_n_u16(identifier), vld1q_u16(ramp_values), vdupq_n_u16(offset_unit));
+    const uint16x8_t occupied = vtstq_u16(ids, ids);
+
+    /** narrowing shift leaves 8 bits per lane, which is the cheapest way to get a mask out of neon */
+    *skip_mask  = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vandq_u16(occupied, vcltq_u16(ids, expected)), 4)), 0);
+    *match_mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vandq_u16(occupied, vceqq_u16(ids, expected)), 4)), 0);
+    #endif
+}
+#endif
+
+
 
 
@@ -62,11 +62,49 @@ along with solipsix.  If not, see <https://www.gnu.org/licenses/>.
 /** optional tweaks to hash map properties */
 #ifndef SOL_HASH_MAP_IDENTIFIER_TYPE
 #define SOL_HASH_MAP_IDENTIFIER_TYPE uint16_t
+/** group probing relies on identifiers being 16 bits, so is only available when the identifier type is not changed */
+#ifdef SOL_HASH_MAP_GROUP_SIZE
+#define SOL_HASH_MAP_IDENTIFIER_GROUP_PROBE
+#endif
 #endif
 #ifndef SOL_HASH_MAP_IDENTIFIER_HASH_INDEX_BITS
 #define SOL_HASH_MAP_IDENTIFIER_HASH_INDEX_BITS 6
 #endif
 
+/** define `SOL_HASH_MAP_INCREMENTAL_RESIZE` to spread the cost of resizing across subsequent operations instead of rehashing every entry at once
+ * while resizing the previous table is kept, lookups check both tables and every find/obtain/remove moves the entries of this many of its buckets to the new table
+ * as find then modifies the map it no longer takes a const map, settle can be used to complete a resize outright */
+#ifdef SOL_HASH_MAP_INCREMENTAL_RESIZE
+#ifndef SOL_HASH_MAP_INCREMENTAL_RESIZE_STEP
+#define SOL_HASH_MAP_INCREMENTAL_RESIZE_STEP 8
+#endif
+#define SOL_HASH_MAP_FIND_MAP_QUALIFIER
+#else
+#define SOL_HASH_MAP_FIND_MAP_QUALIFIER const
+#endif
+
+/** number of keys find_many/obtain_many hash and prefetch ahead of resolving them */
+#ifndef SOL_HASH_MAP_BATCH_SIZE
+#define SOL_HASH_MAP_BATCH_SIZE 16
+#endif
+
+/** define `SOL_HASH_MAP_SHARDED` to split the map into `1 << SOL_HASH_MAP_SHARD_EXPONENT` independently locked tables (selected by the top bits of the hash)
+ * this makes the map safe to access from multiple threads, with threads only contending when they access the same shard
+ * as pointers into a shard cannot outlive its lock the sharded map copies entries in and out rather than returning pointers (see end of file)
+ * the tables themselves are instantiated as `static inline` with `_shard` appended to the struct name and function prefix */
+#ifdef SOL_HASH_MAP_SHARDED
+#ifndef SOL_HASH_MAP_SHARD_EXPONENT
+#define SOL_HASH_MAP_SHARD_EXPONENT 4
+#endif
+#define SOL_HASH_MAP_TABLE_STRUCT_NAME SOL_CONCATENATE(SOL_HASH_MAP_STRUCT_NAME,_shard)
+#define SOL_HASH_MAP_TABLE_FUNCTION_PREFIX SOL_CONCATENATE(SOL_HASH_MAP_FUNCTION_PREFIX,_shard)
+#define SOL_HASH_MAP_TABLE_FUNCTION_KEYWORDS static inline
+#else
+#define SOL_HASH_MAP_TABLE_STRUCT_NAME SOL_HASH_MAP_STRUCT_NAME
+#define SOL_HASH_MAP_TABLE_FUNCTION_PREFIX SOL_HASH_MAP_FUNCTION_PREFIX
+#define SOL_HASH_MAP_TABLE_FUNCTION_KEYWORDS SOL_HASH_MAP_FUNCTION_KEYWORDS
+#endif
+
 
 #ifdef SOL_HASH_MAP_CONTEXT_TYPE
 #define SOL_HASH_MAP_KEY_ENTRY_CMP_EQUAL_CONTEXT(K,E) SOL_HASH_MAP_KEY_ENTRY_CMP_EQUAL(K, E, map->context)
@@ -94,7 +132,7 @@ along with solipsix.  If not, see <https://www.gnu.org/licenses/>.
 
 
 #ifndef SOL_HASH_MAP_DECLARATION_PRESENT
-struct SOL_HASH_MAP_STRUCT_NAME
+struct SOL_HASH_MAP_TABLE_STRUCT_NAME
 {
     struct sol_hash_map_descriptor descriptor;
 
@@ -109,84 +147,112 @@ struct SOL_HASH_MAP_STRUCT_NAME
 
     /** hash/index mask to keep withing entry space, is just `(1 << uint8_t entry_space_exponent) - 1` */
     uint64_t index_mask;
-    uint64_t entry_count;
+    uint64_t entry_count;/** includes entries yet to be moved out of the old table when resizing incrementally */
     uint64_t entry_limit;
+
+    #ifdef SOL_HASH_MAP_INCREMENTAL_RESIZE
+    /** the table from before the last resize, entries are moved out of it a few buckets at a time, NULL when not resizing */
+    SOL_HASH_MAP_ENTRY_TYPE* old_entries;
+    SOL_HASH_MAP_IDENTIFIER_TYPE* old_identifiers;
+    uint64_t old_index_mask;
+    /** every index in the old table before this one has been emptied */
+    uint64_t migration_index;
+    #endif
 };
 #else
 #undef SOL_HASH_MAP_DECLARATION_PRESENT
 #endif
 
 
-/** need to early define insert as resize uses it */
-SOL_HASH_MAP_FUNCTION_KEYWORDS enum sol_map_operation_result SOL_CONCATENATE(SOL_HASH_MAP_FUNCTION_PREFIX,_insert)(struct SOL_HASH_MAP_STRUCT_NAME* map, const SOL_HASH_MAP_ENTRY_TYPE* entry);
-
-static void SOL_CONCATENATE(SOL_HASH_MAP_FUNCTION_PREFIX,_resize__i)(struct SOL_HASH_MAP_STRUCT_NAME* map)
+#ifdef SOL_HASH_MAP_IDENTIFIER_GROUP_PROBE
+/** same result as the scalar version below, but checks a group of identifiers at a time and only compares keys for identifiers that match exactly */
+static inline bool SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_locate__i)(const struct SOL_HASH_MAP_TABLE_STRUCT_NAME* restrict map, SOL_HASH_MAP_ENTRY_TYPE* entries, const SOL_HASH_MAP_IDENTIFIER_TYPE* identifiers, uint64_t index_mask, SOL_HASH_MAP_KEY_TYPE key, SOL_HASH_MAP_IDENTIFIER_TYPE* restrict identifier, uint64_t* restrict index)
 {
-    const uint64_t old_entry_space = (uint64_t)1 << map->entry_space_exponent;
-    uint64_t index;
-    enum sol_map_operation_result insert_result;
+    SOL_HASH_MAP_IDENTIFIER_TYPE wrapped_identifiers[SOL_HASH_MAP_GROUP_SIZE];
+    const SOL_HASH_MAP_IDENTIFIER_TYPE* group_identifiers;
+    uint64_t skip_mask, match_mask, lane;
+    bool matching = false;
 
-    map->entry_space_exponent++;
+    while(true)
+    {
+        if(*index + SOL_HASH_MAP_GROUP_SIZE <= index_mask + 1)
+        {
+            group_identifiers = identifiers + *index;
+        }
+        else
+        {
+            /** group would run off the end of the table, gather the wrapped identifiers */
+            for(lane = 0; lane < SOL_HASH_MAP_GROUP_SIZE; lane++)
+            {
+                wrapped_identifiers[lane] = identifiers[index_mask & (*index + lane)];
+            }
+            group_identifiers = wrapped_identifiers;
+        }
 
-    SOL_HASH_MAP_ENTRY_TYPE* old_entries = map->entries;
-    SOL_HASH_MAP_ENTRY_TYPE* new_entries = malloc(sizeof(SOL_HASH_MAP_ENTRY_TYPE) << map->entry_space_exponent);
-    map->entries = new_entries;
+        sol_hash_map_identifier_group_probe(group_identifiers, *identifier, SOL_HASH_MAP_IDENTIFIER_OFFSET_UNIT, &skip_mask, &match_mask);
 
-    SOL_HASH_MAP_IDENTIFIER_TYPE* old_identifiers = map->identifiers;
-    SOL_HASH_MAP_IDENTIFIER_TYPE* new_identifiers = malloc(sizeof(SOL_HASH_MAP_IDENTIFIER_TYPE) << map->entry_space_exponent);
-    map->identifiers = new_identifiers;
-    memset(new_identifiers, 0x00, sizeof(SOL_HASH_MAP_IDENTIFIER_TYPE) << map->entry_space_exponent);
+        lane = 0;
 
-    if(map->entry_space_exponent == map->descriptor.entry_space_exponent_limit)
-    {
-        map->entry_limit = ((uint64_t)map->descriptor.limit_fill_factor << (map->entry_space_exponent-8));
-    }
-    else
-    {
-        map->entry_limit = ((uint64_t)map->descriptor.resize_fill_factor << (map->entry_space_exponent-8));
-    }
-
-    map->index_mask = (1llu << map->entry_space_exponent) - 1llu;
-    map->entry_count = 0;
+        if( ! matching)
+        {
+            skip_mask = ~skip_mask & SOL_HASH_MAP_GROUP_FULL_MASK;
+            if(skip_mask == 0)
+            {
+                /** every identifier in the group is smaller, the key would go after all of them */
+                *identifier -= SOL_HASH_MAP_IDENTIFIER_OFFSET_UNIT * SOL_HASH_MAP_GROUP_SIZE;
+                *index = index_mask & (*index + SOL_HASH_MAP_GROUP_SIZE);
+                continue;
+            }
+            lane = sol_u64_ctz(skip_mask) / SOL_HASH_MAP_GROUP_LANE_BITS;
+            matching = true;
+        }
 
-    for(index = 0; index < old_entry_space; index++)
-    {
-        /** every location in the old map has a valid location so its unnecessary to account for failure to add here (guaranteed to succeed)*/
-        if(old_identifiers[index])
+        /** the key can only be in the run of matching identifiers starting at lane */
+        while(lane < SOL_HASH_MAP_GROUP_SIZE && (match_mask >> (lane * SOL_HASH_MAP_GROUP_LANE_BITS)) & 1)
         {
-            insert_result = SOL_CONCATENATE(SOL_HASH_MAP_FUNCTION_PREFIX,_insert)(map, old_entries + index);
+            if(SOL_HASH_MAP_KEY_ENTRY_CMP_EQUAL_CONTEXT(key, (entries + (index_mask & (*index + lane)))))
+            {
+                *identifier -= SOL_HASH_MAP_IDENTIFIER_OFFSET_UNIT * lane;
+                *index = index_mask & (*index + lane);
+                return true;/** precise key/entry found */
+            }
+            lane++;
+        }
 
-            assert(insert_result == SOL_MAP_SUCCESS_INSERTED);
+        *identifier -= SOL_HASH_MAP_IDENTIFIER_OFFSET_UNIT * lane;
+        *index = index_mask & (*index + lane);
+
+        if(lane < SOL_HASH_MAP_GROUP_SIZE)
+        {
+            return false;/** insertion required at index */
         }
     }
-
-    free(old_identifiers);
-    free(old_entries);
 }
-
-static inline bool SOL_CONCATENATE(SOL_HASH_MAP_FUNCTION_PREFIX,_locate__i)(const struct SOL_HASH_MAP_STRUCT_NAME* restrict map, SOL_HASH_MAP_KEY_TYPE key, SOL_HASH_MAP_IDENTIFIER_TYPE* restrict identifier, uint64_t* restrict index)
+#else
+static inline bool SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_locate__i)(const struct SOL_HASH_MAP_TABLE_STRUCT_NAME* restrict map, SOL_HASH_MAP_ENTRY_TYPE* entries, const SOL_HASH_MAP_IDENTIFIER_TYPE* identifiers, uint64_t index_mask, SOL_HASH_MAP_KEY_TYPE key, SOL_HASH_MAP_IDENTIFIER_TYPE* restrict identifier, uint64_t* restrict index)
 {
-    while( map->identifiers[*index] && map->identifiers[*index] < *identifier)
+    while( identifiers[*index] && identifiers[*index] < *identifier)
     {
         *identifier -= SOL_HASH_MAP_IDENTIFIER_OFFSET_UNIT;
-        *index = map->index_mask & (*index + 1);
+        *index = index_mask & (*index + 1);
     }
 
-    while(*identifier == map->identifiers[*index])
+    while(*identifier == identifiers[*index])
     {
-        if(SOL_HASH_MAP_KEY_ENTRY_CMP_EQUAL_CONTEXT(key, (map->entries + *index)))
+        if(SOL_HASH_MAP_KEY_ENTRY_CMP_EQUAL_CONTEXT(key, (entries + *index)))
         {
             return true;/** precise key/entry found */
         }
         assert(*identifier >= SOL_HASH_MAP_IDENTIFIER_MINIMUM_DISPLACEMENT_CAPACITY);
         *identifier -= SOL_HASH_MAP_IDENTIFIER_OFFSET_UNIT;
-        *index = map->index_mask & (*index + 1);
+        *index = index_mask & (*index + 1);
     }
 
     return false;/** insertion required at index */
 }
+#endif
 
-static inline void SOL_CONCATENATE(SOL_HASH_MAP_FUNCTION_PREFIX,_evict_index__i)(struct SOL_HASH_MAP_STRUCT_NAME* map, uint64_t index)
+static inline void SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_evict_index__i)(SOL_HASH_MAP_ENTRY_TYPE* entries, SOL_HASH_MAP_IDENTIFIER_TYPE* identifiers, uint64_t index_mask, uint64_t index)
 {
     uint64_t next_index;
     SOL_HASH_MAP_IDENTIFIER_TYPE identifier;
@@ -194,28 +260,248 @@ static inline void SOL_CONCATENATE(SOL_HASH_MAP_FUNCTION_PREFIX,_evict_index__i)
     /** move all following entries backwards until an empty slot or an entry with the maximum displacement capacity is encountered*/
     while(true)
     {
-        next_index = map->index_mask & (index + 1);
-        identifier = map->identifiers[next_index];
+        next_index = index_mask & (index + 1);
+        identifier = identifiers[next_index];
         if(identifier && identifier < SOL_HASH_MAP_IDENTIFIER_MAXIMUM_DISPLACEMENT_CAPACITY)
         {
             assert((SOL_HASH_MAP_IDENTIFIER_TYPE)(identifier + SOL_HASH_MAP_IDENTIFIER_OFFSET_UNIT) > identifier);
-            map->entries    [index] = map->entries[next_index];
-            map->identifiers[index] = identifier + SOL_HASH_MAP_IDENTIFIER_OFFSET_UNIT;
+            entries    [index] = entries[next_index];
+            identifiers[index] = identifier + SOL_HASH_MAP_IDENTIFIER_OFFSET_UNIT;
             index = next_index;
         }
+
         else break;
     }
-    map->identifiers[index] = 0;
-    map->entry_count--;
+    identifiers[index] = 0;
+}
+
+/** find or insert key in the current table without resizing it
+ * returns SOL_MAP_FAIL_FULL (having undone any changes) if the key couldn't be placed within the displacement capacity */
+static inline enum sol_map_operation_result SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_obtain_in_table__i)(struct SOL_HASH_MAP_TABLE_STRUCT_NAME* map, SOL_HASH_MAP_KEY_TYPE key, uint64_t key_hash, SOL_HASH_MAP_ENTRY_TYPE** entry_ptr)
+{
+    uint64_t key_index, move_index, prev_move_index;
+    SOL_HASH_MAP_IDENTIFIER_TYPE move_identifier, key_identifier, next_identifier, prev_identifier;
+
+    key_identifier = (key_hash & SOL_HASH_MAP_IDENTIFIER_FRACTIONAL_HASH_MASK) | SOL_HASH_MAP_IDENTIFIER_MAXIMUM_DISPLACEMENT_CAPACITY;
+    key_index = (key_hash >> SOL_HASH_MAP_IDENTIFIER_FRACTIONAL_HASH_BIT_COUNT) & map->index_mask;
+
+    if(SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_locate__i)(map, map->entries, map->identifiers, map->index_mask, key, &key_identifier, &key_index))
+    {
+        *entry_ptr = map->entries + key_index;
+        return SOL_MAP_SUCCESS_FOUND;
+    }
+
+    move_identifier = key_identifier;
+    move_index      = key_index;
+    /** ^ note: initially checking that the entry being added is being added at a valid location
+     * this flow attempts to continually move the move identifier into the move_index location as long as its identifier is larger */
+    while(true)
+    {
+        if(move_identifier < SOL_HASH_MAP_IDENTIFIER_MINIMUM_DISPLACEMENT_CAPACITY)
+        {
+            /** fail case; unwind identifier changes so the caller can either return failure or resize the hash map */
+            while(move_index != key_index)
+            {
+                /** move backwards: pick up identifier and replace with move identifier */
+                assert(move_identifier < SOL_HASH_MAP_IDENTIFIER_MAXIMUM_DISPLACEMENT_CAPACITY);
+
+                move_index = map->index_mask & (move_index - 1);
+
+                prev_identifier = map->identifiers[move_index];
+                map->identifiers[move_index] = move_identifier + SOL_HASH_MAP_IDENTIFIER_OFFSET_UNIT;
+                move_identifier = prev_identifier;
+            }
+
+            *entry_ptr = NULL;
+            return SOL_MAP_FAIL_FULL;
+        }
+
+        /** move forwards */
+        next_identifier = map->identifiers[move_index];
+        map->identifiers[move_index] = move_identifier;
+
+        if(next_identifier == 0)
+        {
+            break;
+        }
+
+        move_identifier = next_identifier - SOL_HASH_MAP_IDENTIFIER_OFFSET_UNIT;
+        move_index = map->index_mask & (move_index + 1);
+    }
+
+    /** shift everything forward one into the discovered empty slot */
+    while(move_index != key_index)
+    {
+        prev_move_index = map->index_mask & (move_index - 1);
+        map->entries[move_index] = map->entries[prev_move_index];
+        move_index = prev_move_index;
+    }
+
+    *entry_ptr = map->entries + key_index;
+
+    return SOL_MAP_SUCCESS_INSERTED;
+}
+
+/** replaces the current table (without freeing it) with an empty one twice the size */
+static void SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_allocate_larger_table__i)(struct SOL_HASH_MAP_TABLE_STRUCT_NAME* map)
+{
+    map->entry_space_exponent++;
+
+    map->entries = malloc(sizeof(SOL_HASH_MAP_ENTRY_TYPE) << map->entry_space_exponent);
+    map->identifiers = malloc(sizeof(SOL_HASH_MAP_IDENTIFIER_TYPE) << map->entry_space_exponent);
+    memset(map->identifiers, 0x00, sizeof(SOL_HASH_MAP_IDENTIFIER_TYPE) << map->entry_space_exponent);
+
+    if(map->entry_space_exponent == map->descriptor.entry_space_exponent_limit)
+    {
+        map->entry_limit = ((uint64_t)map->descriptor.limit_fill_factor << (map->entry_space_exponent-8));
+    }
+    else
+    {
+        map->entry_limit = ((uint64_t)map->descriptor.resize_fill_factor << (map->entry_space_exponent-8));
+    }
+
+    map->index_mask = (1llu << map->entry_space_exponent) - 1llu;
+}
+
+/** replaces the current table with a larger one, moving every entry in it across (the old table of an incremental resize is left alone)
+ * doubling the table keeps entries in the same order with no more displacement than before (an entry's home index either stays the same or moves up by the previous table size)
+ * so the first attempt should always succeed, but rather than lose entries a larger table is tried if it doesn't */
+static void SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_grow__i)(struct SOL_HASH_MAP_TABLE_STRUCT_NAME* map)
+{
+    SOL_HASH_MAP_ENTRY_TYPE* const previous_entries = map->entries;
+    SOL_HASH_MAP_IDENTIFIER_TYPE* const previous_identifiers = map->identifiers;
+    const uint64_t previous_index_mask = map->index_mask;
+    SOL_HASH_MAP_ENTRY_TYPE* entry_ptr;
+    uint64_t index;
+
+    do
+    {
+        if(map->entry_space_exponent == map->descriptor.entry_space_exponent_limit)
+        {
+            fprintf(stderr, "hash map could not place its entries in a table within its entry space limit (2^%u), the key hash is likely very poorly distributed\n", (unsigned)map->descriptor.entry_space_exponent_limit);
+            abort();
+        }
+
+        if(map->entries != previous_entries)
+        {
+            free(map->entries);
+            free(map->identifiers);
+        }
+
+        SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_allocate_larger_table__i)(map);
+
+        for(index = 0; index <= previous_index_mask; index++)
+        {
+            if(previous_identifiers[index])
+            {
+                if(SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_obtain_in_table__i)(map, SOL_HASH_MAP_KEY_FROM_ENTRY_CONTEXT(previous_entries + index), SOL_HASH_MAP_KEY_HASH_CONTEXT(SOL_HASH_MAP_KEY_FROM_ENTRY_CONTEXT(previous_entries + index)), &entry_ptr) != SOL_MAP_SUCCESS_INSERTED)
+                {
+                    break;
+                }
+                *entry_ptr = previous_entries[index];
+            }
+        }
+    }
+    while(index <= previous_index_mask);
+
+    free(previous_identifiers);
+    free(previous_entries);
+}
+
+#ifdef SOL_HASH_MAP_INCREMENTAL_RESIZE
+static inline bool SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_locate_in_old_table__i)(const struct SOL_HASH_MAP_TABLE_STRUCT_NAME* map, SOL_HASH_MAP_KEY_TYPE key, uint64_t key_hash, uint64_t* index)
+{
+    SOL_HASH_MAP_IDENTIFIER_TYPE key_identifier = (key_hash & SOL_HASH_MAP_IDENTIFIER_FRACTIONAL_HASH_MASK) | SOL_HASH_MAP_IDENTIFIER_MAXIMUM_DISPLACEMENT_CAPACITY;
+
+    if(map->old_entries == NULL)
+    {
+        return false;
+    }
+
+    *index = (key_hash >> SOL_HASH_MAP_IDENTIFIER_FRACTIONAL_HASH_BIT_COUNT) & map->old_index_mask;
+
+    return SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_locate__i)(map, map->old_entries, map->old_identifiers, map->old_index_mask, key, &key_identifier, index);
+}
+
+/** moves every entry in the next `bucket_count` indices of the old table to the current one
+ * emptying each index completely (evicting pulls following displaced entries back into it) means no entry left in the old table can have a home index before `migration_index`
+ * so lookups in the old table remain valid throughout
+ * entries inserted since the resize may leave no room for an old entry, in which case the current table is grown again
+ * if it is already at the entry space limit the migration stops where it is instead, to be resumed once removals have made room */
+static void SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_migrate__i)(struct SOL_HASH_MAP_TABLE_STRUCT_NAME* map, uint64_t bucket_count)
+{
+    SOL_HASH_MAP_ENTRY_TYPE* old_entry;
+    SOL_HASH_MAP_ENTRY_TYPE* entry_ptr;
+    enum sol_map_operation_result insert_result;
+
+    while(map->old_entries && bucket_count--)
+    {
+        while(map->old_identifiers[map->migration_index])
+        {
+            old_entry = map->old_entries + map->migration_index;
+
+            insert_result = SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_obtain_in_table__i)(map, SOL_HASH_MAP_KEY_FROM_ENTRY_CONTEXT(old_entry), SOL_HASH_MAP_KEY_HASH_CONTEXT(SOL_HASH_MAP_KEY_FROM_ENTRY_CONTEXT(old_entry)), &entry_ptr);
+
+            if(insert_result == SOL_MAP_FAIL_FULL)
+            {
+                if(map->entry_space_exponent == map->descriptor.entry_space_exponent_limit)
+                {
+                    return;
+                }
+                SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_grow__i)(map);
+                continue;
+            }
+            /** a key is only ever present in one of the tables */
+            assert(insert_result == SOL_MAP_SUCCESS_INSERTED);
+
+            *entry_ptr = *old_entry;
+            SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_evict_index__i)(map->old_entries, map->old_identifiers, map->old_index_mask, map->migration_index);
+        }
+
+        if(map->migration_index++ == map->old_index_mask)
+        {
+            free(map->old_identifiers);
+            free(map->old_entries);
+            map->old_identifiers = NULL;
+            map->old_entries = NULL;
+        }
+    }
+}
+#endif
+
+static void SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_resize__i)(struct SOL_HASH_MAP_TABLE_STRUCT_NAME* map)
+{
+    #ifdef SOL_HASH_MAP_INCREMENTAL_RESIZE
+    const uint8_t entry_space_exponent = map->entry_space_exponent;
+
+    /** can only have one old table, so any previous resize must be completed first (only happens if the map is growing unusually quickly) */
+    SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_migrate__i)(map, UINT64_MAX);
+
+    if(map->entry_space_exponent != entry_space_exponent)
+    {
+        /** completing the previous resize had to grow the table, which has made the space this resize was for */
+        return;
+    }
+    assert(map->old_entries == NULL);
+
+    map->old_entries = map->entries;
+    map->old_identifiers = map->identifiers;
+    map->old_index_mask = map->index_mask;
+    map->migration_index = 0;
+
+    SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_allocate_larger_table__i)(map);
+    #else
+    SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_grow__i)(map);
+    #endif
 }
 
 
 
 
 #ifdef SOL_HASH_MAP_CONTEXT_TYPE
-SOL_HASH_MAP_FUNCTION_KEYWORDS void SOL_CONCATENATE(SOL_HASH_MAP_FUNCTION_PREFIX,_initialise)(struct SOL_HASH_MAP_STRUCT_NAME* map, struct sol_hash_map_descriptor descriptor, SOL_HASH_MAP_CONTEXT_TYPE context)
+SOL_HASH_MAP_TABLE_FUNCTION_KEYWORDS void SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_initialise)(struct SOL_HASH_MAP_TABLE_STRUCT_NAME* map, struct sol_hash_map_descriptor descriptor, SOL_HASH_MAP_CONTEXT_TYPE context)
 #else
-SOL_HASH_MAP_FUNCTION_KEYWORDS void SOL_CONCATENATE(SOL_HASH_MAP_FUNCTION_PREFIX,_initialise)(struct SOL_HASH_MAP_STRUCT_NAME* map, struct sol_hash_map_descriptor descriptor)
+SOL_HASH_MAP_TABLE_FUNCTION_KEYWORDS void SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_initialise)(struct SOL_HASH_MAP_TABLE_STRUCT_NAME* map, struct sol_hash_map_descriptor descriptor)
 #endif
 {
     assert(sizeof(SOL_HASH_MAP_IDENTIFIER_TYPE) * CHAR_BIT >= SOL_HASH_MAP_IDENTIFIER_HASH_INDEX_BITS);
@@ -253,71 +539,125 @@ SOL_HASH_MAP_FUNCTION_KEYWORDS void SOL_CONCATENATE(SOL_HASH_MAP_FUNCTION_PREFIX
     }
 
     memset(map->identifiers, 0x00, sizeof(SOL_HASH_MAP_IDENTIFIER_TYPE) << descriptor.entry_space_exponent_initial);
+
+    #ifdef SOL_HASH_MAP_INCREMENTAL_RESIZE
+    map->old_entries = NULL;
+    map->old_identifiers = NULL;
+    map->old_index_mask = 0;
+    map->migration_index = 0;
+    #endif
 }
 
-SOL_HASH_MAP_FUNCTION_KEYWORDS void SOL_CONCATENATE(SOL_HASH_MAP_FUNCTION_PREFIX,_terminate)(struct SOL_HASH_MAP_STRUCT_NAME* map)
+SOL_HASH_MAP_TABLE_FUNCTION_KEYWORDS void SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_terminate)(struct SOL_HASH_MAP_TABLE_STRUCT_NAME* map)
 {
     free(map->entries);
     free(map->identifiers);
+
+    #ifdef SOL_HASH_MAP_INCREMENTAL_RESIZE
+    free(map->old_entries);
+    free(map->old_identifiers);
+    #endif
 }
 
 #ifdef SOL_HASH_MAP_CONTEXT_TYPE
-SOL_HASH_MAP_FUNCTION_KEYWORDS struct SOL_HASH_MAP_STRUCT_NAME* SOL_CONCATENATE(SOL_HASH_MAP_FUNCTION_PREFIX,_create)(struct sol_hash_map_descriptor descriptor, SOL_HASH_MAP_CONTEXT_TYPE context)
+SOL_HASH_MAP_TABLE_FUNCTION_KEYWORDS struct SOL_HASH_MAP_TABLE_STRUCT_NAME* SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_create)(struct sol_hash_map_descriptor descriptor, SOL_HASH_MAP_CONTEXT_TYPE context)
 {
-    struct SOL_HASH_MAP_STRUCT_NAME* map = malloc(sizeof(struct SOL_HASH_MAP_STRUCT_NAME));
-    SOL_CONCATENATE(SOL_HASH_MAP_FUNCTION_PREFIX,_initialise)(map, descriptor, context);
+    struct SOL_HASH_MAP_TABLE_STRUCT_NAME* map = malloc(sizeof(struct SOL_HASH_MAP_TABLE_STRUCT_NAME));
+    SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_initialise)(map, descriptor, context);
     return map;
 }
 #else
-SOL_HASH_MAP_FUNCTION_KEYWORDS struct SOL_HASH_MAP_STRUCT_NAME* SOL_CONCATENATE(SOL_HASH_MAP_FUNCTION_PREFIX,_create)(struct sol_hash_map_descriptor descriptor)
+SOL_HASH_MAP_TABLE_FUNCTION_KEYWORDS struct SOL_HASH_MAP_TABLE_STRUCT_NAME* SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_create)(struct sol_hash_map_descriptor descriptor)
 {
-    struct SOL_HASH_MAP_STRUCT_NAME* map = malloc(sizeof(struct SOL_HASH_MAP_STRUCT_NAME));
-    SOL_CONCATENATE(SOL_HASH_MAP_FUNCTION_PREFIX,_initialise)(map, descriptor);
+    struct SOL_HASH_MAP_TABLE_STRUCT_NAME* map = malloc(sizeof(struct SOL_HASH_MAP_TABLE_STRUCT_NAME));
+    SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_initialise)(map, descriptor);
     return map;
 }
 #endif
 
-SOL_HASH_MAP_FUNCTION_KEYWORDS void SOL_CONCATENATE(SOL_HASH_MAP_FUNCTION_PREFIX,_destroy)(struct SOL_HASH_MAP_STRUCT_NAME* map)
+SOL_HASH_MAP_TABLE_FUNCTION_KEYWORDS void SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_destroy)(struct SOL_HASH_MAP_TABLE_STRUCT_NAME* map)
 {
-    SOL_CONCATENATE(SOL_HASH_MAP_FUNCTION_PREFIX,_terminate)(map);
+    SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_terminate)(map);
     free(map);
 }
 
-SOL_HASH_MAP_FUNCTION_KEYWORDS void SOL_CONCATENATE(SOL_HASH_MAP_FUNCTION_PREFIX,_clear)(struct SOL_HASH_MAP_STRUCT_NAME* map)
+SOL_HASH_MAP_TABLE_FUNCTION_KEYWORDS void SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_clear)(struct SOL_HASH_MAP_TABLE_STRUCT_NAME* map)
 {
     map->entry_count = 0;
     memset(map->identifiers, 0x00, sizeof(SOL_HASH_MAP_IDENTIFIER_TYPE) << map->entry_space_exponent);
+
+    #ifdef SOL_HASH_MAP_INCREMENTAL_RESIZE
+    /** nothing is left to migrate, so any resize in progress is finished by discarding the old table */
+    free(map->old_entries);
+    free(map->old_identifiers);
+    map->old_entries = NULL;
+    map->old_identifiers = NULL;
+    #endif
+}
+
+/** completes any incremental resize in progress, so that subsequent operations don't pay for migration (does nothing unless `SOL_HASH_MAP_INCREMENTAL_RESIZE` is defined)
+ * returns false if the map is at its entry space limit with entries still to migrate, in which case migration resumes once removals have made room */
+SOL_HASH_MAP_TABLE_FUNCTION_KEYWORDS bool SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_settle)(struct SOL_HASH_MAP_TABLE_STRUCT_NAME* map)
+{
+    #ifdef SOL_HASH_MAP_INCREMENTAL_RESIZE
+    SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_migrate__i)(map, UINT64_MAX);
+    return map->old_entries == NULL;
+    #else
+    (void)map;
+    return true;
+    #endif
 }
 
 
 
-SOL_HASH_MAP_FUNCTION_KEYWORDS enum sol_map_operation_result SOL_CONCATENATE(SOL_HASH_MAP_FUNCTION_PREFIX,_find)(const struct SOL_HASH_MAP_STRUCT_NAME* map, SOL_HASH_MAP_KEY_TYPE key, SOL_HASH_MAP_ENTRY_TYPE** entry_ptr)
+static inline enum sol_map_operation_result SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_find_hashed__i)(const struct SOL_HASH_MAP_TABLE_STRUCT_NAME* map, SOL_HASH_MAP_KEY_TYPE key, uint64_t key_hash, SOL_HASH_MAP_ENTRY_TYPE** entry_ptr)
 {
-    const uint64_t key_hash = SOL_HASH_MAP_KEY_HASH_CONTEXT(key);
     SOL_HASH_MAP_IDENTIFIER_TYPE key_identifier = (key_hash & SOL_HASH_MAP_IDENTIFIER_FRACTIONAL_HASH_MASK) | SOL_HASH_MAP_IDENTIFIER_MAXIMUM_DISPLACEMENT_CAPACITY;
     uint64_t index = (key_hash >> SOL_HASH_MAP_IDENTIFIER_FRACTIONAL_HASH_BIT_COUNT) & map->index_mask;
 
-    if(SOL_CONCATENATE(SOL_HASH_MAP_FUNCTION_PREFIX,_locate__i)(map, key, &key_identifier, &index ))
+    if(SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_locate__i)(map, map->entries, map->identifiers, map->index_mask, key, &key_identifier, &index ))
     {
         *entry_ptr = map->entries + index;
         return SOL_MAP_SUCCESS_FOUND;
     }
 
+    #ifdef SOL_HASH_MAP_INCREMENTAL_RESIZE
+    /** migration is advanced by the callers before searching, never between finding an entry and returning it */
+    if(SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_locate_in_old_table__i)(map, key, key_hash, &index))
+    {
+        *entry_ptr = map->old_entries + index;
+        return SOL_MAP_SUCCESS_FOUND;
+    }
+    #endif
+
     *entry_ptr = NULL;
     return SOL_MAP_FAIL_ABSENT;
 }
 
-SOL_HASH_MAP_FUNCTION_KEYWORDS enum sol_map_operation_result SOL_CONCATENATE(SOL_HASH_MAP_FUNCTION_PREFIX,_obtain)(struct SOL_HASH_MAP_STRUCT_NAME* map, SOL_HASH_MAP_KEY_TYPE key, SOL_HASH_MAP_ENTRY_TYPE** entry_ptr)
+static inline enum sol_map_operation_result SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_obtain_hashed__i)(struct SOL_HASH_MAP_TABLE_STRUCT_NAME* map, SOL_HASH_MAP_KEY_TYPE key, uint64_t key_hash, SOL_HASH_MAP_ENTRY_TYPE** entry_ptr)
 {
-    const uint64_t key_hash = SOL_HASH_MAP_KEY_HASH_CONTEXT(key);
+    enum sol_map_operation_result result;
 
-    uint64_t key_index, move_index, prev_move_index;
-    SOL_HASH_MAP_IDENTIFIER_TYPE move_identifier, key_identifier, next_identifier, prev_identifier;
+    #ifdef SOL_HASH_MAP_INCREMENTAL_RESIZE
+    uint64_t old_index;
 
-    key_identifier = (key_hash & SOL_HASH_MAP_IDENTIFIER_FRACTIONAL_HASH_MASK);
+    SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_migrate__i)(map, SOL_HASH_MAP_INCREMENTAL_RESIZE_STEP);
+
+    if(SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_locate_in_old_table__i)(map, key, key_hash, &old_index))
+    {
+        *entry_ptr = map->old_entries + old_index;
+        return SOL_MAP_SUCCESS_FOUND;
+    }
+    #endif
 
     if(map->entry_count == map->entry_limit)
     {
+        /** a key that is already present needs no space, and resizing incrementally would move it out of reach of the insertion below */
+        if(SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_find_hashed__i)(map, key, key_hash, entry_ptr) == SOL_MAP_SUCCESS_FOUND)
+        {
+            return SOL_MAP_SUCCESS_FOUND;
+        }
+
         if(map->entry_space_exponent == map->descriptor.entry_space_exponent_limit)
         {
             *entry_ptr = NULL;
@@ -325,88 +665,173 @@ SOL_HASH_MAP_FUNCTION_KEYWORDS enum sol_map_operation_result SOL_CONCATENATE(SOL
         }
         else
         {
-            SOL_CONCATENATE(SOL_HASH_MAP_FUNCTION_PREFIX,_resize__i)(map);
+            SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_resize__i)(map);
+        }
+    }
+
+    while((result = SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_obtain_in_table__i)(map, key, key_hash, entry_ptr)) == SOL_MAP_FAIL_FULL)
+    {
+        if(map->entry_space_exponent == map->descriptor.entry_space_exponent_limit)
+        {
+            return SOL_MAP_FAIL_FULL;
         }
+
+        SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_resize__i)(map);
     }
 
-    obtain_for_map_size:
+    if(result == SOL_MAP_SUCCESS_INSERTED)
     {
-        key_identifier |= SOL_HASH_MAP_IDENTIFIER_MAXIMUM_DISPLACEMENT_CAPACITY;
-        key_index = (key_hash >> SOL_HASH_MAP_IDENTIFIER_FRACTIONAL_HASH_BIT_COUNT) & map->index_mask;
+        map->entry_count++;
+    }
+
+    return result;
+}
+
+SOL_HASH_MAP_TABLE_FUNCTION_KEYWORDS enum sol_map_operation_result SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_find)(SOL_HASH_MAP_FIND_MAP_QUALIFIER struct SOL_HASH_MAP_TABLE_STRUCT_NAME* map, SOL_HASH_MAP_KEY_TYPE key, SOL_HASH_MAP_ENTRY_TYPE** entry_ptr)
+{
+    #ifdef SOL_HASH_MAP_INCREMENTAL_RESIZE
+    SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_migrate__i)(map, SOL_HASH_MAP_INCREMENTAL_RESIZE_STEP);
+    #endif
+
+    return SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_find_hashed__i)(map, key, SOL_HASH_MAP_KEY_HASH_CONTEXT(key), entry_ptr);
+}
+
+SOL_HASH_MAP_TABLE_FUNCTION_KEYWORDS enum sol_map_operation_result SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_obtain)(struct SOL_HASH_MAP_TABLE_STRUCT_NAME* map, SOL_HASH_MAP_KEY_TYPE key, SOL_HASH_MAP_ENTRY_TYPE** entry_ptr)
+{
+    return SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_obtain_hashed__i)(map, key, SOL_HASH_MAP_KEY_HASH_CONTEXT(key), entry_ptr);
+}
 
-        if(SOL_CONCATENATE(SOL_HASH_MAP_FUNCTION_PREFIX,_locate__i)(map, key, &key_identifier, &key_index))
+/** request the home bucket of a key be brought into cache so that it can be resolved later without stalling */
+static inline void SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_prefetch__i)(const struct SOL_HASH_MAP_TABLE_STRUCT_NAME* map, uint64_t key_hash)
+{
+    const uint64_t index = (key_hash >> SOL_HASH_MAP_IDENTIFIER_FRACTIONAL_HASH_BIT_COUNT) & map->index_mask;
+
+    __builtin_prefetch(map->identifiers + index);
+    __builtin_prefetch(map->entries + index);
+
+    #ifdef SOL_HASH_MAP_INCREMENTAL_RESIZE
+    if(map->old_identifiers)
+    {
+        __builtin_prefetch(map->old_identifiers + ((key_hash >> SOL_HASH_MAP_IDENTIFIER_FRACTIONAL_HASH_BIT_COUNT) & map->old_index_mask));
+    }
+    #endif
+}
+
+/** same as calling find for every key, but a batch of keys are hashed and have their home buckets prefetched before any are resolved, hiding the cache misses of large maps
+ * `entry_ptrs` and `results` must have space for `count` elements, as with find the pointers are invalidated by any function that modifies the map
+ * returns the number of keys found */
+SOL_HASH_MAP_TABLE_FUNCTION_KEYWORDS uint64_t SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_find_many)(SOL_HASH_MAP_FIND_MAP_QUALIFIER struct SOL_HASH_MAP_TABLE_STRUCT_NAME* map, const SOL_HASH_MAP_KEY_TYPE* keys, uint64_t count, SOL_HASH_MAP_ENTRY_TYPE** entry_ptrs, enum sol_map_operation_result* results)
+{
+    uint64_t key_hashes[SOL_HASH_MAP_BATCH_SIZE];
+    uint64_t batch_start, batch_count, i, found_count;
+
+    found_count = 0;
+
+    #ifdef SOL_HASH_MAP_INCREMENTAL_RESIZE
+    /** migrating between batches would move entries already returned, so it only happens once up front */
+    SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_migrate__i)(map, SOL_HASH_MAP_INCREMENTAL_RESIZE_STEP);
+    #endif
+
+    for(batch_start = 0; batch_start < count; batch_start += batch_count)
+    {
+        batch_count = SOL_MIN(count - batch_start, SOL_HASH_MAP_BATCH_SIZE);
+
+        for(i = 0; i < batch_count; i++)
         {
-            *entry_ptr = map->entries + key_index;
-            return SOL_MAP_SUCCESS_FOUND;
+            key_hashes[i] = SOL_HASH_MAP_KEY_HASH_CONTEXT(keys[batch_start + i]);
+            SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_prefetch__i)(map, key_hashes[i]);
         }
 
-        move_identifier = key_identifier;
-        move_index      = key_index;
-        /** ^ note: initially checking that the entry being added is being added at a valid location
-         * this flow attempts to continually move the move identifier into the move_index location as long as its identifier is larger */
-        while(true)
+        for(i = 0; i < batch_count; i++)
         {
-            if(move_identifier < SOL_HASH_MAP_IDENTIFIER_MINIMUM_DISPLACEMENT_CAPACITY)
-            {
-                /** fail case; unwind identifier changes and either return failure or resize the hash map */
-                while(move_index != key_index)
-                {
-                    /** move backwards: pick up identifier and replace with move identifier */
-                    assert(move_identifier < SOL_HASH_MAP_IDENTIFIER_MAXIMUM_DISPLACEMENT_CAPACITY);
+            results[batch_start + i] = SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_find_hashed__i)(map, keys[batch_start + i], key_hashes[i], entry_ptrs + batch_start + i);
+            found_count += results[batch_start + i] == SOL_MAP_SUCCESS_FOUND;
+        }
+    }
 
-                    move_index = map->index_mask & (move_index - 1);
+    return found_count;
+}
 
-                    prev_identifier = map->identifiers[move_index];
-                    map->identifiers[move_index] = move_identifier + SOL_HASH_MAP_IDENTIFIER_OFFSET_UNIT;
-                    move_identifier = prev_identifier;
-                }
+/** same as calling obtain for the key of every entry in `entries` (with prefetching as in find_many) except that an inserted entry is initialised as a copy of the corresponding element of `entries`
+ * so `entries` need only have their keys set, the rest of an inserted entry can be filled in through the returned pointer
+ * inserting may move other entries, so if anything was inserted every key is located again at the end, meaning (unlike repeated calls to obtain) ALL returned pointers are valid until the map is next modified
+ * a key present more than once is inserted for its first appearance and found for the rest, a key that could not be inserted gets SOL_MAP_FAIL_FULL and a NULL pointer
+ * returns the number of entries inserted */
+SOL_HASH_MAP_TABLE_FUNCTION_KEYWORDS uint64_t SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_obtain_many)(struct SOL_HASH_MAP_TABLE_STRUCT_NAME* map, const SOL_HASH_MAP_ENTRY_TYPE* entries, uint64_t count, SOL_HASH_MAP_ENTRY_TYPE** entry_ptrs, enum sol_map_operation_result* results)
+{
+    uint64_t key_hashes[SOL_HASH_MAP_BATCH_SIZE];
+    uint64_t batch_start, batch_count, i, inserted_count;
+    bool moved;
 
-                if(map->entry_space_exponent == map->descriptor.entry_space_exponent_limit)
-                {
-                    *entry_ptr = NULL;
-                    return SOL_MAP_FAIL_FULL;
-                }
-                else
-                {
-                    SOL_CONCATENATE(SOL_HASH_MAP_FUNCTION_PREFIX,_resize__i)(map);
-                    goto obtain_for_map_size;
-                }
-            }
+    inserted_count = 0;
+    moved = false;
+
+    for(batch_start = 0; batch_start < count; batch_start += batch_count)
+    {
+        batch_count = SOL_MIN(count - batch_start, SOL_HASH_MAP_BATCH_SIZE);
 
-            /** move forwards */
-            next_identifier = map->identifiers[move_index];
-            map->identifiers[move_index] = move_identifier;
+        for(i = 0; i < batch_count; i++)
+        {
+            key_hashes[i] = SOL_HASH_MAP_KEY_HASH_CONTEXT(SOL_HASH_MAP_KEY_FROM_ENTRY_CONTEXT(entries + batch_start + i));
+            SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_prefetch__i)(map, key_hashes[i]);
+        }
 
-            if(next_identifier == 0)
+        for(i = 0; i < batch_count; i++)
+        {
+            #ifdef SOL_HASH_MAP_INCREMENTAL_RESIZE
+            /** obtain moves entries out of the old table while resizing */
+            moved |= map->old_entries != NULL;
+            #endif
+
+            results[batch_start + i] = SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_obtain_hashed__i)(map, SOL_HASH_MAP_KEY_FROM_ENTRY_CONTEXT(entries + batch_start + i), key_hashes[i], entry_ptrs + batch_start + i);
+
+            switch (results[batch_start + i])
             {
+            case SOL_MAP_SUCCESS_INSERTED:
+                *entry_ptrs[batch_start + i] = entries[batch_start + i];
+                inserted_count++;
+                moved = true;
                 break;
+            case SOL_MAP_FAIL_FULL:
+                /** a resize may have been performed before failing */
+                entry_ptrs[batch_start + i] = NULL;
+                moved = true;
+            default:;
             }
-
-            move_identifier = next_identifier - SOL_HASH_MAP_IDENTIFIER_OFFSET_UNIT;
-            move_index = map->index_mask & (move_index + 1);
         }
     }
 
-    /** shift everything forward one into the discovered empty slot */
-    while(move_index != key_index)
+    if(moved)
     {
-        prev_move_index = map->index_mask & (move_index - 1);
-        map->entries[move_index] = map->entries[prev_move_index];
-        move_index = prev_move_index;
-    }
+        for(batch_start = 0; batch_start < count; batch_start += batch_count)
+        {
+            batch_count = SOL_MIN(count - batch_start, SOL_HASH_MAP_BATCH_SIZE);
 
-    *entry_ptr = map->entries + key_index;
-    map->entry_count++;
+            for(i = 0; i < batch_count; i++)
+            {
+                key_hashes[i] = SOL_HASH_MAP_KEY_HASH_CONTEXT(SOL_HASH_MAP_KEY_FROM_ENTRY_CONTEXT(entries + batch_start + i));
+                SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_prefetch__i)(map, key_hashes[i]);
+            }
 
-    return SOL_MAP_SUCCESS_INSERTED;
+            for(i = 0; i < batch_count; i++)
+            {
+                if(results[batch_start + i] != SOL_MAP_FAIL_FULL)
+                {
+                    SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_find_hashed__i)(map, SOL_HASH_MAP_KEY_FROM_ENTRY_CONTEXT(entries + batch_start + i), key_hashes[i], entry_ptrs + batch_start + i);
+                }
+            }
+        }
+    }
+
+    return inserted_count;
 }
 
-SOL_HASH_MAP_FUNCTION_KEYWORDS enum sol_map_operation_result SOL_CONCATENATE(SOL_HASH_MAP_FUNCTION_PREFIX,_insert)(struct SOL_HASH_MAP_STRUCT_NAME* map, const SOL_HASH_MAP_ENTRY_TYPE* entry)
+SOL_HASH_MAP_TABLE_FUNCTION_KEYWORDS enum sol_map_operation_result SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_insert)(struct SOL_HASH_MAP_TABLE_STRUCT_NAME* map, const SOL_HASH_MAP_ENTRY_TYPE* entry)
 {
     SOL_HASH_MAP_ENTRY_TYPE* entry_ptr;
     enum sol_map_operation_result result;
 
-    result = SOL_CONCATENATE(SOL_HASH_MAP_FUNCTION_PREFIX,_obtain)(map, SOL_HASH_MAP_KEY_FROM_ENTRY_CONTEXT(entry), &entry_ptr);
+    result = SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_obtain)(map, SOL_HASH_MAP_KEY_FROM_ENTRY_CONTEXT(entry), &entry_ptr);
 
     switch (result)
     {
@@ -418,35 +843,257 @@ SOL_HASH_MAP_FUNCTION_KEYWORDS enum sol_map_operation_result SOL_CONCATENATE(SOL
     return result;
 }
 
-SOL_HASH_MAP_FUNCTION_KEYWORDS enum sol_map_operation_result SOL_CONCATENATE(SOL_HASH_MAP_FUNCTION_PREFIX,_remove)(struct SOL_HASH_MAP_STRUCT_NAME* map, SOL_HASH_MAP_KEY_TYPE key, SOL_HASH_MAP_ENTRY_TYPE* entry)
+SOL_HASH_MAP_TABLE_FUNCTION_KEYWORDS enum sol_map_operation_result SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_remove)(struct SOL_HASH_MAP_TABLE_STRUCT_NAME* map, SOL_HASH_MAP_KEY_TYPE key, SOL_HASH_MAP_ENTRY_TYPE* entry)
 {
     const uint64_t key_hash = SOL_HASH_MAP_KEY_HASH_CONTEXT(key);
 
     SOL_HASH_MAP_IDENTIFIER_TYPE key_identifier = (key_hash & SOL_HASH_MAP_IDENTIFIER_FRACTIONAL_HASH_MASK) | SOL_HASH_MAP_IDENTIFIER_MAXIMUM_DISPLACEMENT_CAPACITY;
     uint64_t index = (key_hash >> SOL_HASH_MAP_IDENTIFIER_FRACTIONAL_HASH_BIT_COUNT) & map->index_mask;
 
-    if(SOL_CONCATENATE(SOL_HASH_MAP_FUNCTION_PREFIX,_locate__i)(map, key, &key_identifier, &index ))
+    #ifdef SOL_HASH_MAP_INCREMENTAL_RESIZE
+    SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_migrate__i)(map, SOL_HASH_MAP_INCREMENTAL_RESIZE_STEP);
+    #endif
+
+    if(SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_locate__i)(map, map->entries, map->identifiers, map->index_mask, key, &key_identifier, &index ))
     {
         if(entry)
         {
             *entry = map->entries[index];
         }
-        SOL_CONCATENATE(SOL_HASH_MAP_FUNCTION_PREFIX,_evict_index__i)(map, index);
+        SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_evict_index__i)(map->entries, map->identifiers, map->index_mask, index);
+        map->entry_count--;
+        return SOL_MAP_SUCCESS_REMOVED;
+    }
+
+    #ifdef SOL_HASH_MAP_INCREMENTAL_RESIZE
+    if(SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_locate_in_old_table__i)(map, key, key_hash, &index))
+    {
+        if(entry)
+        {
+            *entry = map->old_entries[index];
+        }
+        SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_evict_index__i)(map->old_entries, map->old_identifiers, map->old_index_mask, index);
+        map->entry_count--;
         return SOL_MAP_SUCCESS_REMOVED;
     }
+    #endif
 
     return SOL_MAP_FAIL_ABSENT;
 }
 
-SOL_HASH_MAP_FUNCTION_KEYWORDS void SOL_CONCATENATE(SOL_HASH_MAP_FUNCTION_PREFIX,_delete_entry)(struct SOL_HASH_MAP_STRUCT_NAME* map, SOL_HASH_MAP_ENTRY_TYPE* entry_ptr)
+SOL_HASH_MAP_TABLE_FUNCTION_KEYWORDS void SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_delete_entry)(struct SOL_HASH_MAP_TABLE_STRUCT_NAME* map, SOL_HASH_MAP_ENTRY_TYPE* entry_ptr)
 {
+    #ifdef SOL_HASH_MAP_INCREMENTAL_RESIZE
+    if(map->old_entries && entry_ptr >= map->old_entries && entry_ptr <= map->old_entries + map->old_index_mask)
+    {
+        SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_evict_index__i)(map->old_entries, map->old_identifiers, map->old_index_mask, entry_ptr - map->old_entries);
+        map->entry_count--;
+        return;
+    }
+    #endif
+
     const uint64_t index = entry_ptr - map->entries;
     assert(entry_ptr >= map->entries);
     assert(entry_ptr < map->entries + (1 << map->entry_space_exponent));
-    SOL_CONCATENATE(SOL_HASH_MAP_FUNCTION_PREFIX,_evict_index__i)(map, index);
+    SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_evict_index__i)(map->entries, map->identifiers, map->index_mask, index);
+    map->entry_count--;
 }
 
 
+#ifdef SOL_HASH_MAP_SHARDED
+
+static_assert(SOL_HASH_MAP_SHARD_EXPONENT > 0 && SOL_HASH_MAP_SHARD_EXPONENT < 16, "hash map shard exponent must be in [1,15]");
+
+#define SOL_HASH_MAP_SHARD_COUNT ((uint64_t)1 << SOL_HASH_MAP_SHARD_EXPONENT)
+
+struct SOL_HASH_MAP_STRUCT_NAME
+{
+    struct
+    {
+        mtx_t mutex;
+        struct SOL_HASH_MAP_TABLE_STRUCT_NAME table;
+    }
+    shards[SOL_HASH_MAP_SHARD_COUNT];
+
+    #ifdef SOL_HASH_MAP_CONTEXT_TYPE
+    SOL_HASH_MAP_CONTEXT_TYPE context;
+    #endif
+};
+
+/** the tables use the low bits of the hash, so the shard is selected with the high bits to keep the two independent */
+static inline uint64_t SOL_CONCATENATE(SOL_HASH_MAP_FUNCTION_PREFIX,_shard_index__i)(const struct SOL_HASH_MAP_STRUCT_NAME* map, SOL_HASH_MAP_KEY_TYPE key)
+{
+    return SOL_HASH_MAP_KEY_HASH_CONTEXT(key) >> (64 - SOL_HASH_MAP_SHARD_EXPONENT);
+}
+
+/** the descriptor describes the whole map, each shard gets an even share of its entry space */
+#ifdef SOL_HASH_MAP_CONTEXT_TYPE
+SOL_HASH_MAP_FUNCTION_KEYWORDS void SOL_CONCATENATE(SOL_HASH_MAP_FUNCTION_PREFIX,_initialise)(struct SOL_HASH_MAP_STRUCT_NAME* map, struct sol_hash_map_descriptor descriptor, SOL_HASH_MAP_CONTEXT_TYPE context)
+#else
+SOL_HASH_MAP_FUNCTION_KEYWORDS void SOL_CONCATENATE(SOL_HASH_MAP_FUNCTION_PREFIX,_initialise)(struct SOL_HASH_MAP_STRUCT_NAME* map, struct sol_hash_map_descriptor descriptor)
+#endif
+{
+    struct sol_hash_map_descriptor shard_descriptor;
+    uint64_t i;
+
+    shard_descriptor = descriptor;
+    shard_descriptor.entry_space_exponent_initial = (descriptor.entry_space_exponent_initial > 8 + SOL_HASH_MAP_SHARD_EXPONENT) ? descriptor.entry_space_exponent_initial - SOL_HASH_MAP_SHARD_EXPONENT : 8;
+    shard_descriptor.entry_space_exponent_limit = (descriptor.entry_space_exponent_limit > shard_descriptor.entry_space_exponent_initial + SOL_HASH_MAP_SHARD_EXPONENT) ? descriptor.entry_space_exponent_limit - SOL_HASH_MAP_SHARD_EXPONENT : shard_descriptor.entry_space_exponent_initial;
+
+    #ifdef SOL_HASH_MAP_CONTEXT_TYPE
+    map->context = context;
+    #endif
+
+    for(i = 0; i < SOL_HASH_MAP_SHARD_COUNT; i++)
+    {
+        if(mtx_init(&map->shards[i].mutex, mtx_plain) != thrd_success)
+        {
+            fprintf(stderr, "hash map could not initialise the mutex of a shard\n");
+            abort();
+        }
+
+        #ifdef SOL_HASH_MAP_CONTEXT_TYPE
+        SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_initialise)(&map->shards[i].table, shard_descriptor, context);
+        #else
+        SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_initialise)(&map->shards[i].table, shard_descriptor);
+        #endif
+    }
+}
+
+SOL_HASH_MAP_FUNCTION_KEYWORDS void SOL_CONCATENATE(SOL_HASH_MAP_FUNCTION_PREFIX,_terminate)(struct SOL_HASH_MAP_STRUCT_NAME* map)
+{
+    uint64_t i;
+
+    for(i = 0; i < SOL_HASH_MAP_SHARD_COUNT; i++)
+    {
+        SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_terminate)(&map->shards[i].table);
+        mtx_destroy(&map->shards[i].mutex);
+    }
+}
+
+#ifdef SOL_HASH_MAP_CONTEXT_TYPE
+SOL_HASH_MAP_FUNCTION_KEYWORDS struct SOL_HASH_MAP_STRUCT_NAME* SOL_CONCATENATE(SOL_HASH_MAP_FUNCTION_PREFIX,_create)(struct sol_hash_map_descriptor descriptor, SOL_HASH_MAP_CONTEXT_TYPE context)
+{
+    struct SOL_HASH_MAP_STRUCT_NAME* map = malloc(sizeof(struct SOL_HASH_MAP_STRUCT_NAME));
+    SOL_CONCATENATE(SOL_HASH_MAP_FUNCTION_PREFIX,_initialise)(map, descriptor, context);
+    return map;
+}
+#else
+SOL_HASH_MAP_FUNCTION_KEYWORDS struct SOL_HASH_MAP_STRUCT_NAME* SOL_CONCATENATE(SOL_HASH_MAP_FUNCTION_PREFIX,_create)(struct sol_hash_map_descriptor descriptor)
+{
+    struct SOL_HASH_MAP_STRUCT_NAME* map = malloc(sizeof(struct SOL_HASH_MAP_STRUCT_NAME));
+    SOL_CONCATENATE(SOL_HASH_MAP_FUNCTION_PREFIX,_initialise)(map, descriptor);
+    return map;
+}
+#endif
+
+SOL_HASH_MAP_FUNCTION_KEYWORDS void SOL_CONCATENATE(SOL_HASH_MAP_FUNCTION_PREFIX,_destroy)(struct SOL_HASH_MAP_STRUCT_NAME* map)
+{
+    SOL_CONCATENATE(SOL_HASH_MAP_FUNCTION_PREFIX,_terminate)(map);
+    free(map);
+}
+
+/** shards are cleared one at a time, so this is not atomic with respect to other threads accessing the map */
+SOL_HASH_MAP_FUNCTION_KEYWORDS void SOL_CONCATENATE(SOL_HASH_MAP_FUNCTION_PREFIX,_clear)(struct SOL_HASH_MAP_STRUCT_NAME* map)
+{
+    uint64_t i;
+
+    for(i = 0; i < SOL_HASH_MAP_SHARD_COUNT; i++)
+    {
+        mtx_lock(&map->shards[i].mutex);
+        SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_clear)(&map->shards[i].table);
+        mtx_unlock(&map->shards[i].mutex);
+    }
+}
+
+/** settles every shard in turn, returns false if any could not complete its resize */
+SOL_HASH_MAP_FUNCTION_KEYWORDS bool SOL_CONCATENATE(SOL_HASH_MAP_FUNCTION_PREFIX,_settle)(struct SOL_HASH_MAP_STRUCT_NAME* map)
+{
+    uint64_t i;
+    bool settled = true;
+
+    for(i = 0; i < SOL_HASH_MAP_SHARD_COUNT; i++)
+    {
+        mtx_lock(&map->shards[i].mutex);
+        settled = SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_settle)(&map->shards[i].table) && settled;
+        mtx_unlock(&map->shards[i].mutex);
+    }
+
+    return settled;
+}
+
+/** if found copies the entry into `entry` (when non-null) */
+SOL_HASH_MAP_FUNCTION_KEYWORDS enum sol_map_operation_result SOL_CONCATENATE(SOL_HASH_MAP_FUNCTION_PREFIX,_find)(struct SOL_HASH_MAP_STRUCT_NAME* map, SOL_HASH_MAP_KEY_TYPE key, SOL_HASH_MAP_ENTRY_TYPE* entry)
+{
+    const uint64_t shard_index = SOL_CONCATENATE(SOL_HASH_MAP_FUNCTION_PREFIX,_shard_index__i)(map, key);
+    SOL_HASH_MAP_ENTRY_TYPE* entry_ptr;
+    enum sol_map_operation_result result;
+
+    mtx_lock(&map->shards[shard_index].mutex);
+    result = SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_find)(&map->shards[shard_index].table, key, &entry_ptr);
+    if(result == SOL_MAP_SUCCESS_FOUND && entry)
+    {
+        *entry = *entry_ptr;
+    }
+    mtx_unlock(&map->shards[shard_index].mutex);
+
+    return result;
+}
+
+/** effectively "find or insert": if the key is present its entry is copied into `entry`, otherwise the contents of `entry` are inserted
+ * this lets racing threads agree on a single entry per key, the one that gets SOL_MAP_SUCCESS_INSERTED is the one whose entry was used */
+SOL_HASH_MAP_FUNCTION_KEYWORDS enum sol_map_operation_result SOL_CONCATENATE(SOL_HASH_MAP_FUNCTION_PREFIX,_obtain)(struct SOL_HASH_MAP_STRUCT_NAME* map, SOL_HASH_MAP_KEY_TYPE key, SOL_HASH_MAP_ENTRY_TYPE* entry)
+{
+    const uint64_t shard_index = SOL_CONCATENATE(SOL_HASH_MAP_FUNCTION_PREFIX,_shard_index__i)(map, key);
+    SOL_HASH_MAP_ENTRY_TYPE* entry_ptr;
+    enum sol_map_operation_result result;
+
+    mtx_lock(&map->shards[shard_index].mutex);
+    result = SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_obtain)(&map->shards[shard_index].table, key, &entry_ptr);
+    switch (result)
+    {
+    case SOL_MAP_SUCCESS_FOUND:
+        *entry = *entry_ptr;
+        break;
+    case SOL_MAP_SUCCESS_INSERTED:
+        *entry_ptr = *entry;
+    default:;
+    }
+    mtx_unlock(&map->shards[shard_index].mutex);
+
+    return result;
+}
+
+/** inserts or replaces the entry with the same key */
+SOL_HASH_MAP_FUNCTION_KEYWORDS enum sol_map_operation_result SOL_CONCATENATE(SOL_HASH_MAP_FUNCTION_PREFIX,_insert)(struct SOL_HASH_MAP_STRUCT_NAME* map, const SOL_HASH_MAP_ENTRY_TYPE* entry)
+{
+    const uint64_t shard_index = SOL_CONCATENATE(SOL_HASH_MAP_FUNCTION_PREFIX,_shard_index__i)(map, SOL_HASH_MAP_KEY_FROM_ENTRY_CONTEXT(entry));
+    enum sol_map_operation_result result;
+
+    mtx_lock(&map->shards[shard_index].mutex);
+    result = SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_insert)(&map->shards[shard_index].table, entry);
+    mtx_unlock(&map->shards[shard_index].mutex);
+
+    return result;
+}
+
+/** if found copies the entry into `entry` (when non-null) before removing it */
+SOL_HASH_MAP_FUNCTION_KEYWORDS enum sol_map_operation_result SOL_CONCATENATE(SOL_HASH_MAP_FUNCTION_PREFIX,_remove)(struct SOL_HASH_MAP_STRUCT_NAME* map, SOL_HASH_MAP_KEY_TYPE key, SOL_HASH_MAP_ENTRY_TYPE* entry)
+{
+    const uint64_t shard_index = SOL_CONCATENATE(SOL_HASH_MAP_FUNCTION_PREFIX,_shard_index__i)(map, key);
+    enum sol_map_operation_result result;
+
+    mtx_lock(&map->shards[shard_index].mutex);
+    result = SOL_CONCATENATE(SOL_HASH_MAP_TABLE_FUNCTION_PREFIX,_remove)(&map->shards[shard_index].table, key, entry);
+    mtx_unlock(&map->shards[shard_index].mutex);
+
+    return result;
+}
+
+#undef SOL_HASH_MAP_SHARD_COUNT
+#endif
+
+
 #undef SOL_HASH_MAP_STRUCT_NAME
 #undef SOL_HASH_MAP_FUNCTION_PREFIX
 #undef SOL_HASH_MAP_KEY_TYPE
@@ -457,6 +1104,22 @@ SOL_HASH_MAP_FUNCTION_KEYWORDS void SOL_CONCATENATE(SOL_HASH_MAP_FUNCTION_PREFIX
 #undef SOL_HASH_MAP_KEY_FROM_ENTRY
 #undef SOL_HASH_MAP_IDENTIFIER_TYPE
 #undef SOL_HASH_MAP_IDENTIFIER_HASH_INDEX_BITS
+#ifdef SOL_HASH_MAP_IDENTIFIER_GROUP_PROBE
+#undef SOL_HASH_MAP_IDENTIFIER_GROUP_PROBE
+#endif
+#ifdef SOL_HASH_MAP_INCREMENTAL_RESIZE
+#undef SOL_HASH_MAP_INCREMENTAL_RESIZE
+#undef SOL_HASH_MAP_INCREMENTAL_RESIZE_STEP
+#undef SOL_HASH_MAP_FIND_MAP_QUALIFIER
+#endif
+#undef SOL_HASH_MAP_BATCH_SIZE
+#ifdef SOL_HASH_MAP_SHARDED
+#undef SOL_HASH_MAP_SHARDED
+#undef SOL_HASH_MAP_SHARD_EXPONENT
+#endif
+#undef SOL_HASH_MAP_TABLE_STRUCT_NAME
+#undef SOL_HASH_MAP_TABLE_FUNCTION_PREFIX
+#undef SOL_HASH_MAP_TABLE_FUNCTION_KEYWORDS
 
 #undef SOL_HASH_MAP_IDENTIFIER_OFFSET_SHIFT
 #undef SOL_HASH_MAP_IDENTIFIER_FRACTIONAL_HASH_BIT_COUNT
@@ -47,10 +47,15 @@ along with solipsix.  If not, see <https://www.gnu.org/licenses/>.
 #endif
 
 
+/** optionally define SOL_LIMITED_CACHE_KEY_HASH(SOL_LIMITED_CACHE_KEY_TYPE K) returning a uint64_t (only the low 32 bits are used)
+ * this adds a hashed index of the entries so that find/obtain don't have to search every entry in the cache, which is strongly suggested for caches with more than a few dozen entries */
+
 #ifdef SOL_LIMITED_CACHE_CONTEXT_TYPE
 #define SOL_LIMITED_CACHE_CMP_EQ_CONTEXT(E, K) SOL_LIMITED_CACHE_CMP_EQ(E, K, context)
+#define SOL_LIMITED_CACHE_KEY_HASH_CONTEXT(K) SOL_LIMITED_CACHE_KEY_HASH(K, context)
 #else
 #define SOL_LIMITED_CACHE_CMP_EQ_CONTEXT(E, K) SOL_LIMITED_CACHE_CMP_EQ(E, K)
+#define SOL_LIMITED_CACHE_KEY_HASH_CONTEXT(K) SOL_LIMITED_CACHE_KEY_HASH(K)
 #endif
 
 
@@ -59,22 +64,44 @@ along with solipsix.  If not, see <https://www.gnu.org/licenses/>.
 struct SOL_LIMITED_CACHE_STRUCT_NAME
 {
     SOL_LIMITED_CACHE_ENTRY_TYPE* entries;
-    struct sol_cache_link_u16* links;
-    uint16_t header_link_index;
-    uint16_t first_free;
-    uint16_t count;
+    struct sol_cache_link_u32* links;
+    uint32_t header_link_index;/** also the number of entries the cache can hold */
+    uint32_t first_free;
+    uint32_t count;
+
+    #ifdef SOL_LIMITED_CACHE_KEY_HASH
+    /** open addressed (linear probing) table of entry indices, kept at most half full
+     * `entry_hashes[i]` is the hash of the key of `entries[i]`, stored so that entries can be removed from the index without a key */
+    uint32_t* hash_index;
+    uint32_t* entry_hashes;
+    uint32_t hash_index_mask;
+    #endif
 };
 
-static inline void SOL_CONCATENATE(SOL_LIMITED_CACHE_FUNCTION_PREFIX,_initialise)(struct SOL_LIMITED_CACHE_STRUCT_NAME* cache, uint16_t size)
+static inline void SOL_CONCATENATE(SOL_LIMITED_CACHE_FUNCTION_PREFIX,_initialise)(struct SOL_LIMITED_CACHE_STRUCT_NAME* cache, uint32_t size)
 {
+    const size_t links_offset = sol_u64_align(sizeof(SOL_LIMITED_CACHE_ENTRY_TYPE) * size, _Alignof(struct sol_cache_link_u32));
+
     assert(size >= 2);
-    assert(size <= 1024);/** it is strongly suggested that another approach is used instead for the cache size requested */
+    assert(size < SOL_U32_INVALID >> 2);
+    #ifndef SOL_LIMITED_CACHE_KEY_HASH
+    assert(size <= 1024);/** searching this many entries linearly is already slow, SOL_LIMITED_CACHE_KEY_HASH should be defined for larger caches */
+    #endif
+
     /** NOTE: links buffer is end of entries buffer (they are a single allocation) */
-    cache->entries = malloc((sizeof(SOL_LIMITED_CACHE_ENTRY_TYPE) + sizeof(struct sol_cache_link_u16)) * (size+1));
-    cache->links = (struct sol_cache_link_u16*)(cache->entries + size);
+    cache->entries = malloc(links_offset + sizeof(struct sol_cache_link_u32) * (size+1));
+    cache->links = (struct sol_cache_link_u32*)((char*)cache->entries + links_offset);
     cache->count = 0;
     cache->first_free = size - 1;
 
+    #ifdef SOL_LIMITED_CACHE_KEY_HASH
+    cache->hash_index_mask = (1u << (sol_u32_exp_ge(size) + 1)) - 1u;
+    /** NOTE: entry hashes are the end of the hash index (they are a single allocation) */
+    cache->hash_index = malloc(sizeof(uint32_t) * (cache->hash_index_mask + 1 + size));
+    cache->entry_hashes = cache->hash_index + cache->hash_index_mask + 1;
+    memset(cache->hash_index, 0xFF, sizeof(uint32_t) * (cache->hash_index_mask + 1));
+    #endif
+
     /** cache is a ring buffer */
     cache->header_link_index = size;
     cache->links[size].newer = size;
@@ -83,9 +110,9 @@ static inline void SOL_CONCATENATE(SOL_LIMITED_CACHE_FUNCTION_PREFIX,_initialise
     while(size--)
     {
         cache->links[size].newer = size - 1;
-        cache->links[size].older = SOL_U16_INVALID;/*not needed*/
+        cache->links[size].older = SOL_U32_INVALID;/*not needed*/
     }
-    assert(cache->links[0].newer == SOL_U16_INVALID);
+    assert(cache->links[0].newer == SOL_U32_INVALID);
 }
 
 static inline void SOL_CONCATENATE(SOL_LIMITED_CACHE_FUNCTION_PREFIX,_terminate)(struct SOL_LIMITED_CACHE_STRUCT_NAME* cache)
@@ -97,13 +124,91 @@ static inline void SOL_CONCATENATE(SOL_LIMITED_CACHE_FUNCTION_PREFIX,_terminate)
 
     /** NOTE: links buffer is end of entries buffer (they are a single allocation) */
     free(cache->entries);
+
+    #ifdef SOL_LIMITED_CACHE_KEY_HASH
+    free(cache->hash_index);
+    #endif
+}
+
+#ifdef SOL_LIMITED_CACHE_KEY_HASH
+static inline void SOL_CONCATENATE(SOL_LIMITED_CACHE_FUNCTION_PREFIX,_hash_index_insert__i)(struct SOL_LIMITED_CACHE_STRUCT_NAME* cache, uint32_t entry_index, uint32_t key_hash)
+{
+    uint32_t position = key_hash & cache->hash_index_mask;
+
+    while(cache->hash_index[position] != SOL_U32_INVALID)
+    {
+        position = (position + 1) & cache->hash_index_mask;
+    }
+
+    cache->hash_index[position] = entry_index;
+    cache->entry_hashes[entry_index] = key_hash;
+}
+
+static inline void SOL_CONCATENATE(SOL_LIMITED_CACHE_FUNCTION_PREFIX,_hash_index_remove__i)(struct SOL_LIMITED_CACHE_STRUCT_NAME* cache, uint32_t entry_index)
+{
+    const uint32_t mask = cache->hash_index_mask;
+    uint32_t position, next_position, home_position;
+
+    position = cache->entry_hashes[entry_index] & mask;
+
+    while(cache->hash_index[position] != entry_index)
+    {
+        assert(cache->hash_index[position] != SOL_U32_INVALID);/** entry must be in the index */
+        position = (position + 1) & mask;
+    }
+
+    /** shift back any following entries that can be moved closer to their home position, so that probing never has to skip empty positions */
+    next_position = position;
+    while(true)
+    {
+        next_position = (next_position + 1) & mask;
+
+        if(cache->hash_index[next_position] == SOL_U32_INVALID)
+        {
+            break;
+        }
+
+        home_position = cache->entry_hashes[cache->hash_index[next_position]] & mask;
+
+        /** can only move back if the empty position is not before its home position (accounting for wrapping) */
+        if(((next_position - home_position) & mask) >= ((next_position - position) & mask))
+        {
+            cache->hash_index[position] = cache->hash_index[next_position];
+            position = next_position;
+        }
+    }
+
+    cache->hash_index[position] = SOL_U32_INVALID;
+}
+
+#ifdef SOL_LIMITED_CACHE_CONTEXT_TYPE
+static inline uint32_t SOL_CONCATENATE(SOL_LIMITED_CACHE_FUNCTION_PREFIX,_hash_index_locate__i)(const struct SOL_LIMITED_CACHE_STRUCT_NAME* cache, const SOL_LIMITED_CACHE_KEY_TYPE key, uint32_t key_hash, SOL_LIMITED_CACHE_CONTEXT_TYPE* context)
+#else
+static inline uint32_t SOL_CONCATENATE(SOL_LIMITED_CACHE_FUNCTION_PREFIX,_hash_index_locate__i)(const struct SOL_LIMITED_CACHE_STRUCT_NAME* cache, const SOL_LIMITED_CACHE_KEY_TYPE key, uint32_t key_hash)
+#endif
+{
+    uint32_t position, index;
+
+    position = key_hash & cache->hash_index_mask;
+
+    while((index = cache->hash_index[position]) != SOL_U32_INVALID)
+    {
+        if(cache->entry_hashes[index] == key_hash && SOL_LIMITED_CACHE_CMP_EQ_CONTEXT((cache->entries + index), key))
+        {
+            return index;
+        }
+        position = (position + 1) & cache->hash_index_mask;
+    }
+
+    return SOL_U32_INVALID;
 }
+#endif
 
 static inline SOL_LIMITED_CACHE_ENTRY_TYPE* SOL_CONCATENATE(SOL_LIMITED_CACHE_FUNCTION_PREFIX,_evict_oldest)(struct SOL_LIMITED_CACHE_STRUCT_NAME* cache)
 {
-    uint16_t oldest_index;
-    struct sol_cache_link_u16* oldest_link;
-    struct sol_cache_link_u16* const header_link = cache->links + cache->header_link_index;
+    uint32_t oldest_index;
+    struct sol_cache_link_u32* oldest_link;
+    struct sol_cache_link_u32* const header_link = cache->links + cache->header_link_index;
 
     oldest_index = header_link->newer;
     oldest_link = cache->links + oldest_index;
@@ -120,9 +225,13 @@ static inline SOL_LIMITED_CACHE_ENTRY_TYPE* SOL_CONCATENATE(SOL_LIMITED_CACHE_FU
     header_link->newer = oldest_link->newer;
 
     oldest_link->newer = cache->first_free;
-    oldest_link->older = SOL_U16_INVALID;/*not needed*/
+    oldest_link->older = SOL_U32_INVALID;/*not needed*/
     cache->first_free = oldest_index;
     cache->count--;
+
+    #ifdef SOL_LIMITED_CACHE_KEY_HASH
+    SOL_CONCATENATE(SOL_LIMITED_CACHE_FUNCTION_PREFIX,_hash_index_remove__i)(cache, oldest_index);
+    #endif
     return cache->entries + oldest_index;
 }
 
@@ -130,11 +239,10 @@ static inline void SOL_CONCATENATE(SOL_LIMITED_CACHE_FUNCTION_PREFIX,_withdraw)(
 {
     assert(cache->count > 0);
 	assert(entry >= cache->entries);
-	assert(entry < (SOL_LIMITED_CACHE_ENTRY_TYPE*)cache->links);
-	/** ^ note: links is end of entries buffer **/
+	assert(entry < cache->entries + cache->header_link_index);
 
-    uint16_t index;
-    struct sol_cache_link_u16* link;
+    uint32_t index;
+    struct sol_cache_link_u32* link;
 
     index = entry - cache->entries;
     link = cache->links + index;
@@ -143,14 +251,18 @@ static inline void SOL_CONCATENATE(SOL_LIMITED_CACHE_FUNCTION_PREFIX,_withdraw)(
     cache->links[link->older].newer = link->newer;
 
     link->newer = cache->first_free;
-    link->older = SOL_U16_INVALID;/*not needed*/
+    link->older = SOL_U32_INVALID;/*not needed*/
     cache->first_free = index;
     cache->count--;
+
+    #ifdef SOL_LIMITED_CACHE_KEY_HASH
+    SOL_CONCATENATE(SOL_LIMITED_CACHE_FUNCTION_PREFIX,_hash_index_remove__i)(cache, index);
+    #endif
 }
 
 static inline SOL_LIMITED_CACHE_ENTRY_TYPE* SOL_CONCATENATE(SOL_LIMITED_CACHE_FUNCTION_PREFIX,_access_oldest)(struct SOL_LIMITED_CACHE_STRUCT_NAME* cache)
 {
-    uint16_t oldest_index = cache->links[cache->header_link_index].newer;
+    uint32_t oldest_index = cache->links[cache->header_link_index].newer;
     if(oldest_index == cache->header_link_index)
     {
         assert(cache->count == 0);
@@ -166,11 +278,32 @@ static inline enum sol_cache_result SOL_CONCATENATE(SOL_LIMITED_CACHE_FUNCTION_P
 static inline enum sol_cache_result SOL_CONCATENATE(SOL_LIMITED_CACHE_FUNCTION_PREFIX,_obtain)(struct SOL_LIMITED_CACHE_STRUCT_NAME* cache, const SOL_LIMITED_CACHE_KEY_TYPE key, SOL_LIMITED_CACHE_ENTRY_TYPE** entry_ptr)
 #endif
 {
-    uint16_t index;
-    struct sol_cache_link_u16* link;
-    struct sol_cache_link_u16* const header_link = cache->links + cache->header_link_index;
+    uint32_t index;
+    struct sol_cache_link_u32* link;
+    struct sol_cache_link_u32* const header_link = cache->links + cache->header_link_index;
     enum sol_cache_result result;
 
+    #ifdef SOL_LIMITED_CACHE_KEY_HASH
+    const uint32_t key_hash = SOL_LIMITED_CACHE_KEY_HASH_CONTEXT(key);
+
+    #ifdef SOL_LIMITED_CACHE_CONTEXT_TYPE
+    index = SOL_CONCATENATE(SOL_LIMITED_CACHE_FUNCTION_PREFIX,_hash_index_locate__i)(cache, key, key_hash, context);
+    #else
+    index = SOL_CONCATENATE(SOL_LIMITED_CACHE_FUNCTION_PREFIX,_hash_index_locate__i)(cache, key, key_hash);
+    #endif
+
+    if(index != SOL_U32_INVALID)
+    {
+        link = cache->links + index;
+
+        /** remove entry from cache */
+        cache->links[link->newer].older = link->older;
+        cache->links[link->older].newer = link->newer;
+
+        result = SOL_CACHE_SUCCESS_FOUND;
+        goto found;
+    }
+    #else
     /** search from the newest cache entry */
     index = header_link->older;
     link = cache->links + index;
@@ -190,9 +323,10 @@ static inline enum sol_cache_result SOL_CONCATENATE(SOL_LIMITED_CACHE_FUNCTION_P
         index = link->older;
         link = cache->links + index;
     }
+    #endif
 
     /** entry not found in cache */
-    if(cache->first_free != SOL_U16_INVALID)
+    if(cache->first_free != SOL_U32_INVALID)
     {
         /** there is an unused cache entry; use it */
         index = cache->first_free;
@@ -210,11 +344,19 @@ static inline enum sol_cache_result SOL_CONCATENATE(SOL_LIMITED_CACHE_FUNCTION_P
         link = cache->links + index;
 
         header_link->newer = link->newer;
-        cache->links[link->older].newer = cache->header_link_index;
+        cache->links[link->newer].older = cache->header_link_index;
+
+        #ifdef SOL_LIMITED_CACHE_KEY_HASH
+        SOL_CONCATENATE(SOL_LIMITED_CACHE_FUNCTION_PREFIX,_hash_index_remove__i)(cache, index);
+        #endif
 
         result = SOL_CACHE_SUCCESS_REPLACED;
     }
 
+    #ifdef SOL_LIMITED_CACHE_KEY_HASH
+    SOL_CONCATENATE(SOL_LIMITED_CACHE_FUNCTION_PREFIX,_hash_index_insert__i)(cache, index, key_hash);
+    #endif
+
     found: /** move entry to the front */
 
     link->older = header_link->older;
@@ -233,11 +375,35 @@ static inline enum sol_cache_result SOL_CONCATENATE(SOL_LIMITED_CACHE_FUNCTION_P
 static inline enum sol_cache_result SOL_CONCATENATE(SOL_LIMITED_CACHE_FUNCTION_PREFIX,_find)(struct SOL_LIMITED_CACHE_STRUCT_NAME* cache, const SOL_LIMITED_CACHE_KEY_TYPE key, SOL_LIMITED_CACHE_ENTRY_TYPE** entry_ptr)
 #endif
 {
-    uint16_t index;
-    struct sol_cache_link_u16* link;
-    struct sol_cache_link_u16* const header_link = cache->links + cache->header_link_index;
-    enum sol_cache_result result;
+    uint32_t index;
+    struct sol_cache_link_u32* link;
+    struct sol_cache_link_u32* const header_link = cache->links + cache->header_link_index;
+
+    #ifdef SOL_LIMITED_CACHE_KEY_HASH
+    #ifdef SOL_LIMITED_CACHE_CONTEXT_TYPE
+    index = SOL_CONCATENATE(SOL_LIMITED_CACHE_FUNCTION_PREFIX,_hash_index_locate__i)(cache, key, SOL_LIMITED_CACHE_KEY_HASH_CONTEXT(key), context);
+    #else
+    index = SOL_CONCATENATE(SOL_LIMITED_CACHE_FUNCTION_PREFIX,_hash_index_locate__i)(cache, key, SOL_LIMITED_CACHE_KEY_HASH_CONTEXT(key));
+    #endif
+
+    if(index != SOL_U32_INVALID)
+    {
+        link = cache->links + index;
+
+        /** remove entry from cache and move to the front */
+        cache->links[link->newer].older = link->older;
+        cache->links[link->older].newer = link->newer;
+
+        link->older = header_link->older;
+        link->newer = cache->header_link_index;
 
+        cache->links[header_link->older].newer = index;
+        header_link->older = index;
+
+        *entry_ptr = cache->entries + index;
+        return SOL_CACHE_SUCCESS_FOUND;
+    }
+    #else
     /** search from the newest cache entry */
     index = header_link->older;
     link = cache->links + index;
@@ -263,6 +429,7 @@ static inline enum sol_cache_result SOL_CONCATENATE(SOL_LIMITED_CACHE_FUNCTION_P
         index = link->older;
         link = cache->links + index;
     }
+    #endif
 
     /** entry not found in cache */
     *entry_ptr = NULL;
@@ -277,6 +444,11 @@ static inline enum sol_cache_result SOL_CONCATENATE(SOL_LIMITED_CACHE_FUNCTION_P
 #undef SOL_LIMITED_CACHE_CMP_EQ
 
 #undef SOL_LIMITED_CACHE_CMP_EQ_CONTEXT
+#undef SOL_LIMITED_CACHE_KEY_HASH_CONTEXT
+
+#ifdef SOL_LIMITED_CACHE_KEY_HASH
+#undef SOL_LIMITED_CACHE_KEY_HASH
+#endif
 
 #ifdef SOL_LIMITED_CACHE_CONTEXT_TYPE
 #undef SOL_LIMITED_CACHE_CONTEXT_TYPE
@@ -0,0 +1,401 @@
+/**
+Copyright 2026 Carl van Mastrigt
+
+This file is part of solipsix.
+
+solipsix is free software: you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+solipsix is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with solipsix.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <stdlib.h>
+#include <assert.h>
+
+#include "sol_utils.h"
+
+#include "data_structures/tlsf.h"
+
+
+/** each first level (power of 2) is split into (1 << exponent) second level bins */
+#define SOL_TLSF_SECOND_LEVEL_EXPONENT 4
+#define SOL_TLSF_SECOND_LEVEL_COUNT (1u << SOL_TLSF_SECOND_LEVEL_EXPONENT)
+
+/** sizes below the second level count all go in the first first level bin (one size per second level bin)
+ * above that first level `n` holds sizes [2^(n + exponent - 1), 2^(n + exponent))
+ * sizes are less than 2^31, but rounding a size up to the next bin boundary can reach 2^31 */
+#define SOL_TLSF_FIRST_LEVEL_COUNT (33 - SOL_TLSF_SECOND_LEVEL_EXPONENT)
+
+struct sol_tlsf_block
+{
+	/** location and extent in units */
+	uint32_t offset;
+	uint32_t size;
+
+	/** indices of the adjacent blocks in the managed range, SOL_U32_INVALID at either end */
+	uint32_t prev_physical;
+	uint32_t next_physical;
+
+	/** indices of adjacent blocks in the available bin linked list, only valid while available */
+	uint32_t prev_available;
+	uint32_t next_available;
+
+	bool available;
+};
+
+#define SOL_ARRAY_ENTRY_TYPE struct sol_tlsf_block
+#define SOL_ARRAY_STRUCT_NAME sol_tlsf_block_array
+#include "data_structures/array.h"
+
+struct sol_tlsf
+{
+	/** array of blocks, both available and acquired */
+	struct sol_tlsf_block_array block_array;
+
+	/** bit per first level that has any available blocks */
+	uint32_t first_level_mask;
+	/** bit per second level bin (of the first level) that has any available blocks */
+	uint32_t second_level_masks[SOL_TLSF_FIRST_LEVEL_COUNT];
+
+	/** head of available block linked list for each bin */
+	uint32_t available_heads[SOL_TLSF_FIRST_LEVEL_COUNT][SOL_TLSF_SECOND_LEVEL_COUNT];
+
+	uint32_t size;
+	uint32_t available_size;
+};
+
+
+
+/** the bin that contains blocks of this size */
+static inline void sol_tlsf_get_bin(uint32_t size, uint32_t* first_level, uint32_t* second_level)
+{
+	uint32_t exponent;
+
+	if(size < SOL_TLSF_SECOND_LEVEL_COUNT)
+	{
+		*first_level = 0;
+		*second_level = size;
+	}
+	else
+	{
+		exponent = sol_u32_exp_le(size);
+		*first_level = exponent - SOL_TLSF_SECOND_LEVEL_EXPONENT + 1;
+		*second_level = (size >> (exponent - SOL_TLSF_SECOND_LEVEL_EXPONENT)) - SOL_TLSF_SECOND_LEVEL_COUNT;
+	}
+}
+
+/** the first bin in which every block is at least this size */
+static inline void sol_tlsf_get_sufficient_bin(uint32_t size, uint32_t* first_level, uint32_t* second_level)
+{
+	if(size >= SOL_TLSF_SECOND_LEVEL_COUNT)
+	{
+		/** round up to the next bin boundary, cannot overflow as sizes are less than 2^31 */
+		size += (1u << (sol_u32_exp_le(size) - SOL_TLSF_SECOND_LEVEL_EXPONENT)) - 1;
+	}
+
+	sol_tlsf_get_bin(size, first_level, second_level);
+}
+
+/** finds a non-empty bin at or above the one specified (in size), returns false if there is none */
+static inline bool sol_tlsf_find_available_bin(const struct sol_tlsf* tlsf, uint32_t* first_level, uint32_t* second_level)
+{
+	uint32_t mask;
+
+	mask = tlsf->second_level_masks[*first_level] & (~0u << *second_level);
+
+	if(mask == 0)
+	{
+		/** no suitable bins in this first level, take the smallest bin of any larger first level */
+		mask = tlsf->first_level_mask & (~1u << *first_level);
+		if(mask == 0)
+		{
+			return false;
+		}
+
+		*first_level = sol_u32_ctz(mask);
+		mask = tlsf->second_level_masks[*first_level];
+		assert(mask);
+	}
+
+	*second_level = sol_u32_ctz(mask);
+
+	return true;
+}
+
+static inline void sol_tlsf_append_available(struct sol_tlsf* tlsf, uint32_t index)
+{
+	struct sol_tlsf_block* block;
+	uint32_t first_level, second_level, head_index;
+
+	block = sol_tlsf_block_array_access_entry(&tlsf->block_array, index);
+	sol_tlsf_get_bin(block->size, &first_level, &second_level);
+
+	head_index = tlsf->available_heads[first_level][second_level];
+
+	block->available = true;
+	block->prev_available = SOL_U32_INVALID;
+	block->next_available = head_index;
+
+	if(head_index != SOL_U32_INVALID)
+	{
+		sol_tlsf_block_array_access_entry(&tlsf->block_array, head_index)->prev_available = index;
+	}
+
+	tlsf->available_heads[first_level][second_level] = index;
+	tlsf->second_level_masks[first_level] |= 1u << second_level;
+	tlsf->first_level_mask |= 1u << first_level;
+}
+
+static inline void sol_tlsf_withdraw_available(struct sol_tlsf* tlsf, uint32_t index)
+{
+	struct sol_tlsf_block* block;
+	uint32_t first_level, second_level;
+
+	block = sol_tlsf_block_array_access_entry(&tlsf->block_array, index);
+	assert(block->available);
+
+	block->available = false;
+
+	if(block->next_available != SOL_U32_INVALID)
+	{
+		sol_tlsf_block_array_access_entry(&tlsf->block_array, block->next_available)->prev_available = block->prev_available;
+	}
+
+	if(block->prev_available != SOL_U32_INVALID)
+	{
+		sol_tlsf_block_array_access_entry(&tlsf->block_array, block->prev_available)->next_available = block->next_available;
+		return;
+	}
+
+	/** was the head of its bin */
+	sol_tlsf_get_bin(block->size, &first_level, &second_level);
+	assert(tlsf->available_heads[first_level][second_level] == index);
+
+	tlsf->available_heads[first_level][second_level] = block->next_available;
+
+	if(block->next_available == SOL_U32_INVALID)
+	{
+		tlsf->second_level_masks[first_level] &= ~(1u << second_level);
+		if(tlsf->second_level_masks[first_level] == 0)
+		{
+			tlsf->first_level_mask &= ~(1u << first_level);
+		}
+	}
+}
+
+/** merges the block following `index` into it and removes it, the following block must already have been withdrawn from its bin */
+static inline void sol_tlsf_absorb_next_physical(struct sol_tlsf* tlsf, uint32_t index)
+{
+	struct sol_tlsf_block* block;
+	struct sol_tlsf_block* next_block;
+	uint32_t next_index;
+
+	block = sol_tlsf_block_array_access_entry(&tlsf->block_array, index);
+	next_index = block->next_physical;
+	next_block = sol_tlsf_block_array_withdraw_ptr(&tlsf->block_array, next_index);
+
+	assert(next_block->available == false);
+	assert(block->offset + block->size == next_block->offset);
+
+	block->size += next_block->size;
+	block->next_physical = next_block->next_physical;
+
+	if(block->next_physical != SOL_U32_INVALID)
+	{
+		sol_tlsf_block_array_access_entry(&tlsf->block_array, block->next_physical)->prev_physical = index;
+	}
+}
+
+
+
+struct sol_tlsf* sol_tlsf_create(uint32_t size)
+{
+	struct sol_tlsf* tlsf;
+	uint32_t first_level, second_level, index;
+
+	assert(size > 0 && size < (1u << 31));
+
+	tlsf = malloc(sizeof(struct sol_tlsf));
+
+	sol_tlsf_block_array_initialise(&tlsf->block_array, 256);
+
+	tlsf->first_level_mask = 0;
+	for(first_level = 0; first_level < SOL_TLSF_FIRST_LEVEL_COUNT; first_level++)
+	{
+		tlsf->second_level_masks[first_level] = 0;
+		for(second_level = 0; second_level < SOL_TLSF_SECOND_LEVEL_COUNT; second_level++)
+		{
+			tlsf->available_heads[first_level][second_level] = SOL_U32_INVALID;
+		}
+	}
+
+	tlsf->size = size;
+	tlsf->available_size = size;
+
+	*sol_tlsf_block_array_append_ptr(&tlsf->block_array, &index) = (struct sol_tlsf_block)
+	{
+		.offset = 0,
+		.size = size,
+		.prev_physical = SOL_U32_INVALID,
+		.next_physical = SOL_U32_INVALID,
+	};
+
+	sol_tlsf_append_available(tlsf, index);
+
+	return tlsf;
+}
+
+void sol_tlsf_destroy(struct sol_tlsf* tlsf)
+{
+	uint32_t first_level, second_level, index;
+
+	/** all allocations should be released before destroying, leaving a single block covering everything */
+	assert(tlsf->available_size == tlsf->size);
+	sol_tlsf_get_bin(tlsf->size, &first_level, &second_level);
+	index = tlsf->available_heads[first_level][second_level];
+	assert(index != SOL_U32_INVALID);
+
+	sol_tlsf_withdraw_available(tlsf, index);
+	sol_tlsf_block_array_withdraw_ptr(&tlsf->block_array, index);
+
+	assert(tlsf->first_level_mask == 0);
+	assert(sol_tlsf_block_array_is_empty(&tlsf->block_array));
+
+	sol_tlsf_block_array_terminate(&tlsf->block_array);
+
+	free(tlsf);
+}
+
+bool sol_tlsf_acquire(struct sol_tlsf* tlsf, uint32_t size, uint32_t* index)
+{
+	struct sol_tlsf_block* block;
+	struct sol_tlsf_block* remainder_block;
+	uint32_t first_level, second_level, remainder_index;
+
+	assert(size > 0);
+
+	if(size > tlsf->available_size)
+	{
+		return false;
+	}
+
+	sol_tlsf_get_sufficient_bin(size, &first_level, &second_level);
+
+	if( ! sol_tlsf_find_available_bin(tlsf, &first_level, &second_level))
+	{
+		return false;
+	}
+
+	*index = tlsf->available_heads[first_level][second_level];
+	sol_tlsf_withdraw_available(tlsf, *index);
+
+	block = sol_tlsf_block_array_access_entry(&tlsf->block_array, *index);
+	assert(block->size >= size);
+
+	if(block->size > size)
+	{
+		/** split off the remainder as a new available block */
+		remainder_block = sol_tlsf_block_array_append_ptr(&tlsf->block_array, &remainder_index);
+		/** note: must reacquire pointer in case array was resized */
+		block = sol_tlsf_block_array_access_entry(&tlsf->block_array, *index);
+
+		*remainder_block = (struct sol_tlsf_block)
+		{
+			.offset = block->offset + size,
+			.size = block->size - size,
+			.prev_physical = *index,
+			.next_physical = block->next_physical,
+		};
+
+		if(block->next_physical != SOL_U32_INVALID)
+		{
+			sol_tlsf_block_array_access_entry(&tlsf->block_array, block->next_physical)->prev_physical = remainder_index;
+		}
+
+		block->next_physical = remainder_index;
+		block->size = size;
+
+		sol_tlsf_append_available(tlsf, remainder_index);
+	}
+
+	tlsf->available_size -= size;
+
+	return true;
+}
+
+void sol_tlsf_release(struct sol_tlsf* tlsf, uint32_t index)
+{
+	struct sol_tlsf_block* block;
+	struct sol_tlsf_block* adjacent_block;
+	uint32_t prev_index;
+
+	block = sol_tlsf_block_array_access_entry(&tlsf->block_array, index);
+	assert( ! block->available);
+
+	tlsf->available_size += block->size;
+
+	if(block->next_physical != SOL_U32_INVALID)
+	{
+		adjacent_block = sol_tlsf_block_array_access_entry(&tlsf->block_array, block->next_physical);
+		if(adjacent_block->available)
+		{
+			sol_tlsf_withdraw_available(tlsf, block->next_physical);
+			sol_tlsf_absorb_next_physical(tlsf, index);
+		}
+	}
+
+	if(block->prev_physical != SOL_U32_INVALID)
+	{
+		prev_index = block->prev_physical;
+		adjacent_block = sol_tlsf_block_array_access_entry(&tlsf->block_array, prev_index);
+		if(adjacent_block->available)
+		{
+			sol_tlsf_withdraw_available(tlsf, prev_index);
+			sol_tlsf_absorb_next_physical(tlsf, prev_index);
+			index = prev_index;
+		}
+	}
+
+	sol_tlsf_append_available(tlsf, index);
+}
+
+uint32_t sol_tlsf_get_offset(const struct sol_tlsf* tlsf, uint32_t index)
+{
+	const struct sol_tlsf_block block = sol_tlsf_block_array_get_entry(&tlsf->block_array, index);
+	assert( ! block.available);
+	return block.offset;
+}
+
+uint32_t sol_tlsf_get_size(const struct sol_tlsf* tlsf, uint32_t index)
+{
+	const struct sol_tlsf_block block = sol_tlsf_block_array_get_entry(&tlsf->block_array, index);
+	assert( ! block.available);
+	return block.size;
+}
+
+bool sol_tlsf_has_space(const struct sol_tlsf* tlsf, uint32_t size)
+{
+	uint32_t first_level, second_level;
+
+	if(size > tlsf->available_size)
+	{
+		return false;
+	}
+
+	sol_tlsf_get_sufficient_bin(size, &first_level, &second_level);
+
+	return sol_tlsf_find_available_bin(tlsf, &first_level, &second_level);
+}
+
+bool sol_tlsf_is_empty(const struct sol_tlsf* tlsf)
+{
+	return tlsf->available_size == tlsf->size;
+}
@@ -0,0 +1,54 @@
+/**
+Copyright 2026 Carl van Mastrigt
+
+This file is part of solipsix.
+
+solipsix is free software: you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+solipsix is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with solipsix.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <inttypes.h>
+#include <stdbool.h>
+
+/** two level segregated fit allocator: allocations of arbitrary size with O(1) acquire and release
+ * available blocks are binned by size; first level by power of 2, second level by linear subdivision of that power of 2
+ * released blocks are immediately coalesced with available neighbours, so there is never more than one available block between allocations
+ * acquire takes from the first bin whose blocks are all large enough, and splits the block so the allocation is exactly the size requested
+ * this is good fit, not best fit: blocks in the request's own bin that would have fit are skipped when a larger bin has an available block
+ *
+ * like `sol_buddy_tree` this deals only in opaque units; scaling offsets and sizes (e.g. to bytes in a VkBuffer or host arena) is the callers responsibility
+ * all bookkeeping lives outside the managed range, so the range itself need not be accessible */
+
+/** underlying type sufficiently complex as to not expose its internals here (so reqire allocation of struct) */
+struct sol_tlsf;
+
+/** size must be less than 2^31 units */
+struct sol_tlsf* sol_tlsf_create(uint32_t size);
+void sol_tlsf_destroy(struct sol_tlsf* tlsf);
+
+/** the acquired index must be released before destroying the tlsf
+ * the index can be used as an index into an externally managed array (indices are reused, available blocks also use indices) */
+bool sol_tlsf_acquire(struct sol_tlsf* tlsf, uint32_t size, uint32_t* index);
+void sol_tlsf_release(struct sol_tlsf* tlsf, uint32_t index);
+
+uint32_t sol_tlsf_get_offset(const struct sol_tlsf* tlsf, uint32_t index);
+/** exactly the size that was acquired */
+uint32_t sol_tlsf_get_size(const struct sol_tlsf* tlsf, uint32_t index);
+
+/** whether an acquire of this size would succeed */
+bool sol_tlsf_has_space(const struct sol_tlsf* tlsf, uint32_t size);
+
+/** tlsf has NO allocations */
+bool sol_tlsf_is_empty(const struct sol_tlsf* tlsf);
@@ -0,0 +1,144 @@
+/**
+Copyright 2026 Carl van Mastrigt
+
+This file is part of solipsix.
+
+solipsix is free software: you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+solipsix is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with solipsix.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <stdlib.h>
+#include <assert.h>
+
+#include "lockfree/deque.h"
+
+void sol_lockfree_deque_initialise(struct sol_lockfree_deque* deque, size_t capacity_exponent)
+{
+    size_t i, count;
+
+    assert(capacity_exponent < 32);
+
+    count = (size_t)1 << capacity_exponent;
+
+    atomic_init(&deque->top, 0);
+    atomic_init(&deque->bottom, 0);
+
+    deque->capacity_exponent = capacity_exponent;
+    deque->entries = malloc(sizeof(void* _Atomic) * count);
+
+    for(i = 0; i < count; i++)
+    {
+        atomic_init(deque->entries + i, NULL);
+    }
+}
+
+void sol_lockfree_deque_terminate(struct sol_lockfree_deque* deque)
+{
+    assert(atomic_load_explicit(&deque->top, memory_order_relaxed) == atomic_load_explicit(&deque->bottom, memory_order_relaxed));/// deque should be empty upon termination
+    free((void*)deque->entries);
+}
+
+bool sol_lockfree_deque_push(struct sol_lockfree_deque* deque, void* entry)
+{
+    int_fast64_t top, bottom;
+    int_fast64_t mask = ((int_fast64_t)1 << deque->capacity_exponent) - 1;
+
+    bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed);
+    top = atomic_load_explicit(&deque->top, memory_order_acquire);
+
+    if(bottom - top > mask)
+    {
+        return false;
+    }
+
+    atomic_store_explicit(deque->entries + (bottom & mask), entry, memory_order_relaxed);
+
+    /** make the entry visible before the bottom that exposes it to stealing threads */
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+
+    return true;
+}
+
+void* sol_lockfree_deque_pull(struct sol_lockfree_deque* deque)
+{
+    int_fast64_t top, bottom;
+    int_fast64_t mask = ((int_fast64_t)1 << deque->capacity_exponent) - 1;
+    void* entry;
+
+    bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&deque->bottom, bottom, memory_order_relaxed);
+
+    /** the reservation of the bottom entry must be globally ordered with respect to the stealing threads read of bottom */
+    atomic_thread_fence(memory_order_seq_cst);
+
+    top = atomic_load_explicit(&deque->top, memory_order_relaxed);
+
+    if(top > bottom)
+    {
+        /** was empty, undo reservation */
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+        return NULL;
+    }
+
+    entry = atomic_load_explicit(deque->entries + (bottom & mask), memory_order_relaxed);
+
+    if(top == bottom)
+    {
+        /** last entry, race stealing threads for it */
+        if( ! atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1, memory_order_seq_cst, memory_order_relaxed))
+        {
+            entry = NULL;
+        }
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+    }
+
+    return entry;
+}
+
+bool sol_lockfree_deque_is_empty(struct sol_lockfree_deque* deque)
+{
+    int_fast64_t top, bottom;
+
+    bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed);
+    top = atomic_load_explicit(&deque->top, memory_order_relaxed);
+
+    return top >= bottom;
+}
+
+void* sol_lockfree_deque_steal(struct sol_lockfree_deque* deque, bool* contended)
+{
+    int_fast64_t top, bottom;
+    int_fast64_t mask = ((int_fast64_t)1 << deque->capacity_exponent) - 1;
+    void* entry;
+
+    top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    bottom = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+
+    if(top >= bottom)
+    {
+        return NULL;
+    }
+
+    entry = atomic_load_explicit(deque->entries + (top & mask), memory_order_relaxed);
+
+    if( ! atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1, memory_order_seq_cst, memory_order_relaxed))
+    {
+        /** lost the race to another stealing thread or the owner */
+        *contended = true;
+        return NULL;
+    }
+
+    return entry;
+}
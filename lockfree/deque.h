@@ -0,0 +1,58 @@
+/**
+Copyright 2026 Carl van Mastrigt
+
+This file is part of solipsix.
+
+solipsix is free software: you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+solipsix is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with solipsix.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+
+/** lockfree_deque
+ * a bounded work stealing deque (Chase-Lev, with the memory orderings of Le, Pop, Cohen & Zappa Nardelli 2013)
+ * a single owning thread may push and pull entries at the bottom (LIFO), any thread may steal entries from the top (FIFO)
+ * unlike the other lockfree structures this stores pointers directly rather than indices into a pool, as it is intended for moving existing objects between threads
+ * the deque does not grow, push will fail when it is full and the owner must handle the entry some other way */
+
+struct sol_lockfree_deque
+{
+    /** top is modified by stealing threads, bottom is only modified by the owning thread */
+    atomic_int_fast64_t top;
+    atomic_int_fast64_t bottom;
+
+    size_t capacity_exponent;
+    void* _Atomic * entries;
+};
+
+void sol_lockfree_deque_initialise(struct sol_lockfree_deque* deque, size_t capacity_exponent);
+void sol_lockfree_deque_terminate(struct sol_lockfree_deque* deque);
+
+/** following may only be called by the thread that owns the deque */
+
+/// returns false if there was no space in the deque for the entry
+bool sol_lockfree_deque_push(struct sol_lockfree_deque* deque, void* entry);
+/// returns NULL if the deque was empty
+void* sol_lockfree_deque_pull(struct sol_lockfree_deque* deque);
+/// entries may be stolen at any time, so this is only a hint when it returns false
+bool sol_lockfree_deque_is_empty(struct sol_lockfree_deque* deque);
+
+/** may be called by any thread
+ * returns NULL if the deque was empty OR another thread took the entry first, in which case `contended` will be set to true
+ * a contended steal does not imply the deque is empty, so should be retried if confirming emptiness is important */
+void* sol_lockfree_deque_steal(struct sol_lockfree_deque* deque, bool* contended);
@@ -18,6 +18,7 @@ along with solipsix.  If not, see <https://www.gnu.org/licenses/>.
 */
 
 #include <stdlib.h>
+#include <stdio.h>
 #include <assert.h>
 
 #include "lockfree/pool.h"
@@ -29,6 +30,7 @@ void sol_lockfree_pool_initialise(struct sol_lockfree_pool* pool, size_t capacit
 
     /// the available entries will store the actual pointers rather than duplicates (like other pools created from this pool)
     atomic_init(&pool->head,0);
+    atomic_init(&pool->magazine_count,0);
     pool->next_buffer = malloc(sizeof(uint32_t)<<capacity_exponent);
     pool->entry_data = malloc(entry_size<<capacity_exponent);
     pool->entry_size = entry_size;
@@ -45,6 +47,15 @@ void sol_lockfree_pool_initialise(struct sol_lockfree_pool* pool, size_t capacit
 
 void sol_lockfree_pool_terminate(struct sol_lockfree_pool* pool)
 {
+    uint_fast32_t magazine_count = atomic_load_explicit(&pool->magazine_count, memory_order_acquire);
+
+    /// checked even without asserts: the entries held by a live magazine would be lost, and the magazine left pointing at freed memory
+    if(magazine_count != 0)
+    {
+        fprintf(stderr, "lockfree pool terminated while %u magazine(s) drawing from it are still live, they must be terminated first\n", (unsigned)magazine_count);
+        abort();
+    }
+
     free(pool->next_buffer);
     free(pool->entry_data);
 }
@@ -83,14 +94,17 @@ void * sol_lockfree_pool_acquire_entry(struct sol_lockfree_pool* pool)
 }
 
 
-void sol_lockfree_pool_relinquish_entry(struct sol_lockfree_pool* pool, void * entry)
+static inline uint32_t sol_lockfree_pool_get_entry_index(struct sol_lockfree_pool* pool, void * entry)
 {
-    uint32_t entry_index;
-
     assert((char*)entry >= pool->entry_data);
     assert((char*)entry < pool->entry_data + (pool->entry_size << pool->capacity_exponent));
 
-    entry_index = (uint32_t) (((char*)entry - pool->entry_data) / pool->entry_size);
+    return (uint32_t) (((char*)entry - pool->entry_data) / pool->entry_size);
+}
+
+void sol_lockfree_pool_relinquish_entry(struct sol_lockfree_pool* pool, void * entry)
+{
+    uint32_t entry_index = sol_lockfree_pool_get_entry_index(pool, entry);
 
     sol_lockfree_pool_relinquish_entry_index_range(pool, entry_index, entry_index);
 }
@@ -167,3 +181,132 @@ void sol_lockfree_pool_call_for_every_entry(struct sol_lockfree_pool* pool, void
 
 
 
+
+
+
+/** moves up to `count` entries from the pool to the top of the magazine with a single compare exchange */
+static void sol_lockfree_pool_magazine_refill(struct sol_lockfree_pool_magazine* magazine, uint32_t count)
+{
+    struct sol_lockfree_pool* pool = magazine->pool;
+    uint_fast64_t current_head, replacement_head;
+    uint32_t entry_index, taken;
+
+    assert(magazine->count + count <= SOL_LOCKFREE_POOL_MAGAZINE_CAPACITY);
+
+    current_head = atomic_load_explicit(&pool->head, memory_order_acquire);
+
+    do
+    {
+        /** walk the list from head, the next values read here may be stale if another thread modifies the list concurrently,
+         * but any modification changes head so the compare exchange will fail and the walk will be repeated
+         * stale next values are still always valid indices (or invalid entry) so this can't read out of bounds */
+        entry_index = (uint32_t)(current_head & SOL_LOCKFREE_POOL_ENTRY_MASK);
+        taken = 0;
+
+        while(taken < count && entry_index != SOL_LOCKFREE_POOL_INVALID_ENTRY)
+        {
+            magazine->indices[magazine->count + taken] = entry_index;
+            entry_index = pool->next_buffer[entry_index];
+            taken++;
+        }
+
+        if(taken == 0)
+        {
+            return;
+        }
+
+        replacement_head = ((current_head & SOL_LOCKFREE_POOL_CHECK_MASK) + SOL_LOCKFREE_POOL_CHECK_UNIT) | (uint_fast64_t)entry_index;
+    }
+    while(!atomic_compare_exchange_weak_explicit(&pool->head, &current_head, replacement_head, memory_order_acquire, memory_order_acquire));
+
+    magazine->count += taken;
+}
+
+/** returns the bottom `count` entries of the magazine to the pool as a single range */
+static void sol_lockfree_pool_magazine_return(struct sol_lockfree_pool_magazine* magazine, uint32_t count)
+{
+    struct sol_lockfree_pool* pool = magazine->pool;
+    uint32_t i;
+
+    assert(count <= magazine->count);
+
+    if(count == 0)
+    {
+        return;
+    }
+
+    /** this thread owns these entries so is free to link them together */
+    for(i = 1; i < count; i++)
+    {
+        pool->next_buffer[magazine->indices[i - 1]] = magazine->indices[i];
+    }
+
+    sol_lockfree_pool_relinquish_entry_index_range(pool, magazine->indices[0], magazine->indices[count - 1]);
+
+    magazine->count -= count;
+
+    for(i = 0; i < magazine->count; i++)
+    {
+        magazine->indices[i] = magazine->indices[i + count];
+    }
+}
+
+void sol_lockfree_pool_magazine_initialise(struct sol_lockfree_pool_magazine* magazine, struct sol_lockfree_pool* pool)
+{
+    magazine->pool = pool;
+    magazine->count = 0;
+
+    atomic_fetch_add_explicit(&pool->magazine_count, 1, memory_order_relaxed);
+}
+
+void sol_lockfree_pool_magazine_terminate(struct sol_lockfree_pool_magazine* magazine)
+{
+    sol_lockfree_pool_magazine_flush(magazine);
+
+    atomic_fetch_sub_explicit(&magazine->pool->magazine_count, 1, memory_order_relaxed);
+}
+
+void sol_lockfree_pool_magazine_flush(struct sol_lockfree_pool_magazine* magazine)
+{
+    sol_lockfree_pool_magazine_return(magazine, magazine->count);
+}
+
+uint32_t sol_lockfree_pool_magazine_acquire_entry_index(struct sol_lockfree_pool_magazine* magazine)
+{
+    if(magazine->count == 0)
+    {
+        sol_lockfree_pool_magazine_refill(magazine, SOL_LOCKFREE_POOL_MAGAZINE_CAPACITY / 2);
+
+        if(magazine->count == 0)
+        {
+            return SOL_LOCKFREE_POOL_INVALID_ENTRY;
+        }
+    }
+
+    return magazine->indices[--magazine->count];
+}
+
+void* sol_lockfree_pool_magazine_acquire_entry(struct sol_lockfree_pool_magazine* magazine)
+{
+    uint32_t entry_index = sol_lockfree_pool_magazine_acquire_entry_index(magazine);
+
+    return sol_lockfree_pool_get_entry_pointer(magazine->pool, entry_index);
+}
+
+void sol_lockfree_pool_magazine_relinquish_entry_index(struct sol_lockfree_pool_magazine* magazine, uint32_t entry_index)
+{
+    assert((uint_fast64_t)entry_index < ((uint_fast64_t)1 << magazine->pool->capacity_exponent));
+
+    if(magazine->count == SOL_LOCKFREE_POOL_MAGAZINE_CAPACITY)
+    {
+        /** return the least recently used half, the top of the magazine is more likely to still be in cache */
+        sol_lockfree_pool_magazine_return(magazine, SOL_LOCKFREE_POOL_MAGAZINE_CAPACITY / 2);
+    }
+
+    magazine->indices[magazine->count++] = entry_index;
+}
+
+void sol_lockfree_pool_magazine_relinquish_entry(struct sol_lockfree_pool_magazine* magazine, void* entry)
+{
+    sol_lockfree_pool_magazine_relinquish_entry_index(magazine, sol_lockfree_pool_get_entry_index(magazine->pool, entry));
+}
@@ -40,6 +40,9 @@ struct sol_lockfree_pool
 {
     atomic_uint_fast64_t head;
 
+    /** number of magazines drawing from this pool that have yet to be terminated, only used to check correctness */
+    atomic_uint_fast32_t magazine_count;
+
     size_t entry_size;
     size_t capacity_exponent;
     char* entry_data;
@@ -60,3 +63,34 @@ void* sol_lockfree_pool_get_entry_pointer(struct sol_lockfree_pool* pool, uint32
 void* sol_lockfree_pool_iterate(struct sol_lockfree_pool* pool, uint32_t* entry_index);
 
 void sol_lockfree_pool_call_for_every_entry(struct sol_lockfree_pool* pool, void(*func)(void* entry, void* data), void* data);
+
+
+/** lockfree_pool_magazine
+ * a small stack of entry indices owned by a single thread that sits in front of a pool
+ * acquiring and relinquishing through a magazine only touches the pools head when the magazine is empty or full,
+ * at which point half of the magazines capacity is moved to/from the pool with a single compare exchange
+ * entries held by a magazine are unavailable to other threads, so the pool must be sized with (magazine count * capacity) entries of overhead
+ * every magazine must be terminated (which flushes it) before the pool it draws from is terminated, terminating a pool with live magazines aborts */
+
+#ifndef SOL_LOCKFREE_POOL_MAGAZINE_CAPACITY
+#define SOL_LOCKFREE_POOL_MAGAZINE_CAPACITY 64
+#endif
+
+struct sol_lockfree_pool_magazine
+{
+    struct sol_lockfree_pool* pool;
+    uint32_t count;
+    uint32_t indices[SOL_LOCKFREE_POOL_MAGAZINE_CAPACITY];
+};
+
+void sol_lockfree_pool_magazine_initialise(struct sol_lockfree_pool_magazine* magazine, struct sol_lockfree_pool* pool);
+void sol_lockfree_pool_magazine_terminate(struct sol_lockfree_pool_magazine* magazine);
+
+/** return every entry held by the magazine to the pool, e.g. before the owning thread goes idle for a long time */
+void sol_lockfree_pool_magazine_flush(struct sol_lockfree_pool_magazine* magazine);
+
+void* sol_lockfree_pool_magazine_acquire_entry(struct sol_lockfree_pool_magazine* magazine);
+uint32_t sol_lockfree_pool_magazine_acquire_entry_index(struct sol_lockfree_pool_magazine* magazine);
+
+void sol_lockfree_pool_magazine_relinquish_entry(struct sol_lockfree_pool_magazine* magazine, void* entry);
+void sol_lockfree_pool_magazine_relinquish_entry_index(struct sol_lockfree_pool_magazine* magazine, uint32_t entry_index);
@@ -0,0 +1,177 @@
+/**
+Copyright 2026 Carl van Mastrigt
+
+This file is part of solipsix.
+
+solipsix is free software: you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+solipsix is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with solipsix.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <stdlib.h>
+#include <assert.h>
+
+#include "lockfree/queue.h"
+
+void sol_lockfree_queue_initialise(struct sol_lockfree_queue* queue, size_t capacity_exponent)
+{
+    size_t i, count;
+
+    assert(capacity_exponent < 32);
+
+    count = (size_t)1 << capacity_exponent;
+
+    atomic_init(&queue->enqueue_position, 0);
+    atomic_init(&queue->dequeue_position, 0);
+
+    queue->capacity_exponent = capacity_exponent;
+    queue->slots = malloc(sizeof(struct sol_lockfree_queue_slot) * count);
+
+    /** slot i is ready to be written by the enqueue at position i */
+    for(i = 0; i < count; i++)
+    {
+        atomic_init(&queue->slots[i].sequence, i);
+        queue->slots[i].entry = NULL;
+    }
+}
+
+void sol_lockfree_queue_terminate(struct sol_lockfree_queue* queue)
+{
+    assert(atomic_load_explicit(&queue->enqueue_position, memory_order_relaxed) == atomic_load_explicit(&queue->dequeue_position, memory_order_relaxed));/// queue should be empty upon termination
+    free(queue->slots);
+}
+
+uint32_t sol_lockfree_queue_enqueue_many(struct sol_lockfree_queue* queue, void* const* entries, uint32_t count)
+{
+    struct sol_lockfree_queue_slot* slot;
+    uint_fast64_t position, mask;
+    uint32_t available, i;
+
+    if(count == 0)
+    {
+        return 0;
+    }
+
+    mask = ((uint_fast64_t)1 << queue->capacity_exponent) - 1;
+
+    position = atomic_load_explicit(&queue->enqueue_position, memory_order_relaxed);
+
+    while(true)
+    {
+        /** count the consecutive slots (from position) that have been emptied by the previous lap of consumers
+         * acquire ensures the consumers are finished reading the entry before it is overwritten */
+        for(available = 0; available < count; available++)
+        {
+            slot = queue->slots + ((position + available) & mask);
+            if(atomic_load_explicit(&slot->sequence, memory_order_acquire) != position + available)
+            {
+                break;
+            }
+        }
+
+        if(available == 0)
+        {
+            /** either full, or another producer took this position (in which case position is stale) */
+            if((int_fast64_t)(atomic_load_explicit(&queue->slots[position & mask].sequence, memory_order_relaxed) - position) < 0)
+            {
+                return 0;
+            }
+            position = atomic_load_explicit(&queue->enqueue_position, memory_order_relaxed);
+        }
+        else if(atomic_compare_exchange_weak_explicit(&queue->enqueue_position, &position, position + available, memory_order_relaxed, memory_order_relaxed))
+        {
+            break;
+        }
+    }
+
+    /** reserved slots can only be modified by this thread until their sequence is updated */
+    for(i = 0; i < available; i++)
+    {
+        assert(entries[i]);/// cannot enqueue NULL
+        slot = queue->slots + ((position + i) & mask);
+        slot->entry = entries[i];
+        atomic_store_explicit(&slot->sequence, position + i + 1, memory_order_release);
+    }
+
+    return available;
+}
+
+uint32_t sol_lockfree_queue_dequeue_many(struct sol_lockfree_queue* queue, void** entries, uint32_t count)
+{
+    struct sol_lockfree_queue_slot* slot;
+    uint_fast64_t position, mask;
+    uint32_t available, i;
+
+    if(count == 0)
+    {
+        return 0;
+    }
+
+    mask = ((uint_fast64_t)1 << queue->capacity_exponent) - 1;
+
+    position = atomic_load_explicit(&queue->dequeue_position, memory_order_relaxed);
+
+    while(true)
+    {
+        /** count the consecutive slots (from position) that have been filled by producers this lap
+         * acquire ensures the entry written by the producer is visible */
+        for(available = 0; available < count; available++)
+        {
+            slot = queue->slots + ((position + available) & mask);
+            if(atomic_load_explicit(&slot->sequence, memory_order_acquire) != position + available + 1)
+            {
+                break;
+            }
+        }
+
+        if(available == 0)
+        {
+            /** either empty, or another consumer took this position (in which case position is stale) */
+            if((int_fast64_t)(atomic_load_explicit(&queue->slots[position & mask].sequence, memory_order_relaxed) - (position + 1)) < 0)
+            {
+                return 0;
+            }
+            position = atomic_load_explicit(&queue->dequeue_position, memory_order_relaxed);
+        }
+        else if(atomic_compare_exchange_weak_explicit(&queue->dequeue_position, &position, position + available, memory_order_relaxed, memory_order_relaxed))
+        {
+            break;
+        }
+    }
+
+    for(i = 0; i < available; i++)
+    {
+        slot = queue->slots + ((position + i) & mask);
+        entries[i] = slot->entry;
+        /** mark the slot as ready for the producer of the next lap */
+        atomic_store_explicit(&slot->sequence, position + i + mask + 1, memory_order_release);
+    }
+
+    return available;
+}
+
+bool sol_lockfree_queue_enqueue(struct sol_lockfree_queue* queue, void* entry)
+{
+    return sol_lockfree_queue_enqueue_many(queue, &entry, 1) == 1;
+}
+
+void* sol_lockfree_queue_dequeue(struct sol_lockfree_queue* queue)
+{
+    void* entry;
+
+    if(sol_lockfree_queue_dequeue_many(queue, &entry, 1))
+    {
+        return entry;
+    }
+
+    return NULL;
+}
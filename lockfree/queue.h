@@ -0,0 +1,69 @@
+/**
+Copyright 2026 Carl van Mastrigt
+
+This file is part of solipsix.
+
+solipsix is free software: you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+solipsix is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with solipsix.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+
+/** lockfree_queue
+ * a bounded multi-producer multi-consumer FIFO queue (Vyukov style), each slot has a sequence number indicating which lap of the ring it is ready for
+ * like the deque this stores pointers directly, NULL cannot be enqueued as it is used to indicate the queue was empty
+ * producers and consumers only contend on their own position, so enqueueing and dequeueing concurrently don't interfere (beyond sharing slots)
+ * the queue does not grow, enqueue will fail when it is full
+ * note: a producer or consumer that is preempted between reserving a slot and filling/emptying it will cause the queue to appear full/empty at that slot until it resumes */
+
+/** size of the padding used to keep the enqueue and dequeue positions on separate cache lines */
+#ifndef SOL_LOCKFREE_QUEUE_FALSE_SHARING_SIZE
+#define SOL_LOCKFREE_QUEUE_FALSE_SHARING_SIZE 64
+#endif
+
+struct sol_lockfree_queue_slot
+{
+    atomic_uint_fast64_t sequence;
+    void* entry;
+};
+
+struct sol_lockfree_queue
+{
+    atomic_uint_fast64_t enqueue_position;
+    char enqueue_padding[SOL_LOCKFREE_QUEUE_FALSE_SHARING_SIZE - sizeof(atomic_uint_fast64_t)];
+
+    atomic_uint_fast64_t dequeue_position;
+    char dequeue_padding[SOL_LOCKFREE_QUEUE_FALSE_SHARING_SIZE - sizeof(atomic_uint_fast64_t)];
+
+    size_t capacity_exponent;
+    struct sol_lockfree_queue_slot* slots;
+};
+
+void sol_lockfree_queue_initialise(struct sol_lockfree_queue* queue, size_t capacity_exponent);
+void sol_lockfree_queue_terminate(struct sol_lockfree_queue* queue);
+
+/// returns false if the queue was full
+bool sol_lockfree_queue_enqueue(struct sol_lockfree_queue* queue, void* entry);
+/// returns NULL if the queue was empty
+void* sol_lockfree_queue_dequeue(struct sol_lockfree_queue* queue);
+
+/** batched variants reserve as many consecutive slots as are available (up to count) with a single compare exchange
+ * returns the number of entries actually enqueued/dequeued, which will be less than count if the queue became full/empty
+ * entries enqueued together are dequeued contiguously and in order, though another consumer may take some of them */
+uint32_t sol_lockfree_queue_enqueue_many(struct sol_lockfree_queue* queue, void* const* entries, uint32_t count);
+uint32_t sol_lockfree_queue_dequeue_many(struct sol_lockfree_queue* queue, void** entries, uint32_t count);
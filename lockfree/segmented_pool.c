@@ -0,0 +1,364 @@
+/**
+Copyright 2026 Carl van Mastrigt
+
+This file is part of solipsix.
+
+solipsix is free software: you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+solipsix is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with solipsix.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <assert.h>
+#include <threads.h>
+
+#include "sol_utils.h"
+
+#include "lockfree/segmented_pool.h"
+
+static inline struct sol_lockfree_segmented_pool_segment* sol_lockfree_segmented_pool_get_segment(struct sol_lockfree_segmented_pool* pool, uint32_t segment_index)
+{
+    /** offsetting by one makes the table index the position of the highest set bit */
+    const uint32_t table_index = sol_u32_exp_le(segment_index + 1);
+
+    return pool->segment_tables[table_index] + (segment_index + 1 - ((uint32_t)1 << table_index));
+}
+
+static inline uint32_t* sol_lockfree_segmented_pool_next_pointer(struct sol_lockfree_segmented_pool* pool, uint32_t entry_index)
+{
+    return sol_lockfree_segmented_pool_get_segment(pool, entry_index >> pool->segment_exponent)->next_buffer + (entry_index & (((uint32_t)1 << pool->segment_exponent) - 1));
+}
+
+/** the next buffers must already link the entries from first to last (inclusive) */
+static void sol_lockfree_segmented_pool_relinquish_entry_index_range(struct sol_lockfree_segmented_pool* pool, uint32_t first_entry_index, uint32_t last_entry_index)
+{
+    uint_fast64_t current_head, replacement_head;
+    uint32_t* last_next;
+
+    last_next = sol_lockfree_segmented_pool_next_pointer(pool, last_entry_index);
+
+    current_head = atomic_load_explicit(&pool->head, memory_order_relaxed);
+
+    do
+    {
+        *last_next = (uint32_t)(current_head & SOL_LOCKFREE_POOL_ENTRY_MASK);
+        replacement_head = ((current_head & SOL_LOCKFREE_POOL_CHECK_MASK) + SOL_LOCKFREE_POOL_CHECK_UNIT) | first_entry_index;
+    }
+    while(!atomic_compare_exchange_weak_explicit(&pool->head, &current_head, replacement_head, memory_order_release, memory_order_relaxed));
+}
+
+/** returns false if the pool was at its limit, otherwise returns true once another thread may have made entries available */
+static bool sol_lockfree_segmented_pool_grow(struct sol_lockfree_segmented_pool* pool)
+{
+    struct sol_lockfree_segmented_pool_segment* segment;
+    uint32_t segment_index, first_entry_index, i, count;
+
+    if(atomic_flag_test_and_set_explicit(&pool->growing, memory_order_acquire))
+    {
+        /** another thread is adding a segment, give it a chance to finish before trying to acquire again */
+        thrd_yield();
+        return true;
+    }
+
+    /** entries may have been relinquished (or a segment added) since this thread found the pool empty */
+    if((atomic_load_explicit(&pool->head, memory_order_acquire) & SOL_LOCKFREE_POOL_ENTRY_MASK) != SOL_LOCKFREE_POOL_INVALID_ENTRY)
+    {
+        atomic_flag_clear_explicit(&pool->growing, memory_order_release);
+        return true;
+    }
+
+    segment_index = (uint32_t)atomic_load_explicit(&pool->segment_count, memory_order_relaxed);
+
+    if(segment_index == pool->segment_limit)
+    {
+        atomic_flag_clear_explicit(&pool->growing, memory_order_release);
+        return false;
+    }
+
+    count = (uint32_t)1 << pool->segment_exponent;
+    first_entry_index = segment_index << pool->segment_exponent;
+
+    /** the first segment of each table is at a power of 2 (offset by one), the table must exist before the segment count that makes it accessible is stored */
+    if(((segment_index + 1) & segment_index) == 0)
+    {
+        pool->segment_tables[sol_u32_exp_le(segment_index + 1)] = malloc(sizeof(struct sol_lockfree_segmented_pool_segment) * (segment_index + 1));
+    }
+
+    segment = sol_lockfree_segmented_pool_get_segment(pool, segment_index);
+    segment->entry_data = malloc(pool->entry_size << pool->segment_exponent);
+    segment->next_buffer = malloc(sizeof(uint32_t) << pool->segment_exponent);
+
+    for(i = 0; i < count; i++)
+    {
+        segment->next_buffer[i] = first_entry_index + i + 1;
+        if(pool->entry_initialise)
+        {
+            pool->entry_initialise(segment->entry_data + pool->entry_size * i, first_entry_index + i, pool->entry_initialise_data);
+        }
+    }
+
+    /** the segment must be accessible before any of its entries can be acquired, the release in relinquish covers this too but this keeps `segment_count` meaningful */
+    atomic_store_explicit(&pool->segment_count, segment_index + 1, memory_order_release);
+
+    sol_lockfree_segmented_pool_relinquish_entry_index_range(pool, first_entry_index, first_entry_index + count - 1);
+
+    atomic_flag_clear_explicit(&pool->growing, memory_order_release);
+
+    return true;
+}
+
+void sol_lockfree_segmented_pool_initialise(struct sol_lockfree_segmented_pool* pool, size_t segment_exponent, uint32_t segment_limit, size_t entry_size, void(*entry_initialise)(void* entry, uint32_t entry_index, void* data), void* entry_initialise_data)
+{
+    uint32_t max_segment_limit, i;
+
+    assert(segment_exponent <= SOL_LOCKFREE_SEGMENTED_POOL_INDEX_BITS);
+
+    /** the last index of the last possible segment would be the invalid entry, so that segment can never be fully used */
+    max_segment_limit = ((uint32_t)1 << (SOL_LOCKFREE_SEGMENTED_POOL_INDEX_BITS - segment_exponent)) - 1;
+    if(segment_limit == 0 || segment_limit > max_segment_limit)
+    {
+        segment_limit = max_segment_limit;
+    }
+    assert(segment_limit > 0);/** segments are too large, at most 2^24 - 1 entries are addressable */
+
+    atomic_init(&pool->head, SOL_LOCKFREE_POOL_INVALID_ENTRY);
+    atomic_init(&pool->magazine_count, 0);
+    atomic_init(&pool->segment_count, 0);
+    atomic_flag_clear_explicit(&pool->growing, memory_order_relaxed);
+
+    pool->entry_size = entry_size;
+    pool->segment_exponent = segment_exponent;
+    pool->segment_limit = segment_limit;
+    for(i = 0; i < SOL_LOCKFREE_SEGMENTED_POOL_SEGMENT_TABLE_COUNT; i++)
+    {
+        pool->segment_tables[i] = NULL;
+    }
+
+    pool->entry_initialise = entry_initialise;
+    pool->entry_initialise_data = entry_initialise_data;
+
+    /** start with one segment so that the common case never has to grow */
+    sol_lockfree_segmented_pool_grow(pool);
+}
+
+void sol_lockfree_segmented_pool_terminate(struct sol_lockfree_segmented_pool* pool)
+{
+    struct sol_lockfree_segmented_pool_segment* segment;
+    uint32_t i, segment_count;
+    uint_fast32_t magazine_count = atomic_load_explicit(&pool->magazine_count, memory_order_acquire);
+
+    /** checked even without asserts: the entries held by a live magazine would be lost, and the magazine left pointing at freed memory */
+    if(magazine_count != 0)
+    {
+        fprintf(stderr, "lockfree segmented pool terminated while %u magazine(s) drawing from it are still live, they must be terminated first\n", (unsigned)magazine_count);
+        abort();
+    }
+
+    segment_count = (uint32_t)atomic_load_explicit(&pool->segment_count, memory_order_acquire);
+
+    for(i = 0; i < segment_count; i++)
+    {
+        segment = sol_lockfree_segmented_pool_get_segment(pool, i);
+        free(segment->entry_data);
+        free(segment->next_buffer);
+    }
+
+    for(i = 0; i < SOL_LOCKFREE_SEGMENTED_POOL_SEGMENT_TABLE_COUNT; i++)
+    {
+        free(pool->segment_tables[i]);
+    }
+}
+
+uint32_t sol_lockfree_segmented_pool_acquire_entry_index(struct sol_lockfree_segmented_pool* pool)
+{
+    uint_fast64_t entry_index, current_head, replacement_head;
+
+    current_head = atomic_load_explicit(&pool->head, memory_order_acquire);
+
+    while(true)
+    {
+        entry_index = current_head & SOL_LOCKFREE_POOL_ENTRY_MASK;
+
+        if(entry_index == (uint_fast64_t)SOL_LOCKFREE_POOL_INVALID_ENTRY)
+        {
+            if( ! sol_lockfree_segmented_pool_grow(pool))
+            {
+                return SOL_LOCKFREE_POOL_INVALID_ENTRY;
+            }
+            current_head = atomic_load_explicit(&pool->head, memory_order_acquire);
+            continue;
+        }
+
+        replacement_head = ((current_head & SOL_LOCKFREE_POOL_CHECK_MASK) + SOL_LOCKFREE_POOL_CHECK_UNIT) | (uint_fast64_t)(*sol_lockfree_segmented_pool_next_pointer(pool, (uint32_t)entry_index));
+
+        if(atomic_compare_exchange_weak_explicit(&pool->head, &current_head, replacement_head, memory_order_acquire, memory_order_acquire))
+        {
+            /// as with the regular pool fail must acquire as the "next" member of "first" element may have changed
+            return (uint32_t)entry_index;
+        }
+    }
+}
+
+void sol_lockfree_segmented_pool_relinquish_entry_index(struct sol_lockfree_segmented_pool* pool, uint32_t entry_index)
+{
+    assert(entry_index != SOL_LOCKFREE_POOL_INVALID_ENTRY);
+    assert((entry_index >> pool->segment_exponent) < atomic_load_explicit(&pool->segment_count, memory_order_relaxed));
+
+    sol_lockfree_segmented_pool_relinquish_entry_index_range(pool, entry_index, entry_index);
+}
+
+void* sol_lockfree_segmented_pool_get_entry_pointer(struct sol_lockfree_segmented_pool* pool, uint32_t entry_index)
+{
+    if(entry_index == SOL_LOCKFREE_POOL_INVALID_ENTRY)
+    {
+        return NULL;
+    }
+
+    assert((entry_index >> pool->segment_exponent) < atomic_load_explicit(&pool->segment_count, memory_order_relaxed));
+
+    return sol_lockfree_segmented_pool_get_segment(pool, entry_index >> pool->segment_exponent)->entry_data + (entry_index & (((uint32_t)1 << pool->segment_exponent) - 1)) * pool->entry_size;
+}
+
+uint32_t sol_lockfree_segmented_pool_capacity(struct sol_lockfree_segmented_pool* pool)
+{
+    return (uint32_t)atomic_load_explicit(&pool->segment_count, memory_order_relaxed) << pool->segment_exponent;
+}
+
+
+
+
+
+
+
+/** moves up to `count` entries from the pool to the top of the magazine with a single compare exchange, growing the pool if it is empty */
+static void sol_lockfree_segmented_pool_magazine_refill(struct sol_lockfree_segmented_pool_magazine* magazine, uint32_t count)
+{
+    struct sol_lockfree_segmented_pool* pool = magazine->pool;
+    uint_fast64_t current_head, replacement_head;
+    uint32_t entry_index, taken;
+
+    assert(magazine->count + count <= SOL_LOCKFREE_POOL_MAGAZINE_CAPACITY);
+
+    current_head = atomic_load_explicit(&pool->head, memory_order_acquire);
+
+    while(true)
+    {
+        /** as with the regular pool's magazine, next values read here may be stale but any modification changes head so the compare exchange will fail
+         * stale next values are still always indices in existing segments (or invalid entry) so this can't read out of bounds */
+        entry_index = (uint32_t)(current_head & SOL_LOCKFREE_POOL_ENTRY_MASK);
+        taken = 0;
+
+        while(taken < count && entry_index != SOL_LOCKFREE_POOL_INVALID_ENTRY)
+        {
+            magazine->indices[magazine->count + taken] = entry_index;
+            entry_index = *sol_lockfree_segmented_pool_next_pointer(pool, entry_index);
+            taken++;
+        }
+
+        if(taken == 0)
+        {
+            if( ! sol_lockfree_segmented_pool_grow(pool))
+            {
+                return;
+            }
+            current_head = atomic_load_explicit(&pool->head, memory_order_acquire);
+            continue;
+        }
+
+        replacement_head = ((current_head & SOL_LOCKFREE_POOL_CHECK_MASK) + SOL_LOCKFREE_POOL_CHECK_UNIT) | (uint_fast64_t)entry_index;
+
+        if(atomic_compare_exchange_weak_explicit(&pool->head, &current_head, replacement_head, memory_order_acquire, memory_order_acquire))
+        {
+            magazine->count += taken;
+            return;
+        }
+    }
+}
+
+/** returns the bottom `count` entries of the magazine to the pool as a single range */
+static void sol_lockfree_segmented_pool_magazine_return(struct sol_lockfree_segmented_pool_magazine* magazine, uint32_t count)
+{
+    struct sol_lockfree_segmented_pool* pool = magazine->pool;
+    uint32_t i;
+
+    assert(count <= magazine->count);
+
+    if(count == 0)
+    {
+        return;
+    }
+
+    /** this thread owns these entries so is free to link them together */
+    for(i = 1; i < count; i++)
+    {
+        *sol_lockfree_segmented_pool_next_pointer(pool, magazine->indices[i - 1]) = magazine->indices[i];
+    }
+
+    sol_lockfree_segmented_pool_relinquish_entry_index_range(pool, magazine->indices[0], magazine->indices[count - 1]);
+
+    magazine->count -= count;
+
+    for(i = 0; i < magazine->count; i++)
+    {
+        magazine->indices[i] = magazine->indices[i + count];
+    }
+}
+
+void sol_lockfree_segmented_pool_magazine_initialise(struct sol_lockfree_segmented_pool_magazine* magazine, struct sol_lockfree_segmented_pool* pool)
+{
+    magazine->pool = pool;
+    magazine->count = 0;
+
+    atomic_fetch_add_explicit(&pool->magazine_count, 1, memory_order_relaxed);
+}
+
+void sol_lockfree_segmented_pool_magazine_terminate(struct sol_lockfree_segmented_pool_magazine* magazine)
+{
+    sol_lockfree_segmented_pool_magazine_flush(magazine);
+
+    atomic_fetch_sub_explicit(&magazine->pool->magazine_count, 1, memory_order_relaxed);
+}
+
+void sol_lockfree_segmented_pool_magazine_flush(struct sol_lockfree_segmented_pool_magazine* magazine)
+{
+    sol_lockfree_segmented_pool_magazine_return(magazine, magazine->count);
+}
+
+uint32_t sol_lockfree_segmented_pool_magazine_acquire_entry_index(struct sol_lockfree_segmented_pool_magazine* magazine)
+{
+    if(magazine->count == 0)
+    {
+        sol_lockfree_segmented_pool_magazine_refill(magazine, SOL_LOCKFREE_POOL_MAGAZINE_CAPACITY / 2);
+
+        if(magazine->count == 0)
+        {
+            return SOL_LOCKFREE_POOL_INVALID_ENTRY;
+        }
+    }
+
+    return magazine->indices[--magazine->count];
+}
+
+void sol_lockfree_segmented_pool_magazine_relinquish_entry_index(struct sol_lockfree_segmented_pool_magazine* magazine, uint32_t entry_index)
+{
+    assert(entry_index != SOL_LOCKFREE_POOL_INVALID_ENTRY);
+    assert((entry_index >> magazine->pool->segment_exponent) < atomic_load_explicit(&magazine->pool->segment_count, memory_order_relaxed));
+
+    if(magazine->count == SOL_LOCKFREE_POOL_MAGAZINE_CAPACITY)
+    {
+        /** return the least recently used half, the top of the magazine is more likely to still be in cache */
+        sol_lockfree_segmented_pool_magazine_return(magazine, SOL_LOCKFREE_POOL_MAGAZINE_CAPACITY / 2);
+    }
+
+    magazine->indices[magazine->count++] = entry_index;
+}
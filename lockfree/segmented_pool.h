@@ -0,0 +1,110 @@
+/**
+Copyright 2026 Carl van Mastrigt
+
+This file is part of solipsix.
+
+solipsix is free software: you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+solipsix is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with solipsix.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+
+#include "lockfree/pool.h"
+
+/** lockfree_segmented_pool
+ * a pool that starts with a single segment of entries and adds more segments as required, up to the same limit on total entries as a regular pool
+ * entries never move once created, so pointers to entries remain valid until the pool is terminated
+ * an entry index is its segment in the high bits and its offset within that segment in the low bits
+ * acquiring and relinquishing entries is lockfree (using the same head + check counter scheme as the regular pool)
+ * only adding a segment serialises, other threads needing entries at the same time will yield until it has been added
+ *
+ * because entries may be created at any point the initialise function provided is called for every entry when its segment is created
+ * the pool doesn't (efficiently) support converting pointers back to indices, so users will generally want to store the index in the entry upon initialisation */
+
+/** same limit on total entries as the regular pool, the invalid entry must not be addressable */
+#define SOL_LOCKFREE_SEGMENTED_POOL_INDEX_BITS 24
+
+/** the segment table grows with the segments without ever moving: table k holds 2^k segments, enough for any number of segments up to the limit */
+#define SOL_LOCKFREE_SEGMENTED_POOL_SEGMENT_TABLE_COUNT (SOL_LOCKFREE_SEGMENTED_POOL_INDEX_BITS + 1)
+
+struct sol_lockfree_segmented_pool_segment
+{
+    char* entry_data;
+    uint32_t* next_buffer;
+};
+
+struct sol_lockfree_segmented_pool
+{
+    atomic_uint_fast64_t head;
+
+    /** number of magazines drawing from this pool that have yet to be terminated, only used to check correctness */
+    atomic_uint_fast32_t magazine_count;
+
+    /** segments are only ever added, this is the count of segments that are safe to access */
+    atomic_uint_fast32_t segment_count;
+    /** set while a segment is being added */
+    atomic_flag growing;
+
+    size_t entry_size;
+    size_t segment_exponent;
+    uint32_t segment_limit;
+    /** segment s is in table floor(log2(s + 1)), tables are only allocated once a segment in them is added */
+    struct sol_lockfree_segmented_pool_segment* segment_tables[SOL_LOCKFREE_SEGMENTED_POOL_SEGMENT_TABLE_COUNT];
+
+    void(*entry_initialise)(void* entry, uint32_t entry_index, void* data);
+    void* entry_initialise_data;
+};
+
+/** `segment_exponent` is the log2 of the number of entries in each segment, `segment_limit` is the maximum number of segments (0 uses the maximum possible)
+ * `entry_initialise` may be NULL */
+void sol_lockfree_segmented_pool_initialise(struct sol_lockfree_segmented_pool* pool, size_t segment_exponent, uint32_t segment_limit, size_t entry_size, void(*entry_initialise)(void* entry, uint32_t entry_index, void* data), void* entry_initialise_data);
+void sol_lockfree_segmented_pool_terminate(struct sol_lockfree_segmented_pool* pool);
+
+/** returns SOL_LOCKFREE_POOL_INVALID_ENTRY only when the pool cannot grow any further */
+uint32_t sol_lockfree_segmented_pool_acquire_entry_index(struct sol_lockfree_segmented_pool* pool);
+
+void sol_lockfree_segmented_pool_relinquish_entry_index(struct sol_lockfree_segmented_pool* pool, uint32_t entry_index);
+
+void* sol_lockfree_segmented_pool_get_entry_pointer(struct sol_lockfree_segmented_pool* pool, uint32_t entry_index);
+
+/** current number of entries, including those in use */
+uint32_t sol_lockfree_segmented_pool_capacity(struct sol_lockfree_segmented_pool* pool);
+
+
+/** lockfree_segmented_pool_magazine
+ * the same as `sol_lockfree_pool_magazine` (see pool.h) but in front of a segmented pool, the pool grows when a magazine can't be refilled
+ * entries held by a magazine are unavailable to other threads, so a limited pool must be sized with (magazine count * capacity) entries of overhead
+ * every magazine must be terminated (which flushes it) before the pool it draws from is terminated, terminating a pool with live magazines aborts */
+
+struct sol_lockfree_segmented_pool_magazine
+{
+    struct sol_lockfree_segmented_pool* pool;
+    uint32_t count;
+    uint32_t indices[SOL_LOCKFREE_POOL_MAGAZINE_CAPACITY];
+};
+
+void sol_lockfree_segmented_pool_magazine_initialise(struct sol_lockfree_segmented_pool_magazine* magazine, struct sol_lockfree_segmented_pool* pool);
+void sol_lockfree_segmented_pool_magazine_terminate(struct sol_lockfree_segmented_pool_magazine* magazine);
+
+/** return every entry held by the magazine to the pool, e.g. before the owning thread goes idle for a long time */
+void sol_lockfree_segmented_pool_magazine_flush(struct sol_lockfree_segmented_pool_magazine* magazine);
+
+/** returns SOL_LOCKFREE_POOL_INVALID_ENTRY only when the pool cannot grow any further */
+uint32_t sol_lockfree_segmented_pool_magazine_acquire_entry_index(struct sol_lockfree_segmented_pool_magazine* magazine);
+
+void sol_lockfree_segmented_pool_magazine_relinquish_entry_index(struct sol_lockfree_segmented_pool_magazine* magazine, uint32_t entry_index);
@@ -215,29 +215,32 @@ void sol_overlay_rendering_resources_default_initialise(struct sol_overlay_rende
         [SOL_OVERLAY_IMAGE_ATLAS_TYPE_BC4] = 
         {
             .format = VK_FORMAT_BC4_UNORM_BLOCK,
-            .usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+            .usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
             .image_array_dimension = 1,
             .image_x_dimension_exponent = 9,
             .image_y_dimension_exponent = 9,
             .grid_tile_size = u16_vec2_set(4, 4),
+            .defragment = true,
         },
         [SOL_OVERLAY_IMAGE_ATLAS_TYPE_R8_UNORM] = 
         {
             .format = VK_FORMAT_R8_UNORM,
-            .usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+            .usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
             .image_array_dimension = 1,
             .image_x_dimension_exponent = 9,
             .image_y_dimension_exponent = 9,
             .grid_tile_size = u16_vec2_set(4, 4),
+            .defragment = true,
         },
         [SOL_OVERLAY_IMAGE_ATLAS_TYPE_RGBA8_UNORM] = 
         {
             .format = VK_FORMAT_R8G8B8A8_UNORM,
-            .usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+            .usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
             .image_array_dimension = 1,
             .image_x_dimension_exponent = 9,
             .image_y_dimension_exponent = 9,
             .grid_tile_size = u16_vec2_set(4, 4),
+            .defragment = true,
         }
     };
 
@@ -660,7 +663,6 @@ VkPipeline sol_overlay_render_pipeline_create_dynamic(struct cvm_vk_device* devi
 
 void sol_overlay_render_batch_initialise(struct sol_overlay_render_batch* batch, struct cvm_vk_device* device, VkDeviceSize upload_buffer_size)
 {
-    uint32_t i;
     VkDeviceSize upload_buffer_alignment = sol_vk_buffer_alignment_requirements(device, VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
 
     sol_overlay_render_element_list_initialise(&batch->elements, 64);
@@ -668,22 +670,10 @@ void sol_overlay_render_batch_initialise(struct sol_overlay_render_batch* batch,
 
     /** note: fixed/limited size lends itself well to buddy allocator use */
     sol_buffer_initialise(&batch->upload_buffer, upload_buffer_size, upload_buffer_alignment);
-
-    for(i = 0; i< SOL_OVERLAY_IMAGE_ATLAS_TYPE_COUNT; i++)
-    {
-        sol_vk_buf_img_copy_list_initialise(batch->atlas_copy_lists + i, 64);
-    }
 }
 
 void sol_overlay_render_batch_terminate(struct sol_overlay_render_batch* batch)
 {
-    uint32_t i;
-
-    for(i = 0; i< SOL_OVERLAY_IMAGE_ATLAS_TYPE_COUNT; i++)
-    {
-        sol_vk_buf_img_copy_list_terminate(batch->atlas_copy_lists + i);
-    }
-
     sol_buffer_terminate(&batch->upload_buffer);
 
     sol_overlay_rendering_deferred_operation_list_terminate(&batch->deferred_operations);
@@ -704,7 +694,6 @@ void sol_overlay_render_step_compose_elements(struct sol_overlay_render_batch* b
 
     for(i = 0; i< SOL_OVERLAY_IMAGE_ATLAS_TYPE_COUNT; i++)
     {
-        assert(sol_vk_buf_img_copy_list_count(batch->atlas_copy_lists + i) == 0);
         assert(sol_image_atlas_access_range_is_active(rendering_resources->atlases[i]));
     }
     assert(sol_buffer_used_space(&batch->upload_buffer) == 0);
@@ -816,7 +805,6 @@ void sol_overlay_render_step_write_descriptors(struct sol_overlay_render_batch*
 void sol_overlay_render_step_early_gpu_work(struct sol_overlay_render_batch* batch, struct sol_overlay_rendering_resources* rendering_resources, struct cvm_vk_device* device, VkCommandBuffer command_buffer)
 {
     struct sol_vk_supervised_image* atlas_supervised_image;
-    struct sol_vk_buf_img_copy_list* atlas_copy_list;
     struct sol_overlay_rendering_deferred_operation deferred_operation;
     VkBuffer staging_buffer;
     VkDeviceSize staging_offset;
@@ -828,9 +816,7 @@ void sol_overlay_render_step_early_gpu_work(struct sol_overlay_render_batch* bat
 
     for(i = 0; i < SOL_OVERLAY_IMAGE_ATLAS_TYPE_COUNT; i++)
     {
-        atlas_copy_list = batch->atlas_copy_lists + i;
-        atlas_supervised_image = sol_image_atlas_access_supervised_image(batch->rendering_resources->atlases[i]);
-        sol_vk_supervised_image_execute_copies(atlas_supervised_image, atlas_copy_list, command_buffer, staging_buffer, staging_offset);
+        sol_image_atlas_execute_copies(batch->rendering_resources->atlases[i], command_buffer, staging_buffer, staging_offset);
     }
 
     deferred_operation_count = batch->deferred_operations.count;
@@ -888,16 +874,9 @@ void sol_overlay_render_step_draw_elements(struct sol_overlay_render_batch* batc
 
 void sol_overlay_render_step_completion(struct sol_overlay_render_batch* batch, struct sol_vk_timeline_semaphore_moment completion_moment)
 {
-    uint32_t i;
-
     const bool last_release = sol_vk_staging_buffer_allocation_release(batch->staging_buffer, &batch->staging_buffer_allocation, &completion_moment);
     assert(last_release);
 
-    for(i = 0; i< SOL_OVERLAY_IMAGE_ATLAS_TYPE_COUNT; i++)
-    {
-        sol_vk_buf_img_copy_list_reset(batch->atlas_copy_lists + i);
-    }
-
     sol_buffer_reset(&batch->upload_buffer);
     sol_overlay_render_element_list_reset(&batch->elements);
     sol_overlay_rendering_deferred_operation_list_reset(&batch->deferred_operations);
@@ -130,10 +130,7 @@ struct sol_overlay_render_batch
     /** miscellaneous inline upload buffer */
     struct sol_buffer upload_buffer;
 
-    /** copy/upload lists that will be provided to the image atlas for scope setup 
-     * note: these are NOT provided/managed as part of image atlas interface because there are legitimate uses of the image atlas that do not require upload */
-    struct sol_vk_buf_img_copy_list atlas_copy_lists[SOL_OVERLAY_IMAGE_ATLAS_TYPE_COUNT];
-    /** offset applied to all copies */
+    /** offset applied to all copies (which are recorded into the atlases copy lists) */
     VkDeviceSize upload_offset;
 
     /** this is just a data container for when the staging allocayion is made */
@@ -555,7 +555,8 @@ static inline bool sol_font_obtain_glyph_atlas_location(struct sol_font* font, c
 
 	image_atlas = render_batch->rendering_resources->atlases[glyph_map_entry->atlas_type];
 
-	find_result = sol_image_atlas_find_identified_entry(image_atlas, glyph_map_entry->id_in_atlas, glyph_atlas_location_result);
+	/** glyphs are composed on a single thread, so always use the first of the atlas thread lists */
+	find_result = sol_image_atlas_find_identified_entry(image_atlas, 0, glyph_map_entry->id_in_atlas, glyph_atlas_location_result);
 
 	switch (find_result)
 	{
@@ -574,7 +575,7 @@ static inline bool sol_font_obtain_glyph_atlas_location(struct sol_font* font, c
 			return false;
 		}
 
-		obtain_result = sol_image_atlas_obtain_identified_entry(image_atlas, glyph_map_entry->id_in_atlas, glyph_size, glyph_atlas_location_result);
+		obtain_result = sol_image_atlas_obtain_identified_entry(image_atlas, 0, glyph_map_entry->id_in_atlas, glyph_size, glyph_atlas_location_result);
 
 		if(obtain_result != SOL_IMAGE_ATLAS_SUCCESS_INSERTED)
 		{
@@ -586,7 +587,7 @@ static inline bool sol_font_obtain_glyph_atlas_location(struct sol_font* font, c
 
 		pixel_upload_segment = sol_vk_image_prepare_copy_simple(
 			atlas_raw_image,
-			render_batch->atlas_copy_lists + glyph_map_entry->atlas_type,
+			sol_image_atlas_access_copy_list(image_atlas, 0),
 			&render_batch->upload_buffer,
 			glyph_atlas_location_result->offset,
 			glyph_size,
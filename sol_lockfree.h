@@ -20,5 +20,8 @@ along with solipsix.  If not, see <https://www.gnu.org/licenses/>.
 #pragma once
 
 #include "lockfree/pool.h"
+#include "lockfree/segmented_pool.h"
 #include "lockfree/stack.h"
 #include "lockfree/hopper.h"
+#include "lockfree/deque.h"
+#include "lockfree/queue.h"
@@ -24,6 +24,9 @@ along with solipsix.  If not, see <https://www.gnu.org/licenses/>.
 #include "sync/gate.h"
 #include "sync/barrier.h"
 
+// optional instrumentation of the task system
+#include "sync/task_trace.h"
+
 // these sync structs are built on top of other primitives
 #include "sync/queue.h"
 
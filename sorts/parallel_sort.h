@@ -0,0 +1,346 @@
+/**
+Copyright 2026 Carl van Mastrigt
+
+This file is part of solipsix.
+
+solipsix is free software: you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+solipsix is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with solipsix.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <assert.h>
+
+#include "sol_utils.h"
+#include "sync/task.h"
+
+/** parallel samplesort run as a chain of tasks on a sol_sync_task_system
+ * splitters are chosen from a sample of the data, then blocks of the data are counted and scattered into buckets (in scratch) in parallel
+ * and finally the buckets are sorted (with the serial introsort in sorts/quicksort.h) and copied back in parallel
+ * many elements with equal keys end up in the same bucket, which will limit how well the final phase is spread across workers
+ * below `SOL_PARALLEL_SORT_SERIAL_THRESHOLD` elements the whole sort is a single task running the serial sort
+ *
+ * instantiating this also instantiates the serial sort as `<prefix>_serial(data, count [, context])` */
+
+#ifndef SOL_PARALLEL_SORT_TYPE
+#error must define SOL_PARALLEL_SORT_TYPE
+#define SOL_PARALLEL_SORT_TYPE int
+#endif
+
+#ifndef SOL_PARALLEL_SORT_STRUCT_NAME
+#error must define SOL_PARALLEL_SORT_STRUCT_NAME
+#define SOL_PARALLEL_SORT_STRUCT_NAME placeholder_parallel_sort
+#endif
+
+#ifndef SOL_PARALLEL_SORT_FUNCTION_PREFIX
+#define SOL_PARALLEL_SORT_FUNCTION_PREFIX SOL_PARALLEL_SORT_STRUCT_NAME
+#endif
+
+#ifndef SOL_PARALLEL_SORT_COMPARE_LT
+#error must define SOL_PARALLEL_SORT_COMPARE_LT(const SOL_PARALLEL_SORT_TYPE* a, const SOL_PARALLEL_SORT_TYPE* b)
+#ifdef SOL_PARALLEL_SORT_CONTEXT_TYPE
+#define SOL_PARALLEL_SORT_COMPARE_LT(A, B, CTX) ((A) < (B))
+#else
+#define SOL_PARALLEL_SORT_COMPARE_LT(A, B) ((A) < (B))
+#endif
+#endif
+
+/** below this many elements parallel sorting isn't worth the overhead */
+#ifndef SOL_PARALLEL_SORT_SERIAL_THRESHOLD
+#define SOL_PARALLEL_SORT_SERIAL_THRESHOLD 16384
+#endif
+
+/** must be a power of 2 (and no more than 256), more buckets spreads the final phase across more workers at the cost of a slightly more expensive classification */
+#ifndef SOL_PARALLEL_SORT_BUCKET_COUNT
+#define SOL_PARALLEL_SORT_BUCKET_COUNT 64
+#endif
+
+/** number of blocks the data is split into for counting and scattering */
+#ifndef SOL_PARALLEL_SORT_BLOCK_COUNT
+#define SOL_PARALLEL_SORT_BLOCK_COUNT 64
+#endif
+
+/** number of samples taken per bucket to select splitters */
+#ifndef SOL_PARALLEL_SORT_OVERSAMPLING
+#define SOL_PARALLEL_SORT_OVERSAMPLING 8
+#endif
+
+#if SOL_PARALLEL_SORT_SERIAL_THRESHOLD < SOL_PARALLEL_SORT_BUCKET_COUNT * SOL_PARALLEL_SORT_OVERSAMPLING
+#error SOL_PARALLEL_SORT_SERIAL_THRESHOLD must be large enough for scratch to hold the sample
+#endif
+
+#ifdef SOL_PARALLEL_SORT_CONTEXT_TYPE
+#define SOL_PARALLEL_SORT_COMPARE_LT_CONTEXTUAL(A, B) SOL_PARALLEL_SORT_COMPARE_LT(A, B, sort->context)
+#else
+#define SOL_PARALLEL_SORT_COMPARE_LT_CONTEXTUAL(A, B) SOL_PARALLEL_SORT_COMPARE_LT(A, B)
+#endif
+
+
+/** instantiate the serial sort, quicksort.h will undefine these */
+#define SOL_SORT_TYPE SOL_PARALLEL_SORT_TYPE
+#define SOL_SORT_FUNCTION_NAME SOL_CONCATENATE(SOL_PARALLEL_SORT_FUNCTION_PREFIX,_serial)
+#define SOL_SORT_COMPARE_LT SOL_PARALLEL_SORT_COMPARE_LT
+#ifdef SOL_PARALLEL_SORT_CONTEXT_TYPE
+#define SOL_SORT_CONTEXT_TYPE SOL_PARALLEL_SORT_CONTEXT_TYPE
+#endif
+#ifdef SOL_PARALLEL_SORT_BUBBLE_THRESHOLD
+#define SOL_SORT_BUBBLE_THRESHOLD SOL_PARALLEL_SORT_BUBBLE_THRESHOLD
+#endif
+#ifdef SOL_PARALLEL_SORT_BLOCK_PARTITION
+#define SOL_SORT_BLOCK_PARTITION
+#endif
+#include "sorts/quicksort.h"
+
+
+/** holds the state of a sort in flight, must remain valid (and not be reused) until the sort has completed */
+struct SOL_PARALLEL_SORT_STRUCT_NAME
+{
+    SOL_PARALLEL_SORT_TYPE* data;
+    SOL_PARALLEL_SORT_TYPE* scratch;
+    size_t count;
+
+    #ifdef SOL_PARALLEL_SORT_CONTEXT_TYPE
+    SOL_PARALLEL_SORT_CONTEXT_TYPE context;
+    #endif
+
+    struct sol_sync_task_handle first_task;
+
+    /** bucket b holds elements not less than splitter b-1 and less than splitter b */
+    SOL_PARALLEL_SORT_TYPE splitters[SOL_PARALLEL_SORT_BUCKET_COUNT - 1];
+
+    /** counts of each bucket in each block, converted in place to where each block scatters its elements in each bucket */
+    size_t block_bucket_offsets[SOL_PARALLEL_SORT_BLOCK_COUNT][SOL_PARALLEL_SORT_BUCKET_COUNT];
+    size_t bucket_offsets[SOL_PARALLEL_SORT_BUCKET_COUNT + 1];
+};
+
+
+static inline uint32_t SOL_CONCATENATE(SOL_PARALLEL_SORT_FUNCTION_PREFIX,_classify__i)(const struct SOL_PARALLEL_SORT_STRUCT_NAME* sort, const SOL_PARALLEL_SORT_TYPE* element)
+{
+    uint32_t bucket, step;
+
+    /** count the splitters not greater than element (binary search over a power of 2) */
+    bucket = 0;
+    for(step = SOL_PARALLEL_SORT_BUCKET_COUNT >> 1; step; step >>= 1)
+    {
+        bucket += ( ! SOL_PARALLEL_SORT_COMPARE_LT_CONTEXTUAL(element, (sort->splitters + bucket + step - 1))) ? step : 0;
+    }
+    return bucket;
+}
+
+static inline void SOL_CONCATENATE(SOL_PARALLEL_SORT_FUNCTION_PREFIX,_block_range__i)(const struct SOL_PARALLEL_SORT_STRUCT_NAME* sort, uint32_t block, size_t* begin, size_t* end)
+{
+    *begin = (sort->count * block) / SOL_PARALLEL_SORT_BLOCK_COUNT;
+    *end = (sort->count * (block + 1)) / SOL_PARALLEL_SORT_BLOCK_COUNT;
+}
+
+static void SOL_CONCATENATE(SOL_PARALLEL_SORT_FUNCTION_PREFIX,_serial_task__i)(void* data)
+{
+    struct SOL_PARALLEL_SORT_STRUCT_NAME* sort = data;
+
+    #ifdef SOL_PARALLEL_SORT_CONTEXT_TYPE
+    SOL_CONCATENATE(SOL_PARALLEL_SORT_FUNCTION_PREFIX,_serial)(sort->data, sort->count, sort->context);
+    #else
+    SOL_CONCATENATE(SOL_PARALLEL_SORT_FUNCTION_PREFIX,_serial)(sort->data, sort->count);
+    #endif
+}
+
+static void SOL_CONCATENATE(SOL_PARALLEL_SORT_FUNCTION_PREFIX,_sample_task__i)(void* data)
+{
+    struct SOL_PARALLEL_SORT_STRUCT_NAME* sort = data;
+    const size_t sample_count = SOL_PARALLEL_SORT_BUCKET_COUNT * SOL_PARALLEL_SORT_OVERSAMPLING;
+    size_t i;
+
+    /** evenly spaced samples (offset to avoid the ends) are sorted in scratch, which isn't used until the scatter */
+    for(i = 0; i < sample_count; i++)
+    {
+        sort->scratch[i] = sort->data[(sort->count * (2 * i + 1)) / (2 * sample_count)];
+    }
+
+    #ifdef SOL_PARALLEL_SORT_CONTEXT_TYPE
+    SOL_CONCATENATE(SOL_PARALLEL_SORT_FUNCTION_PREFIX,_serial)(sort->scratch, sample_count, sort->context);
+    #else
+    SOL_CONCATENATE(SOL_PARALLEL_SORT_FUNCTION_PREFIX,_serial)(sort->scratch, sample_count);
+    #endif
+
+    for(i = 1; i < SOL_PARALLEL_SORT_BUCKET_COUNT; i++)
+    {
+        sort->splitters[i - 1] = sort->scratch[i * SOL_PARALLEL_SORT_OVERSAMPLING];
+    }
+}
+
+static void SOL_CONCATENATE(SOL_PARALLEL_SORT_FUNCTION_PREFIX,_count_range__i)(void* data, uint32_t block_begin, uint32_t block_end)
+{
+    struct SOL_PARALLEL_SORT_STRUCT_NAME* sort = data;
+    size_t* counts;
+    size_t begin, end, i;
+    uint32_t block;
+
+    for(block = block_begin; block < block_end; block++)
+    {
+        counts = sort->block_bucket_offsets[block];
+        memset(counts, 0x00, sizeof(size_t) * SOL_PARALLEL_SORT_BUCKET_COUNT);
+
+        SOL_CONCATENATE(SOL_PARALLEL_SORT_FUNCTION_PREFIX,_block_range__i)(sort, block, &begin, &end);
+        for(i = begin; i < end; i++)
+        {
+            counts[SOL_CONCATENATE(SOL_PARALLEL_SORT_FUNCTION_PREFIX,_classify__i)(sort, sort->data + i)]++;
+        }
+    }
+}
+
+static void SOL_CONCATENATE(SOL_PARALLEL_SORT_FUNCTION_PREFIX,_prefix_task__i)(void* data)
+{
+    struct SOL_PARALLEL_SORT_STRUCT_NAME* sort = data;
+    size_t offset, count;
+    uint32_t bucket, block;
+
+    /** every bucket is contiguous, within a bucket each block gets a contiguous region in block order */
+    offset = 0;
+    for(bucket = 0; bucket < SOL_PARALLEL_SORT_BUCKET_COUNT; bucket++)
+    {
+        sort->bucket_offsets[bucket] = offset;
+        for(block = 0; block < SOL_PARALLEL_SORT_BLOCK_COUNT; block++)
+        {
+            count = sort->block_bucket_offsets[block][bucket];
+            sort->block_bucket_offsets[block][bucket] = offset;
+            offset += count;
+        }
+    }
+    sort->bucket_offsets[SOL_PARALLEL_SORT_BUCKET_COUNT] = offset;
+    assert(offset == sort->count);
+}
+
+static void SOL_CONCATENATE(SOL_PARALLEL_SORT_FUNCTION_PREFIX,_scatter_range__i)(void* data, uint32_t block_begin, uint32_t block_end)
+{
+    struct SOL_PARALLEL_SORT_STRUCT_NAME* sort = data;
+    size_t* offsets;
+    size_t begin, end, i;
+    uint32_t block;
+
+    for(block = block_begin; block < block_end; block++)
+    {
+        offsets = sort->block_bucket_offsets[block];
+
+        SOL_CONCATENATE(SOL_PARALLEL_SORT_FUNCTION_PREFIX,_block_range__i)(sort, block, &begin, &end);
+        for(i = begin; i < end; i++)
+        {
+            sort->scratch[offsets[SOL_CONCATENATE(SOL_PARALLEL_SORT_FUNCTION_PREFIX,_classify__i)(sort, sort->data + i)]++] = sort->data[i];
+        }
+    }
+}
+
+static void SOL_CONCATENATE(SOL_PARALLEL_SORT_FUNCTION_PREFIX,_bucket_range__i)(void* data, uint32_t bucket_begin, uint32_t bucket_end)
+{
+    struct SOL_PARALLEL_SORT_STRUCT_NAME* sort = data;
+    size_t begin, count;
+    uint32_t bucket;
+
+    for(bucket = bucket_begin; bucket < bucket_end; bucket++)
+    {
+        begin = sort->bucket_offsets[bucket];
+        count = sort->bucket_offsets[bucket + 1] - begin;
+
+        #ifdef SOL_PARALLEL_SORT_CONTEXT_TYPE
+        SOL_CONCATENATE(SOL_PARALLEL_SORT_FUNCTION_PREFIX,_serial)(sort->scratch + begin, count, sort->context);
+        #else
+        SOL_CONCATENATE(SOL_PARALLEL_SORT_FUNCTION_PREFIX,_serial)(sort->scratch + begin, count);
+        #endif
+
+        memcpy(sort->data + begin, sort->scratch + begin, sizeof(SOL_PARALLEL_SORT_TYPE) * count);
+    }
+}
+
+
+/** sets up the tasks to sort `data`, `scratch` must have space for `count` elements and the sorted result ends up in `data`
+ * like a prepared task nothing runs until `activate` is called, so predecessors can be attached to the first primitive of the returned range and successors to the last
+ * `sort` must not be modified or reused until the last primitive of the range has signalled its successors */
+#ifdef SOL_PARALLEL_SORT_CONTEXT_TYPE
+static struct sol_sync_primitive_range SOL_CONCATENATE(SOL_PARALLEL_SORT_FUNCTION_PREFIX,_prepare)(struct SOL_PARALLEL_SORT_STRUCT_NAME* sort, struct sol_sync_task_system* task_system, SOL_PARALLEL_SORT_TYPE* data, SOL_PARALLEL_SORT_TYPE* scratch, size_t count, SOL_PARALLEL_SORT_CONTEXT_TYPE context)
+#else
+static struct sol_sync_primitive_range SOL_CONCATENATE(SOL_PARALLEL_SORT_FUNCTION_PREFIX,_prepare)(struct SOL_PARALLEL_SORT_STRUCT_NAME* sort, struct sol_sync_task_system* task_system, SOL_PARALLEL_SORT_TYPE* data, SOL_PARALLEL_SORT_TYPE* scratch, size_t count)
+#endif
+{
+    struct sol_sync_task_handle count_task, prefix_task, scatter_task, bucket_task;
+
+    sort->data = data;
+    sort->scratch = scratch;
+    sort->count = count;
+
+    #ifdef SOL_PARALLEL_SORT_CONTEXT_TYPE
+    sort->context = context;
+    #endif
+
+    if(count < SOL_PARALLEL_SORT_SERIAL_THRESHOLD)
+    {
+        sort->first_task = sol_sync_task_prepare(task_system, &SOL_CONCATENATE(SOL_PARALLEL_SORT_FUNCTION_PREFIX,_serial_task__i), sort);
+
+        return (struct sol_sync_primitive_range)
+        {
+            .first = sort->first_task.primitive,
+            .last = sort->first_task.primitive,
+        };
+    }
+
+    sort->first_task = sol_sync_task_prepare(task_system, &SOL_CONCATENATE(SOL_PARALLEL_SORT_FUNCTION_PREFIX,_sample_task__i), sort);
+    count_task = sol_sync_task_range_prepare(task_system, &SOL_CONCATENATE(SOL_PARALLEL_SORT_FUNCTION_PREFIX,_count_range__i), sort, 0, SOL_PARALLEL_SORT_BLOCK_COUNT, 1);
+    prefix_task = sol_sync_task_prepare(task_system, &SOL_CONCATENATE(SOL_PARALLEL_SORT_FUNCTION_PREFIX,_prefix_task__i), sort);
+    scatter_task = sol_sync_task_range_prepare(task_system, &SOL_CONCATENATE(SOL_PARALLEL_SORT_FUNCTION_PREFIX,_scatter_range__i), sort, 0, SOL_PARALLEL_SORT_BLOCK_COUNT, 1);
+    bucket_task = sol_sync_task_range_prepare(task_system, &SOL_CONCATENATE(SOL_PARALLEL_SORT_FUNCTION_PREFIX,_bucket_range__i), sort, 0, SOL_PARALLEL_SORT_BUCKET_COUNT, 1);
+
+    /** none of these can complete until the first task is activated, so it's safe to attach successors without retaining them */
+    sol_sync_task_attach_successor(sort->first_task, count_task.primitive);
+    sol_sync_task_attach_successor(count_task, prefix_task.primitive);
+    sol_sync_task_attach_successor(prefix_task, scatter_task.primitive);
+    sol_sync_task_attach_successor(scatter_task, bucket_task.primitive);
+
+    sol_sync_task_activate(count_task);
+    sol_sync_task_activate(prefix_task);
+    sol_sync_task_activate(scatter_task);
+    sol_sync_task_activate(bucket_task);
+
+    return (struct sol_sync_primitive_range)
+    {
+        .first = sort->first_task.primitive,
+        .last = bucket_task.primitive,
+    };
+}
+
+/** allows a prepared sort to run (once its predecessors have signalled) */
+static void SOL_CONCATENATE(SOL_PARALLEL_SORT_FUNCTION_PREFIX,_activate)(struct SOL_PARALLEL_SORT_STRUCT_NAME* sort)
+{
+    sol_sync_task_activate(sort->first_task);
+}
+
+
+#undef SOL_PARALLEL_SORT_TYPE
+#undef SOL_PARALLEL_SORT_STRUCT_NAME
+#undef SOL_PARALLEL_SORT_FUNCTION_PREFIX
+#undef SOL_PARALLEL_SORT_COMPARE_LT
+#undef SOL_PARALLEL_SORT_SERIAL_THRESHOLD
+#undef SOL_PARALLEL_SORT_BUCKET_COUNT
+#undef SOL_PARALLEL_SORT_BLOCK_COUNT
+#undef SOL_PARALLEL_SORT_OVERSAMPLING
+
+#undef SOL_PARALLEL_SORT_COMPARE_LT_CONTEXTUAL
+
+#ifdef SOL_PARALLEL_SORT_CONTEXT_TYPE
+#undef SOL_PARALLEL_SORT_CONTEXT_TYPE
+#endif
+#ifdef SOL_PARALLEL_SORT_BUBBLE_THRESHOLD
+#undef SOL_PARALLEL_SORT_BUBBLE_THRESHOLD
+#endif
+#ifdef SOL_PARALLEL_SORT_BLOCK_PARTITION
+#undef SOL_PARALLEL_SORT_BLOCK_PARTITION
+#endif
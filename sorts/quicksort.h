@@ -18,9 +18,11 @@ along with solipsix.  If not, see <https://www.gnu.org/licenses/>.
 */
 
 
-#warning test randomization in pivot selection
-
 #include <stdlib.h>
+#include <inttypes.h>
+#include <stdbool.h>
+
+#include "sol_utils.h"
 
 #ifndef SOL_SORT_TYPE
 #error must define SOL_SORT_TYPE
@@ -46,12 +48,69 @@ along with solipsix.  If not, see <https://www.gnu.org/licenses/>.
 #define SOL_SORT_BUBBLE_THRESHOLD 16
 #endif
 
+/** define `SOL_SORT_BLOCK_PARTITION` to partition using blocks of this many elements (BlockQuicksort, Edelkamp & Weiss 2016)
+ * comparisons for a whole block are done up front without branching on their results, which avoids branch mispredictions
+ * this is only worthwhile when comparison is cheap (e.g. comparing integer keys), expensive comparisons should use the default partitioning */
+#ifdef SOL_SORT_BLOCK_PARTITION
+#ifndef SOL_SORT_BLOCK_SIZE
+#define SOL_SORT_BLOCK_SIZE 64
+#endif
+#if SOL_SORT_BLOCK_SIZE > 256
+#error SOL_SORT_BLOCK_SIZE must fit offsets in a uint8_t
+#endif
+#endif
+
 #ifdef SOL_SORT_CONTEXT_TYPE
 #define SOL_SORT_COMPARE_LT_CONTEXTUAL(A, B) SOL_SORT_COMPARE_LT(A, B, context)
 #else
 #define SOL_SORT_COMPARE_LT_CONTEXTUAL(A, B) SOL_SORT_COMPARE_LT(A, B)
 #endif
 
+
+/** quicksort ranges that are partitioned too many times (from bad pivots) are heapsorted instead (introsort), guaranteeing O(n log n) */
+#ifdef SOL_SORT_CONTEXT_TYPE
+static void SOL_CONCATENATE(SOL_SORT_FUNCTION_NAME,_heapsort__i)(SOL_SORT_TYPE* data, size_t count, SOL_SORT_CONTEXT_TYPE context)
+#else
+static void SOL_CONCATENATE(SOL_SORT_FUNCTION_NAME,_heapsort__i)(SOL_SORT_TYPE* data, size_t count)
+#endif
+{
+    SOL_SORT_TYPE tmp;
+    size_t heap_size, parent, child, i;
+
+    /** build max heap, then repeatedly move the largest to the end */
+    for(i = count >> 1, heap_size = count; heap_size > 1;)
+    {
+        if(i > 0)
+        {
+            parent = --i;
+            tmp = data[parent];
+        }
+        else
+        {
+            heap_size--;
+            tmp = data[heap_size];
+            data[heap_size] = data[0];
+            parent = 0;
+        }
+
+        /** sift tmp down from parent */
+        while((child = (parent << 1) + 1) < heap_size)
+        {
+            if(child + 1 < heap_size && SOL_SORT_COMPARE_LT_CONTEXTUAL((data + child), (data + child + 1)))
+            {
+                child++;
+            }
+            if( ! SOL_SORT_COMPARE_LT_CONTEXTUAL((&tmp), (data + child)))
+            {
+                break;
+            }
+            data[parent] = data[child];
+            parent = child;
+        }
+        data[parent] = tmp;
+    }
+}
+
 #ifdef SOL_SORT_CONTEXT_TYPE
 static void SOL_SORT_FUNCTION_NAME(SOL_SORT_TYPE* data, size_t count, SOL_SORT_CONTEXT_TYPE context)
 #else
@@ -62,10 +121,12 @@ static void SOL_SORT_FUNCTION_NAME(SOL_SORT_TYPE* data, size_t count)
     {
         SOL_SORT_TYPE* start;
         SOL_SORT_TYPE* end;
+        uint32_t depth_remaining;
     }
     stack[48];
 
     size_t stack_size;
+    uint32_t depth_remaining;
 
     SOL_SORT_TYPE tmp;
     SOL_SORT_TYPE pivot;
@@ -77,13 +138,43 @@ static void SOL_SORT_FUNCTION_NAME(SOL_SORT_TYPE* data, size_t count)
     SOL_SORT_TYPE* middle;
     SOL_SORT_TYPE* smallest;
 
+    #ifdef SOL_SORT_BLOCK_PARTITION
+    uint8_t offsets_forwards[SOL_SORT_BLOCK_SIZE];
+    uint8_t offsets_backwards[SOL_SORT_BLOCK_SIZE];
+    size_t count_forwards, count_backwards, first_forwards, first_backwards, swap_count, i;
+    #endif
+
     stack_size = 0;
 
     start = data;
     end = data + count - 1;
 
+    /** typical introsort limit, a range partitioned this many times is having unusually bad luck with pivots */
+    depth_remaining = 2 * sol_u64_exp_le(count);
+
     if(count > SOL_SORT_BUBBLE_THRESHOLD) while(1)
     {
+        if(depth_remaining == 0)
+        {
+            /** heapsort leaves the range fully sorted so it no longer needs processing */
+            #ifdef SOL_SORT_CONTEXT_TYPE
+            SOL_CONCATENATE(SOL_SORT_FUNCTION_NAME,_heapsort__i)(start, end - start + 1, context);
+            #else
+            SOL_CONCATENATE(SOL_SORT_FUNCTION_NAME,_heapsort__i)(start, end - start + 1);
+            #endif
+
+            if(stack_size == 0)
+            {
+                break;
+            }
+            stack_size--;
+            start = stack[stack_size].start;
+            end = stack[stack_size].end;
+            depth_remaining = stack[stack_size].depth_remaining;
+            continue;
+        }
+        depth_remaining--;
+
         /* pre-sort start and end of range */
 
         if(SOL_SORT_COMPARE_LT_CONTEXTUAL(end, start))
@@ -116,6 +207,58 @@ static void SOL_SORT_FUNCTION_NAME(SOL_SORT_TYPE* data, size_t count)
         iter_forwards = start;
         iter_backwards = end;
 
+        #ifdef SOL_SORT_BLOCK_PARTITION
+        /* partition whole blocks from each end, only the swaps depend on comparison results
+         * blocks are only advanced past once every element in them is on the correct side, so everything before iter_forwards+1
+         * and after iter_backwards-1 stays correctly partitioned, and the remainder can be finished by the loop below */
+        count_forwards = count_backwards = 0;
+        first_forwards = first_backwards = 0;
+
+        while(iter_backwards - iter_forwards - 1 >= 2 * SOL_SORT_BLOCK_SIZE)
+        {
+            if(count_forwards == 0)
+            {
+                first_forwards = 0;
+                for(i = 0; i < SOL_SORT_BLOCK_SIZE; i++)
+                {
+                    offsets_forwards[count_forwards] = i;
+                    count_forwards += ! SOL_SORT_COMPARE_LT_CONTEXTUAL((iter_forwards + 1 + i), (&pivot));
+                }
+            }
+            if(count_backwards == 0)
+            {
+                first_backwards = 0;
+                for(i = 0; i < SOL_SORT_BLOCK_SIZE; i++)
+                {
+                    offsets_backwards[count_backwards] = i;
+                    count_backwards += ! SOL_SORT_COMPARE_LT_CONTEXTUAL((&pivot), (iter_backwards - 1 - i));
+                }
+            }
+
+            swap_count = (count_forwards < count_backwards) ? count_forwards : count_backwards;
+            for(i = 0; i < swap_count; i++)
+            {
+                tmp = iter_forwards[1 + offsets_forwards[first_forwards + i]];
+                iter_forwards[1 + offsets_forwards[first_forwards + i]] = iter_backwards[-1 - offsets_backwards[first_backwards + i]];
+                iter_backwards[-1 - offsets_backwards[first_backwards + i]] = tmp;
+            }
+
+            count_forwards -= swap_count;
+            count_backwards -= swap_count;
+            first_forwards += swap_count;
+            first_backwards += swap_count;
+
+            if(count_forwards == 0)
+            {
+                iter_forwards += SOL_SORT_BLOCK_SIZE;
+            }
+            if(count_backwards == 0)
+            {
+                iter_backwards -= SOL_SORT_BLOCK_SIZE;
+            }
+        }
+        #endif
+
         while(1)
         {
             /* we want the iters after these while loops to be the first positions that violate pivot sorting */
@@ -147,6 +290,7 @@ static void SOL_SORT_FUNCTION_NAME(SOL_SORT_TYPE* data, size_t count)
                 stack_size--;
                 start = stack[stack_size].start;
                 end = stack[stack_size].end;
+                depth_remaining = stack[stack_size].depth_remaining;
             }
             else
             {
@@ -165,6 +309,7 @@ static void SOL_SORT_FUNCTION_NAME(SOL_SORT_TYPE* data, size_t count)
         {
             stack[stack_size].start = start;
             stack[stack_size].end   = iter_backwards;
+            stack[stack_size].depth_remaining = depth_remaining;
             stack_size++;
             start = iter_forwards;
         }
@@ -172,6 +317,7 @@ static void SOL_SORT_FUNCTION_NAME(SOL_SORT_TYPE* data, size_t count)
         {
             stack[stack_size].start = iter_forwards;
             stack[stack_size].end   = end;
+            stack[stack_size].depth_remaining = depth_remaining;
             stack_size++;
             end = iter_backwards;
         }
@@ -223,6 +369,11 @@ static void SOL_SORT_FUNCTION_NAME(SOL_SORT_TYPE* data, size_t count)
 
 #undef SOL_SORT_COMPARE_LT_CONTEXTUAL
 
+#ifdef SOL_SORT_BLOCK_PARTITION
+#undef SOL_SORT_BLOCK_PARTITION
+#undef SOL_SORT_BLOCK_SIZE
+#endif
+
 #ifdef SOL_SORT_CONTEXT_TYPE
 #undef SOL_SORT_CONTEXT_TYPE
 #endif
@@ -0,0 +1,135 @@
+/**
+Copyright 2026 Carl van Mastrigt
+
+This file is part of solipsix.
+
+solipsix is free software: you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+solipsix is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with solipsix.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+/** stable least significant digit radix sort on an unsigned integer key projected from each element
+ * signed or floating point keys must be projected to unsigned integers that sort the same way (e.g. flipping the sign bit of a signed integer)
+ * requires a scratch buffer of the same size as the data, the sorted result always ends up in `data` */
+
+#ifndef SOL_SORT_TYPE
+#error must define SOL_SORT_TYPE
+#define SOL_SORT_TYPE uint32_t
+#endif
+
+#ifndef SOL_SORT_FUNCTION_NAME
+#error must define SOL_SORT_FUNCTION_NAME
+#define SOL_SORT_FUNCTION_NAME placeholder_radix_sort
+#endif
+
+/** must be an unsigned integer type, only as many passes as this has bytes are performed so it should be no larger than necessary */
+#ifndef SOL_SORT_KEY_TYPE
+#define SOL_SORT_KEY_TYPE uint32_t
+#endif
+
+#ifndef SOL_SORT_KEY
+#error must define SOL_SORT_KEY(const SOL_SORT_TYPE* e) returning a SOL_SORT_KEY_TYPE
+#ifdef SOL_SORT_CONTEXT_TYPE
+#define SOL_SORT_KEY(E, CTX) (*(E))
+#else
+#define SOL_SORT_KEY(E) (*(E))
+#endif
+#endif
+
+#ifdef SOL_SORT_CONTEXT_TYPE
+#define SOL_SORT_KEY_CONTEXTUAL(E) ((SOL_SORT_KEY_TYPE)SOL_SORT_KEY(E, context))
+#else
+#define SOL_SORT_KEY_CONTEXTUAL(E) ((SOL_SORT_KEY_TYPE)SOL_SORT_KEY(E))
+#endif
+
+#ifdef SOL_SORT_CONTEXT_TYPE
+static void SOL_SORT_FUNCTION_NAME(SOL_SORT_TYPE* data, SOL_SORT_TYPE* scratch, size_t count, SOL_SORT_CONTEXT_TYPE context)
+#else
+static void SOL_SORT_FUNCTION_NAME(SOL_SORT_TYPE* data, SOL_SORT_TYPE* scratch, size_t count)
+#endif
+{
+    size_t offsets[sizeof(SOL_SORT_KEY_TYPE)][256];
+    size_t i, digit, offset, digit_count;
+    SOL_SORT_KEY_TYPE key;
+    SOL_SORT_TYPE* src;
+    SOL_SORT_TYPE* dst;
+    SOL_SORT_TYPE* tmp;
+
+    if(count < 2)
+    {
+        return;
+    }
+
+    memset(offsets, 0x00, sizeof(offsets));
+
+    /** count occurrences of every byte of every key in a single pass */
+    for(i = 0; i < count; i++)
+    {
+        key = SOL_SORT_KEY_CONTEXTUAL(data + i);
+        for(digit = 0; digit < sizeof(SOL_SORT_KEY_TYPE); digit++)
+        {
+            offsets[digit][(key >> (digit * 8)) & 0xFF]++;
+        }
+    }
+
+    src = data;
+    dst = scratch;
+
+    for(digit = 0; digit < sizeof(SOL_SORT_KEY_TYPE); digit++)
+    {
+        /** if every key has the same value for this byte the pass would not change the order, so skip it */
+        key = SOL_SORT_KEY_CONTEXTUAL(data);
+        if(offsets[digit][(key >> (digit * 8)) & 0xFF] == count)
+        {
+            continue;
+        }
+
+        /** convert counts to starting offsets */
+        for(i = 0, offset = 0; i < 256; i++)
+        {
+            digit_count = offsets[digit][i];
+            offsets[digit][i] = offset;
+            offset += digit_count;
+        }
+
+        for(i = 0; i < count; i++)
+        {
+            key = SOL_SORT_KEY_CONTEXTUAL(src + i);
+            dst[offsets[digit][(key >> (digit * 8)) & 0xFF]++] = src[i];
+        }
+
+        tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+
+    if(src != data)
+    {
+        memcpy(data, src, sizeof(SOL_SORT_TYPE) * count);
+    }
+}
+
+#undef SOL_SORT_TYPE
+#undef SOL_SORT_FUNCTION_NAME
+#undef SOL_SORT_KEY_TYPE
+#undef SOL_SORT_KEY
+
+#undef SOL_SORT_KEY_CONTEXTUAL
+
+#ifdef SOL_SORT_CONTEXT_TYPE
+#undef SOL_SORT_CONTEXT_TYPE
+#endif
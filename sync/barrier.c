@@ -169,6 +169,7 @@ static void sol_sync_barrier_initialise(void* entry, void* data)
 void sol_sync_barrier_pool_initialise(struct sol_sync_barrier_pool* pool, size_t total_barrier_exponent, size_t total_successor_exponent)
 {
     sol_lockfree_pool_initialise(&pool->barrier_pool, total_barrier_exponent, sizeof(struct sol_sync_barrier));
+    sol_lockfree_pool_call_for_every_entry(&pool->barrier_pool, &sol_sync_barrier_initialise, pool);
     sol_lockfree_pool_initialise(&pool->successor_pool, total_successor_exponent, sizeof(struct sol_sync_primitive*));
 }
 
@@ -220,8 +221,8 @@ void sol_sync_barrier_signal_conditions(struct sol_sync_barrier_handle barrier,
 
 void sol_sync_barrier_retain_references(struct sol_sync_barrier_handle barrier, uint_fast32_t count)
 {
-    assert(barrier.primitive->sync_functions->retain_references == &sol_sync_barrier_release_references_polymorphic);
-    sol_sync_barrier_release_references_polymorphic(barrier.primitive, count);
+    assert(barrier.primitive->sync_functions->retain_references == &sol_sync_barrier_retain_references_polymorphic);
+    sol_sync_barrier_retain_references_polymorphic(barrier.primitive, count);
 }
 
 void sol_sync_barrier_release_references(struct sol_sync_barrier_handle barrier, uint_fast32_t count)
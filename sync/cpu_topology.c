@@ -0,0 +1,276 @@
+/**
+Copyright 2026 Carl van Mastrigt
+
+This file is part of solipsix.
+
+solipsix is free software: you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+solipsix is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with solipsix.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/** required for the affinity and naming extensions to pthreads */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "sync/cpu_topology.h"
+
+
+#define SOL_SORT_TYPE struct sol_cpu_topology_processor
+#define SOL_SORT_FUNCTION_NAME sol_cpu_topology_processor_sort
+#define SOL_SORT_COMPARE_LT(A, B) (\
+    ((A)->smt_index   != (B)->smt_index)   ? ((A)->smt_index   < (B)->smt_index)   : \
+    ((A)->node        != (B)->node)        ? ((A)->node        < (B)->node)        : \
+    ((A)->cache_group != (B)->cache_group) ? ((A)->cache_group < (B)->cache_group) : \
+    ((A)->cpu < (B)->cpu))
+#include "sorts/quicksort.h"
+
+
+/** parses the sysfs cpu list format e.g. `0-3,8,10-11` */
+static bool sol_cpu_topology_read_cpu_list(const char* path, struct sol_cpu_mask* mask)
+{
+    FILE* file;
+    unsigned long first, last;
+    int c;
+    bool valid;
+
+    *mask = (struct sol_cpu_mask){.words = {0}};
+
+    file = fopen(path, "r");
+    if(file == NULL)
+    {
+        return false;
+    }
+
+    valid = false;
+
+    while(fscanf(file, "%lu", &first) == 1)
+    {
+        last = first;
+        c = fgetc(file);
+        if(c == '-')
+        {
+            if(fscanf(file, "%lu", &last) != 1)
+            {
+                break;
+            }
+            c = fgetc(file);
+        }
+
+        for(; first <= last; first++)
+        {
+            sol_cpu_mask_add(mask, (uint32_t)first);
+        }
+        valid = true;
+
+        if(c != ',')
+        {
+            break;
+        }
+    }
+
+    fclose(file);
+
+    return valid;
+}
+
+/** the lowest processor in a cpu list is used as the identifier of the resource shared by the processors in that list */
+static bool sol_cpu_topology_read_cpu_list_first(const char* path, uint32_t* first)
+{
+    FILE* file;
+    unsigned long value;
+    bool valid;
+
+    file = fopen(path, "r");
+    if(file == NULL)
+    {
+        return false;
+    }
+
+    valid = fscanf(file, "%lu", &value) == 1;
+    fclose(file);
+
+    if(valid)
+    {
+        *first = (uint32_t)value;
+    }
+
+    return valid;
+}
+
+static uint32_t sol_cpu_topology_read_cache_group(uint32_t cpu)
+{
+    char path[256];
+    FILE* file;
+    unsigned int index, level, highest_level;
+    uint32_t cache_group, group;
+
+    /** use whichever cache index has the highest level, which should be the L3 on most systems */
+    cache_group = cpu;
+    highest_level = 0;
+
+    for(index = 0; ; index++)
+    {
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/cache/index%u/level", cpu, index);
+        file = fopen(path, "r");
+        if(file == NULL)
+        {
+            break;
+        }
+        if(fscanf(file, "%u", &level) != 1)
+        {
+            level = 0;
+        }
+        fclose(file);
+
+        if(level > highest_level)
+        {
+            snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/cache/index%u/shared_cpu_list", cpu, index);
+            if(sol_cpu_topology_read_cpu_list_first(path, &group))
+            {
+                highest_level = level;
+                cache_group = group;
+            }
+        }
+    }
+
+    return cache_group;
+}
+
+bool sol_cpu_topology_initialise(struct sol_cpu_topology* topology)
+{
+    char path[256];
+    struct sol_cpu_mask online, node_cpus, online_nodes;
+    struct sol_cpu_topology_processor* processor;
+    uint32_t cpu, node, i, j;
+
+    topology->processors = NULL;
+    topology->processor_count = 0;
+
+    #ifndef __linux__
+    return false;
+    #endif
+
+    if( ! sol_cpu_topology_read_cpu_list("/sys/devices/system/cpu/online", &online))
+    {
+        return false;
+    }
+
+    topology->processors = malloc(sizeof(struct sol_cpu_topology_processor) * SOL_CPU_MASK_CAPACITY);
+
+    for(cpu = 0; cpu < SOL_CPU_MASK_CAPACITY; cpu++)
+    {
+        if(sol_cpu_mask_contains(&online, cpu))
+        {
+            processor = topology->processors + topology->processor_count++;
+
+            processor->cpu = cpu;
+            processor->node = 0;
+            processor->smt_index = 0;
+
+            snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/topology/thread_siblings_list", cpu);
+            if( ! sol_cpu_topology_read_cpu_list_first(path, &processor->core))
+            {
+                processor->core = cpu;
+            }
+
+            processor->cache_group = sol_cpu_topology_read_cache_group(cpu);
+        }
+    }
+
+    /** systems without NUMA may not have node information at all, in which case everything stays in node 0 */
+    if(sol_cpu_topology_read_cpu_list("/sys/devices/system/node/online", &online_nodes))
+    {
+        for(node = 0; node < SOL_CPU_MASK_CAPACITY; node++)
+        {
+            if(sol_cpu_mask_contains(&online_nodes, node))
+            {
+                snprintf(path, sizeof(path), "/sys/devices/system/node/node%u/cpulist", node);
+                if(sol_cpu_topology_read_cpu_list(path, &node_cpus))
+                {
+                    for(i = 0; i < topology->processor_count; i++)
+                    {
+                        if(sol_cpu_mask_contains(&node_cpus, topology->processors[i].cpu))
+                        {
+                            topology->processors[i].node = node;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    /** processors are still in cpu order here, so this gives SMT siblings increasing indices */
+    for(i = 0; i < topology->processor_count; i++)
+    {
+        for(j = 0; j < i; j++)
+        {
+            if(topology->processors[j].core == topology->processors[i].core)
+            {
+                topology->processors[i].smt_index++;
+            }
+        }
+    }
+
+    sol_cpu_topology_processor_sort(topology->processors, topology->processor_count);
+
+    return topology->processor_count > 0;
+}
+
+void sol_cpu_topology_terminate(struct sol_cpu_topology* topology)
+{
+    free(topology->processors);
+}
+
+bool sol_cpu_mask_apply_to_current_thread(const struct sol_cpu_mask* mask)
+{
+    #ifdef __linux__
+    cpu_set_t cpu_set;
+    uint32_t cpu;
+
+    CPU_ZERO(&cpu_set);
+    for(cpu = 0; cpu < SOL_CPU_MASK_CAPACITY && cpu < CPU_SETSIZE; cpu++)
+    {
+        if(sol_cpu_mask_contains(mask, cpu))
+        {
+            CPU_SET(cpu, &cpu_set);
+        }
+    }
+
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpu_set) == 0;
+    #else
+    return false;
+    #endif
+}
+
+void sol_thread_set_current_name(const char* name)
+{
+    #ifdef __linux__
+    char truncated_name[16];
+
+    /** linux limits thread names to 16 characters including the null terminator and rejects longer names outright */
+    strncpy(truncated_name, name, sizeof(truncated_name) - 1);
+    truncated_name[sizeof(truncated_name) - 1] = '\0';
+
+    pthread_setname_np(pthread_self(), truncated_name);
+    #endif
+}
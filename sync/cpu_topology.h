@@ -0,0 +1,80 @@
+/**
+Copyright 2026 Carl van Mastrigt
+
+This file is part of solipsix.
+
+solipsix is free software: you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+solipsix is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with solipsix.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <inttypes.h>
+#include <stdbool.h>
+
+/** enough for every processor linux supports by default (CPU_SETSIZE) */
+#define SOL_CPU_MASK_WORD_COUNT 16
+#define SOL_CPU_MASK_CAPACITY (SOL_CPU_MASK_WORD_COUNT * 64)
+
+struct sol_cpu_mask
+{
+    uint64_t words[SOL_CPU_MASK_WORD_COUNT];
+};
+
+static inline void sol_cpu_mask_add(struct sol_cpu_mask* mask, uint32_t cpu)
+{
+    if(cpu < SOL_CPU_MASK_CAPACITY)
+    {
+        mask->words[cpu >> 6] |= (uint64_t)1 << (cpu & 63);
+    }
+}
+
+static inline bool sol_cpu_mask_contains(const struct sol_cpu_mask* mask, uint32_t cpu)
+{
+    return cpu < SOL_CPU_MASK_CAPACITY && (mask->words[cpu >> 6] & ((uint64_t)1 << (cpu & 63)));
+}
+
+
+/** identifiers are the lowest numbered processor in the set of processors sharing that resource, so can be compared but are not contiguous */
+struct sol_cpu_topology_processor
+{
+    /** operating system index of this logical processor */
+    uint32_t cpu;
+    /** shared by processors on the same physical core (SMT siblings) */
+    uint32_t core;
+    /** shared by processors using the same last level cache */
+    uint32_t cache_group;
+    /** NUMA node */
+    uint32_t node;
+    /** 0 for the first processor of each physical core, 1 for its first SMT sibling &c. */
+    uint32_t smt_index;
+};
+
+struct sol_cpu_topology
+{
+    /** ordered such that every physical core appears before any SMT sibling, then by node, cache group and core
+     * so taking processors in order spreads work across physical cores while keeping it as close together as possible */
+    struct sol_cpu_topology_processor* processors;
+    uint32_t processor_count;
+};
+
+/** reads the topology of the online processors from sysfs
+ * returns false if this is not possible (e.g. not running on linux), in which case the topology will be empty but must still be terminated */
+bool sol_cpu_topology_initialise(struct sol_cpu_topology* topology);
+void sol_cpu_topology_terminate(struct sol_cpu_topology* topology);
+
+/** restrict the calling thread to run on the processors in mask, returns false if that was not possible */
+bool sol_cpu_mask_apply_to_current_thread(const struct sol_cpu_mask* mask);
+
+/** name the calling thread for debuggers and profilers, names longer than 15 characters are truncated */
+void sol_thread_set_current_name(const char* name);
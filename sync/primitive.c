@@ -18,6 +18,7 @@ along with solipsix.  If not, see <https://www.gnu.org/licenses/>.
 */
 
 #include <assert.h>
+#include <stdbool.h>
 
 #include "solipsix/sync/primitive.h"
 
@@ -18,9 +18,13 @@ along with solipsix.  If not, see <https://www.gnu.org/licenses/>.
 */
 
 #include <stdlib.h>
+#include <stdio.h>
 #include <assert.h>
+#include <threads.h>
 
+#include "sol_utils.h"
 #include "sync/task.h"
+#include "sync/task_trace.h"
 
 
 struct sol_sync_task
@@ -28,37 +32,201 @@ struct sol_sync_task
     struct sol_sync_primitive primitive;
 
     struct sol_sync_task_system* task_system;
+    /** index in the task pool, needed to relinquish the task */
+    uint32_t pool_index;
 
     void(*task_function)(void*);
     void* task_function_data;
 
+    enum sol_sync_task_priority priority;
+
     /// need to only init atomics once: "If obj was not default-constructed, or this function is called twice on the same obj, the behavior is undefined."
 
     atomic_uint_fast32_t condition_count;
     atomic_uint_fast32_t reference_count;
 
+    /** decremented when the task function returns, the task only completes (signals its successors) once this reaches zero
+     * this allows tasks spawned by this one to delay its completion until they have completed */
+    atomic_uint_fast32_t completion_count;
+    /** if set this task holds one of the parents completion counts, which will be released upon completion of this task */
+    struct sol_sync_task* completion_parent;
+
     struct sol_lockfree_hopper successor_hopper;
+
+    /** following are only used by range tasks, `range_root` is the task that was actually prepared and the rest of the range is split from */
+    struct sol_sync_task* range_root;
+    uint32_t range_begin;
+    uint32_t range_end;
+
+    /** following are only set in the root of a range */
+    void(*range_function)(void*, uint32_t, uint32_t);
+    void* range_data;
+    uint32_t range_grain_size;
+    /** number of times the range may be split, limits the range to using some multiple of the worker count of tasks */
+    atomic_uint_fast32_t range_split_budget;
 };
 
 #define SOL_TASK_INTERNAL_COUNTER_BIT ((uint_fast32_t)0x80000000)
 
 static void sol_sync_task_release_references_polymorphic(struct sol_sync_primitive* primitive, uint32_t count);
 
-static inline struct sol_sync_task* sol_sync_task_worker_thread_get_task(struct sol_sync_task_system* task_system)
+/** the worker the current thread is acting as, if any, used to put tasks made ready by a worker directly on that workers deque */
+static thread_local struct sol_sync_task_worker* sol_sync_task_current_worker = NULL;
+
+#ifdef SOL_SYNC_TASK_STATISTICS
+#define SOL_SYNC_TASK_STATISTIC(WORKER, COUNTER) ((WORKER)->statistics.COUNTER++)
+#else
+#define SOL_SYNC_TASK_STATISTIC(WORKER, COUNTER)
+#endif
+
+static inline uint32_t sol_sync_task_worker_random(struct sol_sync_task_worker* worker)
 {
+    /** xorshift, only needs to be good enough to spread stealing across workers */
+    uint32_t x = worker->steal_rng_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    worker->steal_rng_state = x;
+    return x;
+}
+
+static inline struct sol_sync_task* sol_sync_task_worker_steal_task(struct sol_sync_task_worker* worker, enum sol_sync_task_priority priority)
+{
+    struct sol_sync_task_system* task_system = worker->task_system;
+    struct sol_sync_task_worker* victim;
     struct sol_sync_task* task;
+    uint32_t i, victim_index, worker_count, pass;
+    bool contended;
 
-    mtx_lock(&task_system->worker_thread_mutex);
+    worker_count = task_system->worker_thread_count;
 
-    while(!sol_task_queue_dequeue(&task_system->pending_task_queue, &task))
+    do
     {
-        assert(task_system->stalled_thread_count < task_system->worker_thread_count);
-        task_system->stalled_thread_count++;
+        contended = false;
+
+        /** when stealing locally the first pass only considers workers on this workers node and the second pass only those on other nodes */
+        for(pass = task_system->node_local_stealing ? 0 : 1; pass < 2; pass++)
+        {
+            /** start at a random worker so that stealing workers dont all contend on the same victim */
+            victim_index = sol_sync_task_worker_random(worker) % worker_count;
+
+            for(i = 0; i < worker_count; i++)
+            {
+                victim = task_system->workers + victim_index;
+
+                if(victim != worker && (!task_system->node_local_stealing || ((victim->node == worker->node) == (pass == 0))))
+                {
+                    SOL_SYNC_TASK_STATISTIC(worker, steal_attempts);
+                    task = sol_lockfree_deque_steal(victim->ready_tasks + priority, &contended);
+                    if(task)
+                    {
+                        SOL_SYNC_TASK_STATISTIC(worker, steals);
+                        return task;
+                    }
+                }
+                victim_index = (victim_index + 1 == worker_count) ? 0 : victim_index + 1;
+            }
+        }
+
+        if(contended)
+        {
+            SOL_SYNC_TASK_STATISTIC(worker, steal_retries);
+        }
+    }
+    while(contended);/** a failed steal does not mean there was nothing to steal */
+
+    return NULL;
+}
+
+/** must be called with the mutex held */
+static inline struct sol_sync_task* sol_sync_task_system_dequeue_pending_task(struct sol_sync_task_system* task_system, enum sol_sync_task_priority priority)
+{
+    struct sol_sync_task* task;
+
+    if(sol_task_queue_dequeue(task_system->pending_task_queues + priority, &task))
+    {
+        atomic_store_explicit(task_system->pending_task_counts + priority, sol_task_queue_count(task_system->pending_task_queues + priority), memory_order_relaxed);
+        return task;
+    }
+
+    return NULL;
+}
+
+static inline struct sol_sync_task* sol_sync_task_worker_find_task(struct sol_sync_task_worker* worker, enum sol_sync_task_priority priority)
+{
+    struct sol_sync_task_system* task_system = worker->task_system;
+    struct sol_sync_task* task;
+
+    /** own tasks first, these are the most recently readied so are most likely to have their data in cache */
+    task = sol_lockfree_deque_pull(worker->ready_tasks + priority);
+    if(task)
+    {
+        return task;
+    }
+
+    /** then tasks readied outside the workers, checking the count first prevents contending on the mutex when they're not being used */
+    if(atomic_load_explicit(task_system->pending_task_counts + priority, memory_order_relaxed))
+    {
+        mtx_lock(&task_system->worker_thread_mutex);
+        task = sol_sync_task_system_dequeue_pending_task(task_system, priority);
+        mtx_unlock(&task_system->worker_thread_mutex);
+        if(task)
+        {
+            SOL_SYNC_TASK_STATISTIC(worker, pending_tasks_dequeued);
+            return task;
+        }
+    }
+
+    return sol_sync_task_worker_steal_task(worker, priority);
+}
+
+static inline struct sol_sync_task* sol_sync_task_worker_thread_get_task(struct sol_sync_task_worker* worker)
+{
+    struct sol_sync_task_system* task_system = worker->task_system;
+    struct sol_sync_task* task;
+    uint32_t i;
+    bool starvation_guard;
+
+    while(true)
+    {
+        /** periodically look for work in reverse priority order, so that a steady supply of more urgent tasks cannot stop less urgent ones from ever running */
+        starvation_guard = ++worker->starvation_guard_counter == SOL_SYNC_TASK_STARVATION_GUARD_INTERVAL;
+        if(starvation_guard)
+        {
+            worker->starvation_guard_counter = 0;
+        }
+
+        for(i = 0; i < SOL_SYNC_TASK_PRIORITY_COUNT; i++)
+        {
+            task = sol_sync_task_worker_find_task(worker, starvation_guard ? SOL_SYNC_TASK_PRIORITY_COUNT - 1 - i : i);
+            if(task)
+            {
+                return task;
+            }
+        }
+
+        /** nothing to do, prepare to stall */
+        mtx_lock(&task_system->worker_thread_mutex);
+
+        assert(atomic_load_explicit(&task_system->stalled_thread_count, memory_order_relaxed) < task_system->worker_thread_count);
+        atomic_fetch_add_explicit(&task_system->stalled_thread_count, 1, memory_order_seq_cst);
+
+        /** having flagged this worker as stalled, any task made ready on another worker from here on will try to wake a stalled worker (which requires the mutex we hold)
+         * so any task made ready before that point must be found now or it may never be executed */
+        for(i = 0; i < SOL_SYNC_TASK_PRIORITY_COUNT; i++)
+        {
+            if((task = sol_sync_task_system_dequeue_pending_task(task_system, i)) || (task = sol_sync_task_worker_steal_task(worker, i)))
+            {
+                atomic_fetch_sub_explicit(&task_system->stalled_thread_count, 1, memory_order_relaxed);
+                mtx_unlock(&task_system->worker_thread_mutex);
+                return task;
+            }
+        }
 
         /** if all threads are stalled (there is no work left to do) and we've asked the system to shut down (this requires there are no more tasks being created) then we can finalise shutdown */
-        if(task_system->shutdown_initiated && (task_system->stalled_thread_count == task_system->worker_thread_count))
+        if(task_system->shutdown_initiated && (atomic_load_explicit(&task_system->stalled_thread_count, memory_order_relaxed) == task_system->worker_thread_count))
         {
-            task_system->stalled_thread_count--;
+            atomic_fetch_sub_explicit(&task_system->stalled_thread_count, 1, memory_order_relaxed);
             task_system->shutdown_completed = true;
             cnd_broadcast(&task_system->worker_thread_condition);/// wake up all stalled threads so that they can exit
             mtx_unlock(&task_system->worker_thread_mutex);
@@ -66,34 +234,37 @@ static inline struct sol_sync_task* sol_sync_task_worker_thread_get_task(struct
         }
 
         /** wait untill more workers are needed or we're shutting down (with appropriate checks in case of spurrious wakeup) */
+        SOL_SYNC_TASK_STATISTIC(worker, stalls);
+        SOL_SYNC_TASK_TRACE(SOL_SYNC_TASK_TRACE_EVENT_STALL_BEGIN, NULL, NULL);
         cnd_wait(&task_system->worker_thread_condition, &task_system->worker_thread_mutex);
+        SOL_SYNC_TASK_TRACE(SOL_SYNC_TASK_TRACE_EVENT_STALL_END, NULL, NULL);
 
-        assert(task_system->stalled_thread_count > 0);
-        task_system->stalled_thread_count--;
+        assert(atomic_load_explicit(&task_system->stalled_thread_count, memory_order_relaxed) > 0);
+        atomic_fetch_sub_explicit(&task_system->stalled_thread_count, 1, memory_order_relaxed);
 
         if(task_system->shutdown_completed)
         {
             mtx_unlock(&task_system->worker_thread_mutex);
             return NULL;
         }
-    }
-
-    mtx_unlock(&task_system->worker_thread_mutex);
 
-    return task;
+        mtx_unlock(&task_system->worker_thread_mutex);
+    }
 }
 
-static int sol_sync_task_worker_thread_function(void* in)
+/** signals the successors of a task whose function (and the functions of any tasks holding its completion count) has returned */
+static inline void sol_sync_task_complete(struct sol_sync_task_worker* worker, struct sol_sync_task* task, uint32_t continuation_depth)
 {
-    struct sol_sync_task_system* task_system = in;
-    struct sol_sync_task* task;
+    struct sol_sync_task_system* task_system = worker->task_system;
     struct sol_sync_primitive** successor_ptr;
-    uint32_t first_successor_index, successor_index;
+    uint32_t first_successor_index, successor_index, released_successor_index;
+    enum sol_sync_task_priority priority;
+    struct sol_sync_task* parent;
 
-    while((task = sol_sync_task_worker_thread_get_task(task_system)))
+    do
     {
-        task->task_function(task->task_function_data);
-
+        priority = task->priority;
+        parent = task->completion_parent;
         first_successor_index = sol_lockfree_hopper_close(&task->successor_hopper);
         successor_ptr = sol_lockfree_pool_get_entry_pointer(&task_system->successor_pool, first_successor_index);
 
@@ -105,21 +276,141 @@ static int sol_sync_task_worker_thread_function(void* in)
 
         successor_index = first_successor_index;
 
+        /** the first successor made ready by signalling is kept by this worker to be run next, avoiding the deque entirely
+         * limit how long a chain can be run this way so other ready tasks on this worker don't get starved
+         * only successors at least as urgent as the completed task are run this way, others may have to wait on more urgent work */
+        worker->continuation_priority_limit = priority;
+        worker->accepting_continuation = continuation_depth < SOL_SYNC_TASK_CONTINUATION_DEPTH_LIMIT && worker->continuation_task == NULL;
+
         while(successor_ptr)
         {
             sol_sync_primitive_signal_conditions(*successor_ptr, 1);
+
+            /** the next index must be read before the entry goes to the magazine, a magazine returning entries to the pool relinks them */
+            released_successor_index = successor_index;
             successor_ptr = sol_lockfree_pool_iterate(&task_system->successor_pool, &successor_index);
+            sol_lockfree_pool_magazine_relinquish_entry_index(&worker->successor_magazine, released_successor_index);
         }
 
-        sol_lockfree_pool_relinquish_entry_index_range(&task_system->successor_pool, first_successor_index, successor_index);
+        worker->accepting_continuation = false;
+
+        task = parent;
+    }
+    while(task && atomic_fetch_sub_explicit(&task->completion_count, 1, memory_order_acq_rel) == 1);
+}
+
+static int sol_sync_task_worker_thread_function(void* in)
+{
+    struct sol_sync_task_worker* worker = in;
+    struct sol_sync_task* task;
+    uint32_t continuation_depth;
+
+    sol_sync_task_current_worker = worker;
+
+    sol_lockfree_pool_magazine_initialise(&worker->successor_magazine, &worker->task_system->successor_pool);
+    sol_lockfree_segmented_pool_magazine_initialise(&worker->task_magazine, &worker->task_system->task_pool);
+
+    if(worker->name[0])
+    {
+        sol_thread_set_current_name(worker->name);
+        SOL_SYNC_TASK_TRACE_NAME_THREAD(worker->name);
+    }
+
+    if(worker->apply_affinity)
+    {
+        sol_cpu_mask_apply_to_current_thread(&worker->affinity);
+    }
+
+    task = sol_sync_task_worker_thread_get_task(worker);
+    continuation_depth = 0;
+
+    while(task)
+    {
+        SOL_SYNC_TASK_STATISTIC(worker, tasks_executed);
+        SOL_SYNC_TASK_TRACE(SOL_SYNC_TASK_TRACE_EVENT_START, task, task->task_function);
+        task->task_function(task->task_function_data);
+        SOL_SYNC_TASK_TRACE(SOL_SYNC_TASK_TRACE_EVENT_END, task, NULL);
+
+        worker->continuation_task = NULL;
+
+        /** acquire-release so that whichever thread completes the task sees all changes made by the functions of tasks holding its completion count */
+        if(atomic_fetch_sub_explicit(&task->completion_count, 1, memory_order_acq_rel) == 1)
+        {
+            sol_sync_task_complete(worker, task, continuation_depth);
+        }
+
+        if(worker->continuation_task)
+        {
+            task = worker->continuation_task;
+            continuation_depth++;
+            SOL_SYNC_TASK_STATISTIC(worker, continuations_executed);
+        }
+        else
+        {
+            task = sol_sync_task_worker_thread_get_task(worker);
+            continuation_depth = 0;
+        }
     }
 
+    sol_lockfree_segmented_pool_magazine_terminate(&worker->task_magazine);
+    sol_lockfree_pool_magazine_terminate(&worker->successor_magazine);
+
+    sol_sync_task_current_worker = NULL;
+
     return 0;
 }
 
 
 
 
+static inline void sol_sync_task_make_ready(struct sol_sync_task_system* task_system, struct sol_sync_task* task)
+{
+    struct sol_sync_task_worker* worker = sol_sync_task_current_worker;
+
+    SOL_SYNC_TASK_TRACE(SOL_SYNC_TASK_TRACE_EVENT_READY, task, NULL);
+
+    if(worker && worker->task_system == task_system && worker->accepting_continuation && task->priority <= worker->continuation_priority_limit)
+    {
+        /** worker is signalling the successors of a task it just completed, it will run this one immediately */
+        worker->continuation_task = task;
+        worker->accepting_continuation = false;
+        return;
+    }
+
+    /** fast path: a worker readying a task keeps it, other workers will steal it if they're idle */
+    if(worker && worker->task_system == task_system && sol_lockfree_deque_push(worker->ready_tasks + task->priority, task))
+    {
+        /** the push must be globally ordered before checking for stalled workers, which check the deques after flagging themselves as stalled */
+        atomic_thread_fence(memory_order_seq_cst);
+
+        if(atomic_load_explicit(&task_system->stalled_thread_count, memory_order_relaxed))
+        {
+            mtx_lock(&task_system->worker_thread_mutex);
+            cnd_signal(&task_system->worker_thread_condition);
+            mtx_unlock(&task_system->worker_thread_mutex);
+        }
+        return;
+    }
+
+    if(worker && worker->task_system == task_system)
+    {
+        SOL_SYNC_TASK_STATISTIC(worker, deque_overflows);
+    }
+
+    mtx_lock(&task_system->worker_thread_mutex);
+
+    sol_task_queue_enqueue(task_system->pending_task_queues + task->priority, task, NULL);
+    atomic_store_explicit(task_system->pending_task_counts + task->priority, sol_task_queue_count(task_system->pending_task_queues + task->priority), memory_order_relaxed);
+
+    if(atomic_load_explicit(&task_system->stalled_thread_count, memory_order_relaxed))
+    {
+        assert(!task_system->shutdown_completed);/** shouldnt have stopped running if tasks have yet to complete */
+        cnd_signal(&task_system->worker_thread_condition);
+    }
+
+    mtx_unlock(&task_system->worker_thread_mutex);
+}
+
 static void sol_sync_task_impose_conditions_polymorphic(struct sol_sync_primitive* primitive, uint32_t count)
 {
     /** undo polymorphism */
@@ -137,23 +428,13 @@ static void sol_sync_task_signal_conditions_polymorphic(struct sol_sync_primitiv
     uint_fast32_t old_count;
 
     /** this is responsible for coalescing all modifications, but also for making them available to the next thread/atomic to recieve this memory (after the potential release in this function) 
-     * at present the `task_system->worker_thread_mutex` releases memory but acquire-release here is sufficient if that changes (e.g. if the task is executed immediately) */
+     * the ready task may be stolen from a workers deque, which doesn't pass through the mutex, so acquire-release here is required */
     old_count = atomic_fetch_sub_explicit(&task->condition_count, count, memory_order_acq_rel);
     assert(old_count >= count);/** must not make condition count go negative */
 
     if(old_count==count)/** this is the last dependency/condition this task was waiting on, put it on list of "ready to run" tasks and make sure there's a worker thread to satisfy it */
     {
-        mtx_lock(&task_system->worker_thread_mutex);
-
-        sol_task_queue_enqueue(&task_system->pending_task_queue, task, NULL);
-
-        if(task_system->stalled_thread_count)
-        {
-            assert(!task_system->shutdown_completed);/** shouldnt have stopped running if tasks have yet to complete */
-            cnd_signal(&task_system->worker_thread_condition);
-        }
-
-        mtx_unlock(&task_system->worker_thread_mutex);
+        sol_sync_task_make_ready(task_system, task);
     }
 }
 static void sol_sync_task_retain_references_polymorphic(struct sol_sync_primitive* primitive, uint32_t count)
@@ -169,6 +450,8 @@ static void sol_sync_task_release_references_polymorphic(struct sol_sync_primiti
     /** undo polymorphism */
     struct sol_sync_task* task = (struct sol_sync_task*)primitive;
 
+    struct sol_sync_task_worker* worker = sol_sync_task_current_worker;
+
     /** need to release to prevent reads/writes of successor/completion data being moved after this operation */
     uint_fast32_t old_count = atomic_fetch_sub_explicit(&task->reference_count, count, memory_order_release);
 
@@ -177,7 +460,14 @@ static void sol_sync_task_release_references_polymorphic(struct sol_sync_primiti
     if(old_count == count)
     {
         /** this should only happen after task completion, BUT the only time this counter can (if used properly) hit zero is if the task HAS completed! */
-        sol_lockfree_pool_relinquish_entry(&task->task_system->task_pool, task);
+        if(worker && worker->task_system == task->task_system)
+        {
+            sol_lockfree_segmented_pool_magazine_relinquish_entry_index(&worker->task_magazine, task->pool_index);
+        }
+        else
+        {
+            sol_lockfree_segmented_pool_relinquish_entry_index(&task->task_system->task_pool, task->pool_index);
+        }
     }
 }
 static void sol_sync_task_attach_successor_polymorphic(struct sol_sync_primitive* primitive, struct sol_sync_primitive* successor)
@@ -185,6 +475,7 @@ static void sol_sync_task_attach_successor_polymorphic(struct sol_sync_primitive
     /** undo polymorphism */
     struct sol_sync_task* task = (struct sol_sync_task*)primitive;
 
+    struct sol_sync_task_worker* worker = sol_sync_task_current_worker;
     struct sol_lockfree_pool* successor_pool;
     struct sol_sync_primitive** successor_ptr;
 
@@ -198,7 +489,15 @@ static void sol_sync_task_attach_successor_polymorphic(struct sol_sync_primitive
 
         successor_pool = &task->task_system->successor_pool;
 
-        successor_ptr = sol_lockfree_pool_acquire_entry(successor_pool);
+        /** workers of this system have their own cache of successors so setting up successors inside tasks doesn't contend on the pool */
+        if(worker && worker->task_system == task->task_system)
+        {
+            successor_ptr = sol_lockfree_pool_magazine_acquire_entry(&worker->successor_magazine);
+        }
+        else
+        {
+            successor_ptr = sol_lockfree_pool_acquire_entry(successor_pool);
+        }
         assert(successor_ptr);///ran out of successors
 
         *successor_ptr = successor;
@@ -208,7 +507,14 @@ static void sol_sync_task_attach_successor_polymorphic(struct sol_sync_primitive
             // potential to run out of successors if thread stalls here, shouldn't be a problem unless system is under stress
             //  ^ (max_worker_threads * max_successors) should be sufficient overhead
             /// if we failed to add the successor then the task has already been completed, relinquish the storage and signal the successor
-            sol_lockfree_pool_relinquish_entry(successor_pool, successor_ptr);
+            if(worker && worker->task_system == task->task_system)
+            {
+                sol_lockfree_pool_magazine_relinquish_entry(&worker->successor_magazine, successor_ptr);
+            }
+            else
+            {
+                sol_lockfree_pool_relinquish_entry(successor_pool, successor_ptr);
+            }
             sol_sync_primitive_signal_conditions(successor, 1);
         }
     }
@@ -223,34 +529,110 @@ const static struct sol_sync_primitive_functions task_sync_functions =
     .attach_successor   = &sol_sync_task_attach_successor_polymorphic,
 };
 
-static void sol_sync_task_initialise(void* entry, void* data)
+static void sol_sync_task_initialise(void* entry, uint32_t entry_index, void* data)
 {
     struct sol_sync_task* task = entry;
     struct sol_sync_task_system* task_system = data;
 
     task->primitive.sync_functions = &task_sync_functions;
     task->task_system = task_system;
+    task->pool_index = entry_index;
 
     sol_lockfree_hopper_initialise(&task->successor_hopper);
 
     atomic_init(&task->condition_count, 0);
     atomic_init(&task->reference_count, 0);
+    atomic_init(&task->completion_count, 0);
+    atomic_init(&task->range_split_budget, 0);
 }
 
 
+/** pick the processor(s) each worker may run on */
+static void sol_sync_task_system_place_workers(struct sol_sync_task_system* task_system, enum sol_sync_task_worker_placement placement)
+{
+    struct sol_cpu_topology topology;
+    struct sol_cpu_topology_processor* assigned;
+    struct sol_cpu_topology_processor* processor;
+    struct sol_sync_task_worker* worker;
+    uint32_t i, j;
+
+    if( ! sol_cpu_topology_initialise(&topology))
+    {
+        sol_cpu_topology_terminate(&topology);
+        return;
+    }
+
+    for(i=0; i<task_system->worker_thread_count; i++)
+    {
+        worker = task_system->workers + i;
+
+        /** topology is ordered such that taking processors in order fills physical cores as closely together as possible */
+        assigned = topology.processors + (i % topology.processor_count);
+        worker->node = assigned->node;
+
+        if(placement == SOL_SYNC_TASK_WORKER_PLACEMENT_NONE)
+        {
+            continue;
+        }
+
+        worker->affinity = (struct sol_cpu_mask){.words = {0}};
+        worker->apply_affinity = true;
+
+        for(j=0; j<topology.processor_count; j++)
+        {
+            processor = topology.processors + j;
+
+            if((placement == SOL_SYNC_TASK_WORKER_PLACEMENT_PROCESSOR   && processor->cpu == assigned->cpu) ||
+               (placement == SOL_SYNC_TASK_WORKER_PLACEMENT_CACHE_GROUP && processor->cache_group == assigned->cache_group) ||
+               (placement == SOL_SYNC_TASK_WORKER_PLACEMENT_NODE        && processor->node == assigned->node))
+            {
+                sol_cpu_mask_add(&worker->affinity, processor->cpu);
+            }
+        }
+    }
+
+    sol_cpu_topology_terminate(&topology);
+}
+
 void sol_sync_task_system_initialise(struct sol_sync_task_system* task_system, uint32_t worker_thread_count, size_t total_task_exponent, size_t total_successor_exponent)
 {
-    uint32_t i;
+    struct sol_sync_task_system_description description =
+    {
+        .worker_thread_count = worker_thread_count,
+        .total_task_exponent = total_task_exponent,
+        .task_segment_limit = 0,
+        .total_successor_exponent = total_successor_exponent,
+        .worker_placement = SOL_SYNC_TASK_WORKER_PLACEMENT_NONE,
+        .worker_name_prefix = NULL,
+        .node_local_stealing = false,
+    };
 
-    sol_lockfree_pool_initialise(&task_system->task_pool, total_task_exponent, sizeof(struct sol_sync_task));
-    sol_lockfree_pool_initialise(&task_system->successor_pool, total_successor_exponent, sizeof(struct sol_sync_primitive*));
+    sol_sync_task_system_initialise_from_description(task_system, &description);
+}
 
-    sol_lockfree_pool_call_for_every_entry(&task_system->task_pool, &sol_sync_task_initialise, task_system);
+void sol_sync_task_system_initialise_from_description(struct sol_sync_task_system* task_system, const struct sol_sync_task_system_description* description)
+{
+    struct sol_sync_task_worker* worker;
+    uint32_t i, j, worker_thread_count;
+    size_t total_task_exponent, deque_exponent;
+
+    worker_thread_count = description->worker_thread_count;
+    total_task_exponent = description->total_task_exponent;
+
+    assert(worker_thread_count > 0);
+
+    sol_lockfree_segmented_pool_initialise(&task_system->task_pool, total_task_exponent, description->task_segment_limit, sizeof(struct sol_sync_task), &sol_sync_task_initialise, task_system);
+    sol_lockfree_pool_initialise(&task_system->successor_pool, description->total_successor_exponent, sizeof(struct sol_sync_primitive*));
 
-    sol_task_queue_initialise(&task_system->pending_task_queue, 16);
+    for(j=0; j<SOL_SYNC_TASK_PRIORITY_COUNT; j++)
+    {
+        sol_task_queue_initialise(task_system->pending_task_queues + j, 16);
+        atomic_init(task_system->pending_task_counts + j, 0);
+    }
 
-    task_system->worker_threads = malloc(sizeof(thrd_t) * worker_thread_count);
+    task_system->workers = malloc(sizeof(struct sol_sync_task_worker) * worker_thread_count);
     task_system->worker_thread_count = worker_thread_count;
+    task_system->node_local_stealing = description->node_local_stealing;
 
     cnd_init(&task_system->worker_thread_condition);
     mtx_init(&task_system->worker_thread_mutex, mtx_plain);
@@ -258,12 +640,51 @@ void sol_sync_task_system_initialise(struct sol_sync_task_system* task_system, u
     task_system->shutdown_completed = false;
     task_system->shutdown_initiated = false;
 
-    task_system->stalled_thread_count = 0;
+    atomic_init(&task_system->stalled_thread_count, 0);
+
+    /** the task pool grows so the deque size is only limited by the number of tasks that can exist if the task pool is limited */
+    deque_exponent = SOL_SYNC_TASK_WORKER_DEQUE_MAX_EXPONENT;
+    if(description->task_segment_limit)
+    {
+        deque_exponent = SOL_MIN(deque_exponent, total_task_exponent + sol_u32_exp_ge(description->task_segment_limit));
+    }
+
+    /** all workers must be set up before any are started as they may try to steal from each other immediately */
+    for(i=0; i<worker_thread_count; i++)
+    {
+        worker = task_system->workers + i;
+        for(j=0; j<SOL_SYNC_TASK_PRIORITY_COUNT; j++)
+        {
+            sol_lockfree_deque_initialise(worker->ready_tasks + j, deque_exponent);
+        }
+        worker->task_system = task_system;
+        worker->index = i;
+        worker->steal_rng_state = 0x9E3779B9u * (i + 1);/** must be non-zero */
+        worker->starvation_guard_counter = 0;
+        worker->continuation_task = NULL;
+        worker->continuation_priority_limit = 0;
+        worker->accepting_continuation = false;
+        worker->statistics = (struct sol_sync_task_statistics){0};
+
+        worker->name[0] = '\0';
+        if(description->worker_name_prefix)
+        {
+            snprintf(worker->name, sizeof(worker->name), "%s%"PRIu32, description->worker_name_prefix, i);
+        }
+        worker->apply_affinity = false;
+        worker->node = 0;
+    }
+
+    /** the topology is still required to know the node of each worker when only stealing locally */
+    if(description->worker_placement != SOL_SYNC_TASK_WORKER_PLACEMENT_NONE || description->node_local_stealing)
+    {
+        sol_sync_task_system_place_workers(task_system, description->worker_placement);
+    }
 
     /// will need setup mutex locked here if we want to wait on all workers to start before progressing (maybe useful to have, but I can't think of a reason)
     for(i=0; i<worker_thread_count; i++)
     {
-        thrd_create(task_system->worker_threads+i, sol_sync_task_worker_thread_function, task_system);
+        thrd_create(&task_system->workers[i].thread, sol_sync_task_worker_thread_function, task_system->workers + i);
     }
 }
 
@@ -289,35 +710,169 @@ void sol_sync_task_system_end_shutdown(struct sol_sync_task_system* task_system)
     for(i=0;i<task_system->worker_thread_count;i++)
     {
         /// if thread gets stuck here its possible that not all tasks were able to complete, perhaps because things werent shut down correctly and some tasks have outstanding dependencies
-        thrd_join(task_system->worker_threads[i], NULL);
+        thrd_join(task_system->workers[i].thread, NULL);
     }
-    assert(task_system->stalled_thread_count==0);/// make sure everyone woke up okay
+    assert(atomic_load_explicit(&task_system->stalled_thread_count, memory_order_relaxed)==0);/// make sure everyone woke up okay
 }
 
 void sol_sync_task_system_terminate(struct sol_sync_task_system* task_system)
 {
-    free(task_system->worker_threads);
+    uint32_t i, j;
+
+    for(i=0;i<task_system->worker_thread_count;i++)
+    {
+        for(j=0; j<SOL_SYNC_TASK_PRIORITY_COUNT; j++)
+        {
+            sol_lockfree_deque_terminate(task_system->workers[i].ready_tasks + j);
+        }
+    }
+    free(task_system->workers);
 
     cnd_destroy(&task_system->worker_thread_condition);
     mtx_destroy(&task_system->worker_thread_mutex);
 
     sol_lockfree_pool_terminate(&task_system->successor_pool);
 
-    sol_task_queue_terminate(&task_system->pending_task_queue);
-    sol_lockfree_pool_terminate(&task_system->task_pool);
+    for(j=0; j<SOL_SYNC_TASK_PRIORITY_COUNT; j++)
+    {
+        sol_task_queue_terminate(task_system->pending_task_queues + j);
+    }
+    sol_lockfree_segmented_pool_terminate(&task_system->task_pool);
 }
 
+#ifdef SOL_SYNC_TASK_STATISTICS
+
+static void sol_sync_task_statistics_accumulate(struct sol_sync_task_statistics* total, const struct sol_sync_task_statistics* statistics)
+{
+    total->tasks_executed         += statistics->tasks_executed;
+    total->continuations_executed += statistics->continuations_executed;
+    total->deque_overflows        += statistics->deque_overflows;
+    total->pending_tasks_dequeued += statistics->pending_tasks_dequeued;
+    total->steal_attempts         += statistics->steal_attempts;
+    total->steals                 += statistics->steals;
+    total->steal_retries          += statistics->steal_retries;
+    total->stalls                 += statistics->stalls;
+    total->range_splits           += statistics->range_splits;
+}
+
+static void sol_sync_task_statistics_write_json(FILE* file, const struct sol_sync_task_statistics* statistics)
+{
+    fprintf(file, "\"tasks_executed\":%"PRIu64",\"continuations_executed\":%"PRIu64",\"deque_overflows\":%"PRIu64",\"pending_tasks_dequeued\":%"PRIu64","
+        "\"steal_attempts\":%"PRIu64",\"steals\":%"PRIu64",\"steal_retries\":%"PRIu64",\"stalls\":%"PRIu64",\"range_splits\":%"PRIu64,
+        statistics->tasks_executed, statistics->continuations_executed, statistics->deque_overflows, statistics->pending_tasks_dequeued,
+        statistics->steal_attempts, statistics->steals, statistics->steal_retries, statistics->stalls, statistics->range_splits);
+}
+
+bool sol_sync_task_system_get_statistics(struct sol_sync_task_system* task_system, struct sol_sync_task_statistics* total_statistics, struct sol_sync_task_statistics* worker_statistics)
+{
+    uint32_t i;
+
+    *total_statistics = (struct sol_sync_task_statistics){0};
+
+    for(i=0; i<task_system->worker_thread_count; i++)
+    {
+        sol_sync_task_statistics_accumulate(total_statistics, &task_system->workers[i].statistics);
+        if(worker_statistics)
+        {
+            worker_statistics[i] = task_system->workers[i].statistics;
+        }
+    }
+
+    return true;
+}
+
+bool sol_sync_task_system_export_statistics_json(struct sol_sync_task_system* task_system, FILE* file)
+{
+    struct sol_sync_task_statistics total_statistics;
+    struct sol_sync_task_worker* worker;
+    uint32_t i;
+
+    sol_sync_task_system_get_statistics(task_system, &total_statistics, NULL);
+
+    fprintf(file, "{\"worker_count\":%"PRIu32",\"workers\":[", task_system->worker_thread_count);
+
+    for(i=0; i<task_system->worker_thread_count; i++)
+    {
+        worker = task_system->workers + i;
+        fprintf(file, "%s\n{\"index\":%"PRIu32",\"name\":\"%s\",\"node\":%"PRIu32",", i ? "," : "", worker->index, worker->name, worker->node);
+        sol_sync_task_statistics_write_json(file, &worker->statistics);
+        fprintf(file, "}");
+    }
+
+    fprintf(file, "],\n\"total\":{");
+    sol_sync_task_statistics_write_json(file, &total_statistics);
+    fprintf(file, "}}\n");
+
+    return ferror(file) == 0;
+}
+
+void sol_sync_task_system_reset_statistics(struct sol_sync_task_system* task_system)
+{
+    uint32_t i;
+
+    for(i=0; i<task_system->worker_thread_count; i++)
+    {
+        task_system->workers[i].statistics = (struct sol_sync_task_statistics){0};
+    }
+}
+
+#else
+
+bool sol_sync_task_system_get_statistics(struct sol_sync_task_system* task_system, struct sol_sync_task_statistics* total_statistics, struct sol_sync_task_statistics* worker_statistics)
+{
+    (void)task_system;
+    (void)total_statistics;
+    (void)worker_statistics;
+    return false;
+}
+
+bool sol_sync_task_system_export_statistics_json(struct sol_sync_task_system* task_system, FILE* file)
+{
+    (void)task_system;
+    (void)file;
+    return false;
+}
+
+void sol_sync_task_system_reset_statistics(struct sol_sync_task_system* task_system)
+{
+    (void)task_system;
+}
+
+#endif
+
 
 
 struct sol_sync_task_handle sol_sync_task_prepare(struct sol_sync_task_system* task_system, void(*task_function)(void*), void * data)
 {
+    return sol_sync_task_prepare_with_priority(task_system, task_function, data, SOL_SYNC_TASK_PRIORITY_NORMAL);
+}
+
+struct sol_sync_task_handle sol_sync_task_prepare_with_priority(struct sol_sync_task_system* task_system, void(*task_function)(void*), void * data, enum sol_sync_task_priority priority)
+{
+    struct sol_sync_task_worker* worker = sol_sync_task_current_worker;
     struct sol_sync_task* task;
+    uint32_t task_index;
 
-    task = sol_lockfree_pool_acquire_entry(&task_system->task_pool);
-    assert(task);//not enough tasks allocated
+    assert(priority < SOL_SYNC_TASK_PRIORITY_COUNT);
+
+    /** workers of this system have their own cache of tasks so preparing tasks inside tasks doesn't contend on the pool */
+    if(worker && worker->task_system == task_system)
+    {
+        task_index = sol_lockfree_segmented_pool_magazine_acquire_entry_index(&worker->task_magazine);
+    }
+    else
+    {
+        task_index = sol_lockfree_segmented_pool_acquire_entry_index(&task_system->task_pool);
+    }
+    assert(task_index != SOL_LOCKFREE_POOL_INVALID_ENTRY);//task segment limit reached
+
+    task = sol_lockfree_segmented_pool_get_entry_pointer(&task_system->task_pool, task_index);
 
     task->task_function=task_function;
     task->task_function_data=data;
+    task->priority=priority;
+    task->completion_parent=NULL;
+    task->range_root=NULL;
 
     sol_lockfree_hopper_reset(&task->successor_hopper);
 
@@ -325,6 +880,10 @@ struct sol_sync_task_handle sol_sync_task_prepare(struct sol_sync_task_system* t
     atomic_store_explicit(&task->condition_count, SOL_TASK_INTERNAL_COUNTER_BIT, memory_order_relaxed);
     /** need to retain a reference until the successors are actually signalled, ergo one extra reference that will be released after completing the task */
     atomic_store_explicit(&task->reference_count, SOL_TASK_INTERNAL_COUNTER_BIT, memory_order_relaxed);
+    /** the task function returning is the only thing required to complete a task until it spawns something that holds a completion count */
+    atomic_store_explicit(&task->completion_count, 1, memory_order_relaxed);
+
+    SOL_SYNC_TASK_TRACE(SOL_SYNC_TASK_TRACE_EVENT_PREPARE, task, task_function);
 
     return (struct sol_sync_task_handle)
     {
@@ -337,6 +896,7 @@ void sol_sync_task_activate(struct sol_sync_task_handle task)
     /** this is basically just called differently to account for the "hidden" wait counter added on task creation */
     /** sol_sync_task_signal_conditions(task, 1); */
     assert(task.primitive->sync_functions->signal_conditions == &sol_sync_task_signal_conditions_polymorphic);
+    SOL_SYNC_TASK_TRACE(SOL_SYNC_TASK_TRACE_EVENT_ACTIVATE, task.primitive, NULL);
     sol_sync_task_signal_conditions_polymorphic(task.primitive, SOL_TASK_INTERNAL_COUNTER_BIT);
 }
 
@@ -372,5 +932,86 @@ void sol_sync_task_attach_successor(struct sol_sync_task_handle task, struct sol
 
 
 
+static void sol_sync_task_range_execute(void* data)
+{
+    struct sol_sync_task* task = data;
+    struct sol_sync_task* root = task->range_root;
+    struct sol_sync_task* split_task;
+    struct sol_sync_task_worker* worker = sol_sync_task_current_worker;
+    struct sol_sync_task_handle split_handle;
+    uint32_t begin, end, split, grain_end, grain_size;
+    uint_fast32_t budget;
+
+    assert(worker && worker->task_system == root->task_system);/** range tasks must only be run by a worker */
+
+    begin = task->range_begin;
+    end = task->range_end;
+    grain_size = root->range_grain_size;
+
+    while(begin < end)
+    {
+        /** lazy binary splitting: only split when this worker has no other work that could be stolen instead, i.e. when splitting could actually feed an idle worker
+         * (halving rather than doubling the grain size, which could overflow) */
+        if((end - begin) / 2 > grain_size && sol_lockfree_deque_is_empty(worker->ready_tasks + root->priority))
+        {
+            budget = atomic_load_explicit(&root->range_split_budget, memory_order_relaxed);
+            while(budget && !atomic_compare_exchange_weak_explicit(&root->range_split_budget, &budget, budget - 1, memory_order_relaxed, memory_order_relaxed));
+
+            if(budget)
+            {
+                split = begin + (end - begin) / 2;
+
+                split_handle = sol_sync_task_prepare_with_priority(root->task_system, &sol_sync_task_range_execute, NULL, root->priority);
+                split_task = (struct sol_sync_task*)split_handle.primitive;
+
+                split_task->task_function_data = split_task;
+                split_task->range_root = root;
+                split_task->range_begin = split;
+                split_task->range_end = end;
+
+                /** the root cannot complete while this task is executing, so it's safe to add to its completion count here */
+                split_task->completion_parent = root;
+                atomic_fetch_add_explicit(&root->completion_count, 1, memory_order_relaxed);
+
+                /** this will put the split task on this workers deque where it can be stolen */
+                sol_sync_task_activate(split_handle);
+                SOL_SYNC_TASK_STATISTIC(worker, range_splits);
+
+                end = split;
+                continue;
+            }
+        }
+
+        grain_end = (end - begin > grain_size) ? begin + grain_size : end;
+        root->range_function(root->range_data, begin, grain_end);
+        begin = grain_end;
+    }
+}
+
+struct sol_sync_task_handle sol_sync_task_range_prepare(struct sol_sync_task_system* task_system, void(*range_function)(void*, uint32_t, uint32_t), void* data, uint32_t range_begin, uint32_t range_end, uint32_t grain_size)
+{
+    return sol_sync_task_range_prepare_with_priority(task_system, range_function, data, range_begin, range_end, grain_size, SOL_SYNC_TASK_PRIORITY_NORMAL);
+}
+
+struct sol_sync_task_handle sol_sync_task_range_prepare_with_priority(struct sol_sync_task_system* task_system, void(*range_function)(void*, uint32_t, uint32_t), void* data, uint32_t range_begin, uint32_t range_end, uint32_t grain_size, enum sol_sync_task_priority priority)
+{
+    struct sol_sync_task_handle handle;
+    struct sol_sync_task* task;
+
+    assert(range_begin <= range_end);
+
+    handle = sol_sync_task_prepare_with_priority(task_system, &sol_sync_task_range_execute, NULL, priority);
+    task = (struct sol_sync_task*)handle.primitive;
 
+    /** every task executing part of the range is passed itself */
+    task->task_function_data = task;
+    task->range_root = task;
+    task->range_begin = range_begin;
+    task->range_end = range_end;
+    task->range_function = range_function;
+    task->range_data = data;
+    task->range_grain_size = grain_size ? grain_size : 1;
+    atomic_store_explicit(&task->range_split_budget, task_system->worker_thread_count * SOL_SYNC_TASK_RANGE_SPLITS_PER_WORKER, memory_order_relaxed);
 
+    return handle;
+}
@@ -21,37 +21,158 @@ along with solipsix.  If not, see <https://www.gnu.org/licenses/>.
 
 #include <inttypes.h>
 #include <stdbool.h>
+#include <stdio.h>
 #include <threads.h>
 
 #include "lockfree/pool.h"
+#include "lockfree/segmented_pool.h"
 #include "lockfree/hopper.h"
+#include "lockfree/deque.h"
 
 #include "sync/primitive.h"
+#include "sync/cpu_topology.h"
 
 struct sol_sync_task;
+struct sol_sync_task_system;
+
+/** ready tasks are run in order of priority (lower value first), within a priority there is no ordering guarantee */
+enum sol_sync_task_priority
+{
+    SOL_SYNC_TASK_PRIORITY_HIGH   = 0,/** latency critical work, e.g. the work required to submit a frame */
+    SOL_SYNC_TASK_PRIORITY_NORMAL = 1,
+    SOL_SYNC_TASK_PRIORITY_LOW    = 2,/** background work, e.g. streaming assets */
+    SOL_SYNC_TASK_PRIORITY_COUNT  = 3,
+};
 
 #define SOL_QUEUE_ENTRY_TYPE struct sol_sync_task*
 #define SOL_QUEUE_FUNCTION_PREFIX sol_task_queue
 #define SOL_QUEUE_STRUCT_NAME sol_task_queue
 #include "data_structures/queue.h"
 
-struct sol_sync_task_system
+/** tasks made ready on a worker thread are pushed to that workers deque, idle workers steal from the deques of other workers
+ * this caps the size of each workers deque, tasks that overflow it are put in the task systems shared queue instead */
+#define SOL_SYNC_TASK_WORKER_DEQUE_MAX_EXPONENT 12
+
+/** upon completing a task a worker will run the first of its successors that becomes ready directly, rather than putting it on its deque
+ * this limits how many times in a row that can happen before the worker must check for other work, setting it to 0 disables this behaviour */
+#ifndef SOL_SYNC_TASK_CONTINUATION_DEPTH_LIMIT
+#define SOL_SYNC_TASK_CONTINUATION_DEPTH_LIMIT 32
+#endif
+
+/** every this many times a worker looks for a task it checks the priorities in reverse order, so that less urgent tasks can't be starved entirely */
+#ifndef SOL_SYNC_TASK_STARVATION_GUARD_INTERVAL
+#define SOL_SYNC_TASK_STARVATION_GUARD_INTERVAL 16
+#endif
+
+/** a range task may be split into at most this many tasks per worker (in addition to the task that was prepared) */
+#ifndef SOL_SYNC_TASK_RANGE_SPLITS_PER_WORKER
+#define SOL_SYNC_TASK_RANGE_SPLITS_PER_WORKER 4
+#endif
+
+/** which processors (as read from the system topology) each worker is allowed to run on */
+enum sol_sync_task_worker_placement
+{
+    SOL_SYNC_TASK_WORKER_PLACEMENT_NONE,/** workers may run on any processor */
+    SOL_SYNC_TASK_WORKER_PLACEMENT_PROCESSOR,/** each worker is pinned to a single processor, workers are spread across physical cores before using SMT siblings */
+    SOL_SYNC_TASK_WORKER_PLACEMENT_CACHE_GROUP,/** each worker may run on any processor sharing the last level cache of the processor it would be pinned to */
+    SOL_SYNC_TASK_WORKER_PLACEMENT_NODE,/** each worker may run on any processor in the NUMA node of the processor it would be pinned to */
+};
+
+struct sol_sync_task_system_description
+{
+    uint32_t worker_thread_count;
+    /** tasks are allocated in segments of 2^total_task_exponent, another segment is added whenever all existing tasks are in use */
+    size_t total_task_exponent;
+    /** maximum number of segments of tasks that may be allocated, 0 allows as many as can be indexed
+     * every worker may hold up to SOL_LOCKFREE_POOL_MAGAZINE_CAPACITY tasks that are unused, this must be accounted for */
+    uint32_t task_segment_limit;
+    /** every worker may hold up to SOL_LOCKFREE_POOL_MAGAZINE_CAPACITY successors that are unused, this must be accounted for */
+    size_t total_successor_exponent;
+
+    /** placement is ignored if the system topology cannot be read */
+    enum sol_sync_task_worker_placement worker_placement;
+
+    /** when set workers are named with this followed by their index, note that names are truncated to 15 characters */
+    const char* worker_name_prefix;
+
+    /** when stealing, workers try every worker on the same NUMA node before trying workers on other nodes */
+    bool node_local_stealing;
+};
+
+/** counts of scheduling events for a worker, only gathered when `SOL_SYNC_TASK_STATISTICS` is defined (for every compilation unit)
+ * each worker only ever writes its own counters, so gathering them costs no more than an increment */
+struct sol_sync_task_statistics
+{
+    uint64_t tasks_executed;
+    /** tasks run directly after the task that made them ready (included in tasks executed) */
+    uint64_t continuations_executed;
+    /** tasks made ready that didn't fit in the workers deque and went to the shared queue instead */
+    uint64_t deque_overflows;
+    uint64_t pending_tasks_dequeued;
+    uint64_t steal_attempts;
+    uint64_t steals;
+    /** times every victim was tried without success but some steal lost a race, so stealing was tried again */
+    uint64_t steal_retries;
+    uint64_t stalls;
+    uint64_t range_splits;
+};
+
+struct sol_sync_task_worker
 {
-    struct sol_lockfree_pool task_pool;
+    struct sol_lockfree_deque ready_tasks[SOL_SYNC_TASK_PRIORITY_COUNT];
 
-    /// must be manged with the mutex
-    struct sol_task_queue pending_task_queue;
+    struct sol_sync_task_system* task_system;
 
+    thrd_t thread;
+    uint32_t index;
+
+    /** set up before the worker starts, then applied by the worker thread itself */
+    char name[16];
+    struct sol_cpu_mask affinity;
+    bool apply_affinity;
+
+    /** NUMA node of the processor(s) the worker is placed on, 0 if unknown */
+    uint32_t node;
+
+    /** used to select a worker to steal from */
+    uint32_t steal_rng_state;
+
+    uint32_t starvation_guard_counter;
+
+    /** only accessed by the worker thread itself, successors attached from within tasks are allocated from here */
+    struct sol_lockfree_pool_magazine successor_magazine;
+    /** only accessed by the worker thread itself, tasks prepared (and released) by this worker are allocated from (and returned to) here */
+    struct sol_lockfree_segmented_pool_magazine task_magazine;
+
+    /** only accessed by the worker thread itself, used to run a completed tasks successor immediately */
+    struct sol_sync_task* continuation_task;
+    enum sol_sync_task_priority continuation_priority_limit;
+    bool accepting_continuation;
+
+    struct sol_sync_task_statistics statistics;
+};
+
+struct sol_sync_task_system
+{
+    struct sol_lockfree_segmented_pool task_pool;
 
     struct sol_lockfree_pool successor_pool;///pool for storing successors (linked list/hopper per task)
 
-    thrd_t* worker_threads;/// make this system extensible (to a degree) should stalled threads want to be switched to a worker thread (can perhaps do this without relying on scheduler though)
+    struct sol_sync_task_worker* workers;/// make this system extensible (to a degree) should stalled threads want to be switched to a worker thread (can perhaps do this without relying on scheduler though)
     uint32_t worker_thread_count;
 
+    bool node_local_stealing;
+
+    /// tasks made ready outside of worker threads (or that overflow a workers deque) go here, must be manged with the mutex
+    struct sol_task_queue pending_task_queues[SOL_SYNC_TASK_PRIORITY_COUNT];
+    /// mirrors the counts of `pending_task_queues` so that workers can check them without taking the mutex, only altered with the mutex held
+    atomic_uint_fast32_t pending_task_counts[SOL_SYNC_TASK_PRIORITY_COUNT];
+
     cnd_t worker_thread_condition;/// multipurpose, used for setup, shutdown and for handling stalled threads
     mtx_t worker_thread_mutex;
 
-    uint32_t stalled_thread_count;
+    /// only altered with the mutex held, but read without it to determine whether a stalled worker needs to be woken
+    atomic_uint_fast32_t stalled_thread_count;
 
     bool shutdown_completed;
     bool shutdown_initiated;
@@ -61,6 +182,7 @@ struct sol_sync_task_system
 };
 
 void sol_sync_task_system_initialise(struct sol_sync_task_system* task_system, uint32_t worker_thread_count, size_t total_task_exponent, size_t total_successor_exponent);
+void sol_sync_task_system_initialise_from_description(struct sol_sync_task_system* task_system, const struct sol_sync_task_system_description* description);
 
 /// invalid to add tasks *that don't depend on other tasks* after this has been called
 /// this CAN be called inside a task!
@@ -74,6 +196,15 @@ void sol_sync_task_system_end_shutdown(struct sol_sync_task_system* task_system)
 /// cleans up allocations
 void sol_sync_task_system_terminate(struct sol_sync_task_system* task_system);
 
+/** following read/modify counters that workers update without synchronisation, so should only be called when the task system is idle or has been shut down (but not terminated)
+ * they do nothing (returning false) unless `SOL_SYNC_TASK_STATISTICS` is defined */
+
+/// `worker_statistics` may be NULL, otherwise it must have space for the statistics of every worker
+bool sol_sync_task_system_get_statistics(struct sol_sync_task_system* task_system, struct sol_sync_task_statistics* total_statistics, struct sol_sync_task_statistics* worker_statistics);
+/// writes the statistics of every worker and their total as JSON, intended for comparing runs of the same workload
+bool sol_sync_task_system_export_statistics_json(struct sol_sync_task_system* task_system, FILE* file);
+void sol_sync_task_system_reset_statistics(struct sol_sync_task_system* task_system);
+
 
 
 struct sol_sync_task_handle
@@ -82,7 +213,9 @@ struct sol_sync_task_handle
 };
 
 // task starts inert/unactivated and cannot run (so that order of execution relative to other primitives can be established) `sol_sync_task_activate` must be called for it to run
+// the task will have `SOL_SYNC_TASK_PRIORITY_NORMAL`
 struct sol_sync_task_handle sol_sync_task_prepare(struct sol_sync_task_system* task_system, void(*task_function)(void*), void* data);
+struct sol_sync_task_handle sol_sync_task_prepare_with_priority(struct sol_sync_task_system* task_system, void(*task_function)(void*), void* data, enum sol_sync_task_priority priority);
 
 /// allows a task to be executed
 /// must either add all associated dependencies/condition before calling this OR impose conditions and retain references the task as necessary to set up dependencies later
@@ -109,3 +242,13 @@ void sol_sync_task_release_references(struct sol_sync_task_handle task, uint_fas
 
 /** convenient typed dependency setup */
 void sol_sync_task_attach_successor(struct sol_sync_task_handle task, struct sol_sync_primitive* successor);
+
+
+
+/** a range task calls `range_function` over every index in [`range_begin`,`range_end`) using as many workers as are available
+ * `range_function` is called with sub-ranges of the form [begin,end) no larger than `grain_size` indices, in no particular order and possibly concurrently
+ * it is split between workers as they become idle, so costs (at most) a small multiple of the worker count of tasks, regardless of the size of the range
+ * the returned handle is a regular task handle: conditions, references and successors work exactly as they do for a task
+ * its successors will be signalled once `range_function` has been called for every index in the range */
+struct sol_sync_task_handle sol_sync_task_range_prepare(struct sol_sync_task_system* task_system, void(*range_function)(void* data, uint32_t begin, uint32_t end), void* data, uint32_t range_begin, uint32_t range_end, uint32_t grain_size);
+struct sol_sync_task_handle sol_sync_task_range_prepare_with_priority(struct sol_sync_task_system* task_system, void(*range_function)(void* data, uint32_t begin, uint32_t end), void* data, uint32_t range_begin, uint32_t range_end, uint32_t grain_size, enum sol_sync_task_priority priority);
@@ -0,0 +1,196 @@
+/**
+Copyright 2026 Carl van Mastrigt
+
+This file is part of solipsix.
+
+solipsix is free software: you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+solipsix is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with solipsix.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "sync/task_trace.h"
+
+#ifdef SOL_SYNC_TASK_TRACING
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <threads.h>
+#include <time.h>
+#include <assert.h>
+
+#define SOL_SYNC_TASK_TRACE_RING_CAPACITY ((uint_fast64_t)1 << SOL_SYNC_TASK_TRACE_RING_EXPONENT)
+
+struct sol_sync_task_trace_ring
+{
+    /** rings are only ever added to the front of the list (until reset) so this never changes once the ring is visible */
+    struct sol_sync_task_trace_ring* next;
+
+    uint32_t thread_index;
+    char name[16];
+
+    /** only written by the owning thread, release ordering makes the events before it visible to export */
+    atomic_uint_fast64_t write_count;
+
+    struct sol_sync_task_trace_event events[SOL_SYNC_TASK_TRACE_RING_CAPACITY];
+};
+
+static struct sol_sync_task_trace_ring* _Atomic sol_sync_task_trace_rings = NULL;
+static atomic_uint_fast32_t sol_sync_task_trace_thread_count = 0;
+/** incremented on reset so that threads know their ring was released */
+static atomic_uint_fast32_t sol_sync_task_trace_generation = 0;
+
+static thread_local struct sol_sync_task_trace_ring* sol_sync_task_trace_current_ring = NULL;
+static thread_local uint_fast32_t sol_sync_task_trace_current_generation = 0;
+
+static struct sol_sync_task_trace_ring* sol_sync_task_trace_get_ring(void)
+{
+    struct sol_sync_task_trace_ring* ring;
+    uint_fast32_t generation;
+
+    ring = sol_sync_task_trace_current_ring;
+    generation = atomic_load_explicit(&sol_sync_task_trace_generation, memory_order_relaxed);
+
+    if(ring && sol_sync_task_trace_current_generation == generation)
+    {
+        return ring;
+    }
+
+    /** first event recorded by this thread (since reset), this is the only time a thread touches shared state */
+    ring = malloc(sizeof(struct sol_sync_task_trace_ring));
+    ring->thread_index = (uint32_t)atomic_fetch_add_explicit(&sol_sync_task_trace_thread_count, 1, memory_order_relaxed);
+    snprintf(ring->name, sizeof(ring->name), "thread %"PRIu32, ring->thread_index);
+    atomic_init(&ring->write_count, 0);
+
+    ring->next = atomic_load_explicit(&sol_sync_task_trace_rings, memory_order_relaxed);
+    while( ! atomic_compare_exchange_weak_explicit(&sol_sync_task_trace_rings, &ring->next, ring, memory_order_release, memory_order_relaxed));
+
+    sol_sync_task_trace_current_ring = ring;
+    sol_sync_task_trace_current_generation = generation;
+
+    return ring;
+}
+
+void sol_sync_task_trace_record(enum sol_sync_task_trace_event_type type, const void* task, uintptr_t function)
+{
+    struct sol_sync_task_trace_ring* ring;
+    struct sol_sync_task_trace_event* event;
+    struct timespec time;
+    uint_fast64_t index;
+
+    ring = sol_sync_task_trace_get_ring();
+
+    /** monotonic so that clock adjustments (e.g. NTP steps) cannot reorder events or produce negative durations */
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    index = atomic_load_explicit(&ring->write_count, memory_order_relaxed);
+    event = ring->events + (index & (SOL_SYNC_TASK_TRACE_RING_CAPACITY - 1));
+
+    event->timestamp = (uint64_t)time.tv_sec * 1000000000llu + (uint64_t)time.tv_nsec;
+    event->task = task;
+    event->function = function;
+    event->type = type;
+
+    atomic_store_explicit(&ring->write_count, index + 1, memory_order_release);
+}
+
+void sol_sync_task_trace_name_thread(const char* name)
+{
+    struct sol_sync_task_trace_ring* ring = sol_sync_task_trace_get_ring();
+
+    strncpy(ring->name, name, sizeof(ring->name) - 1);
+    ring->name[sizeof(ring->name) - 1] = '\0';
+}
+
+bool sol_sync_task_trace_export_chrome_json(FILE* file)
+{
+    struct sol_sync_task_trace_ring* ring;
+    struct sol_sync_task_trace_event* event;
+    uint_fast64_t index, end;
+    uint32_t tid;
+    double ts;
+
+    fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"sol_sync_task_system\"}}");
+
+    for(ring = atomic_load_explicit(&sol_sync_task_trace_rings, memory_order_acquire); ring; ring = ring->next)
+    {
+        tid = ring->thread_index;
+        fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%"PRIu32",\"args\":{\"name\":\"%s\"}}", tid, ring->name);
+
+        end = atomic_load_explicit(&ring->write_count, memory_order_acquire);
+        index = (end > SOL_SYNC_TASK_TRACE_RING_CAPACITY) ? end - SOL_SYNC_TASK_TRACE_RING_CAPACITY : 0;
+
+        for(; index < end; index++)
+        {
+            event = ring->events + (index & (SOL_SYNC_TASK_TRACE_RING_CAPACITY - 1));
+            /** chrome trace timestamps are in microseconds */
+            ts = (double)event->timestamp / 1000.0;
+
+            switch(event->type)
+            {
+            case SOL_SYNC_TASK_TRACE_EVENT_PREPARE:
+            case SOL_SYNC_TASK_TRACE_EVENT_ACTIVATE:
+                fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"task\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%"PRIu32",\"ts\":%.3f,\"args\":{\"task\":\"%p\",\"function\":\"%#"PRIxPTR"\"}}",
+                    event->type == SOL_SYNC_TASK_TRACE_EVENT_PREPARE ? "prepare" : "activate", tid, ts, event->task, event->function);
+                break;
+
+            case SOL_SYNC_TASK_TRACE_EVENT_READY:
+                /** the flow from ready to start shows how long the task waited on a worker, and which worker took it */
+                fprintf(file, ",\n{\"name\":\"ready\",\"cat\":\"task\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%"PRIu32",\"ts\":%.3f,\"args\":{\"task\":\"%p\"}}", tid, ts, event->task);
+                fprintf(file, ",\n{\"name\":\"wait\",\"cat\":\"task\",\"ph\":\"s\",\"id\":\"%p\",\"pid\":1,\"tid\":%"PRIu32",\"ts\":%.3f}", event->task, tid, ts);
+                break;
+
+            case SOL_SYNC_TASK_TRACE_EVENT_START:
+                fprintf(file, ",\n{\"name\":\"wait\",\"cat\":\"task\",\"ph\":\"f\",\"bp\":\"e\",\"id\":\"%p\",\"pid\":1,\"tid\":%"PRIu32",\"ts\":%.3f}", event->task, tid, ts);
+                fprintf(file, ",\n{\"name\":\"%#"PRIxPTR"\",\"cat\":\"task\",\"ph\":\"B\",\"pid\":1,\"tid\":%"PRIu32",\"ts\":%.3f,\"args\":{\"task\":\"%p\"}}", event->function, tid, ts, event->task);
+                break;
+
+            case SOL_SYNC_TASK_TRACE_EVENT_END:
+                fprintf(file, ",\n{\"cat\":\"task\",\"ph\":\"E\",\"pid\":1,\"tid\":%"PRIu32",\"ts\":%.3f}", tid, ts);
+                break;
+
+            case SOL_SYNC_TASK_TRACE_EVENT_STALL_BEGIN:
+                fprintf(file, ",\n{\"name\":\"stalled\",\"cat\":\"worker\",\"ph\":\"B\",\"pid\":1,\"tid\":%"PRIu32",\"ts\":%.3f}", tid, ts);
+                break;
+
+            case SOL_SYNC_TASK_TRACE_EVENT_STALL_END:
+                fprintf(file, ",\n{\"cat\":\"worker\",\"ph\":\"E\",\"pid\":1,\"tid\":%"PRIu32",\"ts\":%.3f}", tid, ts);
+                break;
+            }
+        }
+    }
+
+    fprintf(file, "\n]}\n");
+
+    return ferror(file) == 0;
+}
+
+void sol_sync_task_trace_reset(void)
+{
+    struct sol_sync_task_trace_ring* ring;
+    struct sol_sync_task_trace_ring* next;
+
+    ring = atomic_exchange_explicit(&sol_sync_task_trace_rings, NULL, memory_order_acquire);
+
+    while(ring)
+    {
+        next = ring->next;
+        free(ring);
+        ring = next;
+    }
+
+    atomic_store_explicit(&sol_sync_task_trace_thread_count, 0, memory_order_relaxed);
+    atomic_fetch_add_explicit(&sol_sync_task_trace_generation, 1, memory_order_relaxed);
+}
+
+#endif
@@ -0,0 +1,84 @@
+/**
+Copyright 2026 Carl van Mastrigt
+
+This file is part of solipsix.
+
+solipsix is free software: you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+solipsix is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with solipsix.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+/** task system tracing, only compiled in when `SOL_SYNC_TASK_TRACING` is defined (for every compilation unit)
+ * every thread that records an event gets its own ring buffer, recording an event only touches that threads buffer so never takes a lock
+ * once a threads buffer is full the oldest events are overwritten */
+
+#ifndef SOL_SYNC_TASK_TRACE_RING_EXPONENT
+#define SOL_SYNC_TASK_TRACE_RING_EXPONENT 16
+#endif
+
+enum sol_sync_task_trace_event_type
+{
+    SOL_SYNC_TASK_TRACE_EVENT_PREPARE,
+    SOL_SYNC_TASK_TRACE_EVENT_ACTIVATE,
+    SOL_SYNC_TASK_TRACE_EVENT_READY,/** all conditions have been signalled, task is waiting on a worker */
+    SOL_SYNC_TASK_TRACE_EVENT_START,
+    SOL_SYNC_TASK_TRACE_EVENT_END,
+    SOL_SYNC_TASK_TRACE_EVENT_STALL_BEGIN,/** worker found nothing to do and is waiting to be woken */
+    SOL_SYNC_TASK_TRACE_EVENT_STALL_END,
+};
+
+struct sol_sync_task_trace_event
+{
+    uint64_t timestamp;/** nanoseconds */
+    const void* task;
+    uintptr_t function;
+    enum sol_sync_task_trace_event_type type;
+};
+
+#ifdef SOL_SYNC_TASK_TRACING
+
+void sol_sync_task_trace_record(enum sol_sync_task_trace_event_type type, const void* task, uintptr_t function);
+
+/** label the calling threads events, intended for workers but usable by any thread that interacts with tasks */
+void sol_sync_task_trace_name_thread(const char* name);
+
+/** writes all recorded events in the chrome trace event format (JSON), which can be opened by chrome://tracing or perfetto
+ * events being recorded while this is called may be missed or appear partially written, so should only be called when the task system is idle */
+bool sol_sync_task_trace_export_chrome_json(FILE* file);
+
+/** discard all recorded events and release buffers, must not be called while any thread may be recording events */
+void sol_sync_task_trace_reset(void);
+
+#define SOL_SYNC_TASK_TRACE(TYPE, TASK, FUNCTION) sol_sync_task_trace_record(TYPE, TASK, (uintptr_t)(FUNCTION))
+#define SOL_SYNC_TASK_TRACE_NAME_THREAD(NAME) sol_sync_task_trace_name_thread(NAME)
+
+#else
+
+static inline bool sol_sync_task_trace_export_chrome_json(FILE* file)
+{
+    (void)file;
+    return false;
+}
+static inline void sol_sync_task_trace_reset(void)
+{
+}
+
+#define SOL_SYNC_TASK_TRACE(TYPE, TASK, FUNCTION)
+#define SOL_SYNC_TASK_TRACE_NAME_THREAD(NAME)
+
+#endif
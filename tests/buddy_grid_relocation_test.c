@@ -0,0 +1,306 @@
+/**
+Copyright 2026 Carl van Mastrigt
+
+This file is part of solipsix.
+
+solipsix is free software: you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+solipsix is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with solipsix.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/** checks `sol_buddy_grid_plan_relocations` on a grid fragmented by random acquires and releases, needs nothing but the CPU
+ *
+ * usage: buddy_grid_relocation_test [seed (default: 1)]
+ *
+ * build from the directory containing solipsix, e.g.:
+ *     cc -std=gnu17 -O2 -Isolipsix -I. solipsix/tests/buddy_grid_relocation_test.c solipsix/data_structures/buddy_grid.c -o buddy_grid_relocation_test
+ *
+ * every round plans relocations for every acquired region, with a varying budget, then checks that:
+ *     the area of the planned moves does not exceed the budget
+ *     every destination is placed before its source (in the z-order the grid prefers)
+ *     no two acquired regions overlap, including the destinations and the (still acquired) sources
+ * the sources are then released and the destinations take their place, as the image atlas does once the copies are recorded
+ * returns EXIT_FAILURE (after describing the first problem) if any check fails */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "data_structures/buddy_grid.h"
+
+
+#define SOL_BUDDY_GRID_RELOCATION_TEST_X_EXPONENT 8
+#define SOL_BUDDY_GRID_RELOCATION_TEST_Y_EXPONENT 8
+#define SOL_BUDDY_GRID_RELOCATION_TEST_LAYERS 2
+#define SOL_BUDDY_GRID_RELOCATION_TEST_ROUNDS 256
+/** acquires/releases between rounds, enough to fragment the grid again */
+#define SOL_BUDDY_GRID_RELOCATION_TEST_CHURN 512
+#define SOL_BUDDY_GRID_RELOCATION_TEST_MAX_REGIONS 65536
+
+#define SOL_BUDDY_GRID_RELOCATION_TEST_LAYER_AREA (1u << (SOL_BUDDY_GRID_RELOCATION_TEST_X_EXPONENT + SOL_BUDDY_GRID_RELOCATION_TEST_Y_EXPONENT))
+
+
+/** every acquired index, in no particular order */
+static uint32_t sol_buddy_grid_relocation_test_indices[SOL_BUDDY_GRID_RELOCATION_TEST_MAX_REGIONS];
+static uint32_t sol_buddy_grid_relocation_test_index_count;
+
+static struct sol_buddy_grid_relocation sol_buddy_grid_relocation_test_relocations[SOL_BUDDY_GRID_RELOCATION_TEST_MAX_REGIONS];
+
+/** index occupying each grid unit (0 for none, index 0 is never vended) */
+static uint32_t sol_buddy_grid_relocation_test_occupancy[SOL_BUDDY_GRID_RELOCATION_TEST_LAYERS * SOL_BUDDY_GRID_RELOCATION_TEST_LAYER_AREA];
+
+static uint64_t sol_buddy_grid_relocation_test_random_state;
+
+static inline uint32_t sol_buddy_grid_relocation_test_random(void)
+{
+    sol_buddy_grid_relocation_test_random_state ^= sol_buddy_grid_relocation_test_random_state << 13;
+    sol_buddy_grid_relocation_test_random_state ^= sol_buddy_grid_relocation_test_random_state >> 7;
+    sol_buddy_grid_relocation_test_random_state ^= sol_buddy_grid_relocation_test_random_state << 17;
+    return (uint32_t)(sol_buddy_grid_relocation_test_random_state >> 32);
+}
+
+/** same ordering as the grids packed location: layer, then x and y bits interleaved (x in the lower bit of each pair) */
+static uint32_t sol_buddy_grid_relocation_test_z_order(struct sol_buddy_grid_location location)
+{
+    uint32_t order, bit;
+
+    order = 0;
+    for(bit = 0; bit < 12; bit++)
+    {
+        order |= ((location.xy_offset.x >> bit) & 1u) << (bit * 2);
+        order |= ((location.xy_offset.y >> bit) & 1u) << (bit * 2 + 1);
+    }
+
+    return order | ((uint32_t)location.array_layer << 24);
+}
+
+static uint32_t sol_buddy_grid_relocation_test_area(struct sol_buddy_grid* grid, uint32_t index)
+{
+    const u16_vec2 size = sol_buddy_grid_get_size(grid, index);
+    return (uint32_t)size.x * (uint32_t)size.y;
+}
+
+/** marks every grid unit covered by `index`, returns false (having described the problem) if any was already covered */
+static bool sol_buddy_grid_relocation_test_occupy(struct sol_buddy_grid* grid, uint32_t index)
+{
+    const struct sol_buddy_grid_location location = sol_buddy_grid_get_location(grid, index);
+    const u16_vec2 size = sol_buddy_grid_get_size(grid, index);
+    uint32_t x, y, unit;
+
+    if(location.array_layer >= SOL_BUDDY_GRID_RELOCATION_TEST_LAYERS
+    || location.xy_offset.x + size.x > (1u << SOL_BUDDY_GRID_RELOCATION_TEST_X_EXPONENT)
+    || location.xy_offset.y + size.y > (1u << SOL_BUDDY_GRID_RELOCATION_TEST_Y_EXPONENT))
+    {
+        fprintf(stderr, "index %u (%u,%u layer %u, size %ux%u) is outside the grid\n", index, location.xy_offset.x, location.xy_offset.y, location.array_layer, size.x, size.y);
+        return false;
+    }
+
+    for(y = location.xy_offset.y; y < location.xy_offset.y + size.y; y++)
+    {
+        for(x = location.xy_offset.x; x < location.xy_offset.x + size.x; x++)
+        {
+            unit = location.array_layer * SOL_BUDDY_GRID_RELOCATION_TEST_LAYER_AREA + (y << SOL_BUDDY_GRID_RELOCATION_TEST_X_EXPONENT) + x;
+
+            if(sol_buddy_grid_relocation_test_occupancy[unit])
+            {
+                fprintf(stderr, "index %u overlaps index %u at (%u,%u) layer %u\n", index, sol_buddy_grid_relocation_test_occupancy[unit], x, y, location.array_layer);
+                return false;
+            }
+            sol_buddy_grid_relocation_test_occupancy[unit] = index;
+        }
+    }
+
+    return true;
+}
+
+static void sol_buddy_grid_relocation_test_churn(struct sol_buddy_grid* grid)
+{
+    uint32_t i, position, index;
+    u16_vec2 size;
+
+    for(i = 0; i < SOL_BUDDY_GRID_RELOCATION_TEST_CHURN; i++)
+    {
+        if(sol_buddy_grid_relocation_test_index_count && (sol_buddy_grid_relocation_test_random() & 1))
+        {
+            position = sol_buddy_grid_relocation_test_random() % sol_buddy_grid_relocation_test_index_count;
+            sol_buddy_grid_release(grid, sol_buddy_grid_relocation_test_indices[position]);
+            sol_buddy_grid_relocation_test_indices[position] = sol_buddy_grid_relocation_test_indices[--sol_buddy_grid_relocation_test_index_count];
+        }
+        else if(sol_buddy_grid_relocation_test_index_count < SOL_BUDDY_GRID_RELOCATION_TEST_MAX_REGIONS)
+        {
+            /** mostly small regions with the occasional large one, like glyphs and images in the overlay atlases */
+            size.x = (uint16_t)(1u + sol_buddy_grid_relocation_test_random() % ((sol_buddy_grid_relocation_test_random() & 15) ? 8u : 64u));
+            size.y = (uint16_t)(1u + sol_buddy_grid_relocation_test_random() % ((sol_buddy_grid_relocation_test_random() & 15) ? 8u : 64u));
+
+            if(sol_buddy_grid_acquire(grid, size, &index))
+            {
+                sol_buddy_grid_relocation_test_indices[sol_buddy_grid_relocation_test_index_count++] = index;
+            }
+        }
+    }
+}
+
+/** checks the first `relocation_count` entries of the planned relocations, returns false (having described the first problem) if any check fails */
+static bool sol_buddy_grid_relocation_test_check_plan(struct sol_buddy_grid* grid, uint32_t round, uint32_t relocation_count, uint32_t area_budget, uint32_t* planned_area)
+{
+    const struct sol_buddy_grid_relocation* relocation;
+    uint32_t i;
+
+    *planned_area = 0;
+
+    if(relocation_count > sol_buddy_grid_relocation_test_index_count)
+    {
+        fprintf(stderr, "round %u: planned %u relocations for %u candidates\n", round, relocation_count, sol_buddy_grid_relocation_test_index_count);
+        return false;
+    }
+
+    for(i = 0; i < relocation_count; i++)
+    {
+        relocation = sol_buddy_grid_relocation_test_relocations + i;
+
+        *planned_area += sol_buddy_grid_relocation_test_area(grid, relocation->source_index);
+
+        if(sol_buddy_grid_relocation_test_indices[relocation->reference] != relocation->source_index)
+        {
+            fprintf(stderr, "round %u: relocation of index %u has the wrong reference\n", round, relocation->source_index);
+            return false;
+        }
+
+        if(sol_buddy_grid_relocation_test_area(grid, relocation->destination_index) != sol_buddy_grid_relocation_test_area(grid, relocation->source_index))
+        {
+            fprintf(stderr, "round %u: destination %u is not the same size as source %u\n", round, relocation->destination_index, relocation->source_index);
+            return false;
+        }
+
+        if(sol_buddy_grid_relocation_test_z_order(sol_buddy_grid_get_location(grid, relocation->destination_index)) >= sol_buddy_grid_relocation_test_z_order(sol_buddy_grid_get_location(grid, relocation->source_index)))
+        {
+            fprintf(stderr, "round %u: destination %u is not placed before source %u\n", round, relocation->destination_index, relocation->source_index);
+            return false;
+        }
+    }
+
+    if(*planned_area > area_budget)
+    {
+        fprintf(stderr, "round %u: planned moves cover %u units, more than the budget of %u\n", round, *planned_area, area_budget);
+        return false;
+    }
+
+    /** sources and destinations are all acquired at this point, none may overlap */
+    memset(sol_buddy_grid_relocation_test_occupancy, 0x00, sizeof(sol_buddy_grid_relocation_test_occupancy));
+
+    for(i = 0; i < sol_buddy_grid_relocation_test_index_count; i++)
+    {
+        if( ! sol_buddy_grid_relocation_test_occupy(grid, sol_buddy_grid_relocation_test_indices[i]))
+        {
+            return false;
+        }
+    }
+    for(i = 0; i < relocation_count; i++)
+    {
+        if( ! sol_buddy_grid_relocation_test_occupy(grid, sol_buddy_grid_relocation_test_relocations[i].destination_index))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool sol_buddy_grid_relocation_test_round(struct sol_buddy_grid* grid, uint32_t round, uint64_t* moved_area)
+{
+    const struct sol_buddy_grid_relocation* relocation;
+    uint32_t area_budget, planned_area, relocation_count, i;
+    bool success;
+
+    for(i = 0; i < sol_buddy_grid_relocation_test_index_count; i++)
+    {
+        sol_buddy_grid_relocation_test_relocations[i] = (struct sol_buddy_grid_relocation)
+        {
+            .source_index = sol_buddy_grid_relocation_test_indices[i],
+            .destination_index = 0,
+            .reference = i,
+        };
+    }
+
+    /** budgets from nothing, through smaller than most regions, to enough to move everything */
+    area_budget = (round % 4 == 3) ? UINT32_MAX : (sol_buddy_grid_relocation_test_random() % (1u << (round % 16)));
+
+    relocation_count = sol_buddy_grid_plan_relocations(grid, sol_buddy_grid_relocation_test_relocations, sol_buddy_grid_relocation_test_index_count, area_budget);
+
+    success = sol_buddy_grid_relocation_test_check_plan(grid, round, relocation_count, area_budget, &planned_area);
+
+    for(i = 0; i < relocation_count && i < sol_buddy_grid_relocation_test_index_count; i++)
+    {
+        relocation = sol_buddy_grid_relocation_test_relocations + i;
+
+        if(success)
+        {
+            /** complete the move */
+            sol_buddy_grid_release(grid, relocation->source_index);
+            sol_buddy_grid_relocation_test_indices[relocation->reference] = relocation->destination_index;
+        }
+        else
+        {
+            /** abandon the move so the grid can still be cleaned up */
+            sol_buddy_grid_release(grid, relocation->destination_index);
+        }
+    }
+
+    *moved_area += planned_area;
+
+    return success;
+}
+
+int main(int argc, char** argv)
+{
+    const struct sol_buddy_grid_description description =
+    {
+        .image_x_dimension_exponent = SOL_BUDDY_GRID_RELOCATION_TEST_X_EXPONENT,
+        .image_y_dimension_exponent = SOL_BUDDY_GRID_RELOCATION_TEST_Y_EXPONENT,
+        .image_array_dimension = SOL_BUDDY_GRID_RELOCATION_TEST_LAYERS,
+    };
+    struct sol_buddy_grid* grid;
+    uint64_t moved_area;
+    uint32_t round, i;
+    bool success;
+
+    sol_buddy_grid_relocation_test_random_state = (argc > 1) ? strtoull(argv[1], NULL, 10) : 1;
+    if(sol_buddy_grid_relocation_test_random_state == 0)
+    {
+        sol_buddy_grid_relocation_test_random_state = 1;
+    }
+
+    grid = sol_buddy_grid_create(description);
+    sol_buddy_grid_relocation_test_index_count = 0;
+    moved_area = 0;
+    success = true;
+
+    for(round = 0; round < SOL_BUDDY_GRID_RELOCATION_TEST_ROUNDS && success; round++)
+    {
+        sol_buddy_grid_relocation_test_churn(grid);
+        success = sol_buddy_grid_relocation_test_round(grid, round, &moved_area);
+    }
+
+    for(i = 0; i < sol_buddy_grid_relocation_test_index_count; i++)
+    {
+        sol_buddy_grid_release(grid, sol_buddy_grid_relocation_test_indices[i]);
+    }
+    sol_buddy_grid_destroy(grid);
+
+    if( ! success)
+    {
+        return EXIT_FAILURE;
+    }
+
+    printf("buddy grid relocation test passed: %u rounds, %"PRIu64" grid units moved\n", SOL_BUDDY_GRID_RELOCATION_TEST_ROUNDS, moved_area);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,247 @@
+/**
+Copyright 2026 Carl van Mastrigt
+
+This file is part of solipsix.
+
+solipsix is free software: you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+solipsix is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with solipsix.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/** checks `sol_tlsf` under random acquires and releases
+ *
+ * usage: tlsf_test [seed (default: 1)]
+ *
+ * build from the directory containing solipsix, e.g.:
+ *     cc -std=gnu17 -O2 -Isolipsix -I. solipsix/tests/tlsf_test.c solipsix/data_structures/tlsf.c -o tlsf_test
+ *
+ * every acquire checks that:
+ *     `sol_tlsf_has_space` agrees with whether the acquire succeeded
+ *     the acquired block is exactly the size requested and lies within the managed range
+ *     no two acquired blocks overlap (every unit is painted with the index that covers it)
+ * every round also releases everything and checks the tlsf is empty and can then vend its whole range as a single block
+ * returns EXIT_FAILURE (after describing the first problem) if any check fails */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "sol_utils.h"
+#include "data_structures/tlsf.h"
+
+
+#define SOL_TLSF_TEST_SIZE 65536
+#define SOL_TLSF_TEST_ROUNDS 64
+/** acquires/releases per round, enough to fill and fragment the range many times */
+#define SOL_TLSF_TEST_CHURN 16384
+#define SOL_TLSF_TEST_MAX_BLOCKS SOL_TLSF_TEST_SIZE
+
+
+/** every acquired index, in no particular order */
+static uint32_t sol_tlsf_test_indices[SOL_TLSF_TEST_MAX_BLOCKS];
+static uint32_t sol_tlsf_test_index_count;
+
+/** index occupying each unit plus one (0 for none, index 0 may be vended) */
+static uint32_t sol_tlsf_test_occupancy[SOL_TLSF_TEST_SIZE];
+
+static uint64_t sol_tlsf_test_random_state;
+
+static inline uint32_t sol_tlsf_test_random(void)
+{
+    sol_tlsf_test_random_state ^= sol_tlsf_test_random_state << 13;
+    sol_tlsf_test_random_state ^= sol_tlsf_test_random_state >> 7;
+    sol_tlsf_test_random_state ^= sol_tlsf_test_random_state << 17;
+    return (uint32_t)(sol_tlsf_test_random_state >> 32);
+}
+
+/** paints (or with `index` SOL_U32_INVALID clears) every unit covered by the acquired `block`, returns false (having described the problem) if a unit isn't in the expected state */
+static bool sol_tlsf_test_paint(struct sol_tlsf* tlsf, uint32_t block, uint32_t index)
+{
+    const uint32_t offset = sol_tlsf_get_offset(tlsf, block);
+    const uint32_t size = sol_tlsf_get_size(tlsf, block);
+    const uint32_t expected = (index == SOL_U32_INVALID) ? block + 1 : 0;
+    uint32_t unit;
+
+    if(size == 0 || offset >= SOL_TLSF_TEST_SIZE || size > SOL_TLSF_TEST_SIZE - offset)
+    {
+        fprintf(stderr, "index %u (offset %u, size %u) is outside the managed range\n", block, offset, size);
+        return false;
+    }
+
+    for(unit = offset; unit < offset + size; unit++)
+    {
+        if(sol_tlsf_test_occupancy[unit] != expected)
+        {
+            if(expected)
+            {
+                fprintf(stderr, "index %u (offset %u, size %u) lost unit %u to index %u\n", block, offset, size, unit, sol_tlsf_test_occupancy[unit] - 1);
+            }
+            else
+            {
+                fprintf(stderr, "index %u (offset %u, size %u) overlaps index %u at unit %u\n", block, offset, size, sol_tlsf_test_occupancy[unit] - 1, unit);
+            }
+            return false;
+        }
+        sol_tlsf_test_occupancy[unit] = (index == SOL_U32_INVALID) ? 0 : index + 1;
+    }
+
+    return true;
+}
+
+static bool sol_tlsf_test_acquire(struct sol_tlsf* tlsf, uint32_t round, uint32_t size)
+{
+    uint32_t index;
+    bool has_space, acquired;
+
+    has_space = sol_tlsf_has_space(tlsf, size);
+    acquired = sol_tlsf_acquire(tlsf, size, &index);
+
+    if(has_space != acquired)
+    {
+        fprintf(stderr, "round %u: has space (%s) disagrees with acquire (%s) for size %u\n", round, has_space ? "true" : "false", acquired ? "succeeded" : "failed", size);
+        if(acquired)
+        {
+            sol_tlsf_release(tlsf, index);
+        }
+        return false;
+    }
+
+    if( ! acquired)
+    {
+        return true;
+    }
+
+    if(sol_tlsf_get_size(tlsf, index) != size)
+    {
+        fprintf(stderr, "round %u: acquired size %u for a request of %u\n", round, sol_tlsf_get_size(tlsf, index), size);
+        sol_tlsf_release(tlsf, index);
+        return false;
+    }
+
+    if( ! sol_tlsf_test_paint(tlsf, index, index))
+    {
+        sol_tlsf_release(tlsf, index);
+        return false;
+    }
+
+    sol_tlsf_test_indices[sol_tlsf_test_index_count++] = index;
+    return true;
+}
+
+static bool sol_tlsf_test_release(struct sol_tlsf* tlsf, uint32_t position)
+{
+    const uint32_t index = sol_tlsf_test_indices[position];
+
+    sol_tlsf_test_indices[position] = sol_tlsf_test_indices[--sol_tlsf_test_index_count];
+
+    if( ! sol_tlsf_test_paint(tlsf, index, SOL_U32_INVALID))
+    {
+        sol_tlsf_release(tlsf, index);
+        return false;
+    }
+
+    sol_tlsf_release(tlsf, index);
+    return true;
+}
+
+static bool sol_tlsf_test_round(struct sol_tlsf* tlsf, uint32_t round)
+{
+    uint32_t i, size;
+
+    for(i = 0; i < SOL_TLSF_TEST_CHURN; i++)
+    {
+        /** biased towards acquiring so that the range fills and acquires start failing */
+        if(sol_tlsf_test_index_count && (sol_tlsf_test_random() % 8) < 3)
+        {
+            if( ! sol_tlsf_test_release(tlsf, sol_tlsf_test_random() % sol_tlsf_test_index_count))
+            {
+                return false;
+            }
+        }
+        else if(sol_tlsf_test_index_count < SOL_TLSF_TEST_MAX_BLOCKS)
+        {
+            /** mostly small blocks with the occasional large one, sizes are arbitrary (not bin boundaries) */
+            size = 1u + sol_tlsf_test_random() % ((sol_tlsf_test_random() & 31) ? 64u : 4096u);
+
+            if( ! sol_tlsf_test_acquire(tlsf, round, size))
+            {
+                return false;
+            }
+        }
+    }
+
+    while(sol_tlsf_test_index_count)
+    {
+        if( ! sol_tlsf_test_release(tlsf, sol_tlsf_test_random() % sol_tlsf_test_index_count))
+        {
+            return false;
+        }
+    }
+
+    if( ! sol_tlsf_is_empty(tlsf))
+    {
+        fprintf(stderr, "round %u: not empty after releasing everything\n", round);
+        return false;
+    }
+
+    /** released blocks must have coalesced back into one covering the whole range */
+    if( ! sol_tlsf_test_acquire(tlsf, round, SOL_TLSF_TEST_SIZE) || sol_tlsf_test_index_count != 1 || sol_tlsf_get_offset(tlsf, sol_tlsf_test_indices[0]) != 0)
+    {
+        fprintf(stderr, "round %u: could not acquire the whole range once empty\n", round);
+        return false;
+    }
+
+    if( ! sol_tlsf_test_acquire(tlsf, round, 1) || sol_tlsf_test_index_count != 1)
+    {
+        fprintf(stderr, "round %u: acquired from a full range\n", round);
+        return false;
+    }
+
+    return sol_tlsf_test_release(tlsf, 0);
+}
+
+int main(int argc, char** argv)
+{
+    struct sol_tlsf* tlsf;
+    uint32_t round, i;
+    bool success;
+
+    sol_tlsf_test_random_state = (argc > 1) ? strtoull(argv[1], NULL, 10) : 1;
+    if(sol_tlsf_test_random_state == 0)
+    {
+        sol_tlsf_test_random_state = 1;
+    }
+
+    tlsf = sol_tlsf_create(SOL_TLSF_TEST_SIZE);
+    sol_tlsf_test_index_count = 0;
+    memset(sol_tlsf_test_occupancy, 0x00, sizeof(sol_tlsf_test_occupancy));
+    success = true;
+
+    for(round = 0; round < SOL_TLSF_TEST_ROUNDS && success; round++)
+    {
+        success = sol_tlsf_test_round(tlsf, round);
+    }
+
+    for(i = 0; i < sol_tlsf_test_index_count; i++)
+    {
+        sol_tlsf_release(tlsf, sol_tlsf_test_indices[i]);
+    }
+    sol_tlsf_destroy(tlsf);
+
+    if( ! success)
+    {
+        return EXIT_FAILURE;
+    }
+
+    printf("tlsf test passed: %u rounds of %u acquires/releases\n", SOL_TLSF_TEST_ROUNDS, SOL_TLSF_TEST_CHURN);
+    return EXIT_SUCCESS;
+}
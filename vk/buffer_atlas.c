@@ -32,6 +32,7 @@ along with solipsix.  If not, see <https://www.gnu.org/licenses/>.
 #include "data_structures/indices_list.h"
 #include "data_structures/indices_stack.h"
 #include "data_structures/buddy_tree.h"
+#include "data_structures/tlsf.h"
 
 
 #define SOL_BUFFER_TABLE_RETAIN_BIT_COUNT 20
@@ -65,8 +66,8 @@ struct sol_vk_buffer_atlas_region
 
 	/** TODO: consider compressing this into 8 bytes */
 
-	/** location in memory (in buddy allocator units: sol_vk_buffer_atlas.base_allocation_size) */
-	uint32_t offset;
+	/** location in memory; for the buddy tree this is the offset (in units of sol_vk_buffer_atlas.base_allocation_size), for the tlsf it is the index of the block */
+	uint32_t allocation;
 
 	/** indexes of the adjacent entries in the available region linked list 
 	 * linked list is required for random removal upon re-activation of available regions */
@@ -99,7 +100,7 @@ struct sol_vk_buffer_atlas_region
 struct sol_vk_buffer_atlas_access_range
 {
 	struct sol_indices_stack retained_region_indices;
-	struct sol_indices_stack retained_transient_offsets;
+	struct sol_indices_stack retained_transient_allocations;
 	/** this access range */
 	struct sol_vk_timeline_semaphore_moment last_use_moment;
 	/** TODO: make above a sequence?? */
@@ -114,14 +115,14 @@ struct sol_vk_buffer_atlas_access_range
 static inline void sol_vk_buffer_atlas_access_range_initialise(struct sol_vk_buffer_atlas_access_range* access_range)
 {
 	sol_indices_stack_initialise(&access_range->retained_region_indices, 0);
-	sol_indices_stack_initialise(&access_range->retained_transient_offsets, 0);
+	sol_indices_stack_initialise(&access_range->retained_transient_allocations, 0);
 	access_range->last_use_moment = SOL_VK_TIMELINE_SEMAPHORE_MOMENT_NULL;
 }
 
 static inline void sol_vk_buffer_atlas_access_range_terminate(struct sol_vk_buffer_atlas_access_range* access_range)
 {
 	sol_indices_stack_terminate(&access_range->retained_region_indices);
-	sol_indices_stack_terminate(&access_range->retained_transient_offsets);
+	sol_indices_stack_terminate(&access_range->retained_transient_allocations);
 }
 
 
@@ -146,7 +147,10 @@ struct sol_vk_buffer_atlas
 	struct sol_vk_buffer backing;
 
 
+	enum sol_vk_buffer_atlas_allocator allocator;
+	bool buddy_tree_exact_allocation;
 	struct sol_buddy_tree region_tree;
+	struct sol_tlsf* region_tlsf;
 
 
 	struct sol_vk_buffer_atlas_region_map* region_map;
@@ -178,6 +182,63 @@ struct sol_vk_buffer_atlas
 
 
 
+static inline bool sol_vk_buffer_atlas_acquire_allocation(struct sol_vk_buffer_atlas* table, uint32_t unit_size, uint32_t* allocation)
+{
+	switch(table->allocator)
+	{
+		case SOL_VK_BUFFER_ATLAS_ALLOCATOR_BUDDY_TREE:
+			if(table->buddy_tree_exact_allocation)
+			{
+				return sol_buddy_tree_acquire_exact(&table->region_tree, unit_size, allocation);
+			}
+			return sol_buddy_tree_acquire(&table->region_tree, sol_u32_exp_ge(unit_size), allocation);
+		case SOL_VK_BUFFER_ATLAS_ALLOCATOR_TLSF: return sol_tlsf_acquire(table->region_tlsf, unit_size, allocation);
+		default: assert(false); return false;
+	}
+}
+
+static inline void sol_vk_buffer_atlas_release_allocation(struct sol_vk_buffer_atlas* table, uint32_t allocation)
+{
+	switch(table->allocator)
+	{
+		case SOL_VK_BUFFER_ATLAS_ALLOCATOR_BUDDY_TREE: sol_buddy_tree_release(&table->region_tree, allocation); break;
+		case SOL_VK_BUFFER_ATLAS_ALLOCATOR_TLSF: sol_tlsf_release(table->region_tlsf, allocation); break;
+		default: assert(false);
+	}
+}
+
+/** in base_allocation_size units */
+static inline uint32_t sol_vk_buffer_atlas_allocation_offset(struct sol_vk_buffer_atlas* table, uint32_t allocation)
+{
+	switch(table->allocator)
+	{
+		case SOL_VK_BUFFER_ATLAS_ALLOCATOR_BUDDY_TREE: return allocation;
+		case SOL_VK_BUFFER_ATLAS_ALLOCATOR_TLSF: return sol_tlsf_get_offset(table->region_tlsf, allocation);
+		default: assert(false); return 0;
+	}
+}
+
+/** in base_allocation_size units, the size an allocation of `unit_size` will actually have */
+static inline uint32_t sol_vk_buffer_atlas_allocated_unit_size(struct sol_vk_buffer_atlas* table, uint32_t unit_size)
+{
+	if(table->allocator == SOL_VK_BUFFER_ATLAS_ALLOCATOR_BUDDY_TREE && ! table->buddy_tree_exact_allocation)
+	{
+		return 1u << sol_u32_exp_ge(unit_size);
+	}
+	return unit_size;
+}
+
+/** in base_allocation_size units */
+static inline uint32_t sol_vk_buffer_atlas_allocation_size(struct sol_vk_buffer_atlas* table, uint32_t allocation)
+{
+	switch(table->allocator)
+	{
+		case SOL_VK_BUFFER_ATLAS_ALLOCATOR_BUDDY_TREE: return sol_buddy_tree_query_allocation_size(&table->region_tree, allocation);
+		case SOL_VK_BUFFER_ATLAS_ALLOCATOR_TLSF: return sol_tlsf_get_size(table->region_tlsf, allocation);
+		default: assert(false); return 0;
+	}
+}
+
 static inline bool sol_vk_buffer_atlas_identifier_entry_compare_equal(uint64_t key, uint32_t* entry_index, struct sol_vk_buffer_atlas* table)
 {
 	const struct sol_vk_buffer_atlas_region* region = sol_vk_buffer_atlas_region_array_access_entry(&table->region_array, *entry_index);
@@ -220,8 +281,8 @@ static inline bool sol_vk_buffer_atlas_evict_oldest_available_region(struct sol_
 	/** remove from the identifier hash map */
 	sol_vk_buffer_atlas_region_map_remove(table->region_map, evicted_region->identifier, NULL);
 
-	/** actually make the memory available in the buddy allocator */
-	sol_buddy_tree_release(&table->region_tree, evicted_region->offset);
+	/** actually make the memory available in the allocator */
+	sol_vk_buffer_atlas_release_allocation(table, evicted_region->allocation);
 
 	return true;
 }
@@ -233,7 +294,7 @@ static inline void sol_vk_buffer_atlas_release_access_range(struct sol_vk_buffer
 	struct sol_vk_buffer_atlas_region* region;
 	struct sol_vk_buffer_atlas_region* header_region;
 	struct sol_vk_buffer_atlas_region* newest_region;
-	uint32_t region_index, transient_offset;
+	uint32_t region_index, transient_allocation;
 
 	/** note: this also empties the stack */
 	while(sol_indices_stack_withdraw(&access_range.retained_region_indices, &region_index))
@@ -264,9 +325,9 @@ static inline void sol_vk_buffer_atlas_release_access_range(struct sol_vk_buffer
 		}
 	}
 
-	while(sol_indices_stack_withdraw(&access_range.retained_transient_offsets, &transient_offset))
+	while(sol_indices_stack_withdraw(&access_range.retained_transient_allocations, &transient_allocation))
 	{
-		sol_buddy_tree_release(&table->region_tree, transient_offset);
+		sol_vk_buffer_atlas_release_allocation(table, transient_allocation);
 	}
 
 	access_range.last_use_moment = SOL_VK_TIMELINE_SEMAPHORE_MOMENT_NULL;
@@ -320,7 +381,19 @@ struct sol_vk_buffer_atlas* sol_vk_buffer_atlas_create(struct cvm_vk_device* dev
 
 	sol_vk_buffer_initialise(&table->backing, device, &create_information->buffer_create_info, create_information->required_properties, create_information->desired_properties);
 
-	sol_buddy_tree_initialise(&table->region_tree, create_information->buffer_create_info.size / create_information->base_allocation_size);
+	table->allocator = create_information->allocator;
+	table->buddy_tree_exact_allocation = create_information->buddy_tree_exact_allocation;
+	switch(table->allocator)
+	{
+		case SOL_VK_BUFFER_ATLAS_ALLOCATOR_BUDDY_TREE:
+			sol_buddy_tree_initialise(&table->region_tree, create_information->buffer_create_info.size / create_information->base_allocation_size);
+			break;
+		case SOL_VK_BUFFER_ATLAS_ALLOCATOR_TLSF:
+			assert(create_information->buffer_create_info.size / create_information->base_allocation_size < ((VkDeviceSize)1 << 31));
+			table->region_tlsf = sol_tlsf_create((uint32_t)(create_information->buffer_create_info.size / create_information->base_allocation_size));
+			break;
+		default: assert(false);
+	}
 
 	const struct sol_hash_map_descriptor map_descriptor = 
 	{
@@ -402,7 +475,8 @@ void sol_vk_buffer_atlas_destroy(struct sol_vk_buffer_atlas* table, struct cvm_v
 	assert(table->active_accessor_count == 0);
 	assert(sol_vk_buffer_atlas_access_range_stack_is_empty(&table->in_flight_access_ranges));
 	assert(sol_vk_buffer_atlas_region_array_is_empty(&table->region_array));
-	assert(sol_buddy_tree_is_empty(&table->region_tree));
+	assert(table->allocator != SOL_VK_BUFFER_ATLAS_ALLOCATOR_BUDDY_TREE || sol_buddy_tree_is_empty(&table->region_tree));
+	assert(table->allocator != SOL_VK_BUFFER_ATLAS_ALLOCATOR_TLSF || sol_tlsf_is_empty(table->region_tlsf));
 
 	sol_vk_buffer_atlas_region_array_terminate(&table->region_array);
 
@@ -421,7 +495,12 @@ void sol_vk_buffer_atlas_destroy(struct sol_vk_buffer_atlas* table, struct cvm_v
 	free(table->accessors);
 
 	sol_vk_buffer_atlas_region_map_destroy(table->region_map);
-	sol_buddy_tree_terminate(&table->region_tree);
+	switch(table->allocator)
+	{
+		case SOL_VK_BUFFER_ATLAS_ALLOCATOR_BUDDY_TREE: sol_buddy_tree_terminate(&table->region_tree); break;
+		case SOL_VK_BUFFER_ATLAS_ALLOCATOR_TLSF: sol_tlsf_destroy(table->region_tlsf); break;
+		default: assert(false);
+	}
 	sol_vk_buffer_terminate(&table->backing, device);
 
 	if(table->multithreaded)
@@ -474,7 +553,7 @@ void sol_vk_buffer_atlas_access_range_begin(struct sol_vk_buffer_atlas* table, u
 	}
 
 	assert(sol_indices_stack_is_empty(&accessor->access_range.retained_region_indices));
-	assert(sol_indices_stack_is_empty(&accessor->access_range.retained_transient_offsets));
+	assert(sol_indices_stack_is_empty(&accessor->access_range.retained_transient_allocations));
 
 	/** associate this range with the intended slot */
 	accessor->access_range.accessor_slot = accessor_slot;
@@ -573,11 +652,11 @@ static inline enum sol_buffer_atlas_result sol_vk_buffer_atlas_region_retain(str
 		assert(region->retain_count < SOL_BUFFER_TABLE_MAX_RETAIN_COUNT);
 
 		region->retain_count++;
-		*entry_offset = table->base_allocation_size * region->offset;
+		*entry_offset = table->base_allocation_size * sol_vk_buffer_atlas_allocation_offset(table, region->allocation);
 
 		if(size)
 		{
-			*size = table->base_allocation_size << sol_buddy_tree_query_allocation_size_exponent(&table->region_tree, region->offset);
+			*size = table->base_allocation_size * sol_vk_buffer_atlas_allocation_size(table, region->allocation);
 		}
 
 		return SOL_BUFFER_TABLE_SUCCESS_FOUND;
@@ -622,13 +701,13 @@ enum sol_buffer_atlas_result sol_vk_buffer_atlas_find_identified_region(struct s
 	return result;
 }
 
-static inline enum sol_buffer_atlas_result sol_vk_buffer_atlas_allocate_identified_region(struct sol_vk_buffer_atlas* table, uint64_t region_identifier, uint32_t accessor_slot, uint32_t size_exponent, VkDeviceSize* entry_offset)
+static inline enum sol_buffer_atlas_result sol_vk_buffer_atlas_allocate_identified_region(struct sol_vk_buffer_atlas* table, uint64_t region_identifier, uint32_t accessor_slot, uint32_t unit_size, VkDeviceSize* entry_offset)
 {
 	uint32_t* region_index_ptr;
-	uint32_t buffer_offset;
+	uint32_t allocation;
 	enum sol_map_operation_result map_obtain_result;
 
-	while( ! sol_buddy_tree_acquire(&table->region_tree, size_exponent, &buffer_offset))
+	while( ! sol_vk_buffer_atlas_acquire_allocation(table, unit_size, &allocation))
 	{
 		if( ! sol_vk_buffer_atlas_evict_oldest_available_region(table))
 		{
@@ -644,9 +723,9 @@ static inline enum sol_buffer_atlas_result sol_vk_buffer_atlas_allocate_identifi
 		if( ! sol_vk_buffer_atlas_evict_oldest_available_region(table))
 		{
 			/** no more entries to free 
-			 * must return the acquired region to the buddy-tree before returning the correct error code
+			 * must return the acquired region to the allocator before returning the correct error code
 			 * NOTE: this is sufficiently rare that its not worth special pre-checking of availability */
-			sol_buddy_tree_release(&table->region_tree, buffer_offset);
+			sol_vk_buffer_atlas_release_allocation(table, allocation);
 			return SOL_BUFFER_TABLE_FAIL_MAP_FULL;
 		}
 	}
@@ -660,13 +739,13 @@ static inline enum sol_buffer_atlas_result sol_vk_buffer_atlas_allocate_identifi
 		/** not in available list so links are invalid */
 		.prev = SOL_BUFFER_TABLE_INVALID_INDEX,
 		.next = SOL_BUFFER_TABLE_INVALID_INDEX,
-		.offset = buffer_offset,
+		.allocation = allocation,
 		.retain_count = 1,/** this, the write access retains the allocation */
 		.write_accessor_slot = accessor_slot,
 		.visible_from_read_accessors = false,
 	};
 
-	*entry_offset = table->base_allocation_size * buffer_offset;
+	*entry_offset = table->base_allocation_size * sol_vk_buffer_atlas_allocation_offset(table, allocation);
 
 	/** add (the index of) the region to the retained list for the accessors active access range */
 	sol_indices_stack_append(&table->accessors[accessor_slot].access_range.retained_region_indices, *region_index_ptr);
@@ -681,8 +760,8 @@ enum sol_buffer_atlas_result sol_vk_buffer_atlas_obtain_identified_region(struct
 	uint32_t* region_index_ptr;
 	VkDeviceSize located_size;
 
-	/** when calculating size exponent need to round up base allocation sizes */
-	const uint32_t size_exponent = sol_u64_exp_ge((size + table->base_allocation_size - 1) / table->base_allocation_size);
+	/** need to round up to a whole number of base allocation sizes, the allocator may round this up further (see `sol_vk_buffer_atlas_allocated_unit_size`) */
+	const uint32_t unit_size = (uint32_t)((size + table->base_allocation_size - 1) / table->base_allocation_size);
 
 	assert(size > 0);
 	assert(entry_offset);
@@ -696,14 +775,14 @@ enum sol_buffer_atlas_result sol_vk_buffer_atlas_obtain_identified_region(struct
 	if(map_find_result == SOL_MAP_SUCCESS_FOUND)
 	{
 		result = sol_vk_buffer_atlas_region_retain(table, accessor_slot, *region_index_ptr, entry_offset, &located_size);
-		/** if already extant on disk, should have the appropraie size class for the requested size */
-		assert(located_size == table->base_allocation_size << size_exponent);
+		/** if already extant, should have been allocated with the same (rounded) size */
+		assert(located_size == table->base_allocation_size * sol_vk_buffer_atlas_allocated_unit_size(table, unit_size));
 	}
 	else
 	{
 		/** if not found the only valid alternative should be absent */
 		assert(map_find_result == SOL_MAP_FAIL_ABSENT);
-		result = sol_vk_buffer_atlas_allocate_identified_region(table, region_identifier, accessor_slot, size_exponent, entry_offset);
+		result = sol_vk_buffer_atlas_allocate_identified_region(table, region_identifier, accessor_slot, unit_size, entry_offset);
 	}
 
 	if(table->multithreaded)
@@ -714,11 +793,11 @@ enum sol_buffer_atlas_result sol_vk_buffer_atlas_obtain_identified_region(struct
 	return result;
 }
 
-static inline enum sol_buffer_atlas_result sol_vk_buffer_atlas_allocate_transient_region(struct sol_vk_buffer_atlas* table, uint32_t accessor_slot, uint32_t size_exponent, VkDeviceSize* entry_offset)
+static inline enum sol_buffer_atlas_result sol_vk_buffer_atlas_allocate_transient_region(struct sol_vk_buffer_atlas* table, uint32_t accessor_slot, uint32_t unit_size, VkDeviceSize* entry_offset)
 {
-	uint32_t buffer_offset;
+	uint32_t allocation;
 
-	while( ! sol_buddy_tree_acquire(&table->region_tree, size_exponent, &buffer_offset))
+	while( ! sol_vk_buffer_atlas_acquire_allocation(table, unit_size, &allocation))
 	{
 		if( ! sol_vk_buffer_atlas_evict_oldest_available_region(table))
 		{
@@ -727,10 +806,10 @@ static inline enum sol_buffer_atlas_result sol_vk_buffer_atlas_allocate_transien
 		}
 	}
 
-	*entry_offset = table->base_allocation_size * buffer_offset;
+	*entry_offset = table->base_allocation_size * sol_vk_buffer_atlas_allocation_offset(table, allocation);
 
 	/** add the newly created region (its index) to the retained list for this access range */
-	sol_indices_stack_append(&table->accessors[accessor_slot].access_range.retained_transient_offsets, buffer_offset);
+	sol_indices_stack_append(&table->accessors[accessor_slot].access_range.retained_transient_allocations, allocation);
 
 	return SOL_BUFFER_TABLE_SUCCESS_INSERTED;
 }
@@ -739,8 +818,8 @@ enum sol_buffer_atlas_result sol_vk_buffer_atlas_obtain_transient_region(struct
 {
 	enum sol_buffer_atlas_result result;
 
-	/** when calculating size exponent need to round up base allocation sizes */
-	const uint32_t size_exponent = sol_u64_exp_ge((size + table->base_allocation_size - 1) / table->base_allocation_size);
+	/** need to round up to a whole number of base allocation sizes, the allocator may round this up further (see `sol_vk_buffer_atlas_allocated_unit_size`) */
+	const uint32_t unit_size = (uint32_t)((size + table->base_allocation_size - 1) / table->base_allocation_size);
 
 	assert(size > 0);
 	assert(entry_offset);
@@ -750,7 +829,7 @@ enum sol_buffer_atlas_result sol_vk_buffer_atlas_obtain_transient_region(struct
 		mtx_lock(&table->mutex);
 	}
 
-	result = sol_vk_buffer_atlas_allocate_transient_region(table, accessor_slot, size_exponent, entry_offset);
+	result = sol_vk_buffer_atlas_allocate_transient_region(table, accessor_slot, unit_size, entry_offset);
 
 	if(table->multithreaded)
 	{
@@ -43,6 +43,16 @@ enum sol_buffer_atlas_result
 /** re-writable resources require only one user at a time, same as obtaining a non-extant entry */
 // #define SOL_BUFFER_TABLE_OBTAIN_FLAG_WRITE  0x00000001u
 
+/** how regions of the buffer are allocated */
+enum sol_vk_buffer_atlas_allocator
+{
+    /** power of 2 buddy tree; under sustained mixed size use fragments such that only ~75% of the buffer is usable (see `buddy_tree_exact_allocation`) */
+    SOL_VK_BUFFER_ATLAS_ALLOCATOR_BUDDY_TREE = 0,
+    /** two level segregated fit; O(1) acquire and release of arbitrary sizes, coalesces on release so keeps much more of the buffer usable under mixed size use
+     * the buffer must be less than 2^31 base allocations */
+    SOL_VK_BUFFER_ATLAS_ALLOCATOR_TLSF,
+};
+
 struct sol_vk_buffer_atlas_create_information
 {
     VkBufferCreateInfo buffer_create_info;
@@ -52,6 +62,13 @@ struct sol_vk_buffer_atlas_create_information
 
     VkDeviceSize base_allocation_size;
 
+    /** zero initialised (default) is the buddy tree */
+    enum sol_vk_buffer_atlas_allocator allocator;
+
+    /** only used by the buddy tree; allocate regions with exactly the number of base allocations required, making the slack up to the next power of 2 available to smaller regions
+     * this packs better while the buffer is filling, but under sustained eviction it gains little (slack use prevents coalescing) and costs ~1.5-2x per acquire/release */
+    bool buddy_tree_exact_allocation;
+
     /** slots should be externally referenced/managed, 
      * e.g. with an enum over uses: main render, compute, preload &c. 
      * only 255 available because we want to fit that data in (effectively) a u8 while having an invalid identifier */
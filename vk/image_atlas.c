@@ -21,7 +21,9 @@ along with solipsix.  If not, see <https://www.gnu.org/licenses/>.
 #include "cvm_vk.h"
 #include "vk/image_atlas.h"
 #include "vk/image.h"
+#include "vk/image_utils.h"
 #include "data_structures/buddy_grid.h"
+#include "data_structures/buddy_grid_trace.h"
 #include "data_structures/indices_stack.h"
 
 
@@ -31,15 +33,30 @@ along with solipsix.  If not, see <https://www.gnu.org/licenses/>.
 
 struct sol_image_atlas_entry
 {
-	/** hash map key; used for hash map lookup upon defragmentation eviction top bit of this can be used to indicate the resource is transient*/
+	/** hash map key; used for hash map lookup upon eviction top bit of this can be used to indicate the resource is transient
+	 * NOTE: the map references the entry index, which defragmentation does not change, so relocation only needs to alter `grid_tile_index` */
 	uint64_t identifier;
 
 	uint32_t grid_tile_index;
 
+	/** the access range this entry was last found or inserted in, if multithreaded a found entry is not moved in the queue until the range ends
+	 * and this is what protects it from eviction until then */
+	uint32_t access_range;
+
 	uint32_t prev;
 	uint32_t next;
 };
 
+/** owned by one thread for the duration of an access range, so can be written without holding the mutex */
+struct sol_image_atlas_thread_lists
+{
+	/** entries found in the current access range (only used if multithreaded), they're moved to the front of the queue when it ends */
+	struct sol_indices_stack touched_entries;
+
+	/** writes to obtained entries, merged and recorded by `sol_image_atlas_execute_copies` */
+	struct sol_vk_buf_img_copy_list copies;
+};
+
 /** may be possible to avoid an array in the regular fashion as grid tiles provide an "arrayable" index */
 #define SOL_ARRAY_ENTRY_TYPE struct sol_image_atlas_entry
 #define SOL_ARRAY_STRUCT_NAME sol_image_atlas_entry_array
@@ -95,6 +112,28 @@ struct sol_image_atlas
 	bool accessor_active;
 
 	bool most_recent_usage_moment_set;
+
+	/** only initialised/used if `description.multithreaded` is set, guards all entry, map and grid state (but not the thread lists) */
+	mtx_t mutex;
+
+	/** incremented when an access range begins, see `sol_image_atlas_entry.access_range` */
+	uint32_t access_range;
+
+	/** one per thread that may access the atlas concurrently, only one if not multithreaded */
+	struct sol_image_atlas_thread_lists* thread_lists;
+	uint32_t thread_count;
+
+	/** total area of grid tiles currently acquired, for telling a full grid apart from a fragmented one */
+	uint32_t acquired_grid_area;
+	uint32_t grid_area;
+
+	/** set when an acquire failed despite enough total area being free, only then is `sol_image_atlas_defragment` worth running */
+	bool fragmented;
+
+	/** scratch space for defragmentation, sized to the number of entries when last used */
+	struct sol_buddy_grid_relocation* relocations;
+	VkImageCopy* relocation_copies;
+	uint32_t relocation_space;
 };
 
 static inline bool sol_image_atlas_identifier_entry_compare_equal(uint64_t key, uint32_t* entry_index, struct sol_image_atlas* atlas)
@@ -110,6 +149,55 @@ static inline uint64_t sol_image_atlas_entry_identifier_get(const uint32_t* entr
 }
 
 
+static inline uint32_t sol_image_atlas_grid_area(u16_vec2 grid_size)
+{
+	return (uint32_t)grid_size.x * (uint32_t)grid_size.y;
+}
+
+/** the size the buddy grid would actually acquire for a request */
+static inline u16_vec2 sol_image_atlas_grid_size_po2(u16_vec2 grid_size)
+{
+	return u16_vec2_set(grid_size.x > 1 ? 1u << cvm_po2_32_gte(grid_size.x) : 1, grid_size.y > 1 ? 1u << cvm_po2_32_gte(grid_size.y) : 1);
+}
+
+/** all grid acquire/release should go through these so they can be recorded */
+static inline bool sol_image_atlas_grid_acquire(struct sol_image_atlas* atlas, u16_vec2 grid_size, uint32_t* grid_tile_index)
+{
+	bool acquired;
+
+	acquired = sol_buddy_grid_acquire(atlas->grid, grid_size, grid_tile_index);
+
+	if(acquired)
+	{
+		atlas->acquired_grid_area += sol_image_atlas_grid_area(sol_buddy_grid_get_size(atlas->grid, *grid_tile_index));
+	}
+	else if(atlas->description.defragment && atlas->grid_area - atlas->acquired_grid_area >= sol_image_atlas_grid_area(sol_image_atlas_grid_size_po2(grid_size)))
+	{
+		/** the space exists but is split up, evictions from here on are forced by fragmentation rather than by the atlas being full */
+		atlas->fragmented = true;
+	}
+
+	if(atlas->description.grid_trace)
+	{
+		sol_buddy_grid_trace_record_acquire(atlas->description.grid_trace, grid_size, acquired, acquired ? *grid_tile_index : SOL_U32_INVALID);
+	}
+
+	return acquired;
+}
+
+static inline void sol_image_atlas_grid_release(struct sol_image_atlas* atlas, uint32_t grid_tile_index)
+{
+	if(atlas->description.grid_trace)
+	{
+		sol_buddy_grid_trace_record_release(atlas->description.grid_trace, grid_tile_index);
+	}
+
+	atlas->acquired_grid_area -= sol_image_atlas_grid_area(sol_buddy_grid_get_size(atlas->grid, grid_tile_index));
+
+	sol_buddy_grid_release(atlas->grid, grid_tile_index);
+}
+
+
 
 
 
@@ -198,26 +286,59 @@ static inline void sol_image_atlas_entry_evict(struct sol_image_atlas* atlas, ui
 
 	sol_image_atlas_entry_remove_from_queue(atlas, entry);
 
-	sol_buddy_grid_release(atlas->grid, entry->grid_tile_index);
+	sol_image_atlas_grid_release(atlas, entry->grid_tile_index);
 }
 
 static inline bool sol_image_atlas_evict_oldest_available_region(struct sol_image_atlas* atlas)
 {
 	const struct sol_image_atlas_entry* header_entry = sol_image_atlas_entry_array_access_entry(&atlas->entry_array, SOL_IA_HEADER_ENTRY_INDEX);
+	struct sol_image_atlas_entry* entry;
+	uint32_t entry_index;
 
-	if(header_entry->next >= SOL_IA_ALLOCATION_ENTRY_INDEX_START)
+	while((entry_index = header_entry->next) >= SOL_IA_ALLOCATION_ENTRY_INDEX_START)
 	{
-		sol_image_atlas_entry_evict(atlas, header_entry->next);
+		entry = sol_image_atlas_entry_array_access_entry(&atlas->entry_array, entry_index);
+
+		if(atlas->accessor_active && entry->access_range == atlas->access_range)
+		{
+			/** found in this access range by a thread that has deferred moving it, it's in use so move it now (this one will be moved again when the range ends) */
+			sol_image_atlas_entry_remove_from_queue(atlas, entry);
+			sol_image_atlas_entry_add_to_queue_before(atlas, entry_index, SOL_IA_HEADER_ENTRY_INDEX);
+			continue;
+		}
+
+		sol_image_atlas_entry_evict(atlas, entry_index);
 		return true;
 	}
 
 	return false;
 }
 
+/** must be called inside the mutex lock if multithreaded, marks the entry as used in this access range
+ * returns true if moving the entry to the front of the queue has been deferred, in which case the caller must add it to its threads `touched_entries` */
+static inline bool sol_image_atlas_entry_touch(struct sol_image_atlas* atlas, uint32_t entry_index, struct sol_image_atlas_entry* entry)
+{
+	if( ! atlas->description.multithreaded)
+	{
+		sol_image_atlas_entry_remove_from_queue(atlas, entry);
+		sol_image_atlas_entry_add_to_queue_before(atlas, entry_index, SOL_IA_HEADER_ENTRY_INDEX);
+		return false;
+	}
+
+	/** only the first find in an access range needs to be recorded */
+	if(entry->access_range == atlas->access_range)
+	{
+		return false;
+	}
+
+	entry->access_range = atlas->access_range;
+	return true;
+}
+
 struct sol_image_atlas* sol_image_atlas_create(const struct sol_image_atlas_description* description, struct cvm_vk_device* device)
 {
 	VkResult result;
-	uint32_t entry_index;
+	uint32_t entry_index, i;
 
 	struct sol_image_atlas* atlas = malloc(sizeof(struct sol_image_atlas));
 
@@ -312,11 +433,35 @@ struct sol_image_atlas* sol_image_atlas_create(const struct sol_image_atlas_desc
 	atlas->current_identifier = 0;
 	atlas->accessor_active = false;
 
+	if(description->multithreaded)
+	{
+		mtx_init(&atlas->mutex, mtx_plain);
+	}
+
+	atlas->access_range = 0;
+
+	atlas->thread_count = description->multithreaded ? SOL_MAX(description->thread_count, 1) : 1;
+	atlas->thread_lists = malloc(sizeof(struct sol_image_atlas_thread_lists) * atlas->thread_count);
+	for(i = 0; i < atlas->thread_count; i++)
+	{
+		sol_indices_stack_initialise(&atlas->thread_lists[i].touched_entries, 0);
+		sol_vk_buf_img_copy_list_initialise(&atlas->thread_lists[i].copies, 64);
+	}
+
+	atlas->acquired_grid_area = 0;
+	atlas->grid_area = (1u << (description->image_x_dimension_exponent + description->image_y_dimension_exponent)) * description->image_array_dimension;
+	atlas->fragmented = false;
+
+	atlas->relocations = NULL;
+	atlas->relocation_copies = NULL;
+	atlas->relocation_space = 0;
+
 	/** indices zero and one are reserved, allocate them and make sure their indices are as expected */
 	*sol_image_atlas_entry_array_append_ptr(&atlas->entry_array, &entry_index) = (struct sol_image_atlas_entry)
 	{
 		.identifier = 0,
 		.grid_tile_index = SOL_U32_INVALID,
+		.access_range = 0,
 		.prev = SOL_IA_HEADER_ENTRY_INDEX,
 		.next = SOL_IA_HEADER_ENTRY_INDEX,
 	};
@@ -326,6 +471,7 @@ struct sol_image_atlas* sol_image_atlas_create(const struct sol_image_atlas_desc
 	{
 		.identifier = 0,
 		.grid_tile_index = SOL_U32_INVALID,
+		.access_range = 0,
 		.prev = SOL_U32_INVALID,
 		.next = SOL_U32_INVALID,
 	};
@@ -338,6 +484,7 @@ void sol_image_atlas_destroy(struct sol_image_atlas* atlas, struct cvm_vk_device
 {
 	struct sol_image_atlas_entry* header_entry;
 	struct sol_image_atlas_entry* threshold_entry;
+	uint32_t i;
 
 	/** must release current access before destroying */
 	assert(!atlas->accessor_active);
@@ -374,6 +521,21 @@ void sol_image_atlas_destroy(struct sol_image_atlas* atlas, struct cvm_vk_device
 
 	sol_buddy_grid_destroy(atlas->grid);
 
+	free(atlas->relocations);
+	free(atlas->relocation_copies);
+
+	for(i = 0; i < atlas->thread_count; i++)
+	{
+		sol_indices_stack_terminate(&atlas->thread_lists[i].touched_entries);
+		sol_vk_buf_img_copy_list_terminate(&atlas->thread_lists[i].copies);
+	}
+	free(atlas->thread_lists);
+
+	if(atlas->description.multithreaded)
+	{
+		mtx_destroy(&atlas->mutex);
+	}
+
 	vkDestroyImageView(device->device, atlas->image_view, device->host_allocator);
 	sol_vk_supervised_image_terminate(&atlas->image, device);
 
@@ -385,6 +547,7 @@ void sol_image_atlas_access_range_begin(struct sol_image_atlas* atlas)
 	assert(!atlas->accessor_active);
 	assert(sol_indices_stack_count(&atlas->transient_indices) == 0);
 	atlas->accessor_active = true;
+	atlas->access_range++;
 
 	/** place the threshold to the front of the queue */
 	sol_image_atlas_entry_add_to_queue_before(atlas, SOL_IA_THRESHOLD_ENTRY_INDEX, SOL_IA_HEADER_ENTRY_INDEX);
@@ -392,15 +555,35 @@ void sol_image_atlas_access_range_begin(struct sol_image_atlas* atlas)
 
 void sol_image_atlas_access_range_end(struct sol_image_atlas* atlas, const struct sol_vk_timeline_semaphore_moment* last_use_moment)
 {
+	struct sol_image_atlas_thread_lists* thread_lists;
 	struct sol_image_atlas_entry* threshold_entry;
-	uint32_t tranient_entry_grid_index;
+	struct sol_image_atlas_entry* entry;
+	uint32_t tranient_entry_grid_index, entry_index, i;
 
 	assert(atlas->accessor_active);
+
+	for(i = 0; i < atlas->thread_count; i++)
+	{
+		thread_lists = atlas->thread_lists + i;
+
+		/** perform the queue moves deferred by multithreaded finds, these entries were protected from eviction by being found so are still present */
+		while(sol_indices_stack_withdraw(&thread_lists->touched_entries, &entry_index))
+		{
+			entry = sol_image_atlas_entry_array_access_entry(&atlas->entry_array, entry_index);
+			assert(entry->access_range == atlas->access_range);
+			sol_image_atlas_entry_remove_from_queue(atlas, entry);
+			sol_image_atlas_entry_add_to_queue_before(atlas, entry_index, SOL_IA_HEADER_ENTRY_INDEX);
+		}
+
+		/** writes to entries obtained in this access range must have been recorded */
+		assert(sol_vk_buf_img_copy_list_count(&thread_lists->copies) == 0);
+	}
+
 	atlas->accessor_active = false;
 
 	while(sol_indices_stack_withdraw(&atlas->transient_indices, &tranient_entry_grid_index))
 	{
-		sol_buddy_grid_release(atlas->grid, tranient_entry_grid_index);
+		sol_image_atlas_grid_release(atlas, tranient_entry_grid_index);
 	}
 
 	/** remove the threshold entry as all entries from an access range become evictable (unprotected by the threshold entry) upon the end of the access range */
@@ -428,15 +611,29 @@ bool sol_image_atlas_access_range_is_active(struct sol_image_atlas* atlas)
 
 uint64_t sol_image_atlas_generate_entry_identifier(struct sol_image_atlas* atlas)
 {
+	uint64_t identifier;
+
+	if(atlas->description.multithreaded)
+	{
+		mtx_lock(&atlas->mutex);
+	}
+
 	/** 64 bit lcg copied from sol random */
 	atlas->current_identifier = atlas->current_identifier * 0x5851F42D4C957F2Dlu + 0x7A4111AC0FFEE60Dlu;
 
 	/** NOTE: top N bits may be cut off to reduce cycle length to 2^(64-n), every point an any 2^m cycle will be visited in the bottom m bits for a lcg */
+	identifier = atlas->current_identifier;
 
-	return atlas->current_identifier;
+	if(atlas->description.multithreaded)
+	{
+		mtx_unlock(&atlas->mutex);
+	}
+
+	return identifier;
 }
 
-enum sol_image_atlas_result sol_image_atlas_find_identified_entry(struct sol_image_atlas* atlas, uint64_t entry_identifier, struct sol_image_atlas_location* entry_location)
+/** must be called inside the mutex lock if multithreaded */
+static inline enum sol_image_atlas_result sol_image_atlas_locate_identified_entry(struct sol_image_atlas* atlas, uint64_t entry_identifier, struct sol_image_atlas_location* entry_location, uint32_t* touched_entry_index)
 {
 	struct sol_image_atlas_entry* entry;
 	enum sol_map_operation_result map_find_result;
@@ -456,8 +653,10 @@ enum sol_image_atlas_result sol_image_atlas_find_identified_entry(struct sol_ima
 
 		assert(entry->identifier == entry_identifier);
 
-		sol_image_atlas_entry_remove_from_queue(atlas, entry);
-		sol_image_atlas_entry_add_to_queue_before(atlas, entry_index, SOL_IA_HEADER_ENTRY_INDEX);
+		if(sol_image_atlas_entry_touch(atlas, entry_index, entry))
+		{
+			*touched_entry_index = entry_index;
+		}
 
 		location = sol_buddy_grid_get_location(atlas->grid, entry->grid_tile_index);
 
@@ -473,7 +672,8 @@ enum sol_image_atlas_result sol_image_atlas_find_identified_entry(struct sol_ima
 	}
 }
 
-enum sol_image_atlas_result sol_image_atlas_obtain_identified_entry(struct sol_image_atlas* atlas, uint64_t entry_identifier, u16_vec2 size, struct sol_image_atlas_location* entry_location)
+/** must be called inside the mutex lock if multithreaded */
+static inline enum sol_image_atlas_result sol_image_atlas_allocate_identified_entry(struct sol_image_atlas* atlas, uint64_t entry_identifier, u16_vec2 size, struct sol_image_atlas_location* entry_location, uint32_t* touched_entry_index)
 {
 	/** write access will never return found, only absent or inserted */
 	struct sol_image_atlas_entry_availability_heap* availability_heap;
@@ -503,11 +703,12 @@ enum sol_image_atlas_result sol_image_atlas_obtain_identified_entry(struct sol_i
 
 		assert(entry->identifier == entry_identifier);
 
-		sol_image_atlas_entry_remove_from_queue(atlas, entry);
-
 		/** put in entry queue sector of accessor,
 		 * found and NOT replaced (hot path) */
-		sol_image_atlas_entry_add_to_queue_before(atlas, entry_index, SOL_IA_HEADER_ENTRY_INDEX);
+		if(sol_image_atlas_entry_touch(atlas, entry_index, entry))
+		{
+			*touched_entry_index = entry_index;
+		}
 
 		location = sol_buddy_grid_get_location(atlas->grid, entry->grid_tile_index);
 		
@@ -524,7 +725,7 @@ enum sol_image_atlas_result sol_image_atlas_obtain_identified_entry(struct sol_i
 	grid_size.y = (size.y + atlas->description.grid_tile_size.y - 1) / atlas->description.grid_tile_size.y;
 
 
-	while( ! sol_buddy_grid_acquire(atlas->grid, grid_size, &grid_tile_index))
+	while( ! sol_image_atlas_grid_acquire(atlas, grid_size, &grid_tile_index))
 	{
 		/** no entry of requested size available, need to make space by freeing unused entries
 		 * NOTE: this invalidates the map result */
@@ -544,7 +745,7 @@ enum sol_image_atlas_result sol_image_atlas_obtain_identified_entry(struct sol_i
 			/** no more space can be made in order to accommodate the requested entry
 			 * must return the acquired entry to the available state before returning the correct error code
 			 * NOTE: this is sufficiently rare that its not worth special pre-checking of availability */
-			sol_buddy_grid_release(atlas->grid, grid_tile_index);
+			sol_image_atlas_grid_release(atlas, grid_tile_index);
 			return SOL_IMAGE_ATLAS_FAIL_MAP_FULL;
 		}
 	}
@@ -556,6 +757,8 @@ enum sol_image_atlas_result sol_image_atlas_obtain_identified_entry(struct sol_i
 
 	entry->identifier = entry_identifier;
 	entry->grid_tile_index = grid_tile_index;
+	/** inserted behind the threshold, so already protected from eviction */
+	entry->access_range = atlas->access_range;
 	entry->prev = SOL_U32_INVALID;
 	entry->next = SOL_U32_INVALID;
 
@@ -569,9 +772,9 @@ enum sol_image_atlas_result sol_image_atlas_obtain_identified_entry(struct sol_i
 	return SOL_IMAGE_ATLAS_SUCCESS_INSERTED;
 }
 
-enum sol_image_atlas_result sol_image_atlas_obtain_transient_entry(struct sol_image_atlas* atlas, u16_vec2 size, struct sol_image_atlas_location* entry_location)
+/** must be called inside the mutex lock if multithreaded */
+static inline enum sol_image_atlas_result sol_image_atlas_allocate_transient_entry(struct sol_image_atlas* atlas, u16_vec2 size, struct sol_image_atlas_location* entry_location)
 {
-	struct sol_image_atlas_entry* entry;
 	uint32_t grid_tile_index;
 	struct sol_buddy_grid_location location;
 	u16_vec2 grid_size;
@@ -585,11 +788,11 @@ enum sol_image_atlas_result sol_image_atlas_obtain_transient_entry(struct sol_im
 	grid_size.x = (size.x + atlas->description.grid_tile_size.x - 1) / atlas->description.grid_tile_size.x;
 	grid_size.y = (size.y + atlas->description.grid_tile_size.y - 1) / atlas->description.grid_tile_size.y;
 
-	if(sol_buddy_grid_acquire(atlas->grid, grid_size, &grid_tile_index))
+	if(sol_image_atlas_grid_acquire(atlas, grid_size, &grid_tile_index))
 	{
 		sol_indices_stack_append(&atlas->transient_indices, grid_tile_index);
 
-		location = sol_buddy_grid_get_location(atlas->grid, entry->grid_tile_index);
+		location = sol_buddy_grid_get_location(atlas->grid, grid_tile_index);
 
 		entry_location->array_layer = location.array_layer;
 		entry_location->offset = u16_vec2_mul(location.xy_offset, atlas->description.grid_tile_size);
@@ -602,6 +805,244 @@ enum sol_image_atlas_result sol_image_atlas_obtain_transient_entry(struct sol_im
 	}
 }
 
+enum sol_image_atlas_result sol_image_atlas_find_identified_entry(struct sol_image_atlas* atlas, uint32_t thread_index, uint64_t entry_identifier, struct sol_image_atlas_location* entry_location)
+{
+	enum sol_image_atlas_result result;
+	uint32_t touched_entry_index;
+
+	assert(thread_index < atlas->thread_count);
+	touched_entry_index = SOL_U32_INVALID;
+
+	if(atlas->description.multithreaded)
+	{
+		mtx_lock(&atlas->mutex);
+	}
+
+	result = sol_image_atlas_locate_identified_entry(atlas, entry_identifier, entry_location, &touched_entry_index);
+
+	if(atlas->description.multithreaded)
+	{
+		mtx_unlock(&atlas->mutex);
+	}
+
+	/** the queue is shared, so rather than moving the entry under the lock, record it in this threads list */
+	if(touched_entry_index != SOL_U32_INVALID)
+	{
+		sol_indices_stack_append(&atlas->thread_lists[thread_index].touched_entries, touched_entry_index);
+	}
+
+	return result;
+}
+
+enum sol_image_atlas_result sol_image_atlas_obtain_identified_entry(struct sol_image_atlas* atlas, uint32_t thread_index, uint64_t entry_identifier, u16_vec2 size, struct sol_image_atlas_location* entry_location)
+{
+	enum sol_image_atlas_result result;
+	uint32_t touched_entry_index;
+
+	assert(thread_index < atlas->thread_count);
+	touched_entry_index = SOL_U32_INVALID;
+
+	if(atlas->description.multithreaded)
+	{
+		mtx_lock(&atlas->mutex);
+	}
+
+	result = sol_image_atlas_allocate_identified_entry(atlas, entry_identifier, size, entry_location, &touched_entry_index);
+
+	if(atlas->description.multithreaded)
+	{
+		mtx_unlock(&atlas->mutex);
+	}
+
+	if(touched_entry_index != SOL_U32_INVALID)
+	{
+		sol_indices_stack_append(&atlas->thread_lists[thread_index].touched_entries, touched_entry_index);
+	}
+
+	return result;
+}
+
+enum sol_image_atlas_result sol_image_atlas_obtain_transient_entry(struct sol_image_atlas* atlas, u16_vec2 size, struct sol_image_atlas_location* entry_location)
+{
+	enum sol_image_atlas_result result;
+
+	if(atlas->description.multithreaded)
+	{
+		mtx_lock(&atlas->mutex);
+	}
+
+	result = sol_image_atlas_allocate_transient_entry(atlas, size, entry_location);
+
+	if(atlas->description.multithreaded)
+	{
+		mtx_unlock(&atlas->mutex);
+	}
+
+	return result;
+}
+
+struct sol_vk_buf_img_copy_list* sol_image_atlas_access_copy_list(struct sol_image_atlas* atlas, uint32_t thread_index)
+{
+	assert(atlas->accessor_active);
+	assert(thread_index < atlas->thread_count);
+
+	return &atlas->thread_lists[thread_index].copies;
+}
+
+void sol_image_atlas_execute_copies(struct sol_image_atlas* atlas, VkCommandBuffer command_buffer, VkBuffer src_buffer, VkDeviceSize src_buffer_offset)
+{
+	struct sol_vk_buf_img_copy_list* merged_copies;
+	struct sol_vk_buf_img_copy_list* thread_copies;
+	uint32_t i;
+
+	assert(atlas->accessor_active);
+
+	merged_copies = &atlas->thread_lists[0].copies;
+
+	for(i = 1; i < atlas->thread_count; i++)
+	{
+		thread_copies = &atlas->thread_lists[i].copies;
+		if(sol_vk_buf_img_copy_list_count(thread_copies) > 0)
+		{
+			sol_vk_buf_img_copy_list_append_many(merged_copies, sol_vk_buf_img_copy_list_data(thread_copies), sol_vk_buf_img_copy_list_count(thread_copies));
+			sol_vk_buf_img_copy_list_reset(thread_copies);
+		}
+	}
+
+	/** resets the list */
+	sol_vk_supervised_image_execute_copies(&atlas->image, merged_copies, command_buffer, src_buffer, src_buffer_offset);
+}
+
+void sol_image_atlas_defragment(struct sol_image_atlas* atlas, VkCommandBuffer command_buffer, VkDeviceSize byte_budget)
+{
+	const struct sol_image_atlas_entry* header_entry;
+	struct sol_image_atlas_entry* entry;
+	struct sol_vk_format_block_properties block_properties;
+	struct sol_buddy_grid_location source_location, destination_location;
+	VkDeviceSize grid_tile_bytes;
+	uint32_t entry_index, candidate_count, relocation_count, i;
+	u16_vec2 grid_size;
+
+	/** locations vended in an access range must remain valid until its end */
+	assert(!atlas->accessor_active);
+
+	/** planning scans and sorts every entry, so only do so once fragmentation has actually caused an acquire to fail */
+	if( ! atlas->description.defragment || ! atlas->fragmented)
+	{
+		return;
+	}
+
+	/** contents are moved with image to image copies */
+	assert((atlas->description.usage & (VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT)) == (VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT));
+
+	block_properties = sol_vk_format_block_properties(atlas->description.format);
+	grid_tile_bytes = (VkDeviceSize)(atlas->description.grid_tile_size.x / block_properties.texel_width) *
+		(VkDeviceSize)(atlas->description.grid_tile_size.y / block_properties.texel_height) * (VkDeviceSize)block_properties.bytes;
+
+	if(byte_budget < grid_tile_bytes)
+	{
+		return;
+	}
+
+	if(atlas->relocation_space < atlas->entry_array.count)
+	{
+		atlas->relocation_space = atlas->entry_array.count;
+		atlas->relocations = realloc(atlas->relocations, sizeof(struct sol_buddy_grid_relocation) * atlas->relocation_space);
+		atlas->relocation_copies = realloc(atlas->relocation_copies, sizeof(VkImageCopy) * atlas->relocation_space);
+	}
+
+	/** outside of an access range every entry is in the queue */
+	header_entry = sol_image_atlas_entry_array_access_entry(&atlas->entry_array, SOL_IA_HEADER_ENTRY_INDEX);
+	candidate_count = 0;
+	for(entry_index = header_entry->next; entry_index != SOL_IA_HEADER_ENTRY_INDEX; entry_index = entry->next)
+	{
+		entry = sol_image_atlas_entry_array_access_entry(&atlas->entry_array, entry_index);
+		assert(candidate_count < atlas->relocation_space);
+		atlas->relocations[candidate_count++] = (struct sol_buddy_grid_relocation)
+		{
+			.source_index = entry->grid_tile_index,
+			.destination_index = SOL_U32_INVALID,
+			.reference = entry_index,
+		};
+	}
+
+	relocation_count = sol_buddy_grid_plan_relocations(atlas->grid, atlas->relocations, candidate_count, (uint32_t)SOL_MIN(byte_budget / grid_tile_bytes, UINT32_MAX));
+
+	if(relocation_count == 0)
+	{
+		/** compacted as far as the planner can, wait for another failed acquire before trying again */
+		atlas->fragmented = false;
+		return;
+	}
+
+	for(i = 0; i < relocation_count; i++)
+	{
+		source_location = sol_buddy_grid_get_location(atlas->grid, atlas->relocations[i].source_index);
+		destination_location = sol_buddy_grid_get_location(atlas->grid, atlas->relocations[i].destination_index);
+		grid_size = sol_buddy_grid_get_size(atlas->grid, atlas->relocations[i].source_index);
+
+		atlas->relocation_copies[i] = (VkImageCopy)
+		{
+			.srcSubresource = (VkImageSubresourceLayers)
+			{
+				.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+				.mipLevel = 0,
+				.baseArrayLayer = source_location.array_layer,
+				.layerCount = 1,
+			},
+			.srcOffset = (VkOffset3D)
+			{
+				.x = source_location.xy_offset.x * atlas->description.grid_tile_size.x,
+				.y = source_location.xy_offset.y * atlas->description.grid_tile_size.y,
+				.z = 0,
+			},
+			.dstSubresource = (VkImageSubresourceLayers)
+			{
+				.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+				.mipLevel = 0,
+				.baseArrayLayer = destination_location.array_layer,
+				.layerCount = 1,
+			},
+			.dstOffset = (VkOffset3D)
+			{
+				.x = destination_location.xy_offset.x * atlas->description.grid_tile_size.x,
+				.y = destination_location.xy_offset.y * atlas->description.grid_tile_size.y,
+				.z = 0,
+			},
+			/** regions are entirely within the image as grid tiles are a multiple of the image size */
+			.extent = (VkExtent3D)
+			{
+				.width  = grid_size.x * atlas->description.grid_tile_size.x,
+				.height = grid_size.y * atlas->description.grid_tile_size.y,
+				.depth  = 1,
+			},
+		};
+
+		if(atlas->description.grid_trace)
+		{
+			/** the planner acquires destinations directly from the grid */
+			sol_buddy_grid_trace_record_acquire(atlas->description.grid_trace, grid_size, true, atlas->relocations[i].destination_index);
+		}
+		atlas->acquired_grid_area += sol_image_atlas_grid_area(grid_size);
+
+		entry = sol_image_atlas_entry_array_access_entry(&atlas->entry_array, atlas->relocations[i].reference);
+		assert(entry->grid_tile_index == atlas->relocations[i].source_index);
+		entry->grid_tile_index = atlas->relocations[i].destination_index;
+	}
+
+	/** sources and destinations never overlap (sources remain acquired while destinations are planned), so all copies can be done at once
+	 * the image is both source and destination, which requires the general layout */
+	sol_vk_supervised_image_barrier(&atlas->image, command_buffer, VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_READ_BIT | VK_ACCESS_2_TRANSFER_WRITE_BIT);
+
+	vkCmdCopyImage(command_buffer, atlas->image.image.image, VK_IMAGE_LAYOUT_GENERAL, atlas->image.image.image, VK_IMAGE_LAYOUT_GENERAL, relocation_count, atlas->relocation_copies);
+
+	/** any subsequent write to the released regions will be recorded after the copies and barriered against them */
+	for(i = 0; i < relocation_count; i++)
+	{
+		sol_image_atlas_grid_release(atlas, atlas->relocations[i].source_index);
+	}
+}
+
 // bool sol_image_atlas_entry_release(struct sol_image_atlas* atlas, uint64_t entry_identifier)
 // {
 // 	assert(false);// NYI
@@ -31,8 +31,9 @@ along with solipsix.  If not, see <https://www.gnu.org/licenses/>.
 #include "vk/timeline_semaphore.h"
 
 #include "data_structures/buddy_grid.h"
+#include "data_structures/buddy_grid_trace.h"
 
-/** external syncrronization of contents must be performed */
+/** external syncrronization of contents must be performed, see `sol_image_atlas_description.multithreaded` for concurrent access to entries */
 
 struct cvm_vk_device;
 
@@ -40,6 +41,8 @@ struct sol_image_atlas;
 
 struct sol_vk_supervised_image;
 
+struct sol_vk_buf_img_copy_list;
+
 #warning these need better names
 enum sol_image_atlas_result
 {
@@ -63,6 +66,23 @@ struct sol_image_atlas_description
 	/** minimum tile size, useful to specify if this wraps a block compressed format, 
 	 * actual allocated regions will be a power of 2 multiplied by this (grid_tile_size * 2^n) */
 	u16_vec2 grid_tile_size;
+
+	/** at the cost of locking a mutex each time; allows find/obtain (and identifier generation) to be called from multiple threads within the same access range
+	 * each thread must pass its own `thread_index` (less than `thread_count`) and record writes into its own copy list (see `sol_image_atlas_access_copy_list`)
+	 * access range begin/end, copy execution and defragmentation must still be externally ordered with respect to these
+	 * NOTE: the mutex guards the map, buddy grid and entry array; moving found entries to the front of the LRU queue is deferred to per-thread lists
+	 * that `sol_image_atlas_access_range_end` drains, so finding an already present entry only holds the lock for the map lookup */
+	bool multithreaded;
+	/** number of threads that may access the atlas concurrently, ignored (treated as 1) unless multithreaded */
+	uint32_t thread_count;
+
+	/** opt in to `sol_image_atlas_defragment`, which otherwise does nothing; usage must then include transfer src and dst
+	 * when set the atlas notes acquires that fail even though enough total area is free (i.e. evictions forced by fragmentation rather than by the atlas being full) */
+	bool defragment;
+
+	/** if set, every acquire/release performed on the atlas' buddy grid is recorded to this trace, for replaying without a GPU (see `buddy_grid_trace.h`)
+	 * must be initialised with a description matching the above and outlive the atlas (the atlas releases everything it holds when destroyed) */
+	struct sol_buddy_grid_trace* grid_trace;
 };
 
 struct sol_image_atlas_location
@@ -102,14 +122,15 @@ bool sol_image_atlas_access_range_is_active(struct sol_image_atlas* atlas);
  * `transient` entries may be released the moment they are no longer retained by an accessor and must be written every time they are used */
 uint64_t sol_image_atlas_generate_entry_identifier(struct sol_image_atlas* atlas);
 
-/** find an existing, initialised entry with the specified identifier */
-enum sol_image_atlas_result sol_image_atlas_find_identified_entry(struct sol_image_atlas* atlas, uint64_t entry_identifier, struct sol_image_atlas_location* entry_location);
+/** find an existing, initialised entry with the specified identifier
+ * `thread_index` identifies the calling thread's lists, must be 0 unless the atlas is multithreaded */
+enum sol_image_atlas_result sol_image_atlas_find_identified_entry(struct sol_image_atlas* atlas, uint32_t thread_index, uint64_t entry_identifier, struct sol_image_atlas_location* entry_location);
 
 /** if the entry didnt exist, create a slot for it, prefer this if entry will be created regardless (over calling find first)
  * this must be used with write if its contents will be modified in any way
  * if the same resource will be written and used over and over it is the callers responsibility to ensure any read-write-read chain is properly synchonised
  * NOTE: transient resources obtained will be made available immediately when access is released */
-enum sol_image_atlas_result sol_image_atlas_obtain_identified_entry(struct sol_image_atlas* atlas, uint64_t entry_identifier, u16_vec2 size, struct sol_image_atlas_location* entry_location);
+enum sol_image_atlas_result sol_image_atlas_obtain_identified_entry(struct sol_image_atlas* atlas, uint32_t thread_index, uint64_t entry_identifier, u16_vec2 size, struct sol_image_atlas_location* entry_location);
 
 
 /** create a tile that will be released at the end of the active access range */
@@ -132,8 +153,20 @@ enum sol_image_atlas_result sol_image_atlas_obtain_transient_entry(struct sol_im
 use that new spot (consider allowing image->image copy list to facilitate this type of behaviour)
 
 
+/** writes to entries obtained by the thread with `thread_index` should be recorded here, only that thread may use it during the access range */
+struct sol_vk_buf_img_copy_list* sol_image_atlas_access_copy_list(struct sol_image_atlas* atlas, uint32_t thread_index);
+
+/** merges every threads copy list and records the copies into the command buffer, all copy lists must be executed this way before the access range ends
+ * must be called after the writes have been recorded, (i.e. externally ordered after any find/obtain in this access range) */
+void sol_image_atlas_execute_copies(struct sol_image_atlas* atlas, VkCommandBuffer command_buffer, VkBuffer src_buffer, VkDeviceSize src_buffer_offset);
+
 struct sol_vk_supervised_image* sol_image_atlas_access_supervised_image(struct sol_image_atlas* atlas);
 VkImageView sol_image_atlas_access_image_view(const struct sol_image_atlas* atlas);
 
 
-// bool sol_image_atlas_defragment(struct sol_image_atlas* atlas, const struct cvm_vk_device* device, )
+/** move entries towards the start of the atlas so that free space coalesces, limited to moving `byte_budget` bytes of image contents per call
+ * does nothing unless the atlas was created with `defragment` set and an acquire has failed due to fragmentation since compaction last ran out of moves
+ * so it's cheap to call regularly (e.g. every frame) with a small budget, the moves are planned from the buddy grid (see `sol_buddy_grid_plan_relocations`)
+ * image to image copies are recorded into the command buffer, which must be submitted before any work using this atlas that is recorded after this call
+ * must be called outside of an access range (so that no location vended in the current access range is invalidated) */
+void sol_image_atlas_defragment(struct sol_image_atlas* atlas, VkCommandBuffer command_buffer, VkDeviceSize byte_budget);
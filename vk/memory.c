@@ -52,9 +52,7 @@ void cvm_vk_managed_buffer_create(cvm_vk_managed_buffer * mb,uint32_t buffer_siz
 
     for(i=0;i<32;i++)
     {
-        mb->available_temporary_allocations[i].heap=malloc(sizeof(uint32_t)*16);
-        mb->available_temporary_allocations[i].space=16;
-        mb->available_temporary_allocations[i].count=0;
+        cvm_vk_available_temporary_allocation_heap_initialise(mb->available_temporary_allocations+i,16);
     }
     mb->available_temporary_allocation_bitmask=0;
 
@@ -101,7 +99,7 @@ void cvm_vk_managed_buffer_destroy(cvm_vk_managed_buffer * mb)
 
     for(i=0;i<32;i++)
     {
-        free(mb->available_temporary_allocations[i].heap);
+        cvm_vk_available_temporary_allocation_heap_terminate(mb->available_temporary_allocations+i);
     }
 
     free(mb->temporary_allocation_data);
@@ -112,8 +110,7 @@ void cvm_vk_managed_buffer_destroy(cvm_vk_managed_buffer * mb)
 
 bool cvm_vk_managed_buffer_acquire_temporary_allocation(cvm_vk_managed_buffer * mb,uint64_t size,uint32_t * allocation_index,uint64_t * allocation_offset)
 {
-    uint32_t i,offset,size_bitmask,up,down,end,size_factor,available_bitmask,additional_allocations;///up down current are for binary heap management
-    uint32_t *heap;
+    uint32_t i,offset,size_bitmask,size_factor,available_bitmask,additional_allocations;
     uint32_t prev_index,next_index;
     cvm_vk_temporary_buffer_allocation_data *allocations,*prev_data,*next_data;
 
@@ -163,31 +160,14 @@ bool cvm_vk_managed_buffer_acquire_temporary_allocation(cvm_vk_managed_buffer *
         ///find lowest size with available allocation
         i=cvm_lbs_32(available_bitmask>>size_factor)+size_factor;
 
-        heap=mb->available_temporary_allocations[i].heap;
-
-        prev_index=heap[0];///what we want, the lowest offset available allocation of the required size or smaller
+        ///what we want, the lowest offset available allocation of the required size or smaller
+        cvm_vk_available_temporary_allocation_heap_withdraw(mb->available_temporary_allocations+i,&prev_index,allocations);
         prev_data=allocations+prev_index;
 
         prev_data->available=false;
         prev_data->size_factor=size_factor;
 
-        if((end= --mb->available_temporary_allocations[i].count))///after extraction patch up the heap if its nonempty
-        {
-            up=0;
-
-            while((down=(up<<1)+1)<end)
-            {
-                down+= (down+1<end) && (allocations[heap[down+1]].offset < allocations[heap[down]].offset);///find smallest of downwards offset
-                if(allocations[heap[end]].offset < allocations[heap[down]].offset) break;///if last element (old count) has smaller offset than next down then early exit
-                allocations[heap[down]].heap_index=up;///need to know (new) index in heap
-                heap[up]=heap[down];
-                up=down;
-            }
-
-            allocations[heap[end]].heap_index=up;
-            heap[up]=heap[end];
-        }
-        else available_bitmask&= ~(1<<i);///otherwise, if now empty mark the heap as such
+        if(cvm_vk_available_temporary_allocation_heap_count(mb->available_temporary_allocations+i)==0)available_bitmask&= ~(1<<i);///if now empty mark the heap as such
 
         while(i-- > size_factor)
         {
@@ -206,11 +186,8 @@ bool cvm_vk_managed_buffer_acquire_temporary_allocation(cvm_vk_managed_buffer *
             next_data->size_factor=i;
             next_data->offset=prev_data->offset+(1u<<i);
             next_data->available=true;
-            next_data->heap_index=0;///index in heap
-            ///if this allocation size wasn't empty, then this code path wouldn't be taken, ergo addition to heap is super simple
-
-            mb->available_temporary_allocations[i].heap[0]=next_index;
-            mb->available_temporary_allocations[i].count=1;
+            ///if this allocation size wasn't empty, then this code path wouldn't be taken, ergo this is the only entry in the heap
+            cvm_vk_available_temporary_allocation_heap_append(mb->available_temporary_allocations+i,next_index,allocations);
 
             available_bitmask|=1<<i;
         }
@@ -250,14 +227,8 @@ bool cvm_vk_managed_buffer_acquire_temporary_allocation(cvm_vk_managed_buffer *
             next_data->prev=prev_index;///right/next will get set after the fact (after this loop), prev on available linked list has not been set, so will need to set that
             next_data->size_factor=i;
             next_data->available=true;
-            next_data->heap_index=mb->available_temporary_allocations[i].count++;///by virtue of being allocated from the end it will have the largest offset, thus will never need to move up the heap
-            ///add to heap
-
-            if(next_data->heap_index==mb->available_temporary_allocations[i].space)
-            {
-                mb->available_temporary_allocations[i].heap=realloc(mb->available_temporary_allocations[i].heap,sizeof(uint32_t)*(mb->available_temporary_allocations[i].space+=16));
-            }
-            mb->available_temporary_allocations[i].heap[next_data->heap_index]=next_index;
+            ///by virtue of being allocated from the end it will have the largest offset, thus will never need to move up the heap
+            cvm_vk_available_temporary_allocation_heap_append(mb->available_temporary_allocations+i,next_index,allocations);
 
             available_bitmask|=1<<i;
 
@@ -292,8 +263,7 @@ bool cvm_vk_managed_buffer_acquire_temporary_allocation(cvm_vk_managed_buffer *
 
 void cvm_vk_managed_buffer_release_temporary_allocation(cvm_vk_managed_buffer * mb,uint32_t allocation_index)
 {
-    uint32_t up,down,end,size_factor,offset;
-    uint32_t * heap;
+    uint32_t size_factor,offset;
     uint32_t neighbour_index;///represents neighbouring/"buddy" allocation
     cvm_vk_temporary_buffer_allocation_data * allocations;
     cvm_vk_temporary_buffer_allocation_data *allocation_data,*neighbour_data;
@@ -322,23 +292,9 @@ void cvm_vk_managed_buffer_release_temporary_allocation(cvm_vk_managed_buffer *
         while(allocation_index!=CVM_INVALID_U32_INDEX && allocations[allocation_index].available)
         {
             size_factor=allocations[allocation_index].size_factor;
-            ///remove from heap, index itself cannot have any children as it's the allocation with the largest offset (it's at the end), but the one we replace it with may, so no need to check down when adding
-            if((end= --mb->available_temporary_allocations[size_factor].count))
-            {
-                heap=mb->available_temporary_allocations[size_factor].heap;
-
-                down=allocations[allocation_index].heap_index;
-                while(down && allocations[heap[end]].offset < allocations[heap[(up=(down-1)>>1)]].offset)
-                {
-                    allocations[heap[up]].heap_index=down;
-                    heap[down]=heap[up];
-                    down=up;
-                }
-
-                allocations[heap[end]].heap_index=down;
-                heap[down]=heap[end];
-            }
-            else mb->available_temporary_allocation_bitmask&= ~(1<<size_factor);///just removed last available allocation of this size
+            ///remove from heap
+            cvm_vk_available_temporary_allocation_heap_withdraw_index(mb->available_temporary_allocations+size_factor,allocations[allocation_index].heap_index,NULL,allocations);
+            if(cvm_vk_available_temporary_allocation_heap_count(mb->available_temporary_allocations+size_factor)==0)mb->available_temporary_allocation_bitmask&= ~(1<<size_factor);///just removed last available allocation of this size
 
             mb->first_unused_temporary_allocation=allocation_index;
             allocation_index=allocations[allocation_index].prev;
@@ -366,33 +322,8 @@ void cvm_vk_managed_buffer_release_temporary_allocation(cvm_vk_managed_buffer *
 
             ///remove n from its availability heap
             ///n's size factor must be same as size factor here
-            if((end= --mb->available_temporary_allocations[size_factor].count))
-            {
-                heap=mb->available_temporary_allocations[size_factor].heap;
-
-                down=neighbour_data->heap_index;
-                ///try moving up
-                while(down && allocations[heap[end]].offset < allocations[heap[(up=(down-1)>>1)]].offset)
-                {
-                    allocations[heap[up]].heap_index=down;
-                    heap[down]=heap[up];
-                    down=up;
-                }
-                ///try moving down
-                up=down;
-                while((down=(up<<1)+1)<end)
-                {
-                    down+= (down+1<end) && (allocations[heap[down+1]].offset < allocations[heap[down]].offset);
-                    if(allocations[heap[end]].offset < allocations[heap[down]].offset) break;///will break on first cycle if above loop did anything
-                    allocations[heap[down]].heap_index=up;
-                    heap[up]=heap[down];
-                    up=down;
-                }
-
-                allocations[heap[end]].heap_index=up;
-                heap[up]=heap[end];
-            }
-            else mb->available_temporary_allocation_bitmask&= ~(1<<size_factor);///just removed last available allocation of this size
+            cvm_vk_available_temporary_allocation_heap_withdraw_index(mb->available_temporary_allocations+size_factor,neighbour_data->heap_index,NULL,allocations);
+            if(cvm_vk_available_temporary_allocation_heap_count(mb->available_temporary_allocations+size_factor)==0)mb->available_temporary_allocation_bitmask&= ~(1<<size_factor);///just removed last available allocation of this size
 
             ///change linked list/ adjacency information
             if(offset&1<<size_factor) /// a is next/right
@@ -416,23 +347,7 @@ void cvm_vk_managed_buffer_release_temporary_allocation(cvm_vk_managed_buffer *
         allocation_data->available=true;
 
         /// add a to appropriate availability heap
-        down=mb->available_temporary_allocations[size_factor].count++;///by virtue of being allocated from the end it will have the largest offset, thus will never need to move up the heap
-
-        heap=mb->available_temporary_allocations[size_factor].heap;
-        if(down==mb->available_temporary_allocations[size_factor].space)
-        {
-            heap=mb->available_temporary_allocations[size_factor].heap=realloc(heap,sizeof(uint32_t)*(mb->available_temporary_allocations[size_factor].space+=16));
-        }
-
-        while(down && offset < allocations[heap[(up=(down-1)>>1)]].offset)
-        {
-            allocations[heap[up]].heap_index=down;
-            heap[down]=heap[up];
-            down=up;
-        }
-
-        allocation_data->heap_index=down;
-        heap[down]=allocation_index;
+        cvm_vk_available_temporary_allocation_heap_append(mb->available_temporary_allocations+size_factor,allocation_index,allocations);
 
         mb->available_temporary_allocation_bitmask|=1<<size_factor;
     }
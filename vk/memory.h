@@ -96,14 +96,15 @@ cvm_vk_temporary_buffer_allocation_data;
 ///     ^ require all chunks to meet the largest supported types alignment requirements
 
 
-///cannot use generic heap for this as a bunch of specialised things are done with this heap (randomised deletions, and tracked indices to support that)
-typedef struct cvm_vk_available_temporary_allocation_heap
-{
-    uint32_t * heap;///indices of allocations
-    uint32_t space;
-    uint32_t count;
-}
-cvm_vk_available_temporary_allocation_heap;
+///heaps of the indices of available allocations ordered by offset, with the index in the heap tracked by the allocation (to support removing arbitrary allocations when recombining)
+///the allocation data array (which may be reallocated) is passed as context
+#define SOL_BINARY_HEAP_ENTRY_TYPE uint32_t
+#define SOL_BINARY_HEAP_STRUCT_NAME cvm_vk_available_temporary_allocation_heap
+#define SOL_BINARY_HEAP_CONTEXT_TYPE cvm_vk_temporary_buffer_allocation_data*
+#define SOL_BINARY_HEAP_DEFAULT_STARTING_SIZE 16
+#define SOL_BINARY_HEAP_ENTRY_CMP_LT(A, B, CTX) ((CTX)[*(A)].offset < (CTX)[*(B)].offset)
+#define SOL_BINARY_HEAP_SET_ENTRY_INDEX(E, IDX, CTX) ((CTX)[*(E)].heap_index = (IDX))
+#include "data_structures/binary_heap.h"
 
 struct cvm_vk_managed_buffer
 {
@@ -127,8 +128,7 @@ struct cvm_vk_managed_buffer
 
     uint32_t last_used_allocation;///used for setting left/right of new allocations
 
-    ///for various reasons can't/shouldn't use generic heap data structure here
-    cvm_vk_available_temporary_allocation_heap available_temporary_allocations[32];
+    struct cvm_vk_available_temporary_allocation_heap available_temporary_allocations[32];
     uint32_t available_temporary_allocation_bitmask;
     uint32_t base_temporary_allocation_size_factor;
 